@@ -0,0 +1,331 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    An aggregation (e.g., a sum or maximum, grouped by the value of a key field) over the rows of many flights.
+    Implementation.
+*/
+
+#include "Aggregation.hh"
+#include "OutputBuffer.hh"
+
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <vector>
+
+#define MAX_ROW_DURATION 10000 // milliseconds; a longer gap between rows (e.g., a break in the log) isn't counted
+
+////////// AggregateGroup implementation //////////
+
+AggregateGroup::AggregateGroup()
+  : value(0.0), numValues(0), numFlights(0), lastFlight(0) {
+}
+
+
+////////// Aggregation implementation //////////
+
+static struct { char const* name; AggregationFunction function; int hasField; } const functions[] = {
+  { "count", AggregateCount, 0 },
+  { "sum", AggregateSum, 1 },
+  { "mean", AggregateMean, 1 },
+  { "min", AggregateMin, 1 },
+  { "max", AggregateMax, 1 },
+  { "time", AggregateTime, 0 }
+};
+#define NUM_FUNCTIONS (sizeof functions/sizeof functions[0])
+
+// Returns "str" without leading or trailing white space:
+static std::string trim(std::string const& str) {
+  std::string::size_type start = 0, end = str.size();
+  while (start < end && isspace((unsigned char)str[start])) ++start;
+  while (end > start && isspace((unsigned char)str[end-1])) --end;
+  return str.substr(start, end - start);
+}
+
+// Returns the column named "name" - or, if "allowRawLabel", whose field (e.g., the raw value of an interpreted
+// column) is "name" - or NULL if none.  (If more than one column has the same name, the last one is used.):
+static OutputColumn const* findColumn(std::string const& name, OutputColumn const* columns, unsigned numColumns,
+				      int allowRawLabel) {
+  OutputColumn const* result = NULL;
+  for (unsigned i = 0; i < numColumns; ++i) {
+    if (name == columns[i].columnName() || (allowRawLabel && name == columns[i].label)) result = &columns[i];
+  }
+
+  return result;
+}
+
+Aggregation* Aggregation::createNew(char const* spec, OutputColumn const* columns, unsigned numColumns) {
+  // Split "spec" into "<function>[(<field>)]" and "<keyField>":
+  std::string str = spec, key;
+  std::string::size_type byPos = str.find(" by ");
+  if (byPos != std::string::npos) {
+    key = trim(str.substr(byPos + 4));
+    str = str.substr(0, byPos);
+  }
+  str = trim(str);
+
+  std::string functionName = str, field;
+  std::string::size_type openPos = str.find('(');
+  if (openPos != std::string::npos) {
+    if (str[str.size()-1] != ')') functionName.clear(); // bad syntax
+    else {
+      functionName = trim(str.substr(0, openPos));
+      field = trim(str.substr(openPos + 1, str.size() - openPos - 2));
+    }
+  }
+
+  unsigned i;
+  for (i = 0; i < NUM_FUNCTIONS; ++i) {
+    if (functionName == functions[i].name && field.empty() == !functions[i].hasField
+	&& (byPos == std::string::npos || !key.empty())) break;
+  }
+  if (i == NUM_FUNCTIONS) {
+    fprintf(stderr, "Bad aggregation \"%s\": expected \"count\", \"time\", \"sum(<field>)\", \"mean(<field>)\", \"min(<field>)\" or \"max(<field>)\", optionally followed by \" by <keyField>\"\n", spec);
+    return NULL;
+  }
+
+  // Check the fields against the output columns (before any flight is parsed):
+  OutputColumn const* fieldColumn = field.empty() ? NULL : findColumn(field, columns, numColumns, 1);
+  if (!field.empty() && fieldColumn == NULL) {
+    fprintf(stderr, "Unknown field \"%s\"\n", field.c_str());
+    return NULL;
+  }
+  if (!key.empty() && findColumn(key, columns, numColumns, 0) == NULL) {
+    fprintf(stderr, "Unknown field \"%s\"\n", key.c_str());
+    return NULL;
+  }
+
+  return new Aggregation(functions[i].function, field, key, fieldColumn == NULL ? 0 : fieldColumn->numFractionalDigits);
+}
+
+Aggregation::Aggregation(AggregationFunction function, std::string const& field, std::string const& key,
+			 unsigned numFractionalDigits)
+  : fFunction(function), fField(field), fKey(key), fNumFractionalDigits(numFractionalDigits),
+    fFieldDatabase(NULL), fFieldLabel(NULL), fKeyColumn(NULL), fKeyInterpretationTable(NULL),
+    fFlightNumber(1), fKeyBuffer(-1, 256), fPreviousGroup(NULL), fPreviousRowTime(-1.0) {
+  for (unsigned i = 0; i < NUM_FUNCTIONS; ++i) {
+    if (functions[i].function == function) fSpec = functions[i].name;
+  }
+  if (!field.empty()) fSpec += "(" + field + ")";
+}
+
+Aggregation::~Aggregation() {
+}
+
+int Aggregation::startFlight(FieldDatabase* fieldDatabase, OutputColumn const* columns, unsigned numColumns) {
+  fFieldDatabase = fieldDatabase;
+  OutputColumn const* fieldColumn = fField.empty() ? NULL : findColumn(fField, columns, numColumns, 1);
+  fFieldLabel = fieldColumn == NULL ? NULL : fieldColumn->label; // (a raw value, if the column is interpreted)
+  fKeyColumn = fKey.empty() ? NULL : findColumn(fKey, columns, numColumns, 0);
+
+  if (!fField.empty() && fFieldLabel == NULL) {
+    fprintf(stderr, "Unknown field \"%s\"\n", fField.c_str());
+    return 0;
+  }
+  if (!fKey.empty() && fKeyColumn == NULL) {
+    fprintf(stderr, "Unknown field \"%s\"\n", fKey.c_str());
+    return 0;
+  }
+  if (fKeyColumn != NULL && fKeyColumn->kind == ColumnInterpreted) {
+    fKeyInterpretationTable = fieldDatabase->lookupInterpretationTable(fKeyColumn->interpretedLabel);
+  }
+
+  return 1;
+}
+
+AggregateGroup* Aggregation::currentGroup() {
+  if (fKeyColumn == NULL) return fPreviousGroup = &fGroups[""]; // there's just one group
+
+  // Format the key's current value (as in the CSV output):
+  FieldSnapshot snapshot;
+  fArena.reset();
+  fFieldDatabase->snapshotField(fKeyColumn->label, snapshot, fArena);
+  if (!snapshot.isPresent) return NULL;
+
+  fKeyBuffer.reset();
+  switch (fKeyColumn->kind) {
+    case ColumnPlain: {
+      FieldDatabase::formatField(fKeyBuffer, snapshot, fKeyColumn->numFractionalDigits);
+      break;
+    }
+    case ColumnBoolean: {
+      FieldDatabase::formatFieldAsBoolean(fKeyBuffer, snapshot);
+      break;
+    }
+    case ColumnInterpreted: {
+      FieldDatabase::formatFieldInterpreted(fKeyBuffer, snapshot, fKeyInterpretationTable);
+      break;
+    }
+  }
+
+  // The key usually has the same value as in the previous row, so check for that before looking it up:
+  if (fPreviousGroup == NULL || fPreviousKey.compare(0, std::string::npos, fKeyBuffer.data(), fKeyBuffer.size()) != 0) {
+    fPreviousKey.assign(fKeyBuffer.data(), fKeyBuffer.size());
+    for (unsigned i = 0; i < fPreviousKey.size(); ++i) {
+      if (fPreviousKey[i] == '\t' || fPreviousKey[i] == '\n') fPreviousKey[i] = ' '; // (see "writePartial()")
+    }
+    fPreviousGroup = &fGroups[fPreviousKey]; // (pointers to elements remain valid as the map grows)
+  }
+  return fPreviousGroup;
+}
+
+void Aggregation::noteFlight(AggregateGroup& group) {
+  if (group.lastFlight != fFlightNumber) {
+    group.lastFlight = fFlightNumber;
+    ++group.numFlights;
+  }
+}
+
+void Aggregation::noteRow(int isColumnLabels) {
+  if (isColumnLabels || !functionIsPerRow()) return; // we use only the final values, in "endFlight()"
+
+  if (fFunction == AggregateTime) {
+    // The time between the previous row and this one is spent in the previous row's group:
+    double rowTime;
+    if (!fFieldDatabase->getFieldAsDouble("CUSTOM.updateTime", rowTime)) return;
+    AggregateGroup* previousGroup = fPreviousRowTime >= 0.0 ? fPreviousGroup : NULL;
+    if (previousGroup != NULL && rowTime > fPreviousRowTime && rowTime - fPreviousRowTime <= MAX_ROW_DURATION) {
+      previousGroup->value += rowTime - fPreviousRowTime; // milliseconds (so that the sum is exact)
+      ++previousGroup->numValues;
+      noteFlight(*previousGroup);
+    }
+
+    fPreviousRowTime = currentGroup() != NULL ? rowTime : -1.0;
+    return;
+  }
+
+  // "min" or "max":
+  double value;
+  if (!fFieldDatabase->getFieldAsDouble(fFieldLabel, value) || value != value/*NaN*/) return;
+  AggregateGroup* group = currentGroup();
+  if (group == NULL) return;
+
+  if (group->numValues == 0 || (fFunction == AggregateMin ? value < group->value : value > group->value)) {
+    group->value = value;
+  }
+  ++group->numValues;
+  noteFlight(*group);
+}
+
+void Aggregation::endFlight() {
+  if (!functionIsPerRow()) {
+    // Use the fields' final values:
+    double value = 0.0;
+    AggregateGroup* group;
+    if ((fFieldLabel == NULL || (fFieldDatabase->getFieldAsDouble(fFieldLabel, value) && value == value/*not NaN*/))
+	&& (group = currentGroup()) != NULL) {
+      group->value += fFunction == AggregateCount ? 1.0 : value;
+      ++group->numValues;
+      noteFlight(*group);
+    }
+  }
+
+  // Get ready for the next flight:
+  ++fFlightNumber;
+  fPreviousGroup = NULL;
+  fPreviousRowTime = -1.0;
+}
+
+int Aggregation::writePartial(FILE* fid) const {
+  // Each line is: <key> <value> <numValues> <numFlights> (tab-separated):
+  for (std::unordered_map<std::string, AggregateGroup>::const_iterator itr = fGroups.begin(); itr != fGroups.end(); ++itr) {
+    AggregateGroup const& group = itr->second; // alias
+    if (group.numValues == 0) continue;
+    fprintf(fid, "%s\t%.17g\t%llu\t%llu\n", itr->first.c_str(), group.value,
+	    (unsigned long long)group.numValues, (unsigned long long)group.numFlights);
+  }
+
+  return fflush(fid) == 0 && !ferror(fid);
+}
+
+int Aggregation::mergePartial(FILE* fid) {
+  char* line = NULL;
+  size_t lineSize = 0;
+  int result = 1;
+  while (getline(&line, &lineSize, fid) > 0) {
+    line[strcspn(line, "\n")] = '\0';
+
+    // The key may be empty, so split the line from the end: <key> <value> <numValues> <numFlights>:
+    char* fields[3];
+    unsigned numFields = 0;
+    for (; numFields < 3; ++numFields) {
+      char* tab = strrchr(line, '\t');
+      if (tab == NULL) break;
+      *tab = '\0';
+      fields[2-numFields] = tab + 1;
+    }
+    double value;
+    unsigned long long numValues, numFlights;
+    if (numFields != 3 || sscanf(fields[0], "%lg", &value) != 1
+	|| sscanf(fields[1], "%llu", &numValues) != 1 || sscanf(fields[2], "%llu", &numFlights) != 1) {
+      result = 0;
+      break;
+    }
+
+    AggregateGroup& group = fGroups[line]; // alias
+    if (fFunction == AggregateMin || fFunction == AggregateMax) {
+      if (group.numValues == 0 || (fFunction == AggregateMin ? value < group.value : value > group.value)) {
+	group.value = value;
+      }
+    } else {
+      group.value += value;
+    }
+    group.numValues += numValues;
+    group.numFlights += numFlights; // (each partial result is from different flights)
+  }
+
+  free(line);
+  return result;
+}
+
+void Aggregation::outputResult(FILE* fid) const {
+  std::vector<std::string> keys;
+  for (std::unordered_map<std::string, AggregateGroup>::const_iterator itr = fGroups.begin(); itr != fGroups.end(); ++itr) {
+    if (itr->second.numValues > 0) keys.push_back(itr->first);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  if (!fKey.empty()) {
+    outputCSVString(fid, fKey.c_str());
+    fputc(',', fid);
+  }
+  outputCSVString(fid, fSpec.c_str());
+  fputs(",flights\n", fid);
+  for (unsigned i = 0; i < keys.size(); ++i) {
+    AggregateGroup const& group = fGroups.find(keys[i])->second; // alias
+    if (!fKey.empty()) {
+      outputCSVString(fid, keys[i].c_str());
+      fputc(',', fid);
+    }
+
+    // A count is a whole number, and a time is in seconds (from milliseconds).  Other values are output at the
+    // precision of their field, as in the CSV output:
+    if (fFunction == AggregateCount) {
+      fprintf(fid, "%.0f", group.value);
+    } else if (fFunction == AggregateTime) {
+      fprintf(fid, "%.3f", group.value/1000.0);
+    } else {
+      fprintf(fid, "%.*f", fNumFractionalDigits,
+	      fFunction == AggregateMean ? group.value/group.numValues : group.value);
+    }
+    fprintf(fid, ",%llu\n", (unsigned long long)group.numFlights);
+  }
+}
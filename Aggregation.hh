@@ -0,0 +1,118 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    An aggregation (e.g., a sum or maximum, grouped by the value of a key field) over the rows of many flights.
+    Header File.
+*/
+
+#ifndef _AGGREGATION_HH
+#define _AGGREGATION_HH
+
+#ifndef _ROW_WRITER_HH
+#include "RowWriter.hh"
+#endif
+#ifndef _FLIGHT_OBSERVER_HH
+#include "FlightObserver.hh"
+#endif
+
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+
+// The functions that can be aggregated:
+enum AggregationFunction {
+  AggregateCount, // the number of flights
+  AggregateSum, // of the field's final value in each flight (e.g., "DETAILS.totalTime")
+  AggregateMean, // ditto
+  AggregateMin, // of the field's value in every row
+  AggregateMax, // ditto
+  AggregateTime // the time (in seconds) spent in each row
+};
+
+// The (partial) result for one value of the key:
+class AggregateGroup {
+public:
+  AggregateGroup();
+
+public:
+  double value; // the sum (for count, sum, mean and time (in milliseconds)), or the minimum or maximum
+  u_int64_t numValues; // the number of values that contributed to "value"
+  u_int64_t numFlights; // the number of flights that contributed to "value"
+  u_int32_t lastFlight; // used to count flights
+};
+
+// An aggregation - specified as "<function>[(<field>)][ by <keyField>]", e.g., "sum(DETAILS.totalTime) by
+// DETAILS.aircraftSn", "max(CENTER_BATTERY.loopNum) by DETAILS.batterySn" or "time by OSD.flycState" - over
+// the rows of any number of flights (each followed as it's parsed; see "DJITxtParser::addFlightObserver()").
+// Fields are named as in the CSV output's column labels.  Partial results (e.g., from separate processes) can
+// be merged:
+class Aggregation: public FlightObserver {
+public:
+  static Aggregation* createNew(char const* spec, OutputColumn const* columns, unsigned numColumns);
+      // returns NULL (after reporting an error) if "spec" is bad, or names a field that isn't one of the "columns"
+      // (see "DJITxtParser::outputColumnTable()")
+
+  virtual ~Aggregation();
+
+  // Partial results are written (as text, one line per group) to, and merged from, a file (e.g., a
+  // worker process's results file; see "WorkerPool.hh").  Each returns 1 iff it succeeds:
+  int writePartial(FILE* fid) const;
+  int mergePartial(FILE* fid);
+
+  void outputResult(FILE* fid) const; // as CSV, one line per value of the key (in order)
+
+private: // redefined virtual functions:
+  virtual int startFlight(FieldDatabase* fieldDatabase, OutputColumn const* columns, unsigned numColumns);
+      // returns 0 (after reporting an error) if one of our fields isn't an output column
+  virtual void noteRow(int isColumnLabels);
+  virtual void endFlight();
+
+private:
+  Aggregation(AggregationFunction function, std::string const& field, std::string const& key,
+	      unsigned numFractionalDigits); // called only by "createNew()"
+
+  int functionIsPerRow() const { return fFunction >= AggregateMin; }
+  AggregateGroup* currentGroup(); // for the key's current value; NULL if the key has no value
+  void noteFlight(AggregateGroup& group);
+
+private:
+  AggregationFunction fFunction;
+  std::string fSpec, fField, fKey; // "fField" and/or "fKey" may be empty
+  unsigned fNumFractionalDigits; // of "fField"'s column; its results are output at this precision
+
+  // Set by "startFlight()":
+  FieldDatabase* fFieldDatabase;
+  char const* fFieldLabel; // the database's label for "fField" (NULL if none)
+  OutputColumn const* fKeyColumn; // NULL if there's no key
+  InterpretationTable* fKeyInterpretationTable; // used only if "fKeyColumn" is interpreted
+
+  std::unordered_map<std::string, AggregateGroup> fGroups;
+  u_int32_t fFlightNumber; // of the current flight (starting at 1)
+
+  // State used while formatting the key:
+  StringArena fArena;
+  OutputBuffer fKeyBuffer; // in memory
+  std::string fPreviousKey;
+  AggregateGroup* fPreviousGroup; // for "fPreviousKey"
+  double fPreviousRowTime; // in milliseconds; < 0 if none (in this flight)
+};
+
+#endif
@@ -0,0 +1,256 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Exporting a "FlightTable" through the Arrow C Data Interface (a plain C ABI; no Arrow library is needed).
+    Implementation.
+*/
+
+#include "ArrowExport.hh"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+////////// Schema export //////////
+
+// An exported schema owns (copies of) its strings, so it doesn't depend upon the table at all:
+static void releaseSchema(struct ArrowSchema* schema) {
+  for (int64_t i = 0; i < schema->n_children; ++i) {
+    struct ArrowSchema* child = schema->children[i];
+    if (child->release != NULL) child->release(child);
+    delete child;
+  }
+  delete[] schema->children;
+
+  if (schema->dictionary != NULL) {
+    if (schema->dictionary->release != NULL) schema->dictionary->release(schema->dictionary);
+    delete schema->dictionary;
+  }
+
+  delete[] (char*)schema->format;
+  delete[] (char*)schema->name;
+  schema->release = NULL;
+}
+
+static char* strDup(char const* str) {
+  char* result = new char[strlen(str) + 1];
+  strcpy(result, str);
+  return result;
+}
+
+static void initSchema(struct ArrowSchema* schema, char const* format, char const* name,
+		       int64_t flags, unsigned numChildren) {
+  schema->format = strDup(format);
+  schema->name = strDup(name);
+  schema->metadata = NULL;
+  schema->flags = flags;
+  schema->n_children = numChildren;
+  schema->children = NULL;
+  if (numChildren > 0) {
+    schema->children = new struct ArrowSchema*[numChildren];
+    for (unsigned i = 0; i < numChildren; ++i) schema->children[i] = new struct ArrowSchema;
+  }
+  schema->dictionary = NULL;
+  schema->release = releaseSchema;
+  schema->private_data = NULL;
+}
+
+////////// Array export //////////
+
+// The table (whose buffers the exported arrays refer to) is shared by all of the exported arrays.
+// Because a consumer may move child arrays out of their parent (and release them separately),
+// the table is reference-counted, and deleted only when the last exported array is released:
+class ExportedTable {
+public:
+  ExportedTable(FlightTable* table): fTable(table), fRefCount(0) {}
+  ~ExportedTable() { delete fTable; }
+
+  void addRef() { ++fRefCount; }
+  void release() { if (--fRefCount == 0) delete this; }
+
+private:
+  FlightTable* fTable;
+  std::atomic<unsigned> fRefCount;
+};
+
+// The producer-specific data for each exported array:
+class ExportedArray {
+public:
+  ExportedArray(ExportedTable* owner): fOwner(owner), fPackedBooleans(NULL) {
+    fOwner->addRef();
+    fBuffers[0] = fBuffers[1] = fBuffers[2] = NULL;
+  }
+  ~ExportedArray() {
+    delete[] fPackedBooleans;
+    fOwner->release();
+  }
+
+public:
+  ExportedTable* fOwner;
+  void const* fBuffers[3];
+  u_int8_t* fPackedBooleans; // used only for "FlightColumnBoolean" columns
+};
+
+static void releaseArray(struct ArrowArray* array) {
+  for (int64_t i = 0; i < array->n_children; ++i) {
+    struct ArrowArray* child = array->children[i];
+    if (child->release != NULL) child->release(child);
+    delete child;
+  }
+  delete[] array->children;
+
+  if (array->dictionary != NULL) {
+    if (array->dictionary->release != NULL) array->dictionary->release(array->dictionary);
+    delete array->dictionary;
+  }
+
+  delete (ExportedArray*)array->private_data;
+  array->release = NULL;
+}
+
+static ExportedArray* initArray(struct ArrowArray* array, ExportedTable* owner,
+				int64_t length, int64_t nullCount, unsigned numBuffers, unsigned numChildren) {
+  ExportedArray* exportedArray = new ExportedArray(owner);
+
+  array->length = length;
+  array->null_count = nullCount;
+  array->offset = 0;
+  array->n_buffers = numBuffers;
+  array->n_children = numChildren;
+  array->buffers = exportedArray->fBuffers;
+  array->children = NULL;
+  if (numChildren > 0) {
+    array->children = new struct ArrowArray*[numChildren];
+    for (unsigned i = 0; i < numChildren; ++i) array->children[i] = new struct ArrowArray;
+  }
+  array->dictionary = NULL;
+  array->release = releaseArray;
+  array->private_data = exportedArray;
+
+  return exportedArray;
+}
+
+#define MAX_INT32_OFFSET 0x7FFFFFFF
+
+static void exportColumn(FlightColumn const* column, ExportedTable* owner,
+			 struct ArrowSchema* schema, struct ArrowArray* array) {
+  unsigned length = column->length();
+  unsigned nullCount = column->nullCount();
+
+  // The validity bitmap may be omitted if there are no nulls:
+  void const* validity = nullCount > 0 ? column->validityBitmap() : NULL;
+
+  switch (column->type()) {
+    case FlightColumnNull: {
+      initSchema(schema, "n", column->name(), ARROW_FLAG_NULLABLE, 0);
+      (void)initArray(array, owner, length, length, 0, 0); // a 'null' array has no buffers
+      break;
+    }
+    case FlightColumnInt64:
+    case FlightColumnTimestamp: {
+      initSchema(schema, column->type() == FlightColumnInt64 ? "l" : "tsm:", column->name(),
+		 ARROW_FLAG_NULLABLE, 0);
+      ExportedArray* exportedArray = initArray(array, owner, length, nullCount, 2, 0);
+      exportedArray->fBuffers[0] = validity;
+      exportedArray->fBuffers[1] = column->int64Values();
+      break;
+    }
+    case FlightColumnDouble: {
+      initSchema(schema, "g", column->name(), ARROW_FLAG_NULLABLE, 0);
+      ExportedArray* exportedArray = initArray(array, owner, length, nullCount, 2, 0);
+      exportedArray->fBuffers[0] = validity;
+      exportedArray->fBuffers[1] = column->doubleValues();
+      break;
+    }
+    case FlightColumnBoolean: {
+      initSchema(schema, "b", column->name(), ARROW_FLAG_NULLABLE, 0);
+      ExportedArray* exportedArray = initArray(array, owner, length, nullCount, 2, 0);
+
+      // Arrow booleans are bit-packed (like the validity bitmap), so we can't export the table's
+      // (one byte per value) buffer directly:
+      unsigned numBytes = (length+7)/8;
+      u_int8_t* packedBooleans = exportedArray->fPackedBooleans = new u_int8_t[numBytes];
+      memset(packedBooleans, 0, numBytes);
+      u_int8_t const* booleans = column->booleanValues();
+      for (unsigned i = 0; i < length; ++i) {
+	if (booleans[i]) packedBooleans[i>>3] |= 1<<(i&7);
+      }
+
+      exportedArray->fBuffers[0] = validity;
+      exportedArray->fBuffers[1] = packedBooleans;
+      break;
+    }
+    case FlightColumnString: {
+      // Our (unsigned) 32-bit offsets are also valid (signed) Arrow "utf8" offsets (we checked that
+      // they're small enough before exporting):
+      initSchema(schema, "u", column->name(), ARROW_FLAG_NULLABLE, 0);
+      ExportedArray* exportedArray = initArray(array, owner, length, nullCount, 3, 0);
+      exportedArray->fBuffers[0] = validity;
+      exportedArray->fBuffers[1] = column->stringOffsets();
+      exportedArray->fBuffers[2] = column->stringData();
+      break;
+    }
+    case FlightColumnDictionary: {
+      initSchema(schema, "i", column->name(), ARROW_FLAG_NULLABLE, 0);
+      schema->dictionary = new struct ArrowSchema;
+      initSchema(schema->dictionary, "u", "", 0, 0);
+
+      ExportedArray* exportedArray = initArray(array, owner, length, nullCount, 2, 0);
+      exportedArray->fBuffers[0] = validity;
+      exportedArray->fBuffers[1] = column->dictionaryIndices();
+
+      array->dictionary = new struct ArrowArray;
+      ExportedArray* exportedDictionary
+	= initArray(array->dictionary, owner, column->dictionarySize(), 0, 3, 0);
+      exportedDictionary->fBuffers[1] = column->dictionaryOffsets();
+      exportedDictionary->fBuffers[2] = column->dictionaryData();
+      break;
+    }
+  }
+}
+
+int exportFlightTableToArrow(FlightTable* table, struct ArrowSchema* schema, struct ArrowArray* array) {
+  if (table == NULL) return 0;
+  unsigned numColumns = table->numColumns();
+
+  // Check that each string column can be exported with 32-bit offsets:
+  for (unsigned i = 0; i < numColumns; ++i) {
+    FlightColumn const* column = table->column(i);
+    if ((column->type() == FlightColumnString
+	 && column->stringOffsets()[column->length()] > MAX_INT32_OFFSET)
+	|| (column->type() == FlightColumnDictionary
+	    && column->dictionaryOffsets()[column->dictionarySize()] > MAX_INT32_OFFSET)) {
+      fprintf(stderr, "Can't export column \"%s\" to Arrow: its string data is too large\n", column->name());
+      return 0;
+    }
+  }
+
+  initSchema(schema, "+s", "", 0, numColumns);
+
+  ExportedTable* owner = new ExportedTable(table);
+  ExportedArray* exportedArray = initArray(array, owner, table->numRows(), 0, 1, numColumns);
+  exportedArray->fBuffers[0] = NULL; // the rows themselves are never null
+
+  for (unsigned i = 0; i < numColumns; ++i) {
+    exportColumn(table->column(i), owner, schema->children[i], array->children[i]);
+  }
+
+  return 1;
+}
@@ -0,0 +1,94 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Exporting a "FlightTable" through the Arrow C Data Interface (a plain C ABI; no Arrow library is needed).
+    Header File.
+*/
+
+#ifndef _ARROW_EXPORT_HH
+#define _ARROW_EXPORT_HH
+
+#ifndef _FLIGHT_TABLE_HH
+#include "FlightTable.hh"
+#endif
+
+#include <stdint.h>
+
+// The following definitions are copied verbatim from the Arrow C Data Interface specification
+// (https://arrow.apache.org/docs/format/CDataInterface.html), so that they're compatible with
+// (and may be included alongside) Arrow's own "abi.h":
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+// Exports "table" as an Arrow 'struct' array (with one child array per column), and its schema.
+// Column types are exported as:
+//	int64 => "l"; double => "g" (float64); boolean => "b"; timestamp => "tsm:" (milliseconds);
+//	string => "u" (utf8); dictionary => "i" (int32 indices) into a "u" dictionary;
+//	a column that never had a value => "n" (null)
+// The exported arrays refer directly to the table's own buffers (except for booleans, which are
+// bit-packed on export).  Therefore the arrays take ownership of "table": it is deleted once the
+// consumer has released the top-level array, and every child array that it moved out of it.
+// (The schema does not refer to the table, and can be released independently.)
+// Returns 1 iff it succeeds (in which case both "*schema" and "*array" must later be released);
+// on failure (e.g., a string column too large for 32-bit offsets), neither is set, and the caller
+// still owns "table".
+int exportFlightTableToArrow(FlightTable* table, struct ArrowSchema* schema, struct ArrowArray* array);
+
+#endif
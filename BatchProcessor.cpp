@@ -0,0 +1,312 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Incremental processing of a directory of ".txt" files, using a persistent manifest of the results.
+    Implementation.
+*/
+
+#include "BatchProcessor.hh"
+#include "FileHash.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <limits.h>
+#include <algorithm>
+
+BatchProcessor* BatchProcessor::createNew(char const* inputDirectoryName, char const* outputDirectoryName,
+					  char const* outputSuffix, BatchProcessFunc* processFunc) {
+  if (mkdir(outputDirectoryName, 0755) != 0 && errno != EEXIST) {
+    fprintf(stderr, "Failed to create the output directory \"%s\": %s\n", outputDirectoryName, strerror(errno));
+    return NULL;
+  }
+
+  BatchProcessor* batchProcessor
+    = new BatchProcessor(inputDirectoryName, outputDirectoryName, outputSuffix, processFunc);
+  if (!batchProcessor->readManifest()) {
+    delete batchProcessor;
+    return NULL;
+  }
+
+  return batchProcessor;
+}
+
+BatchProcessor::BatchProcessor(char const* inputDirectoryName, char const* outputDirectoryName,
+			       char const* outputSuffix, BatchProcessFunc* processFunc)
+  : fInputDirectoryName(inputDirectoryName), fOutputDirectoryName(outputDirectoryName),
+    fManifestFileName(outputPath(BATCH_MANIFEST_FILE_NAME)),
+    fOutputSuffix(outputSuffix), fProcessFunc(processFunc), fManifestWriteFailed(0) {
+}
+
+BatchProcessor::~BatchProcessor() {
+}
+
+// Returns the length of "name"'s ".txt" (or gzip-compressed ".txt.gz") suffix, or 0 if it has neither:
+static unsigned txtSuffixLength(char const* name) {
+  unsigned nameLength = strlen(name);
+  if (nameLength > 4 && strcasecmp(&name[nameLength-4], ".txt") == 0) return 4;
+  if (nameLength > 7 && strcasecmp(&name[nameLength-7], ".txt.gz") == 0) return 7;
+  return 0;
+}
+
+int BatchProcessor::listInputFiles(char const* inputDirectoryName, std::vector<std::string>& names) {
+  DIR* dir = opendir(inputDirectoryName);
+  if (dir == NULL) {
+    fprintf(stderr, "Failed to open the input directory \"%s\": %s\n", inputDirectoryName, strerror(errno));
+    return 0;
+  }
+  names.clear();
+  struct dirent* dirEntry;
+  while ((dirEntry = readdir(dir)) != NULL) {
+    if (txtSuffixLength(dirEntry->d_name) > 0) names.push_back(dirEntry->d_name);
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+
+  return 1;
+}
+
+int BatchProcessor::run(unsigned maxNumProcesses) {
+  std::vector<std::string> names;
+  if (!listInputFiles(fInputDirectoryName.c_str(), names)) return 1;
+
+  // Forget the input files that are no longer in the directory, then figure out which files need to
+  // be processed:
+  int manifestChanged = removeMissingInputs(names);
+  fPending.clear();
+  unsigned numUpToDate = 0;
+  for (unsigned i = 0; i < names.size(); ++i) {
+    if (strpbrk(names[i].c_str(), "\t\n") != NULL) continue; // can't be recorded in the manifest
+    if (txtSuffixLength(names[i].c_str()) == 7
+	&& std::binary_search(names.begin(), names.end(), names[i].substr(0, names[i].size()-3))) {
+      // "<name>.txt.gz" would have the same output (and JPEG archive) as "<name>.txt", so process only the latter:
+      fprintf(stderr, "Skipping \"%s\", because \"%s\" (which has the same output file names) is also in the directory\n",
+	      inputPath(names[i]).c_str(), names[i].substr(0, names[i].size()-3).c_str());
+      continue;
+    }
+
+    struct stat sb;
+    if (stat(inputPath(names[i]).c_str(), &sb) != 0 || !S_ISREG(sb.st_mode)) continue;
+
+    ManifestEntry entry;
+    entry.name = names[i];
+    entry.size = sb.st_size;
+    entry.mtimeSeconds = sb.st_mtim.tv_sec;
+    entry.mtimeNanoseconds = sb.st_mtim.tv_nsec;
+    entry.outputName = "-";
+    if (fOutputSuffix != NULL) {
+      entry.outputName = names[i].substr(0, names[i].size() - txtSuffixLength(names[i].c_str())) + fOutputSuffix;
+    }
+
+    std::unordered_map<std::string, unsigned>::iterator itr = fManifestIndex.find(entry.name);
+    ManifestEntry const* previous = itr == fManifestIndex.end() ? NULL : &fManifest[itr->second];
+    if (previous != NULL && previous->outputName == entry.outputName && outputExists(*previous)
+	&& previous->size == entry.size && previous->mtimeSeconds == entry.mtimeSeconds
+	&& previous->mtimeNanoseconds == entry.mtimeNanoseconds) {
+      ++numUpToDate; // unchanged since we last processed it
+      continue;
+    }
+
+    if (!hashFile(inputPath(entry.name).c_str(), entry.hash)) {
+      fprintf(stderr, "Failed to read \"%s\"\n", inputPath(entry.name).c_str());
+      continue;
+    }
+    if (previous != NULL && previous->outputName == entry.outputName && outputExists(*previous)
+	&& previous->size == entry.size && previous->hash == entry.hash) {
+      // The file was touched (or copied again), but its contents are the same:
+      updateManifest(entry);
+      manifestChanged = 1;
+      ++numUpToDate;
+      continue;
+    }
+
+    fPending.push_back(entry);
+  }
+  if (manifestChanged && !writeManifest()) return 1;
+
+  fprintf(stderr, "%u file(s) are up-to-date; %u file(s) to process\n", numUpToDate, (unsigned)fPending.size());
+
+  // Process the pending files, in up to "maxNumProcesses" worker processes.  (Each is added to the
+  // manifest - in "taskDone()" - as soon as it's done.):
+  fManifestWriteFailed = 0;
+  int result = runTasks(fPending.size(), maxNumProcesses) ? 0 : 1;
+  fPending.clear();
+
+  return result || fManifestWriteFailed;
+}
+
+int BatchProcessor::outputExists(ManifestEntry const& entry) const {
+  if (entry.outputName == "-") return 1;
+
+  struct stat sb;
+  return stat(outputPath(entry.outputName).c_str(), &sb) == 0;
+}
+
+int BatchProcessor::doTask(unsigned taskIndex, FILE* /*resultFile*/) {
+  // (We're in a worker process.)  Process the file, writing its output to a temporary file:
+  ManifestEntry const& entry = fPending[taskIndex]; // alias
+  int outputFD = 1;
+  if (fOutputSuffix != NULL) {
+    std::string tempOutputFileName = outputPath(entry.outputName) + ".tmp";
+    outputFD = open(tempOutputFileName.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (outputFD < 0) {
+      fprintf(stderr, "Failed to open \"%s\": %s\n", tempOutputFileName.c_str(), strerror(errno));
+      return 0;
+    }
+  }
+
+  int result = (*fProcessFunc)(inputPath(entry.name).c_str(), fOutputDirectoryName.c_str(), outputFD) == 0;
+  if (fOutputSuffix != NULL && close(outputFD) != 0) result = 0;
+  return result;
+}
+
+void BatchProcessor::taskDone(unsigned taskIndex, int succeeded) {
+  ManifestEntry const& entry = fPending[taskIndex]; // alias
+
+  // The output was written to a temporary file.  If the file was processed successfully, rename it, then
+  // record the result in the manifest:
+  std::string outputFileName = outputPath(entry.outputName);
+  std::string tempOutputFileName = outputFileName + ".tmp";
+  if (succeeded && (fOutputSuffix == NULL || rename(tempOutputFileName.c_str(), outputFileName.c_str()) == 0)) {
+    updateManifest(entry);
+    if (!writeManifest()) fManifestWriteFailed = 1;
+    fprintf(stderr, "Processed \"%s\"\n", inputPath(entry.name).c_str());
+  } else {
+    fprintf(stderr, "Failed to process \"%s\"\n", inputPath(entry.name).c_str());
+    if (fOutputSuffix != NULL) unlink(tempOutputFileName.c_str());
+  }
+}
+
+void BatchProcessor::updateManifest(ManifestEntry const& entry) {
+  std::unordered_map<std::string, unsigned>::iterator itr = fManifestIndex.find(entry.name);
+  if (itr != fManifestIndex.end()) {
+    fManifest[itr->second] = entry;
+  } else {
+    fManifestIndex[entry.name] = fManifest.size();
+    fManifest.push_back(entry);
+  }
+}
+
+int BatchProcessor::removeMissingInputs(std::vector<std::string> const& names) {
+  std::vector<ManifestEntry> remaining;
+  for (unsigned i = 0; i < fManifest.size(); ++i) {
+    if (std::binary_search(names.begin(), names.end(), fManifest[i].name)) remaining.push_back(fManifest[i]);
+  }
+  if (remaining.size() == fManifest.size()) return 0;
+
+  fManifest.swap(remaining);
+  fManifestIndex.clear();
+  for (unsigned i = 0; i < fManifest.size(); ++i) fManifestIndex[fManifest[i].name] = i;
+  return 1;
+}
+
+////////// Reading and writing the manifest //////////
+
+// The manifest is a text file, with one (tab-separated) line for each input file that has been
+// processed successfully:
+//	<name> <size> <mtime (seconds.nanoseconds)> <content hash (hex)> <output name>
+
+int BatchProcessor::readManifest() {
+  FILE* fid = fopen(fManifestFileName.c_str(), "r");
+  if (fid == NULL) {
+    if (errno == ENOENT) return 1; // we're starting from scratch
+    fprintf(stderr, "Failed to open \"%s\": %s\n", fManifestFileName.c_str(), strerror(errno));
+    return 0;
+  }
+
+  char line[2*PATH_MAX + 100];
+  unsigned version = 0;
+  if (fgets(line, sizeof line, fid) == NULL
+      || sscanf(line, "# djiparsetxt manifest, version %u", &version) != 1 || version != BATCH_MANIFEST_VERSION) {
+    fprintf(stderr, "\"%s\" is not a (version %u) manifest\n", fManifestFileName.c_str(), BATCH_MANIFEST_VERSION);
+    fclose(fid);
+    return 0;
+  }
+
+  while (fgets(line, sizeof line, fid) != NULL) {
+    if (line[0] == '#') continue;
+    line[strcspn(line, "\n")] = '\0';
+
+    char* fields[5];
+    unsigned numFields = 0;
+    char* savePtr;
+    for (char* field = strtok_r(line, "\t", &savePtr); field != NULL && numFields < 5;
+	 field = strtok_r(NULL, "\t", &savePtr)) {
+      fields[numFields++] = field;
+    }
+
+    ManifestEntry entry;
+    unsigned long long size, hash;
+    long long mtimeSeconds;
+    if (numFields != 5
+	|| sscanf(fields[1], "%llu", &size) != 1
+	|| sscanf(fields[2], "%lld.%ld", &mtimeSeconds, &entry.mtimeNanoseconds) != 2
+	|| sscanf(fields[3], "%llx", &hash) != 1) {
+      fprintf(stderr, "Ignoring a bad line in \"%s\"\n", fManifestFileName.c_str());
+      continue;
+    }
+    entry.name = fields[0];
+    entry.size = size;
+    entry.mtimeSeconds = mtimeSeconds;
+    entry.hash = hash;
+    entry.outputName = fields[4];
+    updateManifest(entry);
+  }
+
+  fclose(fid);
+  return 1;
+}
+
+int BatchProcessor::writeManifest() {
+  // Write the new manifest under a temporary name, then rename it, so that the manifest is always
+  // complete (even if we're interrupted):
+  std::string tempFileName = fManifestFileName + ".tmp";
+  FILE* fid = fopen(tempFileName.c_str(), "w");
+  if (fid == NULL) {
+    fprintf(stderr, "Failed to open \"%s\": %s\n", tempFileName.c_str(), strerror(errno));
+    return 0;
+  }
+
+  fprintf(fid, "# djiparsetxt manifest, version %u\n", BATCH_MANIFEST_VERSION);
+  fprintf(fid, "# name\tsize\tmtime\thash\toutput\n");
+  for (unsigned i = 0; i < fManifest.size(); ++i) {
+    ManifestEntry const& entry = fManifest[i];
+    fprintf(fid, "%s\t%llu\t%lld.%09ld\t%016llx\t%s\n", entry.name.c_str(),
+	    (unsigned long long)entry.size, (long long)entry.mtimeSeconds, entry.mtimeNanoseconds,
+	    (unsigned long long)entry.hash, entry.outputName.c_str());
+  }
+
+  int writeFailed = fflush(fid) != 0 || fsync(fileno(fid)) != 0;
+  if (fclose(fid) != 0) writeFailed = 1;
+  if (writeFailed || rename(tempFileName.c_str(), fManifestFileName.c_str()) != 0) {
+    fprintf(stderr, "Failed to write \"%s\": %s\n", fManifestFileName.c_str(), strerror(errno));
+    unlink(tempFileName.c_str());
+    return 0;
+  }
+
+  return 1;
+}
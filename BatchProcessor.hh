@@ -0,0 +1,102 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Incremental processing of a directory of ".txt" files, using a persistent manifest of the results.
+    Header File.
+*/
+
+#ifndef _BATCH_PROCESSOR_HH
+#define _BATCH_PROCESSOR_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#ifndef _WORKER_POOL_HH
+#include "WorkerPool.hh"
+#endif
+
+#define BATCH_MANIFEST_FILE_NAME "djiparsetxt-manifest.tsv" // within the output directory
+#define BATCH_MANIFEST_VERSION 1
+
+// The function that processes one input file (in a separate process), writing its output to "outputFD".
+// It returns 0 iff it succeeds:
+typedef int BatchProcessFunc(char const* inputFileName, char const* outputDirectoryName, int outputFD);
+
+// One line of the manifest: an input file that has been processed successfully:
+class ManifestEntry {
+public:
+  std::string name; // the input file's name, within the input directory
+  u_int64_t size;
+  int64_t mtimeSeconds;
+  long mtimeNanoseconds;
+  u_int64_t hash; // of the input file's contents
+  std::string outputName; // within the output directory; "-" if there's no output file
+};
+
+class BatchProcessor: public WorkerPool {
+public:
+  static BatchProcessor* createNew(char const* inputDirectoryName, char const* outputDirectoryName,
+				   char const* outputSuffix, BatchProcessFunc* processFunc);
+      // "outputSuffix" (e.g., ".csv") is NULL if no output file is written for each input file.
+      // Returns NULL (after printing an error message) if the output directory can't be created,
+      // or its manifest can't be read.
+
+  virtual ~BatchProcessor();
+
+  // Sets "names" to the (sorted) names of the input files - those named "*.txt" or "*.txt.gz" - in a directory.
+  // Returns 0 (after printing an error message) if the directory can't be read:
+  static int listInputFiles(char const* inputDirectoryName, std::vector<std::string>& names);
+
+  // Processes each input file that's new or changed since it was last processed successfully,
+  // running up to "maxNumProcesses" at once.  The manifest is updated (atomically) as each file is
+  // completed, so an interrupted run can just be repeated.  Returns 0 iff every file succeeded:
+  int run(unsigned maxNumProcesses);
+
+private:
+  BatchProcessor(char const* inputDirectoryName, char const* outputDirectoryName,
+		 char const* outputSuffix, BatchProcessFunc* processFunc); // called only by "createNew()"
+
+  int readManifest(); // returns 1 iff it succeeds (or there's no manifest yet)
+  int writeManifest(); // ditto
+  int outputExists(ManifestEntry const& entry) const;
+  std::string inputPath(std::string const& name) const { return fInputDirectoryName + "/" + name; }
+  std::string outputPath(std::string const& name) const { return fOutputDirectoryName + "/" + name; }
+  void updateManifest(ManifestEntry const& entry);
+  int removeMissingInputs(std::vector<std::string> const& names);
+      // removes the manifest entries whose input files aren't in "names" (sorted); returns 1 iff there were any
+
+private: // redefined virtual functions:
+  virtual int doTask(unsigned taskIndex, FILE* resultFile);
+  virtual void taskDone(unsigned taskIndex, int succeeded);
+
+private:
+  std::string fInputDirectoryName, fOutputDirectoryName, fManifestFileName;
+  char const* fOutputSuffix;
+  BatchProcessFunc* fProcessFunc;
+  std::vector<ManifestEntry> fManifest;
+  std::unordered_map<std::string, unsigned> fManifestIndex; // name => index in "fManifest"
+  std::vector<ManifestEntry> fPending; // the files being processed by "run()"
+  int fManifestWriteFailed;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A bounded, lock-free ring buffer of bytes, between exactly one producer thread and one consumer thread.
+    Implementation.
+*/
+
+#include "ByteRingBuffer.hh"
+
+#include <sched.h>
+#include <unistd.h>
+
+static void backOff(unsigned numTries) {
+  // Spin (yielding the CPU) briefly, then sleep, so that a waiting thread doesn't monopolize a core:
+  if (numTries < 64) sched_yield(); else usleep(100);
+}
+
+ByteRingBuffer::ByteRingBuffer(unsigned capacity)
+  : fBuffer(new u_int8_t[capacity]), fCapacity(capacity), fEndOfData(0), fStopped(0),
+    fHead(0), fTail(0) {
+}
+
+ByteRingBuffer::~ByteRingBuffer() {
+  delete[] fBuffer;
+}
+
+u_int8_t* ByteRingBuffer::beginWrite(unsigned& numBytes) {
+  u_int64_t tail = fTail.load(std::memory_order_relaxed);
+  for (unsigned numTries = 0; !fStopped.load(std::memory_order_acquire); ++numTries) {
+    unsigned numFree = fCapacity - (unsigned)(tail - fHead.load(std::memory_order_acquire));
+    if (numFree > 0) {
+      // Don't go past the end of the buffer; the rest can be written next time:
+      unsigned offset = tail&(fCapacity-1);
+      numBytes = fCapacity - offset;
+      if (numBytes > numFree) numBytes = numFree;
+      return &fBuffer[offset];
+    }
+    backOff(numTries);
+  }
+
+  numBytes = 0;
+  return NULL;
+}
+
+void ByteRingBuffer::endWrite(unsigned numBytes) {
+  fTail.store(fTail.load(std::memory_order_relaxed) + numBytes, std::memory_order_release);
+}
+
+void ByteRingBuffer::setEndOfData() {
+  fEndOfData.store(1, std::memory_order_release);
+}
+
+u_int8_t const* ByteRingBuffer::beginRead(unsigned& numBytes, unsigned minNumBytes) {
+  u_int64_t head = fHead.load(std::memory_order_relaxed);
+  for (unsigned numTries = 0; ; ++numTries) {
+    // Check for the end of the data first, so that we don't miss data that was written just before it:
+    int isEndOfData = fEndOfData.load(std::memory_order_acquire);
+    u_int64_t tail = fTail.load(std::memory_order_acquire);
+    if (tail != head) {
+      unsigned offset = head&(fCapacity-1);
+      numBytes = fCapacity - offset;
+      if (numBytes > tail - head) numBytes = tail - head;
+      // (If the area ends at the end of the buffer, it can't get any larger, so return it anyway:)
+      if (numBytes >= minNumBytes || numBytes == fCapacity - offset || isEndOfData) return &fBuffer[offset];
+    } else if (isEndOfData) {
+      break;
+    }
+    backOff(numTries);
+  }
+
+  numBytes = 0;
+  return NULL;
+}
+
+void ByteRingBuffer::endRead(unsigned numBytes) {
+  fHead.store(fHead.load(std::memory_order_relaxed) + numBytes, std::memory_order_release);
+}
+
+void ByteRingBuffer::stop() {
+  fStopped.store(1, std::memory_order_release);
+}
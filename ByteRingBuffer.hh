@@ -0,0 +1,61 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A bounded, lock-free ring buffer of bytes, between exactly one producer thread and one consumer thread.
+    Header File.
+*/
+
+#ifndef _BYTE_RING_BUFFER_HH
+#define _BYTE_RING_BUFFER_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <atomic>
+
+class ByteRingBuffer {
+public:
+  ByteRingBuffer(unsigned capacity); // "capacity" must be a power of 2
+  virtual ~ByteRingBuffer();
+
+  // Called only by the producer thread.  Waits for room, then returns a contiguous area (of size
+  // "numBytes") to fill in, or NULL if the consumer has called "stop()":
+  u_int8_t* beginWrite(unsigned& numBytes);
+  void endWrite(unsigned numBytes); // makes the first "numBytes" of the area available to the consumer
+  void setEndOfData(); // after the last "endWrite()"
+
+  // Called only by the consumer thread.  Waits for (at least "minNumBytes" of) data, then returns a
+  // contiguous area (of size "numBytes") of it.  "numBytes" is 0 (and the result NULL) once all of the
+  // data has been read.  (At the end of the data, "numBytes" may be less than "minNumBytes".):
+  u_int8_t const* beginRead(unsigned& numBytes, unsigned minNumBytes = 1);
+  void endRead(unsigned numBytes); // releases the first "numBytes" of the area back to the producer
+  void stop(); // no more data will be read; wakes up the producer, if it's waiting for room
+  int isStopped() const { return fStopped.load(std::memory_order_acquire); }
+
+private:
+  u_int8_t* fBuffer;
+  unsigned fCapacity;
+  std::atomic<int> fEndOfData, fStopped;
+  // Keep the producer's and the consumer's positions in separate cache lines:
+  alignas(64) std::atomic<u_int64_t> fHead;
+  alignas(64) std::atomic<u_int64_t> fTail;
+};
+
+#endif
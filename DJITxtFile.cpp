@@ -0,0 +1,125 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A DJI ".txt" file, mapped into memory (with its header checked).
+    Implementation.
+*/
+
+#include "DJITxtFile.hh"
+#include "DJITxtParser.hh"
+#include "FileHash.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+
+DJITxtFile* DJITxtFile::createNew(char const* fileName) {
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open \"%s\"\n", fileName);
+    return NULL;
+  }
+
+  // Figure out the file's size
+  struct stat sb;
+  u_int64_t fileSize;
+  if (fstat(fd, &sb) == 0) {
+    fileSize = sb.st_size;
+  } else {
+    fprintf(stderr, "Failed to get file size\n");
+    close(fd);
+    return NULL;
+  }
+
+  // Check the file size:
+  if (fileSize < OLD_HEADER_SIZE) {
+    fprintf(stderr, "Bad file size: %llu bytes\n", (unsigned long long)fileSize);
+    close(fd);
+    return NULL;
+  }
+
+  // Map the file into memory:
+  u_int8_t* const mappedFile
+    = (u_int8_t*)mmap(0, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping remains valid
+  if (mappedFile == MAP_FAILED) {
+    fprintf(stderr, "mmap() call failed: %s\n", strerror(errno));
+    return NULL;
+  }
+
+  DJITxtFile* file = new DJITxtFile(mappedFile, fileSize);
+  if (!file->checkHeader()) {
+    delete file;
+    return NULL;
+  }
+
+  return file;
+}
+
+DJITxtFile::DJITxtFile(u_int8_t* mappedFile, u_int64_t fileSize)
+  : fMappedFile(mappedFile), fFileSize(fileSize), fVersionNumber(0), fIsScrambled(0),
+    fHeaderSize(OLD_HEADER_SIZE), fHeaderPlusRecordAreaSize(0), fContentHash(0), fHaveContentHash(0) {
+}
+
+DJITxtFile::~DJITxtFile() {
+  munmap(fMappedFile, fFileSize);
+}
+
+u_int64_t DJITxtFile::contentHash() const {
+  if (!fHaveContentHash) {
+    fContentHash = hashFileContents(fMappedFile, fFileSize);
+    fHaveContentHash = 1;
+  }
+
+  return fContentHash;
+}
+
+int DJITxtFile::checkHeader() {
+  // Get/check the first 8 bytes (little-endian) of the file; it's the size of the header+record area:
+  u_int8_t const* ptr = fMappedFile;
+  fHeaderPlusRecordAreaSize = getWord64LE(ptr);
+
+  // The next 4 bytes are the file version number (apparently big-endian):
+  fVersionNumber = getWord32BE(ptr);
+  fprintf(stderr, "File version number: 0x%08x\n", fVersionNumber);
+
+  if (versionHasNewHeader(fVersionNumber)) {
+    fHeaderSize = NEW_HEADER_SIZE;
+    fIsScrambled = 1;
+  } else {
+    fHeaderSize = OLD_HEADER_SIZE;
+    fIsScrambled = 0;
+  }
+
+  unsigned const minFileSize = fHeaderSize + MIN_RECORD_SIZE;
+  if (fHeaderPlusRecordAreaSize < minFileSize || fHeaderPlusRecordAreaSize > fFileSize) {
+    fprintf(stderr, "Bad 'header+record-area' size: %llu (0x%llx); file size is %llu\n",
+	    (unsigned long long)fHeaderPlusRecordAreaSize, (unsigned long long)fHeaderPlusRecordAreaSize,
+	    (unsigned long long)fFileSize);
+    return 0;
+  }
+
+  return 1;
+}
@@ -0,0 +1,72 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A DJI ".txt" file, mapped into memory (with its header checked).
+    Header File.
+*/
+
+#ifndef _DJI_TXT_FILE_HH
+#define _DJI_TXT_FILE_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+
+#define OLD_HEADER_SIZE 12
+#define NEW_HEADER_SIZE 100
+#define MIN_RECORD_SIZE 3 // type+0-length+FF
+
+class DJITxtFile {
+public:
+  static DJITxtFile* createNew(char const* fileName);
+      // returns NULL (after printing an error message) if the file can't be opened, or is bad
+
+  virtual ~DJITxtFile(); // unmaps the file
+
+  u_int8_t const* data() const { return fMappedFile; }
+  u_int64_t size() const { return fFileSize; }
+  u_int32_t versionNumber() const { return fVersionNumber; }
+  int isScrambled() const { return fIsScrambled; }
+  u_int64_t contentHash() const; // a hash of the entire file (computed when first needed)
+
+  // Old versions of the file have a smaller header, and are not scrambled:
+  static int versionHasNewHeader(u_int32_t versionNumber) { return (versionNumber&0x0000FF00) >= 0x00000600; }
+
+  // The file consists of a header, then an area of records, then a 'details' area:
+  u_int8_t const* recordArea() const { return &fMappedFile[fHeaderSize]; }
+  u_int8_t const* detailsArea() const { return &fMappedFile[fHeaderPlusRecordAreaSize]; } // also the end of the records
+  u_int8_t const* endOfFile() const { return &fMappedFile[fFileSize]; }
+
+private:
+  DJITxtFile(u_int8_t* mappedFile, u_int64_t fileSize); // called only by "createNew()"
+  int checkHeader(); // returns 1 iff the header is OK
+
+private:
+  u_int8_t* fMappedFile;
+  u_int64_t fFileSize;
+  u_int32_t fVersionNumber;
+  int fIsScrambled;
+  unsigned fHeaderSize;
+  u_int64_t fHeaderPlusRecordAreaSize;
+  mutable u_int64_t fContentHash;
+  mutable int fHaveContentHash;
+};
+
+#endif
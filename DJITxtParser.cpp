@@ -24,8 +24,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DJITxtParser.hh"
+#include "DJITxtFile.hh"
 #include <stdio.h>
 
+u_int32_t fileVersionNumber; // of the file currently being parsed
+
 u_int8_t getByte(u_int8_t const*& ptr, u_int8_t const* limit) {
   if (limit != NULL && ptr > limit-1) throw END_OF_DATA;
   return *ptr++;
@@ -90,8 +93,49 @@ void printHex(char const* label, u_int8_t const*& ptr, u_int8_t const* limit) {
 
 ////////// DJITxtParser implementation //////////
 
-DJITxtParser::DJITxtParser() {
+DJITxtParser::DJITxtParser()
+  : fPositionBase(NULL), fBasePosition(0) {
 }
 
 DJITxtParser::~DJITxtParser() {
 }
+
+int DJITxtParser::parseFile(DJITxtFile const& file, int parseInParallel) {
+  fileVersionNumber = file.versionNumber();
+
+  // Begin by parsing the 'DETAILS' area (the data after the header+record area):
+  u_int8_t const* ptr = file.detailsArea();
+  parseDetailsArea(ptr, file.endOfFile());
+
+  // Then, parse all of the records in the file:
+  u_int8_t const* const endOfRecordArea = file.detailsArea();
+  ptr = file.recordArea();
+  setPositionBase(file.data(), 0);
+  prepareToParseRecords(ptr, endOfRecordArea);
+#ifdef DEBUG_RECORD_PARSING
+  parseInParallel = 0; // so that the debugging output stays in order
+#endif
+  if (parseInParallel) {
+    parseRecordsInParallel(ptr, endOfRecordArea, file.isScrambled());
+  } else {
+    while (ptr < endOfRecordArea) {
+#ifdef DEBUG_RECORD_PARSING
+      u_int64_t curFilePosition = ptr - file.data();
+      fprintf(stderr, "@0x%08llx: ", (unsigned long long)curFilePosition);
+#endif
+      if (!parseRecord(ptr, endOfRecordArea, file.isScrambled())) break;
+    }
+  }
+
+  int result = 1;
+  if (ptr < endOfRecordArea) {
+    u_int64_t curFilePosition = ptr - file.data();
+    fprintf(stderr, "Premature end of record parsing at file position %llu (0x%08llx)\n",
+	    (unsigned long long)curFilePosition, (unsigned long long)curFilePosition);
+    result = 0;
+  }
+  outputOneRow(); // the final row of data
+  summarizeRecordParsing();
+
+  return result;
+}
@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <sys/types.h>
 #include <stdlib.h>
+#include <string>
 
 // Uncomment the following line (then: make clean; make) to generate more debugging output:
 //#define DEBUG_RECORD_PARSING 1
@@ -46,9 +47,34 @@ void printHex(char const* label, u_int8_t const*& ptr, u_int8_t const* limit);
 
 #define END_OF_DATA 1 // exception thrown if parsing unexpectedly reaches the end of the buffer
 
+// Results of "checkRecord()":
+#define RECORD_IS_COMPLETE 1
+#define RECORD_IS_INCOMPLETE 0 // the record continues past "limit"
+#define RECORD_IS_BAD (-1)
+
+class DJITxtFile; // forward
+class FlightTable; // forward
+class InputStream; // forward
+class OutputCompressor; // forward
+class FlightObserver; // forward
+class OutputColumn; // forward
+
+// Values of "rowOutput" (for "DJITxtParser::createNew()"):
+#define ROW_OUTPUT_NONE 0
+#define ROW_OUTPUT_CSV 1 // one line per row, with a value for each column
+#define ROW_OUTPUT_CSV_CHANGES 2 // "row,column,value" lines, only for values that differ from the previous row's
+#define ROW_OUTPUT_JSON_LINES 3 // one JSON object per row
+
 class DJITxtParser {
 public:
-  static DJITxtParser* createNew();
+  static DJITxtParser* createNew(int rowOutput = ROW_OUTPUT_CSV, int outputFD = 1/*stdout*/,
+				 OutputCompressor* compressor = NULL);
+      // If "rowOutput" is ROW_OUTPUT_NONE, rows are not output (as CSV or JSON, to "outputFD");
+      // instead, call "enableFlightTable()" to collect them in a "FlightTable".
+      // If "compressor" is not NULL, the output is compressed by it (and it must be deleted after us)
+
+  // The columns of each output row (the same for every flight), e.g., to check field names before parsing:
+  static OutputColumn const* outputColumnTable(unsigned& numColumns); // implemented in "rowOutput.cpp"
 
 protected:
   DJITxtParser(); // called only by "createNew()"
@@ -56,10 +82,94 @@ protected:
 public:
   virtual ~DJITxtParser();
 
+  // Parses an entire (already opened) file: first its 'details' area, then all of its records.
+  // Returns 1 iff all of the records were parsed successfully:
+  int parseFile(DJITxtFile const& file, int parseInParallel = 1);
+
+  // Parses a file that's still being written (e.g., by the app, during a flight), outputting rows as
+  // new records are appended to it.  Returns (1 iff all of the records were parsed successfully) once
+  // the file has been completed (i.e., its 'details' area has been written), or removed:
+  int followFile(char const* fileName); // implemented in "followFile.cpp"
+
+  // Parse a file that's read sequentially - using a fixed amount of memory - from a file descriptor
+  // (e.g., a pipe), or from an input stream.  (Implemented in "parseStream.cpp", using a "StreamingParser";
+  // see "StreamingParser.hh".)
+  // Returns 1 iff all of the records were parsed successfully:
+  int parseFileDescriptor(int fd);
+      // If "fd" is a (seekable) file, its 'details' area is read (from the end) first
+  int parseStream(InputStream& input, u_int64_t recordAreaEnd = 0);
+      // If "recordAreaEnd" is not 0, the 'details' area (after it) has already been parsed
+  u_int64_t parseDetailsAreaOfStream(InputStream& input);
+      // Reads all of "input", but parses only its 'details' area (at the end).  If the same data can then be read
+      // again (e.g., by decompressing a compressed file again), give it to "parseStream()", with the result as
+      // "recordAreaEnd", so that (as when the file is mapped) every row gets the 'DETAILS' fields.
+      // Returns 0 if there's no 'details' area
+
+  // Collect each row of data (also) into a columnar "FlightTable".  Call before parsing:
+  virtual void enableFlightTable() = 0;
+  virtual FlightTable* detachFlightTable() = 0; // after parsing; the caller then owns the result
+
+  // Also output every record of each type (e.g., 'GIMBAL' or 'RC') - not just the most recent one, whenever
+  // a row is output - to a separate CSV file, named "<fileNamePrefix><recordTypeName><fileNameSuffix>".
+  // (The output may be compressed; see "OutputCompressor.hh".)  Call before parsing:
+  virtual void enableRecordStreams(char const* fileNamePrefix, char const* fileNameSuffix = ".csv",
+				   int compressionMethod = 0/*none*/, int compressionLevel = -1) = 0;
+
+  // Also write the flight's track (the aircraft's positions, its home point, and the app's GPS positions) to the
+  // file "fileName", as GPX, KML or GeoJSON ("trackFormat"; see "TrackExporter.hh").  If "minDistance" (in meters)
+  // is not 0.0, the track is decimated to positions that are at least this far apart.  The file also contains a
+  // simplified version of the aircraft's track for each of the "lodTolerances" (in meters), if any.  Call before
+  // parsing (once for each track file that's wanted).  Returns 0 iff the file couldn't be created:
+  virtual int enableTrackExport(char const* fileName, int trackFormat, double minDistance = 0.0,
+				double const* lodTolerances = NULL, unsigned numLODLevels = 0) = 0;
+
+  // Also have "observer" (see "FlightObserver.hh"), which must outlive us, follow the flight as it's parsed - e.g.,
+  // an "Aggregation" (of each row, and of the flight's final values), "TrackCells" (the grid cells that the track
+  // passes through), a "GeofenceMonitor" (following the aircraft through a set of zones), or a "FlightSegmenter"
+  // (dividing the flight into segments, such as airborne, or returning to home).  Call before parsing.  Returns 0
+  // if the observer can't follow the flight (e.g., because an aggregation names an unknown field):
+  virtual int addFlightObserver(FlightObserver* observer) = 0;
+
+  // Don't output the embedded JPEG images (e.g., if only a summary of the flight is wanted).  Call before parsing:
+  virtual void disableJPEGOutput() = 0;
+
+  // After parsing: 1 if embedded JPEG images were output to an archive; 0 if there were none; -1 if
+  // the archive couldn't be written:
+  virtual int jpegArchiveResult() const = 0;
+
+  // The current value (e.g., after parsing, the final value) of a field, named as in the CSV output's column
+  // labels - either as a number, or formatted as in the CSV output.  Each returns 0 if the field is unknown,
+  // has no value, or (for the first) isn't numeric:
+  virtual int getFieldValue(char const* fieldName, double& result) = 0;
+  virtual int getFieldValue(char const* fieldName, std::string& result) = 0;
+
   virtual void parseDetailsArea(u_int8_t const*& ptr, u_int8_t const* limit) = 0;
+  virtual void prepareToParseRecords(u_int8_t const* ptr, u_int8_t const* limit) = 0;
+      // called (after the 'details' area has been parsed) before parsing the records in [ptr,limit)
   virtual int parseRecord(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled) = 0;
+  virtual void parseRecordsInParallel(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled) = 0;
+      // parses all records (up to "limit"), but uses separate threads to find and decode them
+  virtual int checkRecord(u_int8_t const* ptr, u_int8_t const* limit) = 0;
+      // checks - without parsing it - whether the record at "ptr" lies entirely before "limit"
   virtual void outputOneRow(int outputColumnLabels = 0) = 0;
+  virtual void flushRows() = 0; // writes out any rows that have been output so far
   virtual void summarizeRecordParsing() = 0;
+
+  // The position (in the file) of data that's being parsed, given that the data at "base" is at "basePosition".
+  // (The records may be parsed from a mapped file, or from chunks of a stream.):
+  void setPositionBase(u_int8_t const* base, u_int64_t basePosition) {
+    fPositionBase = base; fBasePosition = basePosition;
+  }
+
+protected:
+  u_int64_t filePosition(u_int8_t const* ptr) const { return fBasePosition + (ptr - fPositionBase); }
+
+private:
+  void parseDetailsAreaAfterHeader(u_int8_t const* header, u_int8_t const* detailsArea, unsigned detailsAreaSize);
+      // implemented in "parseStream.cpp"
+
+  u_int8_t const* fPositionBase;
+  u_int64_t fBasePosition;
 };
 
 #endif
@@ -43,9 +43,63 @@ FieldValue::~FieldValue() {
 }
 
 
+////////// StringArena: implementation //////////
+
+#define STRING_ARENA_CHUNK_SIZE 16384
+
+StringArena::StringArena()
+  : fChunk(NULL), fChunkSize(0), fChunkFill(0) {
+}
+
+StringArena::~StringArena() {
+  reset();
+  delete[] fChunk;
+}
+
+char const* StringArena::save(char const* str) {
+  unsigned strSize = strlen(str) + 1;
+  if (fChunk == NULL || fChunkFill + strSize > fChunkSize) {
+    // Start a new chunk (which remembers the previous one, so that it can be freed later):
+    unsigned newChunkSize = sizeof (char*) + strSize;
+    if (newChunkSize < STRING_ARENA_CHUNK_SIZE) newChunkSize = STRING_ARENA_CHUNK_SIZE;
+    char* newChunk = new char[newChunkSize];
+    *(char**)newChunk = fChunk;
+    fChunk = newChunk;
+    fChunkSize = newChunkSize;
+    fChunkFill = sizeof (char*);
+  }
+
+  char* result = &fChunk[fChunkFill];
+  memcpy(result, str, strSize);
+  fChunkFill += strSize;
+
+  return result;
+}
+
+void StringArena::reset() {
+  // Free all chunks except the current one (which we reuse):
+  if (fChunk == NULL) return;
+  char* prevChunk = *(char**)fChunk;
+  while (prevChunk != NULL) {
+    char* chunkToDelete = prevChunk;
+    prevChunk = *(char**)prevChunk;
+    delete[] chunkToDelete;
+  }
+  *(char**)fChunk = NULL;
+  fChunkFill = sizeof (char*);
+}
+
+
+////////// FieldObserver: implementation //////////
+
+FieldObserver::~FieldObserver() {
+}
+
+
 ////////// FieldDatabase: implementation //////////
 
-FieldDatabase::FieldDatabase() {
+FieldDatabase::FieldDatabase()
+  : fEpoch(1), fObserver(NULL) {
   initializeInterpretationTables();
 }
 
@@ -112,17 +166,107 @@ void FieldDatabase::addStringField(char const* label, char const* str) {
 }
 
 void FieldDatabase::addFieldValue(char const* label, FieldValue* fieldValue) {
-  // First, delete any existing "FieldValue" for this label (the assignment below doesn't do that):
-  delete fUMap[label];
+  FieldValue*& slot = fUMap[label];
+
+  // Note whether the value has changed (and if so, tell our observer, if any):
+  int const isChanged = slot == NULL || !sameValue(slot, fieldValue);
+  fieldValue->fChangeEpoch = isChanged ? fEpoch : slot->fChangeEpoch;
+  if (isChanged && fObserver != NULL) {
+    FieldSnapshot snapshot;
+    copyValue(fieldValue, snapshot);
+    snapshot.isChanged = 1;
+    fObserver->fieldChanged(label, snapshot);
+  }
+
+  // Then, replace any existing "FieldValue" for this label:
+  delete slot;
+  slot = fieldValue;
+}
+
+int FieldDatabase::sameValue(FieldValue const* a, FieldValue const* b) {
+  if (a->fType != b->fType) return 0;
+
+  switch (a->fType) {
+    case IntegerByteUnsigned:
+    case IntegerByteSigned: { return a->fByte == b->fByte; }
+    case Integer2ByteUnsigned:
+    case Integer2ByteSigned:
+    case Date2Byte: { return a->fBytes2 == b->fBytes2; }
+    case Integer4ByteUnsigned:
+    case Integer4ByteSigned:
+    case Version4Byte: { return a->fBytes4 == b->fBytes4; }
+    case Float: { return memcmp(&a->fFloat, &b->fFloat, sizeof a->fFloat) == 0; } // so that NaN == NaN
+    case Double: { return memcmp(&a->fDouble, &b->fDouble, sizeof a->fDouble) == 0; }
+    case Timestamp8ByteInSeconds:
+    case Timestamp8ByteInMilliseconds: { return a->fBytes8 == b->fBytes8; }
+    case String: { return strcmp(a->fStr, b->fStr) == 0; }
+  }
+
+  return 0;
+}
 
-  // Then, store the new "FieldValue":
-  fUMap[label] = fieldValue;
+int FieldDatabase::fieldHasChanged(char const* label) {
+  FieldValue const* fieldValue = lookupFieldValue(label);
+  return fieldValue != NULL && fieldValue->fChangeEpoch == fEpoch;
 }
 
 FieldValue const* FieldDatabase::lookupFieldValue(char const* label) {
   return fUMap[label];
 }
 
+void FieldDatabase::snapshotField(char const* label, FieldSnapshot& snapshot, StringArena& arena) {
+  FieldValue const* fieldValue = lookupFieldValue(label);
+  if (fieldValue == NULL) {
+    snapshot.isPresent = snapshot.isChanged = 0;
+    return;
+  }
+
+  copyValue(fieldValue, snapshot);
+  snapshot.isChanged = fieldValue->fChangeEpoch == fEpoch;
+  if (fieldValue->fType == String) snapshot.fStr = arena.save(fieldValue->fStr);
+}
+
+InterpretationTable* FieldDatabase::lookupInterpretationTable(char const* interpretedLabel) {
+  std::unordered_map<char const*, InterpretationTable*>::iterator itr
+    = fInterpretationTableMap.find(interpretedLabel);
+  return itr == fInterpretationTableMap.end() ? NULL : itr->second;
+}
+
+int FieldDatabase::getFieldAsDouble(char const* label, double& result) {
+  FieldValue const* fieldValue = lookupFieldValue(label);
+  if (fieldValue == NULL) return 0;
+
+  FieldSnapshot snapshot;
+  copyValue(fieldValue, snapshot);
+  return numericValue(snapshot, result);
+}
+
+int FieldDatabase::numericValue(FieldSnapshot const& field, double& result) {
+  if (!field.isPresent) return 0;
+
+  switch (field.fType) {
+    case IntegerByteUnsigned: { result = field.fByte; break; }
+    case IntegerByteSigned: { result = (int8_t)(field.fByte); break; }
+    case Integer2ByteUnsigned: { result = field.fBytes2; break; }
+    case Integer2ByteSigned: { result = (int16_t)(field.fBytes2); break; }
+    case Integer4ByteUnsigned: { result = field.fBytes4; break; }
+    case Integer4ByteSigned: { result = (int32_t)(field.fBytes4); break; }
+    case Float: { result = field.fFloat; break; }
+    case Double: { result = field.fDouble; break; }
+    case Timestamp8ByteInSeconds:
+    case Timestamp8ByteInMilliseconds: { result = (double)(field.fBytes8); break; }
+    default: { return 0; } // not numeric
+  }
+
+  return 1;
+}
+
+void FieldDatabase::copyValue(FieldValue const* fieldValue, FieldSnapshot& snapshot) {
+  snapshot.isPresent = 1;
+  snapshot.fType = fieldValue->fType;
+  memcpy(&snapshot.fBytes8, &fieldValue->fBytes8, sizeof snapshot.fBytes8); // copies any union member
+}
+
 InterpretationTable* FieldDatabase
 ::newInterpretationTable(char const* interpretedLabel, char const* defaultResultString) {
   InterpretationTable* it = new InterpretationTable(defaultResultString);
@@ -30,6 +30,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "InterpretationTable.hh"
 #endif
 
+#ifndef _OUTPUT_BUFFER_HH
+#include "OutputBuffer.hh"
+#endif
+
 // How each field value is represented:
 enum FieldType {
      IntegerByteUnsigned,
@@ -62,6 +66,7 @@ public:
 private:
   friend class FieldDatabase;
   FieldType fType;
+  u_int32_t fChangeEpoch; // the database's 'epoch' when this value was entered (or last changed)
   union {
     u_int8_t fByte;
     u_int16_t fBytes2;
@@ -73,6 +78,46 @@ private:
   };
 };
 
+// Storage for copies of strings, that remain valid until the arena is "reset()":
+class StringArena {
+public:
+  StringArena();
+  virtual ~StringArena();
+
+  char const* save(char const* str);
+  void reset();
+
+private:
+  char* fChunk; // the current chunk; each chunk begins with a pointer to the previous chunk (if any)
+  unsigned fChunkSize, fChunkFill;
+};
+
+// A copy of a field's value (taken when a row is output), so that it can be formatted later -
+// possibly by another thread - independently of the database:
+class FieldSnapshot {
+public:
+  int isPresent;
+  int isChanged; // whether the value has changed since the database was last "markAllUnchanged()"
+  FieldType fType;
+  union {
+    u_int8_t fByte;
+    u_int16_t fBytes2;
+    u_int32_t fBytes4;
+    u_int64_t fBytes8;
+    float fFloat;
+    double fDouble;
+    char const* fStr; // points into a "StringArena"
+  };
+};
+
+// An object that's told whenever a field's value changes (e.g., so that it can keep its own copy of the value):
+class FieldObserver {
+public:
+  virtual ~FieldObserver();
+  virtual void fieldChanged(char const* label, FieldSnapshot const& value) = 0;
+      // (If the value is a string, "value.fStr" remains valid only during the call.)
+};
+
 class FieldDatabase {
 public:
   FieldDatabase();
@@ -90,13 +135,44 @@ public:
   void add8ByteTimestampField(char const* label, u_int64_t value, int isInMilliseconds);
   void addStringField(char const* label, char const* str);
 
-  // Routines for outputting field values (to 'stdout'):
-  void outputField(char const* label, unsigned numFractionalDigits = 0);
-  void outputFieldAsBoolean(char const* label);
-  void outputFieldInterpreted(char const* label, char const* interpretedLabel);
+  // Returns 1 (and sets "result") iff the field currently has a numeric value:
+  int getFieldAsDouble(char const* label, double& result);
+
+  // Copies the field's current value into "snapshot" (with any string being copied into "arena"):
+  void snapshotField(char const* label, FieldSnapshot& snapshot, StringArena& arena);
+
+  // Change tracking (e.g., for outputting only those fields that have changed since the previous row).
+  // Entering a field value that's the same as the existing one doesn't count as a change:
+  int fieldHasChanged(char const* label); // since the last call to "markAllUnchanged()"
+  void markAllUnchanged() { ++fEpoch; }
+
+  void setObserver(FieldObserver* observer) { fObserver = observer; } // NULL if none
+
+  InterpretationTable* lookupInterpretationTable(char const* interpretedLabel); // NULL if none
+
+  // Returns 1 (and sets "result") iff the (snapshot of the) field has a numeric value:
+  static int numericValue(FieldSnapshot const& field, double& result);
+
+  // Routines for formatting (snapshots of) field values.  (These don't access the database,
+  // so can be called from another thread):
+  static void formatField(OutputBuffer& out, FieldSnapshot const& field, unsigned numFractionalDigits = 0);
+  static void formatFieldAsBoolean(OutputBuffer& out, FieldSnapshot const& field);
+  static void formatFieldInterpreted(OutputBuffer& out, FieldSnapshot const& field,
+				     InterpretationTable* interpretationTable);
+
+  // Routines for formatting (snapshots of) field values as JSON values: numbers, booleans or strings.
+  // (Dates, versions and timestamps become strings, formatted as above.)  These output "null" if the field
+  // has no value (or no value of the right kind).  (Implemented in "fieldOutput.cpp".):
+  static void formatFieldAsJSON(OutputBuffer& out, FieldSnapshot const& field, unsigned numFractionalDigits = 0);
+  static void formatFieldAsJSONBoolean(OutputBuffer& out, FieldSnapshot const& field);
+  static void formatFieldAsJSONInterpreted(OutputBuffer& out, FieldSnapshot const& field,
+					   InterpretationTable* interpretationTable);
+  static void formatJSONString(OutputBuffer& out, char const* str); // with quotes, and escaped as needed
 
 private:
   void addFieldValue(char const* label, FieldValue* fieldValue);
+  static void copyValue(FieldValue const* fieldValue, FieldSnapshot& snapshot); // except for strings
+  static int sameValue(FieldValue const* a, FieldValue const* b);
   FieldValue const* lookupFieldValue(char const* label); // returns NULL if not found
 
   void initializeInterpretationTables(); // called by our constructor
@@ -107,6 +183,8 @@ private:
 private:
   // Implement the database using an 'unordered map' - i.e., a hash table:
   std::unordered_map<char const*, FieldValue*> fUMap;
+  u_int32_t fEpoch; // advanced by "markAllUnchanged()"
+  FieldObserver* fObserver;
 
   // We also use an 'unordered map' to look up "InterpretationTable"s:
   std::unordered_map<char const*, InterpretationTable*> fInterpretationTableMap;
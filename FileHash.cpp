@@ -0,0 +1,145 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A fast (non-cryptographic) 64-bit hash of a file's contents.
+    Implementation.
+*/
+
+#include "FileHash.hh"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline u_int64_t rotl64(u_int64_t x, unsigned r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// (The hash is defined in terms of little-endian words.)
+static inline u_int64_t read64LE(u_int8_t const* p) {
+  return (u_int64_t)p[0] | ((u_int64_t)p[1]<<8) | ((u_int64_t)p[2]<<16) | ((u_int64_t)p[3]<<24)
+    | ((u_int64_t)p[4]<<32) | ((u_int64_t)p[5]<<40) | ((u_int64_t)p[6]<<48) | ((u_int64_t)p[7]<<56);
+}
+
+static inline u_int32_t read32LE(u_int8_t const* p) {
+  return (u_int32_t)p[0] | ((u_int32_t)p[1]<<8) | ((u_int32_t)p[2]<<16) | ((u_int32_t)p[3]<<24);
+}
+
+static inline u_int64_t round64(u_int64_t acc, u_int64_t input) {
+  acc += input*PRIME64_2;
+  acc = rotl64(acc, 31);
+  return acc*PRIME64_1;
+}
+
+static inline u_int64_t mergeRound64(u_int64_t acc, u_int64_t value) {
+  acc ^= round64(0, value);
+  return acc*PRIME64_1 + PRIME64_4;
+}
+
+u_int64_t hashFileContents(u_int8_t const* data, u_int64_t size, u_int64_t seed) {
+  u_int8_t const* ptr = data;
+  u_int8_t const* const limit = data + size;
+  u_int64_t h;
+
+  if (size >= 32) {
+    u_int64_t v1 = seed + PRIME64_1 + PRIME64_2;
+    u_int64_t v2 = seed + PRIME64_2;
+    u_int64_t v3 = seed;
+    u_int64_t v4 = seed - PRIME64_1;
+
+    u_int8_t const* const stripesLimit = limit - 32;
+    do {
+      v1 = round64(v1, read64LE(ptr));
+      v2 = round64(v2, read64LE(ptr+8));
+      v3 = round64(v3, read64LE(ptr+16));
+      v4 = round64(v4, read64LE(ptr+24));
+      ptr += 32;
+    } while (ptr <= stripesLimit);
+
+    h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    h = mergeRound64(h, v1);
+    h = mergeRound64(h, v2);
+    h = mergeRound64(h, v3);
+    h = mergeRound64(h, v4);
+  } else {
+    h = seed + PRIME64_5;
+  }
+  h += size;
+
+  // Then, the remaining (< 32) bytes:
+  while (ptr + 8 <= limit) {
+    h ^= round64(0, read64LE(ptr));
+    h = rotl64(h, 27)*PRIME64_1 + PRIME64_4;
+    ptr += 8;
+  }
+  if (ptr + 4 <= limit) {
+    h ^= (u_int64_t)read32LE(ptr)*PRIME64_1;
+    h = rotl64(h, 23)*PRIME64_2 + PRIME64_3;
+    ptr += 4;
+  }
+  while (ptr < limit) {
+    h ^= (*ptr++)*PRIME64_5;
+    h = rotl64(h, 11)*PRIME64_1;
+  }
+
+  // Final 'avalanche':
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+
+  return h;
+}
+
+int hashFile(char const* fileName, u_int64_t& result) {
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0) return 0;
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0) {
+    close(fd);
+    return 0;
+  }
+  u_int64_t const fileSize = sb.st_size;
+
+  if (fileSize == 0) {
+    result = hashFileContents(NULL, 0);
+  } else {
+    u_int8_t* const mappedFile = (u_int8_t*)mmap(0, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (mappedFile == MAP_FAILED) {
+      close(fd);
+      return 0;
+    }
+    result = hashFileContents(mappedFile, fileSize);
+    munmap(mappedFile, fileSize);
+  }
+
+  close(fd);
+  return 1;
+}
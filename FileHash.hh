@@ -0,0 +1,40 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A fast (non-cryptographic) 64-bit hash of a file's contents.
+    Header File.
+*/
+
+#ifndef _FILE_HASH_HH
+#define _FILE_HASH_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+
+// Returns a 64-bit hash of "size" bytes of "data" (the "XXH64" algorithm).
+// The bulk of the data is processed as 32-byte stripes, by 4 independent 'lanes', so that the hash
+// runs at close to memory bandwidth.  (It's used to identify files - not to protect them.)
+u_int64_t hashFileContents(u_int8_t const* data, u_int64_t size, u_int64_t seed = 0);
+
+// Hashes the entire contents of the named file (by mapping it into memory).  Returns 1 iff it succeeds:
+int hashFile(char const* fileName, u_int64_t& result);
+
+#endif
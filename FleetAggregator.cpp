@@ -0,0 +1,74 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Running an aggregation over every log file in a directory, in parallel.
+    Implementation.
+*/
+
+#include "FleetAggregator.hh"
+#include "BatchProcessor.hh"
+
+#include <stdio.h>
+
+FleetAggregator* FleetAggregator::createNew(char const* inputDirectoryName, Aggregation& aggregation,
+					    AggregateFileFunc* aggregateFileFunc) {
+  FleetAggregator* fleetAggregator = new FleetAggregator(inputDirectoryName, aggregation, aggregateFileFunc);
+  if (!BatchProcessor::listInputFiles(inputDirectoryName, fleetAggregator->fNames)) {
+    delete fleetAggregator;
+    return NULL;
+  }
+
+  return fleetAggregator;
+}
+
+FleetAggregator::FleetAggregator(char const* inputDirectoryName, Aggregation& aggregation,
+				 AggregateFileFunc* aggregateFileFunc)
+  : fInputDirectoryName(inputDirectoryName), fAggregation(aggregation), fAggregateFileFunc(aggregateFileFunc) {
+}
+
+FleetAggregator::~FleetAggregator() {
+}
+
+int FleetAggregator::run(unsigned maxNumProcesses) {
+  // Parse the files, then merge the workers' partial results (in "collectResults()"):
+  int result = runTasks(fNames.size(), maxNumProcesses) ? 0 : 1;
+
+  fprintf(stderr, "Aggregated %u file(s) (%u failed) in %u process(es)\n",
+	  (unsigned)fNames.size(), numFailedTasks(), numWorkers());
+  return result;
+}
+
+int FleetAggregator::doTask(unsigned taskIndex, FILE* /*resultFile*/) {
+  std::string inputPath = fInputDirectoryName + "/" + fNames[taskIndex];
+  if ((*fAggregateFileFunc)(inputPath.c_str(), fAggregation) != 0) {
+    fprintf(stderr, "Failed to parse \"%s\"\n", inputPath.c_str());
+    return 0;
+  }
+  return 1;
+}
+
+int FleetAggregator::finishWorker(FILE* resultFile) {
+  return fAggregation.writePartial(resultFile);
+}
+
+int FleetAggregator::collectResults(FILE* resultFile) {
+  return fAggregation.mergePartial(resultFile);
+}
@@ -0,0 +1,74 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Running an aggregation over every log file in a directory, in parallel.
+    Header File.
+*/
+
+#ifndef _FLEET_AGGREGATOR_HH
+#define _FLEET_AGGREGATOR_HH
+
+#ifndef _AGGREGATION_HH
+#include "Aggregation.hh"
+#endif
+
+#ifndef _WORKER_POOL_HH
+#include "WorkerPool.hh"
+#endif
+
+#include <vector>
+
+// The function that parses one input file, adding its rows to "aggregation".  It returns 0 iff it succeeds:
+typedef int AggregateFileFunc(char const* inputFileName, Aggregation& aggregation);
+
+// Parses every log file (".txt" or ".txt.gz") in a directory, adding each one's rows to an aggregation -
+// without producing any other output.  The files are parsed in worker processes (see "WorkerPool.hh"), each
+// of which accumulates its own partial result, which is then merged (through its results file) into the
+// final result:
+class FleetAggregator: public WorkerPool {
+public:
+  static FleetAggregator* createNew(char const* inputDirectoryName, Aggregation& aggregation,
+				    AggregateFileFunc* aggregateFileFunc);
+      // Returns NULL (after printing an error message) if the directory can't be read
+
+  virtual ~FleetAggregator();
+
+  // Parses the files, in up to "maxNumProcesses" worker processes.  The result is merged into the
+  // aggregation.  Returns 0 iff every file was parsed successfully:
+  int run(unsigned maxNumProcesses);
+
+private:
+  FleetAggregator(char const* inputDirectoryName, Aggregation& aggregation,
+		  AggregateFileFunc* aggregateFileFunc); // called only by "createNew()"
+
+private: // redefined virtual functions:
+  virtual int doTask(unsigned taskIndex, FILE* resultFile);
+  virtual int finishWorker(FILE* resultFile);
+  virtual int collectResults(FILE* resultFile);
+
+private:
+  std::string fInputDirectoryName;
+  Aggregation& fAggregation;
+  AggregateFileFunc* fAggregateFileFunc;
+  std::vector<std::string> fNames;
+};
+
+#endif
@@ -0,0 +1,913 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A catalog of many flights (from their logs' 'details' and 'RECOVER' data), with indexes for fast queries.
+    Implementation.
+*/
+
+#include "FleetCatalog.hh"
+#include "BatchProcessor.hh"
+#include "OutputBuffer.hh"
+#include "WorkerPool.hh"
+#include "GeoConstants.hh"
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <algorithm>
+#include <unordered_map>
+
+#define KILOMETERS_PER_DEGREE (METERS_PER_DEGREE/1000.0)
+
+static u_int64_t alignOffset(u_int64_t offset) {
+  return (offset + FLEET_CATALOG_ALIGNMENT-1) & ~(u_int64_t)(FLEET_CATALOG_ALIGNMENT-1);
+}
+
+// A grid (of cells "cellSize" degrees square) is numbered in rows (of latitude), then columns (of longitude):
+static unsigned numGridColumns(double cellSize) {
+  return (unsigned)(360.0/cellSize + 0.5);
+}
+
+static unsigned gridRow(double latitude, double cellSize) {
+  unsigned const numRows = (unsigned)(180.0/cellSize + 0.5);
+  int row = (int)floor((latitude + 90.0)/cellSize);
+  return row < 0 ? 0 : row >= (int)numRows ? numRows-1 : row;
+}
+
+static unsigned gridColumn(double longitude, double cellSize) {
+  unsigned const numColumns = numGridColumns(cellSize);
+  int column = (int)floor((longitude + 180.0)/cellSize);
+  return column < 0 ? 0 : column >= (int)numColumns ? numColumns-1 : column;
+}
+
+// The great-circle distance, in kilometers, between two points:
+static double distanceBetween(double latitude1, double longitude1, double latitude2, double longitude2) {
+  double sinHalfDLatitude = sin((latitude2 - latitude1)*RADIANS_PER_DEGREE/2);
+  double sinHalfDLongitude = sin((longitude2 - longitude1)*RADIANS_PER_DEGREE/2);
+  double a = sinHalfDLatitude*sinHalfDLatitude
+    + cos(latitude1*RADIANS_PER_DEGREE)*cos(latitude2*RADIANS_PER_DEGREE)*sinHalfDLongitude*sinHalfDLongitude;
+  return 2*(EARTH_RADIUS/1000.0)*asin(sqrt(a < 1.0 ? a : 1.0));
+}
+
+////////// FleetCatalogQuery implementation //////////
+
+FleetCatalogQuery::FleetCatalogQuery()
+  : hasTimeRange(0), fromTime(INT64_MIN), toTime(INT64_MAX),
+    hasLocation(0), latitude(0.0), longitude(0.0), radius(0.0),
+    hasTrackArea(0), trackLatitude(0.0), trackLongitude(0.0), trackRadius(0.0) {
+}
+
+int FleetCatalogQuery::parseTime(char const* str, int64_t& result) {
+  struct tm tm;
+  memset(&tm, 0, sizeof tm);
+  tm.tm_mday = 1;
+  int numChars = 0;
+  if (sscanf(str, "%d-%d%n", &tm.tm_year, &tm.tm_mon, &numChars) != 2) return 0;
+  str += numChars;
+  if (*str == '-') {
+    if (sscanf(str, "-%d%n", &tm.tm_mday, &numChars) != 1) return 0;
+    str += numChars;
+    if (*str == 'T') {
+      if (sscanf(str, "T%d:%d%n", &tm.tm_hour, &tm.tm_min, &numChars) != 2) return 0;
+      str += numChars;
+      if (*str == ':') {
+	if (sscanf(str, ":%d%n", &tm.tm_sec, &numChars) != 1) return 0;
+	str += numChars;
+      }
+    }
+  }
+  if (*str != '\0' || tm.tm_mon < 1 || tm.tm_mon > 12 || tm.tm_mday < 1 || tm.tm_mday > 31
+      || tm.tm_hour > 23 || tm.tm_min > 59 || tm.tm_sec > 60) return 0;
+
+  tm.tm_year -= 1900;
+  tm.tm_mon -= 1;
+  result = (int64_t)timegm(&tm)*1000;
+  return 1;
+}
+
+// Parses "<latitude>,<longitude>,<kilometers>".  Returns 1 iff it's OK:
+static int parseCircle(char const* str, double& latitude, double& longitude, double& radius) {
+  int numChars = 0;
+  return sscanf(str, "%lf,%lf,%lf%n", &latitude, &longitude, &radius, &numChars) == 3 && str[numChars] == '\0'
+    && latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0 && radius > 0.0;
+}
+
+int FleetCatalogQuery::parse(char const* spec) {
+  static char const* const serialNames[NUM_CATALOG_SERIALS] = { "aircraft", "battery", "camera" };
+
+  char const* ptr = spec;
+  while (1) {
+    while (*ptr == ' ') ++ptr;
+    if (*ptr == '\0') break;
+    char const* termEnd = strchr(ptr, ' ');
+    if (termEnd == NULL) termEnd = ptr + strlen(ptr);
+    std::string term(ptr, termEnd - ptr);
+    ptr = termEnd;
+
+    std::string::size_type equalsPos = term.find('=');
+    std::string name = term.substr(0, equalsPos);
+    char const* value = equalsPos == std::string::npos ? "" : &term.c_str()[equalsPos+1];
+    int serialNum = -1;
+    for (unsigned i = 0; i < NUM_CATALOG_SERIALS; ++i) {
+      if (name == serialNames[i]) serialNum = i;
+    }
+
+    int isOK = *value != '\0';
+    if (isOK) {
+      if (serialNum >= 0) {
+	serials[serialNum] = value;
+      } else if (name == "from") {
+	isOK = parseTime(value, fromTime);
+	hasTimeRange = 1;
+      } else if (name == "to") {
+	isOK = parseTime(value, toTime);
+	hasTimeRange = 1;
+      } else if (name == "month") {
+	// [the start of the month, the start of the next month):
+	int year, month, numChars = 0;
+	isOK = sscanf(value, "%d-%d%n", &year, &month, &numChars) == 2 && value[numChars] == '\0'
+	  && parseTime(value, fromTime);
+	if (isOK) {
+	  char nextMonth[32];
+	  sprintf(nextMonth, "%d-%d", month == 12 ? year+1 : year, month == 12 ? 1 : month+1);
+	  isOK = parseTime(nextMonth, toTime);
+	}
+	hasTimeRange = 1;
+      } else if (name == "near") {
+	isOK = parseCircle(value, latitude, longitude, radius);
+	hasLocation = 1;
+      } else if (name == "over") {
+	isOK = parseCircle(value, trackLatitude, trackLongitude, trackRadius);
+	hasTrackArea = 1;
+      } else {
+	isOK = 0;
+      }
+    }
+
+    if (!isOK) {
+      fprintf(stderr, "Bad catalog query term \"%s\": expected \"aircraft=<serialNumber>\", \"battery=<serialNumber>\", \"camera=<serialNumber>\", \"from=<time>\", \"to=<time>\", \"month=<YYYY-MM>\", \"near=<latitude>,<longitude>,<kilometers>\" or \"over=<latitude>,<longitude>,<kilometers>\"\n", term.c_str());
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+////////// Updating //////////
+
+// A catalog entry, while it's being updated:
+class CatalogEntry {
+public:
+  std::string name;
+  std::string serials[NUM_CATALOG_SERIALS];
+  FleetCatalogFlight flight; // its string offsets are set only when the catalog is written
+  std::vector<TrackCellPosting> trackPostings; // their "flight" is set only when the catalog is written
+  int previousFlight; // its index in the previous catalog (if it's reused from there), or -1
+  int isParsed; // if it had to be parsed: whether this succeeded
+};
+
+// Sets "entry" from the fields of a (just-parsed) flight:
+static void noteFlight(DJITxtParser& parser, CatalogEntry& entry) {
+  static char const* const detailsSerialFields[NUM_CATALOG_SERIALS]
+    = { "DETAILS.aircraftSn", "DETAILS.batterySn", "DETAILS.cameraSn" };
+  static char const* const recoverSerialFields[NUM_CATALOG_SERIALS]
+    = { "RECOVER.aircraftSn", "RECOVER.batterySn", "RECOVER.cameraSn" };
+  FleetCatalogFlight& flight = entry.flight; // alias
+
+  // (Older logs may have empty serial numbers in their 'details' area, but not in their 'RECOVER' records.):
+  for (unsigned i = 0; i < NUM_CATALOG_SERIALS; ++i) {
+    if (!parser.getFieldValue(detailsSerialFields[i], entry.serials[i]) || entry.serials[i].empty()) {
+      if (!parser.getFieldValue(recoverSerialFields[i], entry.serials[i])) entry.serials[i].clear();
+    }
+  }
+
+  double timestamp;
+  if (parser.getFieldValue("DETAILS.timestamp", timestamp) && timestamp > 0.0) {
+    flight.timestamp = (int64_t)timestamp;
+    flight.flags |= CATALOG_FLIGHT_HAS_TIME;
+  }
+
+  double latitude = 0.0, longitude = 0.0;
+  if (!parser.getFieldValue("DETAILS.latitude", latitude) || !parser.getFieldValue("DETAILS.longitude", longitude)
+      || (latitude == 0.0 && longitude == 0.0)) {
+    if (!parser.getFieldValue("HOME.latitude", latitude) || !parser.getFieldValue("HOME.longitude", longitude)) {
+      latitude = longitude = 0.0;
+    }
+  }
+  if ((latitude != 0.0 || longitude != 0.0)
+      && latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0) {
+    flight.latitude = latitude;
+    flight.longitude = longitude;
+    flight.flags |= CATALOG_FLIGHT_HAS_LOCATION;
+  }
+
+  if (!parser.getFieldValue("DETAILS.totalTime", flight.totalTime)) flight.totalTime = 0.0;
+  if (!parser.getFieldValue("DETAILS.maxHeight", flight.maxHeight)) flight.maxHeight = 0.0;
+}
+
+// Orders flights by a serial number (unless "serialNum" is -1), then time, then file name:
+class CatalogEntryOrder {
+public:
+  CatalogEntryOrder(std::vector<CatalogEntry> const& entries, int serialNum)
+    : entries(entries), serialNum(serialNum) {
+  }
+
+  bool operator()(u_int32_t a, u_int32_t b) const {
+    CatalogEntry const& entryA = entries[a]; // alias
+    CatalogEntry const& entryB = entries[b]; // alias
+    if (serialNum >= 0) {
+      int comparison = entryA.serials[serialNum].compare(entryB.serials[serialNum]);
+      if (comparison != 0) return comparison < 0;
+    }
+    if (entryA.flight.timestamp != entryB.flight.timestamp) return entryA.flight.timestamp < entryB.flight.timestamp;
+    return entryA.name < entryB.name;
+  }
+
+public:
+  std::vector<CatalogEntry> const& entries;
+  int serialNum;
+};
+
+static bool operator<(FleetCatalogGridPosting const& a, FleetCatalogGridPosting const& b) {
+  return a.cell != b.cell ? a.cell < b.cell : a.flight < b.flight;
+}
+
+static bool operator<(TrackCellPosting const& a, TrackCellPosting const& b) {
+  if (a.cell != b.cell) return a.cell < b.cell;
+  return a.flight != b.flight ? a.flight < b.flight : a.startTime < b.startTime;
+}
+
+static void padTo(OutputBuffer& out, u_int64_t& position, u_int64_t offset) {
+  while (position < offset) {
+    out.appendChar(0);
+    ++position;
+  }
+}
+
+static void writeBlock(OutputBuffer& out, u_int64_t& position, u_int64_t offset,
+		       void const* data, u_int64_t size) {
+  if (size == 0) return;
+  padTo(out, position, offset);
+  out.append((char const*)data, size);
+  position += size;
+}
+
+// Writes a catalog file (in a single pass).  Returns 1 iff it succeeds:
+static int writeCatalog(char const* fileName, std::vector<CatalogEntry>& entries) {
+  u_int32_t const numFlights = entries.size();
+
+  // Collect the strings (each one once), and set the flights' offsets to them:
+  std::string strings(1, '\0'); // offset 0 is the empty string
+  std::unordered_map<std::string, u_int32_t> stringOffsets;
+  stringOffsets[""] = 0;
+  for (unsigned i = 0; i < numFlights; ++i) {
+    CatalogEntry& entry = entries[i]; // alias
+    for (unsigned s = 0; s <= NUM_CATALOG_SERIALS; ++s) {
+      std::string const& str = s < NUM_CATALOG_SERIALS ? entry.serials[s] : entry.name; // alias
+      std::unordered_map<std::string, u_int32_t>::iterator itr = stringOffsets.find(str);
+      u_int32_t offset;
+      if (itr != stringOffsets.end()) {
+	offset = itr->second;
+      } else {
+	offset = strings.size();
+	strings.append(str.c_str(), str.size() + 1);
+	stringOffsets[str] = offset;
+      }
+      if (s < NUM_CATALOG_SERIALS) entry.flight.serialOffsets[s] = offset; else entry.flight.nameOffset = offset;
+    }
+  }
+
+  // Make the indexes:
+  std::vector<u_int32_t> indexes[NUM_CATALOG_SERIALS+1]; // the last one is the time index
+  for (unsigned s = 0; s <= NUM_CATALOG_SERIALS; ++s) {
+    indexes[s].resize(numFlights);
+    for (u_int32_t i = 0; i < numFlights; ++i) indexes[s][i] = i;
+    std::sort(indexes[s].begin(), indexes[s].end(),
+	      CatalogEntryOrder(entries, s < NUM_CATALOG_SERIALS ? (int)s : -1));
+  }
+  std::vector<FleetCatalogGridPosting> gridPostings;
+  for (u_int32_t i = 0; i < numFlights; ++i) {
+    FleetCatalogFlight const& flight = entries[i].flight; // alias
+    if ((flight.flags&CATALOG_FLIGHT_HAS_LOCATION) == 0) continue;
+
+    FleetCatalogGridPosting posting;
+    posting.cell = gridRow(flight.latitude, FLEET_CATALOG_GRID_CELL_SIZE)*numGridColumns(FLEET_CATALOG_GRID_CELL_SIZE)
+      + gridColumn(flight.longitude, FLEET_CATALOG_GRID_CELL_SIZE);
+    posting.flight = i;
+    gridPostings.push_back(posting);
+  }
+  std::sort(gridPostings.begin(), gridPostings.end());
+  std::vector<TrackCellPosting> trackPostings;
+  for (u_int32_t i = 0; i < numFlights; ++i) {
+    for (unsigned j = 0; j < entries[i].trackPostings.size(); ++j) {
+      trackPostings.push_back(entries[i].trackPostings[j]);
+      trackPostings.back().flight = i;
+    }
+  }
+  std::sort(trackPostings.begin(), trackPostings.end());
+
+  // Lay out the file:
+  FleetCatalogHeader header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, FLEET_CATALOG_MAGIC, sizeof header.magic);
+  header.byteOrderMark = FLEET_CATALOG_BYTE_ORDER_MARK;
+  header.formatVersion = FLEET_CATALOG_FORMAT_VERSION;
+  header.numFlights = numFlights;
+  header.numGridPostings = gridPostings.size();
+  header.numTrackPostings = trackPostings.size();
+  u_int64_t const indexSize = numFlights*sizeof (u_int32_t);
+  header.flightsOffset = alignOffset(sizeof header);
+  header.stringsOffset = alignOffset(header.flightsOffset + numFlights*sizeof (FleetCatalogFlight));
+  header.stringsSize = strings.size();
+  u_int64_t offset = alignOffset(header.stringsOffset + header.stringsSize);
+  for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+    header.serialIndexOffsets[s] = offset;
+    offset = alignOffset(offset + indexSize);
+  }
+  header.timeIndexOffset = offset;
+  header.gridOffset = alignOffset(header.timeIndexOffset + indexSize);
+  header.trackOffset = alignOffset(header.gridOffset + gridPostings.size()*sizeof (FleetCatalogGridPosting));
+  header.fileSize = alignOffset(header.trackOffset + trackPostings.size()*sizeof (TrackCellPosting));
+
+  // Then, write it (under a temporary name):
+  char tempFileName[strlen(fileName) + 30];
+  sprintf(tempFileName, "%s.%d.tmp", fileName, (int)getpid());
+  int fd = ::open(tempFileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open catalog file \"%s\": %s\n", tempFileName, strerror(errno));
+    return 0;
+  }
+
+  int writeFailed;
+  {
+    OutputBuffer out(fd);
+    u_int64_t position = 0;
+    writeBlock(out, position, 0, &header, sizeof header);
+    for (unsigned i = 0; i < numFlights; ++i) {
+      writeBlock(out, position, header.flightsOffset + i*sizeof (FleetCatalogFlight),
+		 &entries[i].flight, sizeof (FleetCatalogFlight));
+    }
+    writeBlock(out, position, header.stringsOffset, strings.data(), strings.size());
+    for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+      writeBlock(out, position, header.serialIndexOffsets[s], indexes[s].data(), indexSize);
+    }
+    writeBlock(out, position, header.timeIndexOffset, indexes[NUM_CATALOG_SERIALS].data(), indexSize);
+    writeBlock(out, position, header.gridOffset, gridPostings.data(),
+	       gridPostings.size()*sizeof (FleetCatalogGridPosting));
+    writeBlock(out, position, header.trackOffset, trackPostings.data(),
+	       trackPostings.size()*sizeof (TrackCellPosting));
+    padTo(out, position, header.fileSize);
+
+    out.flush();
+    writeFailed = out.writeFailed();
+  }
+
+  if (close(fd) != 0) writeFailed = 1;
+  if (writeFailed || rename(tempFileName, fileName) != 0) {
+    fprintf(stderr, "Failed to write catalog file \"%s\": %s\n", fileName, strerror(errno));
+    unlink(tempFileName);
+    return 0;
+  }
+
+  return 1;
+}
+
+// Parses a log file into "entry" (whose file details have already been set).  Returns 1 iff it succeeds:
+static int parseFlight(char const* inputPath, CatalogParseFunc* parseFunc, CatalogEntry& entry) {
+  TrackCells trackCells;
+  DJITxtParser* parser = DJITxtParser::createNew(ROW_OUTPUT_NONE);
+  (void)parser->addFlightObserver(&trackCells);
+  parser->disableJPEGOutput();
+  int const parseFailed = (*parseFunc)(inputPath, *parser) != 0;
+  if (!parseFailed) noteFlight(*parser, entry);
+  delete parser;
+  if (parseFailed) return 0;
+
+  entry.trackPostings = trackCells.postings();
+  return 1;
+}
+
+// A worker process returns each entry that it has parsed (in a temporary file) as: the entry's index (in
+// the list of entries to be parsed); its "FleetCatalogFlight"; its serial numbers (each as a length, then
+// the characters); and its number of track postings, then the postings:
+static void writeParsedEntry(FILE* fid, u_int32_t pendingIndex, CatalogEntry const& entry) {
+  fwrite(&pendingIndex, sizeof pendingIndex, 1, fid);
+  fwrite(&entry.flight, sizeof entry.flight, 1, fid);
+  for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+    u_int32_t length = entry.serials[s].size();
+    fwrite(&length, sizeof length, 1, fid);
+    fwrite(entry.serials[s].data(), 1, length, fid);
+  }
+  u_int32_t numPostings = entry.trackPostings.size();
+  fwrite(&numPostings, sizeof numPostings, 1, fid);
+  fwrite(entry.trackPostings.data(), sizeof (TrackCellPosting), numPostings, fid);
+}
+
+// Reads an entry written by "writeParsedEntry()" into one of "pending" (an entry to be parsed).
+// Returns 1 iff it succeeds (0 at the end of the file, or if the file is bad):
+static int readParsedEntry(FILE* fid, std::vector<CatalogEntry*>& pending) {
+  u_int32_t pendingIndex;
+  if (fread(&pendingIndex, sizeof pendingIndex, 1, fid) != 1 || pendingIndex >= pending.size()) return 0;
+  CatalogEntry& entry = *pending[pendingIndex]; // alias
+
+  if (fread(&entry.flight, sizeof entry.flight, 1, fid) != 1) return 0;
+  for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+    u_int32_t length;
+    if (fread(&length, sizeof length, 1, fid) != 1 || length > 0xFFFF) return 0;
+    std::string& serial = entry.serials[s]; // alias
+    serial.resize(length);
+    if (length > 0 && fread(&serial[0], 1, length, fid) != length) return 0;
+  }
+  u_int32_t numPostings;
+  if (fread(&numPostings, sizeof numPostings, 1, fid) != 1 || numPostings > 0x10000000) return 0;
+  entry.trackPostings.resize(numPostings);
+  if (fread(entry.trackPostings.data(), sizeof (TrackCellPosting), numPostings, fid) != numPostings) return 0;
+
+  entry.isParsed = 1;
+  return 1;
+}
+
+// Parses the "pending" entries in worker processes (see "WorkerPool.hh"), which return each parsed entry
+// through their results files.  Entries that fail to parse are left with "isParsed" 0:
+class CatalogParsingPool: public WorkerPool {
+public:
+  CatalogParsingPool(char const* inputDirectoryName, CatalogParseFunc* parseFunc, std::vector<CatalogEntry*>& pending);
+
+private: // redefined virtual functions:
+  virtual int doTask(unsigned taskIndex, FILE* resultFile);
+  virtual int collectResults(FILE* resultFile);
+
+private:
+  char const* fInputDirectoryName;
+  CatalogParseFunc* fParseFunc;
+  std::vector<CatalogEntry*>& fPending;
+};
+
+CatalogParsingPool::CatalogParsingPool(char const* inputDirectoryName, CatalogParseFunc* parseFunc,
+				       std::vector<CatalogEntry*>& pending)
+  : fInputDirectoryName(inputDirectoryName), fParseFunc(parseFunc), fPending(pending) {
+}
+
+int CatalogParsingPool::doTask(unsigned taskIndex, FILE* resultFile) {
+  CatalogEntry& entry = *fPending[taskIndex]; // alias
+  std::string inputPath = std::string(fInputDirectoryName) + "/" + entry.name;
+  if (!parseFlight(inputPath.c_str(), fParseFunc, entry)) {
+    fprintf(stderr, "Failed to parse \"%s\"; it's not in the catalog\n", inputPath.c_str());
+    return 0;
+  }
+
+  writeParsedEntry(resultFile, taskIndex, entry);
+  return 1;
+}
+
+int CatalogParsingPool::collectResults(FILE* resultFile) {
+  while (readParsedEntry(resultFile, fPending)) {}
+  return 1;
+}
+
+int FleetCatalog::update(char const* catalogFileName, char const* inputDirectoryName, CatalogParseFunc* parseFunc,
+			 unsigned maxNumProcesses) {
+  std::vector<std::string> names;
+  if (!BatchProcessor::listInputFiles(inputDirectoryName, names)) return 0;
+
+  // Use the existing catalog (if any) for files that haven't changed:
+  FleetCatalog* previous = open(catalogFileName, 0/*it may not exist yet*/);
+  std::unordered_map<std::string, u_int32_t> previousIndex;
+  for (u_int32_t i = 0; previous != NULL && i < previous->numFlights(); ++i) {
+    previousIndex[previous->string(previous->flight(i).nameOffset)] = i;
+  }
+
+  std::vector<CatalogEntry> entries;
+  for (unsigned i = 0; i < names.size(); ++i) {
+    std::string inputPath = std::string(inputDirectoryName) + "/" + names[i];
+    struct stat sb;
+    if (stat(inputPath.c_str(), &sb) != 0 || !S_ISREG(sb.st_mode)) continue;
+
+    entries.push_back(CatalogEntry());
+    CatalogEntry& entry = entries.back(); // alias
+    entry.name = names[i];
+    memset(&entry.flight, 0, sizeof entry.flight);
+    entry.flight.sourceSize = sb.st_size;
+    entry.flight.mtimeSeconds = sb.st_mtim.tv_sec;
+    entry.flight.mtimeNanoseconds = sb.st_mtim.tv_nsec;
+    entry.previousFlight = -1;
+    entry.isParsed = 0;
+
+    std::unordered_map<std::string, u_int32_t>::iterator itr = previousIndex.find(names[i]);
+    FleetCatalogFlight const* previousFlight = itr == previousIndex.end() ? NULL : &previous->flight(itr->second);
+    if (previousFlight != NULL && previousFlight->sourceSize == entry.flight.sourceSize
+	&& previousFlight->mtimeSeconds == entry.flight.mtimeSeconds
+	&& previousFlight->mtimeNanoseconds == entry.flight.mtimeNanoseconds) {
+      entry.flight = *previousFlight;
+      for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+	entry.serials[s] = previous->string(previousFlight->serialOffsets[s]);
+      }
+      entry.previousFlight = itr->second;
+    }
+  }
+
+  // Parse the files that are new (or have changed):
+  std::vector<CatalogEntry*> pending;
+  for (unsigned i = 0; i < entries.size(); ++i) {
+    if (entries[i].previousFlight < 0) pending.push_back(&entries[i]);
+  }
+  CatalogParsingPool parsingPool(inputDirectoryName, parseFunc, pending);
+  (void)parsingPool.runTasks(pending.size(), maxNumProcesses); // (the entries that failed are counted below)
+
+  // Drop the entries that failed to parse, and note where (in the new catalog) each reused entry will be:
+  std::vector<int> newIndexOfPrevious(previous == NULL ? 0 : previous->numFlights(), -1);
+  unsigned numKept = 0, numParsed = 0, numUnchanged = 0;
+  for (unsigned i = 0; i < entries.size(); ++i) {
+    if (entries[i].previousFlight >= 0) {
+      newIndexOfPrevious[entries[i].previousFlight] = numKept;
+      ++numUnchanged;
+    } else if (entries[i].isParsed) {
+      ++numParsed;
+    } else {
+      continue;
+    }
+    if (numKept != i) std::swap(entries[numKept], entries[i]);
+    ++numKept;
+  }
+  unsigned const numFailed = entries.size() - numKept;
+  entries.resize(numKept);
+
+  // Reuse the track postings of the unchanged entries (in one pass through the previous catalog's):
+  for (unsigned i = 0; previous != NULL && i < previous->numTrackPostings(); ++i) {
+    TrackCellPosting const& posting = previous->trackPosting(i); // alias
+    int newIndex = newIndexOfPrevious[posting.flight];
+    if (newIndex >= 0) entries[newIndex].trackPostings.push_back(posting);
+  }
+  delete previous;
+
+  if (!writeCatalog(catalogFileName, entries)) return 0;
+  fprintf(stderr, "Catalog \"%s\": %u flight(s) (%u parsed, %u unchanged); %u file(s) failed\n",
+	  catalogFileName, (unsigned)entries.size(), numParsed, numUnchanged, numFailed);
+
+  return numFailed == 0;
+}
+
+////////// Opening //////////
+
+FleetCatalog* FleetCatalog::open(char const* catalogFileName, int reportMissing) {
+  int fd = ::open(catalogFileName, O_RDONLY);
+  if (fd < 0) {
+    if (errno != ENOENT || reportMissing) {
+      fprintf(stderr, "Failed to open catalog file \"%s\": %s\n", catalogFileName, strerror(errno));
+    }
+    return NULL;
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0 || (u_int64_t)sb.st_size < sizeof (FleetCatalogHeader)) {
+    fprintf(stderr, "Bad catalog file \"%s\"\n", catalogFileName);
+    close(fd);
+    return NULL;
+  }
+  u_int64_t const fileSize = sb.st_size;
+
+  u_int8_t* const mappedFile = (u_int8_t*)mmap(0, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping remains valid
+  if (mappedFile == MAP_FAILED) {
+    fprintf(stderr, "mmap() call failed: %s\n", strerror(errno));
+    return NULL;
+  }
+
+  // Check the header, and that each block lies within the file:
+  FleetCatalogHeader const* header = (FleetCatalogHeader const*)mappedFile;
+  u_int64_t const indexSize = (u_int64_t)header->numFlights*sizeof (u_int32_t);
+  int isOK = memcmp(header->magic, FLEET_CATALOG_MAGIC, sizeof header->magic) == 0
+    && header->byteOrderMark == FLEET_CATALOG_BYTE_ORDER_MARK
+    && header->formatVersion == FLEET_CATALOG_FORMAT_VERSION
+    && header->fileSize == fileSize
+    && header->stringsSize > 0;
+  u_int64_t const offsets[NUM_CATALOG_SERIALS+5] = {
+    header->flightsOffset, header->stringsOffset, header->timeIndexOffset, header->gridOffset, header->trackOffset,
+    header->serialIndexOffsets[0], header->serialIndexOffsets[1], header->serialIndexOffsets[2]
+  };
+  u_int64_t const sizes[NUM_CATALOG_SERIALS+5] = {
+    header->numFlights*sizeof (FleetCatalogFlight), header->stringsSize, indexSize,
+    header->numGridPostings*sizeof (FleetCatalogGridPosting), header->numTrackPostings*sizeof (TrackCellPosting),
+    indexSize, indexSize, indexSize
+  };
+  for (unsigned b = 0; isOK && b < NUM_CATALOG_SERIALS+5; ++b) {
+    if (offsets[b] < sizeof (FleetCatalogHeader) || offsets[b]%FLEET_CATALOG_ALIGNMENT != 0
+	|| offsets[b] > fileSize || sizes[b] > fileSize - offsets[b]) {
+      isOK = 0;
+    }
+  }
+  if (isOK && mappedFile[header->stringsOffset + header->stringsSize - 1] != '\0') isOK = 0;
+
+  FleetCatalog* catalog = isOK ? new FleetCatalog(mappedFile, fileSize) : NULL;
+
+  // Check that each flight's strings, and each index entry, are within bounds:
+  for (u_int32_t i = 0; isOK && i < header->numFlights; ++i) {
+    FleetCatalogFlight const& flight = catalog->flight(i); // alias
+    if (flight.nameOffset >= header->stringsSize) isOK = 0;
+    for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+      if (flight.serialOffsets[s] >= header->stringsSize || catalog->fSerialIndexes[s][i] >= header->numFlights) isOK = 0;
+    }
+    if (catalog->fTimeIndex[i] >= header->numFlights) isOK = 0;
+  }
+  for (u_int32_t i = 0; isOK && i < header->numGridPostings; ++i) {
+    if (catalog->fGridPostings[i].flight >= header->numFlights) isOK = 0;
+  }
+  for (u_int32_t i = 0; isOK && i < header->numTrackPostings; ++i) {
+    if (catalog->fTrackPostings[i].flight >= header->numFlights) isOK = 0;
+  }
+  if (!isOK) {
+    fprintf(stderr, "Bad catalog file \"%s\"\n", catalogFileName);
+    if (catalog != NULL) delete catalog; else munmap(mappedFile, fileSize);
+    return NULL;
+  }
+
+  return catalog;
+}
+
+FleetCatalog::FleetCatalog(u_int8_t* mappedFile, u_int64_t fileSize)
+  : fMappedFile(mappedFile), fFileSize(fileSize), fHeader((FleetCatalogHeader const*)mappedFile) {
+  fFlights = (FleetCatalogFlight const*)&mappedFile[fHeader->flightsOffset];
+  fStrings = (char const*)&mappedFile[fHeader->stringsOffset];
+  for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+    fSerialIndexes[s] = (u_int32_t const*)&mappedFile[fHeader->serialIndexOffsets[s]];
+  }
+  fTimeIndex = (u_int32_t const*)&mappedFile[fHeader->timeIndexOffset];
+  fGridPostings = (FleetCatalogGridPosting const*)&mappedFile[fHeader->gridOffset];
+  fTrackPostings = (TrackCellPosting const*)&mappedFile[fHeader->trackOffset];
+}
+
+FleetCatalog::~FleetCatalog() {
+  munmap(fMappedFile, fFileSize);
+}
+
+////////// Querying //////////
+
+int FleetCatalog::meetsConditions(u_int32_t flightIndex, FleetCatalogQuery const& query) const {
+  FleetCatalogFlight const& flight = fFlights[flightIndex]; // alias
+
+  for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+    if (!query.serials[s].empty() && query.serials[s] != string(flight.serialOffsets[s])) return 0;
+  }
+  if (query.hasTimeRange && !query.hasTrackArea // (if there's a track area, the time range applies to it instead)
+      && ((flight.flags&CATALOG_FLIGHT_HAS_TIME) == 0
+	  || flight.timestamp < query.fromTime || flight.timestamp >= query.toTime)) return 0;
+  if (query.hasLocation
+      && ((flight.flags&CATALOG_FLIGHT_HAS_LOCATION) == 0
+	  || distanceBetween(query.latitude, query.longitude, flight.latitude, flight.longitude) > query.radius)) return 0;
+
+  return 1;
+}
+
+u_int32_t const* FleetCatalog::lowerBound(u_int32_t const* begin, u_int32_t const* end,
+					  int serialNum, char const* serial, int64_t time) const {
+  while (begin < end) {
+    u_int32_t const* middle = begin + (end - begin)/2;
+    FleetCatalogFlight const& flight = fFlights[*middle]; // alias
+    int comparison = serialNum < 0 ? 0 : strcmp(string(flight.serialOffsets[serialNum]), serial);
+    if (comparison < 0 || (comparison == 0 && flight.timestamp < time)) {
+      begin = middle + 1;
+    } else {
+      end = middle;
+    }
+  }
+
+  return begin;
+}
+
+void FleetCatalog::indexRange(int serialNum, FleetCatalogQuery const& query,
+			      u_int32_t const*& begin, u_int32_t const*& end) const {
+  u_int32_t const* index = serialNum < 0 ? fTimeIndex : fSerialIndexes[serialNum];
+  char const* serial = serialNum < 0 ? "" : query.serials[serialNum].c_str();
+
+  begin = lowerBound(index, index + numFlights(), serialNum, serial, query.fromTime);
+  end = lowerBound(begin, index + numFlights(), serialNum, serial, query.toTime);
+}
+
+// Sets "ranges" to the ranges of cells (in a grid of cells "cellSize" degrees square) that overlap a circle.
+// (Within each row of cells, the cells in a range of longitudes have consecutive numbers.):
+static void cellRanges(double latitude, double longitude, double radius, double cellSize,
+		       std::vector<std::pair<u_int32_t, u_int32_t> >& ranges) {
+  ranges.clear();
+
+  // The range of latitudes, and longitudes (which may wrap around), that the circle lies within:
+  double const latitudeRadius = radius/KILOMETERS_PER_DEGREE;
+  double const minLatitude = latitude - latitudeRadius, maxLatitude = latitude + latitudeRadius;
+  double const maxAbsLatitude = fmax(fabs(minLatitude), fabs(maxLatitude));
+  double longitudeRadius = maxAbsLatitude >= 90.0 ? 180.0 : latitudeRadius/cos(maxAbsLatitude*RADIANS_PER_DEGREE);
+
+  double longitudeRanges[2][2];
+  unsigned numLongitudeRanges = 1;
+  if (longitudeRadius >= 180.0) {
+    longitudeRanges[0][0] = -180.0; longitudeRanges[0][1] = 180.0;
+  } else {
+    double minLongitude = longitude - longitudeRadius, maxLongitude = longitude + longitudeRadius;
+    longitudeRanges[0][0] = minLongitude; longitudeRanges[0][1] = maxLongitude;
+    if (minLongitude < -180.0) {
+      longitudeRanges[0][0] = -180.0;
+      longitudeRanges[1][0] = minLongitude + 360.0; longitudeRanges[1][1] = 180.0;
+      numLongitudeRanges = 2;
+    } else if (maxLongitude > 180.0) {
+      longitudeRanges[0][1] = 180.0;
+      longitudeRanges[1][0] = -180.0; longitudeRanges[1][1] = maxLongitude - 360.0;
+      numLongitudeRanges = 2;
+    }
+  }
+
+  unsigned const numColumns = numGridColumns(cellSize);
+  for (unsigned row = gridRow(minLatitude, cellSize); row <= gridRow(maxLatitude, cellSize); ++row) {
+    for (unsigned r = 0; r < numLongitudeRanges; ++r) {
+      ranges.push_back(std::make_pair(row*numColumns + gridColumn(longitudeRanges[r][0], cellSize),
+				      row*numColumns + gridColumn(longitudeRanges[r][1], cellSize)));
+    }
+  }
+}
+
+void FleetCatalog::gridCandidates(FleetCatalogQuery const& query, std::vector<u_int32_t>& result) const {
+  std::vector<std::pair<u_int32_t, u_int32_t> > ranges;
+  cellRanges(query.latitude, query.longitude, query.radius, FLEET_CATALOG_GRID_CELL_SIZE, ranges);
+
+  FleetCatalogGridPosting const* const postingsEnd = fGridPostings + fHeader->numGridPostings;
+  for (unsigned i = 0; i < ranges.size(); ++i) {
+    FleetCatalogGridPosting first;
+    first.cell = ranges[i].first;
+    first.flight = 0;
+    for (FleetCatalogGridPosting const* posting = std::lower_bound(fGridPostings, postingsEnd, first);
+	 posting < postingsEnd && posting->cell <= ranges[i].second; ++posting) {
+      result.push_back(posting->flight);
+    }
+  }
+}
+
+// The distance, in kilometers, from a point to (the nearest point of) a posting's bounds:
+static double distanceToBounds(double latitude, double longitude, TrackCellPosting const& posting) {
+  double nearestLatitude = latitude < posting.minLatitude ? posting.minLatitude
+    : latitude > posting.maxLatitude ? posting.maxLatitude : latitude;
+  double nearestLongitude = longitude < posting.minLongitude ? posting.minLongitude
+    : longitude > posting.maxLongitude ? posting.maxLongitude : longitude;
+
+  return distanceBetween(latitude, longitude, nearestLatitude, nearestLongitude);
+}
+
+void FleetCatalog::trackCandidates(FleetCatalogQuery const& query, std::vector<FleetCatalogMatch>& result) const {
+  std::vector<std::pair<u_int32_t, u_int32_t> > ranges;
+  cellRanges(query.trackLatitude, query.trackLongitude, query.trackRadius, TRACK_CELL_SIZE, ranges);
+
+  // Check each posting in these cells, noting the (first and last) times that each flight was in the area:
+  std::unordered_map<u_int32_t, unsigned> matchForFlight; // index into "result"
+  TrackCellPosting const* const postingsEnd = fTrackPostings + fHeader->numTrackPostings;
+  for (unsigned i = 0; i < ranges.size(); ++i) {
+    TrackCellPosting first;
+    memset(&first, 0, sizeof first);
+    first.cell = ranges[i].first;
+    first.startTime = INT64_MIN;
+    for (TrackCellPosting const* posting = std::lower_bound(fTrackPostings, postingsEnd, first);
+	 posting < postingsEnd && posting->cell <= ranges[i].second; ++posting) {
+      if (query.hasTimeRange && (posting->endTime < query.fromTime || posting->startTime >= query.toTime)) continue;
+      if (distanceToBounds(query.trackLatitude, query.trackLongitude, *posting) > query.trackRadius) continue;
+
+      std::unordered_map<u_int32_t, unsigned>::iterator itr = matchForFlight.find(posting->flight);
+      if (itr == matchForFlight.end()) {
+	FleetCatalogMatch match;
+	match.flight = posting->flight;
+	match.passageStartTime = posting->startTime;
+	match.passageEndTime = posting->endTime;
+	matchForFlight[posting->flight] = result.size();
+	result.push_back(match);
+      } else {
+	FleetCatalogMatch& match = result[itr->second]; // alias
+	if (posting->startTime < match.passageStartTime) match.passageStartTime = posting->startTime;
+	if (posting->endTime > match.passageEndTime) match.passageEndTime = posting->endTime;
+      }
+    }
+  }
+}
+
+// Orders matches by time (of the flight's start, or - if "byPassage" - of its passage), then file name:
+class CatalogMatchOrder {
+public:
+  CatalogMatchOrder(FleetCatalog const& catalog, int byPassage)
+    : catalog(catalog), byPassage(byPassage) {
+  }
+
+  bool operator()(FleetCatalogMatch const& a, FleetCatalogMatch const& b) const {
+    FleetCatalogFlight const& flightA = catalog.flight(a.flight); // alias
+    FleetCatalogFlight const& flightB = catalog.flight(b.flight); // alias
+    int64_t const timeA = byPassage ? a.passageStartTime : flightA.timestamp;
+    int64_t const timeB = byPassage ? b.passageStartTime : flightB.timestamp;
+    if (timeA != timeB) return timeA < timeB;
+    return strcmp(catalog.string(flightA.nameOffset), catalog.string(flightB.nameOffset)) < 0;
+  }
+
+public:
+  FleetCatalog const& catalog;
+  int byPassage;
+};
+
+void FleetCatalog::query(FleetCatalogQuery const& query, std::vector<FleetCatalogMatch>& result) const {
+  result.clear();
+
+  std::vector<FleetCatalogMatch> candidates;
+  if (query.hasTrackArea) {
+    // The candidates are the flights that passed through the area (during the time range):
+    trackCandidates(query, candidates);
+  } else {
+    // Find the candidate flights, using the index that narrows them down the most - a serial number index
+    // (whichever gives the fewest), or else the grid (for a location), or else the time index:
+    u_int32_t const* begin = NULL;
+    u_int32_t const* end = NULL;
+    for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+      if (query.serials[s].empty()) continue;
+
+      u_int32_t const* serialBegin;
+      u_int32_t const* serialEnd;
+      indexRange(s, query, serialBegin, serialEnd);
+      if (begin == NULL || serialEnd - serialBegin < end - begin) {
+	begin = serialBegin;
+	end = serialEnd;
+      }
+    }
+
+    std::vector<u_int32_t> gridFlights;
+    if (begin == NULL) {
+      if (query.hasLocation) {
+	gridCandidates(query, gridFlights);
+	begin = gridFlights.data();
+	end = begin + gridFlights.size();
+      } else {
+	indexRange(-1, query, begin, end);
+      }
+    }
+
+    FleetCatalogMatch match;
+    match.passageStartTime = match.passageEndTime = 0;
+    for (u_int32_t const* candidate = begin; candidate < end; ++candidate) {
+      match.flight = *candidate;
+      candidates.push_back(match);
+    }
+  }
+
+  // Then, check each one:
+  for (unsigned i = 0; i < candidates.size(); ++i) {
+    if (meetsConditions(candidates[i].flight, query)) result.push_back(candidates[i]);
+  }
+  std::sort(result.begin(), result.end(), CatalogMatchOrder(*this, query.hasTrackArea));
+}
+
+void FleetCatalog::outputFlights(FILE* fid, std::vector<FleetCatalogMatch> const& matches,
+				 FleetCatalogQuery const& query) const {
+  fprintf(fid, "file,timestamp,aircraftSn,batterySn,cameraSn,latitude,longitude,totalTime,maxHeight%s%s\n",
+	  query.hasLocation ? ",distance" : "", query.hasTrackArea ? ",passageStart,passageEnd" : "");
+
+  for (unsigned i = 0; i < matches.size(); ++i) {
+    FleetCatalogFlight const& flight = fFlights[matches[i].flight]; // alias
+
+    outputCSVString(fid, string(flight.nameOffset));
+    fputc(',', fid);
+    if (flight.flags&CATALOG_FLIGHT_HAS_TIME) outputTime(fid, flight.timestamp);
+    for (unsigned s = 0; s < NUM_CATALOG_SERIALS; ++s) {
+      fputc(',', fid);
+      outputCSVString(fid, string(flight.serialOffsets[s]));
+    }
+    if (flight.flags&CATALOG_FLIGHT_HAS_LOCATION) {
+      fprintf(fid, ",%.6f,%.6f", flight.latitude, flight.longitude);
+    } else {
+      fprintf(fid, ",,");
+    }
+    fprintf(fid, ",%.1f,%.1f", flight.totalTime, flight.maxHeight);
+    if (query.hasLocation) {
+      fprintf(fid, ",%.3f", distanceBetween(query.latitude, query.longitude, flight.latitude, flight.longitude));
+    }
+    if (query.hasTrackArea) {
+      // (A passage time of 0 means that the log had no times.):
+      fputc(',', fid);
+      if (matches[i].passageStartTime > 0) outputTime(fid, matches[i].passageStartTime);
+      fputc(',', fid);
+      if (matches[i].passageEndTime > 0) outputTime(fid, matches[i].passageEndTime);
+    }
+    fputc('\n', fid);
+  }
+}
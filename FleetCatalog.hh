@@ -0,0 +1,195 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A catalog of many flights (from their logs' 'details' and 'RECOVER' data), with indexes for fast queries.
+    Header File.
+*/
+
+#ifndef _FLEET_CATALOG_HH
+#define _FLEET_CATALOG_HH
+
+#ifndef _DJI_TXT_PARSER_HH
+#include "DJITxtParser.hh"
+#endif
+
+#ifndef _TRACK_CELLS_HH
+#include "TrackCells.hh"
+#endif
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// A 'fleet catalog' file describes each flight (log file) in a directory, and contains (in host byte order):
+//	- a 64-byte-aligned header ("FleetCatalogHeader");
+//	- one entry ("FleetCatalogFlight") for each flight, in file name order;
+//	- the strings (file names and serial numbers; each '\0'-terminated) that the entries refer to;
+//	- secondary indexes: for each serial number (aircraft, battery and camera), the flights' indices, sorted
+//	  by that serial number, then time; and the flights' indices sorted by time alone;
+//	- a location index: a 'posting' ("FleetCatalogGridPosting") for each flight that has a location, sorted
+//	  by the grid cell (of FLEET_CATALOG_GRID_CELL_SIZE degrees of latitude and longitude) that contains it;
+//	- a track index: the postings ("TrackCellPosting") for the (smaller) grid cells that each flight's track
+//	  passes through - with when, and where within the cell - sorted by cell, then flight.
+// Each block is aligned on a 64-byte boundary, and all locations are byte offsets from the start of the file,
+// so (as with a flight cache file) opening the file is just a "mmap()".  A query uses a binary search of one
+// index (e.g., for "this aircraft, in March", the aircraft index), then checks only the flights that it finds.
+
+#define FLEET_CATALOG_MAGIC "DJICATL1" // 8 bytes
+#define FLEET_CATALOG_BYTE_ORDER_MARK 0x01020304
+#define FLEET_CATALOG_FORMAT_VERSION 2
+#define FLEET_CATALOG_ALIGNMENT 64
+#define FLEET_CATALOG_GRID_CELL_SIZE 0.1 // degrees (about 11 km of latitude)
+
+// The serial numbers that are indexed:
+#define CATALOG_AIRCRAFT_SN 0
+#define CATALOG_BATTERY_SN 1
+#define CATALOG_CAMERA_SN 2
+#define NUM_CATALOG_SERIALS 3
+
+// Values of "FleetCatalogFlight::flags":
+#define CATALOG_FLIGHT_HAS_TIME 0x01
+#define CATALOG_FLIGHT_HAS_LOCATION 0x02
+
+class FleetCatalogHeader {
+public:
+  char magic[8];
+  u_int32_t byteOrderMark, formatVersion;
+  u_int32_t numFlights, numGridPostings;
+  u_int64_t flightsOffset, stringsOffset, stringsSize;
+  u_int64_t serialIndexOffsets[NUM_CATALOG_SERIALS], timeIndexOffset; // each an array of "numFlights" u_int32_t
+  u_int64_t gridOffset;
+  u_int32_t numTrackPostings, reserved;
+  u_int64_t trackOffset, fileSize;
+};
+
+class FleetCatalogFlight {
+public:
+  u_int64_t sourceSize; // of the log file; used (with its modification time) to tell whether it has changed
+  int64_t mtimeSeconds;
+  int64_t timestamp; // DETAILS.timestamp (in milliseconds)
+  double latitude, longitude; // DETAILS.latitude and DETAILS.longitude (or, if those are 0, the home point)
+  double totalTime, maxHeight; // DETAILS.totalTime and DETAILS.maxHeight
+  u_int32_t mtimeNanoseconds;
+  u_int32_t nameOffset; // of the log file's name; relative to the start of the strings
+  u_int32_t serialOffsets[NUM_CATALOG_SERIALS]; // ditto; from DETAILS, or (if empty there) from RECOVER records
+  u_int32_t flags;
+};
+
+class FleetCatalogGridPosting {
+public:
+  u_int32_t cell; // (latitude cell number)*(number of longitude cells) + (longitude cell number)
+  u_int32_t flight;
+};
+
+// The conditions of a query.  (A flight must meet all of them.)  If the query has a track area, its time
+// range is that of the flight's passage through the area; otherwise, it's that of the flight's start:
+class FleetCatalogQuery {
+public:
+  FleetCatalogQuery();
+
+  // Sets the conditions from a specification - space-separated terms, each one of "aircraft=<serialNumber>",
+  // "battery=<serialNumber>", "camera=<serialNumber>", "from=<time>", "to=<time>" (exclusive), "month=<YYYY-MM>",
+  // "near=<latitude>,<longitude>,<kilometers>" (the flight's start), or "over=<latitude>,<longitude>,<kilometers>"
+  // (anywhere along its track).  Times (UTC) are "YYYY-MM-DD[THH:MM[:SS]]" or "YYYY-MM".
+  // Returns 0 (after reporting an error) if "spec" is bad:
+  int parse(char const* spec);
+
+  // Parses a (UTC) time - "YYYY-MM-DD[THH:MM[:SS]]" or "YYYY-MM" - into milliseconds.  Returns 1 iff it's OK:
+  static int parseTime(char const* str, int64_t& result);
+
+public:
+  std::string serials[NUM_CATALOG_SERIALS]; // empty if not a condition
+  int hasTimeRange;
+  int64_t fromTime, toTime; // in milliseconds, if "hasTimeRange"
+  int hasLocation;
+  double latitude, longitude, radius; // in degrees, and kilometers, if "hasLocation"
+  int hasTrackArea;
+  double trackLatitude, trackLongitude, trackRadius; // ditto, if "hasTrackArea"
+};
+
+// A flight that meets a query's conditions:
+class FleetCatalogMatch {
+public:
+  u_int32_t flight;
+  int64_t passageStartTime, passageEndTime; // when the track was in the query's track area (if it has one)
+};
+
+// The function that parses one log file (with no output) into "parser".  It returns 0 iff it succeeds:
+typedef int CatalogParseFunc(char const* inputFileName, DJITxtParser& parser);
+
+class FleetCatalog {
+public:
+  // Brings a catalog file up to date with the log files (".txt" or ".txt.gz") in a directory: files that are
+  // new (or whose size or modification time has changed) are parsed - by up to "maxNumProcesses" (worker)
+  // processes at once - and the others' entries (and track postings) are reused.  (The file is written under
+  // a temporary name, then renamed, so readers never see a partial file.)  Returns 1 iff it succeeds:
+  static int update(char const* catalogFileName, char const* inputDirectoryName, CatalogParseFunc* parseFunc,
+		    unsigned maxNumProcesses);
+
+  // Opens a catalog file, or returns NULL (after reporting an error, unless "reportMissing" is 0 and the file
+  // doesn't exist) if it doesn't exist or is bad:
+  static FleetCatalog* open(char const* catalogFileName, int reportMissing = 1);
+
+  virtual ~FleetCatalog();
+
+  unsigned numFlights() const { return fHeader->numFlights; }
+  FleetCatalogFlight const& flight(unsigned i) const { return fFlights[i]; }
+  char const* string(u_int32_t offset) const { return &fStrings[offset]; }
+  unsigned numTrackPostings() const { return fHeader->numTrackPostings; }
+  TrackCellPosting const& trackPosting(unsigned i) const { return fTrackPostings[i]; }
+
+  // Sets "result" to the flights that meet the conditions of "query", in time order (of their start, or of
+  // their passage through the query's track area):
+  void query(FleetCatalogQuery const& query, std::vector<FleetCatalogMatch>& result) const;
+
+  // Outputs (as CSV) a description of each of "matches" (with its distance, if "query" has a location, and its
+  // passage times, if it has a track area):
+  void outputFlights(FILE* fid, std::vector<FleetCatalogMatch> const& matches, FleetCatalogQuery const& query) const;
+
+private:
+  FleetCatalog(u_int8_t* mappedFile, u_int64_t fileSize); // called only by "open()"
+
+  int meetsConditions(u_int32_t flightIndex, FleetCatalogQuery const& query) const;
+  u_int32_t const* lowerBound(u_int32_t const* begin, u_int32_t const* end,
+			      int serialNum, char const* serial, int64_t time) const;
+      // the first flight (in a range of an index) that's not before ("serial", "time"); "serialNum" is
+      // -1 for the time index
+  void indexRange(int serialNum, FleetCatalogQuery const& query,
+		  u_int32_t const*& begin, u_int32_t const*& end) const;
+      // the range of an index that holds the flights with the query's serial number and time range
+  void gridCandidates(FleetCatalogQuery const& query, std::vector<u_int32_t>& result) const;
+      // the flights in the grid cells that overlap the query's location (and radius)
+  void trackCandidates(FleetCatalogQuery const& query, std::vector<FleetCatalogMatch>& result) const;
+      // the flights whose tracks pass through the query's track area, during its time range
+
+private:
+  u_int8_t* fMappedFile;
+  u_int64_t fFileSize;
+  FleetCatalogHeader const* fHeader;
+  FleetCatalogFlight const* fFlights;
+  char const* fStrings;
+  u_int32_t const* fSerialIndexes[NUM_CATALOG_SERIALS];
+  u_int32_t const* fTimeIndex;
+  FleetCatalogGridPosting const* fGridPostings;
+  TrackCellPosting const* fTrackPostings;
+};
+
+#endif
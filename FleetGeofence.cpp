@@ -0,0 +1,113 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Checking every log file in a directory (in parallel) against a set of geofence zones.
+    Implementation.
+*/
+
+#include "FleetGeofence.hh"
+#include "BatchProcessor.hh"
+
+#include <string.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+FleetGeofence* FleetGeofence::createNew(char const* inputName, GeofenceZones const& zones,
+					GeofenceFileFunc* geofenceFileFunc) {
+  struct stat sb;
+  if (stat(inputName, &sb) != 0) {
+    fprintf(stderr, "Failed to open \"%s\": %s\n", inputName, strerror(errno));
+    return NULL;
+  }
+
+  FleetGeofence* fleetGeofence = new FleetGeofence(zones, geofenceFileFunc);
+  if (!S_ISDIR(sb.st_mode)) {
+    fleetGeofence->fNames.push_back(inputName);
+  } else {
+    fleetGeofence->fInputDirectoryName = inputName;
+    if (!BatchProcessor::listInputFiles(inputName, fleetGeofence->fNames)) {
+      delete fleetGeofence;
+      return NULL;
+    }
+  }
+
+  return fleetGeofence;
+}
+
+FleetGeofence::FleetGeofence(GeofenceZones const& zones, GeofenceFileFunc* geofenceFileFunc)
+  : fZones(zones), fGeofenceFileFunc(geofenceFileFunc) {
+}
+
+FleetGeofence::~FleetGeofence() {
+}
+
+int FleetGeofence::run(unsigned maxNumProcesses, FILE* fid) {
+  unsigned const numFiles = fNames.size();
+  fOutputs.assign(numFiles, std::string());
+  fHaveOutput.assign(numFiles, 0);
+
+  // Parse the files, collecting each one's output (in "collectResults()"):
+  int result = runTasks(numFiles, maxNumProcesses) ? 0 : 1;
+
+  // Then output it all, in file order:
+  OutputBuffer out(fileno(fid));
+  GeofenceMonitor::outputHeader(out);
+  unsigned numMissing = 0;
+  for (unsigned i = 0; i < numFiles; ++i) {
+    if (fHaveOutput[i]) out.append(fOutputs[i].data(), fOutputs[i].size()); else ++numMissing;
+  }
+  out.flush();
+  if (out.writeFailed() || numMissing > 0) result = 1;
+
+  fprintf(stderr, "Checked %u file(s) (%u failed) against %u zone(s), in %u process(es)\n",
+	  numFiles, numFailedTasks(), fZones.numZones(), numWorkers());
+  return result;
+}
+
+// A worker returns the output for each file that it parsed as: the file's index (in "fNames"), the
+// output's size, then the output:
+int FleetGeofence::doTask(unsigned taskIndex, FILE* resultFile) {
+  OutputBuffer out(-1/*in memory*/, 64*1024);
+  GeofenceMonitor monitor(fZones, out);
+
+  std::string inputPath = fInputDirectoryName.empty() ? fNames[taskIndex] : fInputDirectoryName + "/" + fNames[taskIndex];
+  monitor.setFlightName(fNames[taskIndex].c_str());
+  int result = (*fGeofenceFileFunc)(inputPath.c_str(), monitor) == 0;
+  if (!result) fprintf(stderr, "Failed to parse \"%s\"\n", inputPath.c_str());
+
+  u_int32_t const header[2] = { taskIndex, out.size() };
+  fwrite(header, sizeof header, 1, resultFile);
+  fwrite(out.data(), 1, out.size(), resultFile);
+  return result;
+}
+
+int FleetGeofence::collectResults(FILE* resultFile) {
+  u_int32_t header[2];
+  while (fread(header, sizeof header, 1, resultFile) == 1) {
+    if (header[0] >= fNames.size()) return 0;
+
+    std::string& output = fOutputs[header[0]]; // alias
+    output.resize(header[1]);
+    if (header[1] > 0 && fread(&output[0], 1, header[1], resultFile) != header[1]) return 0;
+    fHaveOutput[header[0]] = 1;
+  }
+  return 1;
+}
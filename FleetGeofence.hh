@@ -0,0 +1,74 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Checking every log file in a directory (in parallel) against a set of geofence zones.
+    Header File.
+*/
+
+#ifndef _FLEET_GEOFENCE_HH
+#define _FLEET_GEOFENCE_HH
+
+#ifndef _GEOFENCE_HH
+#include "Geofence.hh"
+#endif
+
+#ifndef _WORKER_POOL_HH
+#include "WorkerPool.hh"
+#endif
+
+#include <stdio.h>
+
+// The function that parses one input file into "monitor".  It returns 0 iff it succeeds:
+typedef int GeofenceFileFunc(char const* inputFileName, GeofenceMonitor& monitor);
+
+// Parses every log file (".txt" or ".txt.gz") in a directory - or a single log file - following each one
+// through a set of geofence zones, and outputs (as CSV) the visits to the zones, in file name order.  As for
+// "FleetAggregator", the files are parsed in worker processes (see "WorkerPool.hh"); each worker returns its
+// output through its results file:
+class FleetGeofence: public WorkerPool {
+public:
+  static FleetGeofence* createNew(char const* inputName, GeofenceZones const& zones,
+				  GeofenceFileFunc* geofenceFileFunc);
+      // "inputName" is a directory or a file.  Returns NULL (after printing an error message) if it can't be read
+
+  virtual ~FleetGeofence();
+
+  // Parses the files, in up to "maxNumProcesses" worker processes, and outputs the visits to "fid".
+  // Returns 0 iff every file was parsed successfully:
+  int run(unsigned maxNumProcesses, FILE* fid);
+
+private:
+  FleetGeofence(GeofenceZones const& zones, GeofenceFileFunc* geofenceFileFunc); // called only by "createNew()"
+
+private: // redefined virtual functions:
+  virtual int doTask(unsigned taskIndex, FILE* resultFile);
+  virtual int collectResults(FILE* resultFile);
+
+private:
+  GeofenceZones const& fZones;
+  GeofenceFileFunc* fGeofenceFileFunc;
+  std::string fInputDirectoryName; // empty if the input is a single file
+  std::vector<std::string> fNames;
+  std::vector<std::string> fOutputs; // for each file (collected from the workers)
+  std::vector<char> fHaveOutput; // ditto
+};
+
+#endif
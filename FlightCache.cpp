@@ -0,0 +1,314 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A memory-mappable binary file ('flight cache') containing a parsed "FlightTable".
+    Implementation.
+*/
+
+#include "FlightCache.hh"
+#include "DJITxtFile.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+
+static u_int64_t alignOffset(u_int64_t offset) {
+  return (offset + FLIGHT_CACHE_ALIGNMENT-1) & ~(u_int64_t)(FLIGHT_CACHE_ALIGNMENT-1);
+}
+
+// The blocks of data that make up one column, and their sizes (in bytes):
+class ColumnBlocks {
+public:
+  ColumnBlocks(FlightColumnType type, u_int64_t numRows, u_int64_t dictionarySize, u_int64_t dataSize);
+
+  u_int64_t validitySize, valuesSize, offsetsSize, dataSize;
+};
+
+ColumnBlocks::ColumnBlocks(FlightColumnType type, u_int64_t numRows, u_int64_t dictionarySize, u_int64_t dataSize)
+  : validitySize((numRows+7)/8), valuesSize(0), offsetsSize(0), dataSize(dataSize) {
+  switch (type) {
+    case FlightColumnInt64:
+    case FlightColumnTimestamp: { valuesSize = numRows*sizeof (int64_t); break; }
+    case FlightColumnDouble: { valuesSize = numRows*sizeof (double); break; }
+    case FlightColumnBoolean: { valuesSize = numRows; break; }
+    case FlightColumnString: { offsetsSize = (numRows+1)*sizeof (u_int32_t); break; }
+    case FlightColumnDictionary: {
+      valuesSize = numRows*sizeof (int32_t);
+      offsetsSize = (dictionarySize+1)*sizeof (u_int32_t);
+      break;
+    }
+    default: { break; }
+  }
+  if (offsetsSize == 0) this->dataSize = 0;
+}
+
+////////// Writing //////////
+
+static void padTo(OutputBuffer& out, u_int64_t& position, u_int64_t offset) {
+  while (position < offset) {
+    out.appendChar(0);
+    ++position;
+  }
+}
+
+static void writeBlock(OutputBuffer& out, u_int64_t& position, u_int64_t offset,
+		       void const* data, u_int64_t size) {
+  if (size == 0) return;
+  padTo(out, position, offset);
+  out.append((char const*)data, size);
+  position += size;
+}
+
+int FlightCache::write(FlightTable const& table, DJITxtFile const& source, char const* fileName) {
+  unsigned const numColumns = table.numColumns();
+  unsigned const numRows = table.numRows();
+
+  // First, lay out the file:
+  FlightCacheHeader header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, FLIGHT_CACHE_MAGIC, sizeof header.magic);
+  header.byteOrderMark = FLIGHT_CACHE_BYTE_ORDER_MARK;
+  header.formatVersion = FLIGHT_CACHE_FORMAT_VERSION;
+  header.sourceHash = source.contentHash();
+  header.sourceSize = source.size();
+  header.numColumns = numColumns;
+  header.numRows = numRows;
+  header.directoryOffset = sizeof header;
+  header.namesOffset = header.directoryOffset + numColumns*sizeof (FlightCacheColumnEntry);
+
+  FlightCacheColumnEntry* directory = new FlightCacheColumnEntry[numColumns];
+  memset(directory, 0, numColumns*sizeof (FlightCacheColumnEntry));
+  u_int32_t namesSize = 0;
+  for (unsigned i = 0; i < numColumns; ++i) {
+    directory[i].nameOffset = namesSize;
+    namesSize += strlen(table.column(i)->name()) + 1;
+  }
+
+  u_int64_t offset = alignOffset(header.namesOffset + namesSize);
+  for (unsigned i = 0; i < numColumns; ++i) {
+    FlightColumn const* column = table.column(i);
+    FlightCacheColumnEntry& entry = directory[i];
+    entry.type = column->type();
+    entry.nullCount = column->nullCount();
+    entry.numFractionalDigits = column->numFractionalDigits();
+    entry.dictionarySize = column->type() == FlightColumnDictionary ? column->dictionarySize() : 0;
+    ColumnBlocks blocks(column->type(), numRows, entry.dictionarySize,
+			column->type() == FlightColumnString ? column->stringOffsets()[numRows]
+			: column->type() == FlightColumnDictionary ? column->dictionaryOffsets()[entry.dictionarySize]
+			: 0);
+    entry.dataSize = blocks.dataSize;
+
+    if (blocks.validitySize > 0) { entry.validityOffset = offset; offset = alignOffset(offset + blocks.validitySize); }
+    if (blocks.valuesSize > 0) { entry.valuesOffset = offset; offset = alignOffset(offset + blocks.valuesSize); }
+    if (blocks.offsetsSize > 0) { entry.offsetsOffset = offset; offset = alignOffset(offset + blocks.offsetsSize); }
+    if (blocks.dataSize > 0) { entry.dataOffset = offset; offset = alignOffset(offset + blocks.dataSize); }
+  }
+  header.fileSize = offset;
+
+  // Then, write it (under a temporary name):
+  char tempFileName[strlen(fileName) + 30];
+  sprintf(tempFileName, "%s.%d.tmp", fileName, (int)getpid());
+  int fd = ::open(tempFileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open flight cache file \"%s\": %s\n", tempFileName, strerror(errno));
+    delete[] directory;
+    return 0;
+  }
+
+  int writeFailed;
+  {
+    OutputBuffer out(fd);
+    u_int64_t position = 0;
+    writeBlock(out, position, 0, &header, sizeof header);
+    writeBlock(out, position, header.directoryOffset, directory, numColumns*sizeof (FlightCacheColumnEntry));
+    for (unsigned i = 0; i < numColumns; ++i) {
+      char const* name = table.column(i)->name();
+      writeBlock(out, position, header.namesOffset + directory[i].nameOffset, name, strlen(name) + 1);
+    }
+
+    for (unsigned i = 0; i < numColumns; ++i) {
+      FlightColumn const* column = table.column(i);
+      FlightCacheColumnEntry const& entry = directory[i];
+      ColumnBlocks blocks(column->type(), numRows, entry.dictionarySize, entry.dataSize);
+      void const* values = NULL;
+      void const* offsets = NULL;
+      void const* data = NULL;
+      switch (column->type()) {
+	case FlightColumnInt64:
+	case FlightColumnTimestamp: { values = column->int64Values(); break; }
+	case FlightColumnDouble: { values = column->doubleValues(); break; }
+	case FlightColumnBoolean: { values = column->booleanValues(); break; }
+	case FlightColumnString: { offsets = column->stringOffsets(); data = column->stringData(); break; }
+	case FlightColumnDictionary: {
+	  values = column->dictionaryIndices();
+	  offsets = column->dictionaryOffsets();
+	  data = column->dictionaryData();
+	  break;
+	}
+	default: { break; }
+      }
+
+      if (blocks.validitySize > 0) {
+	writeBlock(out, position, entry.validityOffset, column->validityBitmap(), blocks.validitySize);
+      }
+      writeBlock(out, position, entry.valuesOffset, values, blocks.valuesSize);
+      writeBlock(out, position, entry.offsetsOffset, offsets, blocks.offsetsSize);
+      writeBlock(out, position, entry.dataOffset, data, blocks.dataSize);
+    }
+    padTo(out, position, header.fileSize);
+
+    out.flush();
+    writeFailed = out.writeFailed();
+  }
+  delete[] directory;
+
+  if (close(fd) != 0) writeFailed = 1;
+  if (writeFailed || rename(tempFileName, fileName) != 0) {
+    fprintf(stderr, "Failed to write flight cache file \"%s\": %s\n", fileName, strerror(errno));
+    unlink(tempFileName);
+    return 0;
+  }
+
+  return 1;
+}
+
+////////// Opening //////////
+
+// Checks the values that are used to index other data - the string (or dictionary) offsets, and the
+// dictionary indices - so that a damaged file can't make us read outside its blocks:
+static int columnValuesAreOK(FlightCacheColumnEntry const& entry, ColumnBlocks const& blocks,
+			     u_int8_t const* mappedFile, unsigned numRows) {
+  if (blocks.offsetsSize > 0) {
+    u_int32_t const* offsets = (u_int32_t const*)&mappedFile[entry.offsetsOffset];
+    u_int64_t const numOffsets = blocks.offsetsSize/sizeof (u_int32_t);
+    if (offsets[0] != 0 || offsets[numOffsets-1] != entry.dataSize) return 0;
+    for (u_int64_t i = 1; i < numOffsets; ++i) {
+      if (offsets[i] < offsets[i-1]) return 0;
+    }
+  }
+
+  if (entry.type == FlightColumnDictionary) {
+    u_int8_t const* validity = &mappedFile[entry.validityOffset];
+    int32_t const* indices = (int32_t const*)&mappedFile[entry.valuesOffset];
+    for (unsigned row = 0; row < numRows; ++row) {
+      if (((validity[row>>3]>>(row&7))&1) == 0) continue; // the index of a null value is never used
+      if (indices[row] < 0 || (u_int32_t)indices[row] >= entry.dictionarySize) return 0;
+    }
+  }
+
+  return 1;
+}
+
+FlightTable* FlightCache::open(char const* fileName, DJITxtFile const* source) {
+  int fd = ::open(fileName, O_RDONLY);
+  if (fd < 0) {
+    if (errno != ENOENT) fprintf(stderr, "Failed to open flight cache file \"%s\": %s\n", fileName, strerror(errno));
+    return NULL;
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0 || (u_int64_t)sb.st_size < sizeof (FlightCacheHeader)) {
+    fprintf(stderr, "Bad flight cache file \"%s\"\n", fileName);
+    close(fd);
+    return NULL;
+  }
+  u_int64_t const fileSize = sb.st_size;
+
+  u_int8_t* const mappedFile = (u_int8_t*)mmap(0, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping remains valid
+  if (mappedFile == MAP_FAILED) {
+    fprintf(stderr, "mmap() call failed: %s\n", strerror(errno));
+    return NULL;
+  }
+
+  // Check the header, and the directory:
+  FlightCacheHeader const* header = (FlightCacheHeader const*)mappedFile;
+  FlightCacheColumnEntry const* directory = (FlightCacheColumnEntry const*)&mappedFile[header->directoryOffset];
+  int isOK = memcmp(header->magic, FLIGHT_CACHE_MAGIC, sizeof header->magic) == 0
+    && header->byteOrderMark == FLIGHT_CACHE_BYTE_ORDER_MARK
+    && header->formatVersion == FLIGHT_CACHE_FORMAT_VERSION
+    && header->fileSize == fileSize
+    && header->directoryOffset == sizeof (FlightCacheHeader)
+    && header->namesOffset == header->directoryOffset + header->numColumns*sizeof (FlightCacheColumnEntry)
+    && header->namesOffset <= fileSize;
+
+  for (unsigned i = 0; isOK && i < header->numColumns; ++i) {
+    FlightCacheColumnEntry const& entry = directory[i];
+    u_int64_t const nameOffset = header->namesOffset + entry.nameOffset;
+    if (entry.type > FlightColumnDictionary || entry.nullCount > header->numRows
+	|| nameOffset >= fileSize || memchr(&mappedFile[nameOffset], '\0', fileSize - nameOffset) == NULL) {
+      isOK = 0;
+      break;
+    }
+
+    ColumnBlocks blocks((FlightColumnType)entry.type, header->numRows, entry.dictionarySize, entry.dataSize);
+    u_int64_t const offsets[4] = { entry.validityOffset, entry.valuesOffset, entry.offsetsOffset, entry.dataOffset };
+    u_int64_t const sizes[4] = { blocks.validitySize, blocks.valuesSize, blocks.offsetsSize, blocks.dataSize };
+    for (unsigned b = 0; b < 4; ++b) {
+      if (sizes[b] > 0 && (offsets[b] == 0 || offsets[b]%FLIGHT_CACHE_ALIGNMENT != 0
+			   || offsets[b] > fileSize || sizes[b] > fileSize - offsets[b])) {
+	isOK = 0;
+      }
+    }
+
+    if (isOK) isOK = columnValuesAreOK(entry, blocks, mappedFile, header->numRows);
+  }
+  if (!isOK) {
+    fprintf(stderr, "Bad flight cache file \"%s\"\n", fileName);
+    munmap(mappedFile, fileSize);
+    return NULL;
+  }
+
+  if (source != NULL && (header->sourceSize != source->size() || header->sourceHash != source->contentHash())) {
+    // The file is OK, but it was made from a different (or modified) ".txt" file:
+    munmap(mappedFile, fileSize);
+    return NULL;
+  }
+
+  // Create a table whose columns refer to the mapped data:
+  FlightTable* table = new FlightTable(header->numColumns, header->numRows, mappedFile, fileSize);
+  char const* names = (char const*)&mappedFile[header->namesOffset];
+  for (unsigned i = 0; i < header->numColumns; ++i) {
+    FlightCacheColumnEntry const& entry = directory[i];
+
+    OutputColumn outputColumn;
+    outputColumn.label = &names[entry.nameOffset];
+    outputColumn.interpretedLabel = NULL;
+    outputColumn.kind = ColumnPlain;
+    outputColumn.numFractionalDigits = entry.numFractionalDigits;
+
+    FlightColumnBuffers buffers;
+    buffers.validity = entry.validityOffset == 0 ? NULL : &mappedFile[entry.validityOffset];
+    buffers.values = entry.valuesOffset == 0 ? NULL : &mappedFile[entry.valuesOffset];
+    buffers.offsets = entry.offsetsOffset == 0 ? NULL : (u_int32_t const*)&mappedFile[entry.offsetsOffset];
+    buffers.data = entry.dataOffset == 0 ? "" : (char const*)&mappedFile[entry.dataOffset];
+    buffers.dictionarySize = entry.dictionarySize;
+
+    table->fColumns[i] = new FlightColumn(outputColumn, (FlightColumnType)entry.type,
+					  header->numRows, entry.nullCount, buffers);
+  }
+
+  return table;
+}
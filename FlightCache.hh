@@ -0,0 +1,81 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A memory-mappable binary file ('flight cache') containing a parsed "FlightTable".
+    Header File.
+*/
+
+#ifndef _FLIGHT_CACHE_HH
+#define _FLIGHT_CACHE_HH
+
+#ifndef _FLIGHT_TABLE_HH
+#include "FlightTable.hh"
+#endif
+
+class DJITxtFile; // forward
+
+// A 'flight cache' file contains (in host byte order):
+//	- a 64-byte header ("FlightCacheHeader"), which identifies the source ".txt" file by its size
+//	  and content hash;
+//	- a directory: one 64-byte entry ("FlightCacheColumnEntry") for each column;
+//	- the column names (each '\0'-terminated);
+//	- each column's data blocks (validity bitmap, values, string offsets, string data),
+//	  each aligned on a 64-byte boundary.
+// All locations are byte offsets from the start of the file, so opening the file is just a "mmap()",
+// and a conversion of each offset into a pointer.
+
+#define FLIGHT_CACHE_MAGIC "DJIFLTC1" // 8 bytes
+#define FLIGHT_CACHE_BYTE_ORDER_MARK 0x01020304
+#define FLIGHT_CACHE_FORMAT_VERSION 1
+#define FLIGHT_CACHE_ALIGNMENT 64
+
+class FlightCacheHeader {
+public:
+  char magic[8];
+  u_int32_t byteOrderMark, formatVersion;
+  u_int64_t sourceHash, sourceSize;
+  u_int32_t numColumns, numRows;
+  u_int64_t directoryOffset, namesOffset, fileSize;
+};
+
+class FlightCacheColumnEntry {
+public:
+  u_int32_t type; // a "FlightColumnType"
+  u_int32_t nullCount, numFractionalDigits;
+  u_int32_t nameOffset; // relative to the start of the names
+  u_int32_t dictionarySize, reserved;
+  u_int64_t validityOffset, valuesOffset, offsetsOffset, dataOffset; // 0 if the block is not present
+  u_int64_t dataSize;
+};
+
+class FlightCache {
+public:
+  // Writes "table" (which was parsed from "source") to a flight cache file named "fileName".
+  // (The file is written under a temporary name, then renamed, so readers never see a partial file.)
+  // Returns 1 iff it succeeds:
+  static int write(FlightTable const& table, DJITxtFile const& source, char const* fileName);
+
+  // Opens a flight cache file, returning its (read-only) table, or NULL if the file doesn't exist or
+  // is bad.  If "source" is not NULL, NULL is also returned if the file was not made from "source".
+  static FlightTable* open(char const* fileName, DJITxtFile const* source = NULL);
+};
+
+#endif
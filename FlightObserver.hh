@@ -0,0 +1,60 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    An object that follows a flight as it's parsed (e.g., to aggregate its fields, or to find its segments).
+    Header File.
+*/
+
+#ifndef _FLIGHT_OBSERVER_HH
+#define _FLIGHT_OBSERVER_HH
+
+#ifndef _FIELD_DATABASE_HH
+#include "FieldDatabase.hh"
+#endif
+
+class OutputColumn; // forward
+
+// The parser calls each of these (see "DJITxtParser::addFlightObserver()"); by default, they do nothing:
+class FlightObserver {
+public:
+  virtual ~FlightObserver();
+
+  // When we're added to the parser (before parsing).  The fields - named as in "columns" (the parser's output
+  // columns) - get their values in "fieldDatabase".  Returns 0 (after reporting an error) if we can't follow
+  // the flight (e.g., because we need a field that isn't an output column):
+  virtual int startFlight(FieldDatabase* fieldDatabase, OutputColumn const* columns, unsigned numColumns);
+
+  // After each record (at [position, endPosition) in the file) has been parsed - i.e., its fields have been
+  // entered in the database:
+  virtual void noteRecord(u_int8_t recordType, u_int64_t position, u_int64_t endPosition);
+
+  // As each row is output (before the 'OSD' record that starts the next row is parsed).  The first row is
+  // output as the column labels, and has no data:
+  virtual void noteRow(int isColumnLabels);
+
+  virtual void flush(); // when the parser's output (so far) is written out
+  virtual void endFlight(); // when the parser is deleted (the fields then have their final values)
+
+protected:
+  FlightObserver(); // abstract base class
+};
+
+#endif
@@ -0,0 +1,221 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Dividing a flight into segments (motors on, airborne, return-to-home, landing, and flight modes), for a segment index.
+    Implementation.
+*/
+
+#include "FlightSegmenter.hh"
+#include "OutputBuffer.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <algorithm>
+
+// The record types that we use (see "parseRecord.cpp"):
+#define RECORD_TYPE_OSD 0x01
+#define RECORD_TYPE_RECOVER 0x0D
+#define RECORD_TYPE_FIRMWARE 0x0F
+
+// OSD.groundOrSky values (see "interpretationTables.cpp") of 2 or more mean 'Sky':
+#define GROUND_OR_SKY_SKY 2
+
+////////// FlightSegment implementation //////////
+
+static char const* const segmentKindNames[NUM_SEGMENT_KINDS] = {
+  "motors", "airborne", "goHome", "landing", "timeRange", "mode"
+};
+
+char const* FlightSegment::kindName(int kind) {
+  return kind >= 0 && kind < NUM_SEGMENT_KINDS ? segmentKindNames[kind] : "?";
+}
+
+int FlightSegment::kindFromName(char const* name) {
+  for (int kind = 0; kind < NUM_SEGMENT_KINDS; ++kind) {
+    if (kind == SEGMENT_TIME_RANGE) continue; // its rows are given by a time range, not found by name
+    if (strcmp(name, segmentKindNames[kind]) == 0) return kind;
+  }
+  return -1;
+}
+
+////////// FlightSegmenter implementation //////////
+
+FlightSegmenter::FlightSegmenter()
+  : fHasTimeRange(0), fFromTime(0), fToTime(0) {
+  startFlight(NULL, NULL, 0);
+}
+
+FlightSegmenter::~FlightSegmenter() {
+}
+
+int FlightSegmenter::startFlight(FieldDatabase* fieldDatabase, OutputColumn const* /*columns*/,
+				 unsigned /*numColumns*/) {
+  fFieldDatabase = fieldDatabase;
+  fSegments.clear();
+  fDescriptionRecords.clear();
+  for (unsigned kind = 0; kind < NUM_SEGMENT_KINDS; ++kind) fSegmentIsOpen[kind] = 0;
+  fMode = -1;
+  fNumRows = 0;
+  fFirstRowPosition = fRowPosition = 0;
+  fEndPosition = 0;
+  fLastTime = 0;
+  fIsEnded = 0;
+  return 1;
+}
+
+// Whether a flycState is returning to home, or landing (automatically, or forced):
+static int isGoHomeMode(int mode) {
+  return mode == 15/*GoHome*/ || mode == 36/*NaviAdvGoHome*/;
+}
+
+static int isLandingMode(int mode) {
+  return mode == 12/*AutoLanding*/ || mode == 13/*AttiLanding*/ || mode == 33/*ForceLanding*/
+    || mode == 37/*NaviAdvLanding*/;
+}
+
+void FlightSegmenter::noteRecord(u_int8_t recordType, u_int64_t position, u_int64_t endPosition) {
+  fEndPosition = endPosition;
+  if (recordType == RECORD_TYPE_RECOVER || recordType == RECORD_TYPE_FIRMWARE) {
+    RecordExtent extent = { position, endPosition };
+    fDescriptionRecords.push_back(extent);
+  }
+  if (recordType != RECORD_TYPE_OSD) return;
+
+  // This record begins a new row (which we'll look at once it's complete - in "noteRow()"):
+  if (fFirstRowPosition == 0) fFirstRowPosition = position;
+  fRowPosition = position;
+}
+
+void FlightSegmenter::noteRow(int isColumnLabels) {
+  if (isColumnLabels) return;
+
+  // The row (begun by the 'OSD' record at "fRowPosition") is now complete, so its fields - including its
+  // CUSTOM.updateTime, from a record that follows the 'OSD' record - have their values for the row:
+  ++fNumRows;
+  double value;
+  int64_t const time = fFieldDatabase->getFieldAsDouble("CUSTOM.updateTime", value) && value > 0.0
+    ? (int64_t)value : fLastTime; // (not known before the first 'CUSTOM' record)
+  fLastTime = time;
+
+  int const motorsAreOn = fFieldDatabase->getFieldAsDouble("OSD.isMotorUp", value) && value != 0.0;
+  int const isAirborne = fFieldDatabase->getFieldAsDouble("OSD.groundOrSky.RAW", value) && value >= GROUND_OR_SKY_SKY;
+  int const mode = fFieldDatabase->getFieldAsDouble("OSD.flycState.RAW", value) ? (int)value : -1;
+  int const isInTimeRange = fHasTimeRange && time > 0 && time >= fFromTime && time < fToTime;
+  int const isActive[NUM_SEGMENT_KINDS-1]
+    = { motorsAreOn, isAirborne, isGoHomeMode(mode), isLandingMode(mode), isInTimeRange };
+
+  for (int kind = 0; kind < NUM_SEGMENT_KINDS-1; ++kind) {
+    if (isActive[kind] && !fSegmentIsOpen[kind]) {
+      beginSegment(kind, "", fRowPosition, time);
+    } else if (!isActive[kind] && fSegmentIsOpen[kind]) {
+      endSegment(kind, fNumRows - 1, fRowPosition, time);
+    }
+  }
+
+  if (mode != fMode) {
+    if (fSegmentIsOpen[SEGMENT_MODE]) endSegment(SEGMENT_MODE, fNumRows - 1, fRowPosition, time);
+    fMode = mode;
+    if (mode >= 0) {
+      InterpretationTable* interpretationTable = fFieldDatabase->lookupInterpretationTable("OSD.flycState");
+      char modeNumber[12];
+      sprintf(modeNumber, "%d", mode);
+      beginSegment(SEGMENT_MODE, interpretationTable != NULL ? interpretationTable->lookup(mode) : modeNumber,
+		   fRowPosition, time);
+    }
+  }
+}
+
+void FlightSegmenter::endFlight() {
+  if (fIsEnded) return;
+
+  // End the segments that are still open (in kind order, so that the segments stay in order):
+  for (int kind = 0; kind < NUM_SEGMENT_KINDS; ++kind) {
+    if (fSegmentIsOpen[kind]) endSegment(kind, fNumRows, fEndPosition, fLastTime);
+  }
+  fIsEnded = 1;
+}
+
+void FlightSegmenter::setTimeRange(int64_t fromTime, int64_t toTime) {
+  fHasTimeRange = 1;
+  fFromTime = fromTime;
+  fToTime = toTime;
+}
+
+// Orders segments by their start, then kind:
+static bool operator<(FlightSegment const& a, FlightSegment const& b) {
+  return a.startRow != b.startRow ? a.startRow < b.startRow : a.kind < b.kind;
+}
+
+void FlightSegmenter::beginSegment(int kind, char const* label, u_int64_t position, int64_t time) {
+  FlightSegment& segment = fOpenSegments[kind]; // alias
+  segment.kind = kind;
+  segment.label = label;
+  segment.startRow = fNumRows - 1;
+  segment.startPosition = position;
+  segment.startTime = time;
+  fSegmentIsOpen[kind] = 1;
+}
+
+void FlightSegmenter::endSegment(int kind, u_int32_t endRow, u_int64_t position, int64_t time) {
+  FlightSegment& segment = fOpenSegments[kind]; // alias
+  segment.endRow = endRow;
+  segment.endPosition = position;
+  segment.endTime = time;
+  fSegmentIsOpen[kind] = 0;
+
+  // Keep the segments in order (they usually end in order of their start, so this is cheap):
+  fSegments.insert(std::upper_bound(fSegments.begin(), fSegments.end(), segment), segment);
+}
+
+int FlightSegmenter::writeIndex(char const* fileName) const {
+  int fd = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open segment index file \"%s\": %s\n", fileName, strerror(errno));
+    return 0;
+  }
+
+  int writeFailed;
+  {
+    OutputBuffer out(fd, 64*1024);
+    out.append("kind,label,startRow,endRow,startPosition,endPosition,startTime,endTime\n");
+    for (unsigned i = 0; i < fSegments.size(); ++i) {
+      FlightSegment const& segment = fSegments[i]; // alias
+      out.appendf("%s,%s,%u,%u,%llu,%llu,", FlightSegment::kindName(segment.kind), segment.label.c_str(),
+		  segment.startRow, segment.endRow,
+		  (unsigned long long)segment.startPosition, (unsigned long long)segment.endPosition);
+      out.appendTime(segment.startTime);
+      out.appendChar(',');
+      out.appendTime(segment.endTime);
+      out.appendChar('\n');
+    }
+    out.flush();
+    writeFailed = out.writeFailed();
+  }
+
+  if (close(fd) != 0 || writeFailed) {
+    fprintf(stderr, "Failed to write segment index file \"%s\"\n", fileName);
+    return 0;
+  }
+  return 1;
+}
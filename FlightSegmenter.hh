@@ -0,0 +1,118 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Dividing a flight into segments (motors on, airborne, return-to-home, landing, and flight modes), for a segment index.
+    Header File.
+*/
+
+#ifndef _FLIGHT_SEGMENTER_HH
+#define _FLIGHT_SEGMENTER_HH
+
+#ifndef _FLIGHT_OBSERVER_HH
+#include "FlightObserver.hh"
+#endif
+
+#include <string>
+#include <vector>
+
+// The kinds of segment:
+#define SEGMENT_MOTORS 0 // the motors are running (from their start to their stop)
+#define SEGMENT_AIRBORNE 1 // from takeoff to landing
+#define SEGMENT_GO_HOME 2 // returning to home (flycState "GoHome" or "NaviAdvGoHome")
+#define SEGMENT_LANDING 3 // an automatic or forced landing (flycState "AutoLanding", "ForceLanding", etc.)
+#define SEGMENT_TIME_RANGE 4 // the rows within a given time range (only if "setTimeRange()" was called)
+#define SEGMENT_MODE 5 // a period in one flight mode (flycState)
+#define NUM_SEGMENT_KINDS 6
+
+// A segment of a flight.  Its rows are numbered as in the CSV output (starting at 0, for the first row after the
+// column labels); its positions are those (in the file) of the 'OSD' records that begin its first row and the
+// row after its last row - so the records in [startPosition, endPosition) are exactly those of its rows:
+class FlightSegment {
+public:
+  int kind;
+  std::string label; // for a "mode" segment, the flight mode; otherwise empty
+  u_int32_t startRow, endRow; // "endRow" is the row after the segment
+  u_int64_t startPosition, endPosition;
+  int64_t startTime, endTime; // CUSTOM.updateTime (in milliseconds) at the start of the first and following rows
+
+  static char const* kindName(int kind); // e.g., "airborne"
+  static int kindFromName(char const* name); // -1 if not recognized (or "timeRange")
+};
+
+// The extent (in the file) of a record, or of a sequence of records:
+class RecordExtent {
+public:
+  u_int64_t position, endPosition;
+};
+
+// Divides a flight into segments, as it's parsed (see "DJITxtParser::addFlightObserver()").  This is a
+// (streaming) state machine, driven by each row's OSD.isMotorUp, OSD.groundOrSky and OSD.flycState:
+// each kind of segment begins at the row where its condition becomes true, and ends at the row where it
+// becomes false (or at the end of the flight).  Segments of different kinds overlap (e.g., a "goHome" segment
+// lies within an "airborne" segment, which lies within a "motors" segment):
+class FlightSegmenter: public FlightObserver {
+public:
+  FlightSegmenter();
+  virtual ~FlightSegmenter();
+
+  // Also find the rows whose time (CUSTOM.updateTime, in milliseconds) is in [fromTime, toTime), as a
+  // "timeRange" segment (or, if the time leaves the range and then returns, several).  Call before parsing:
+  void setTimeRange(int64_t fromTime, int64_t toTime);
+
+  // The (completed) segments, in order of their start (then kind):
+  std::vector<FlightSegment> const& segments() const { return fSegments; }
+  unsigned numRows() const { return fNumRows; }
+  u_int64_t firstRowPosition() const { return fFirstRowPosition; } // of the first 'OSD' record; 0 if none
+  std::vector<RecordExtent> const& descriptionRecords() const { return fDescriptionRecords; }
+      // the 'RECOVER' and 'FIRMWARE' records, which describe the aircraft (rather than its flight), and
+      // usually appear only once, near the start of the log
+
+  // Writes the segments (as CSV) to a file.  Returns 1 iff it succeeds:
+  int writeIndex(char const* fileName) const;
+
+private: // redefined virtual functions:
+  virtual int startFlight(FieldDatabase* fieldDatabase, OutputColumn const* columns, unsigned numColumns);
+  virtual void noteRecord(u_int8_t recordType, u_int64_t position, u_int64_t endPosition);
+  virtual void noteRow(int isColumnLabels);
+  virtual void endFlight();
+
+private:
+  void beginSegment(int kind, char const* label, u_int64_t position, int64_t time);
+  void endSegment(int kind, u_int32_t endRow, u_int64_t position, int64_t time);
+
+private:
+  FieldDatabase* fFieldDatabase;
+  std::vector<FlightSegment> fSegments;
+  std::vector<RecordExtent> fDescriptionRecords;
+  FlightSegment fOpenSegments[NUM_SEGMENT_KINDS];
+  int fSegmentIsOpen[NUM_SEGMENT_KINDS];
+  int fMode; // the current flycState, or -1 if none yet
+  int fHasTimeRange;
+  int64_t fFromTime, fToTime;
+  unsigned fNumRows;
+  u_int64_t fFirstRowPosition;
+  u_int64_t fRowPosition; // of the 'OSD' record that began the current row
+  u_int64_t fEndPosition; // of the last record so far
+  int64_t fLastTime;
+  int fIsEnded;
+};
+
+#endif
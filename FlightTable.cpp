@@ -0,0 +1,286 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A columnar (in-memory) table of the rows parsed from a DJI ".txt" file.
+    Implementation.
+*/
+
+#include "FlightTable.hh"
+#include <string.h>
+#include <sys/mman.h>
+
+////////// FlightColumn implementation //////////
+
+FlightColumn::FlightColumn(OutputColumn const& outputColumn, InterpretationTable* interpretationTable)
+  : nextWithSameLabel(NULL), fOutputColumn(outputColumn), fInterpretationTable(interpretationTable),
+    fType(FlightColumnNull), fLength(0), fNullCount(0), fIsMapped(0),
+    fHasCurrentValue(0), fCurrentInt64(0), fCurrentDouble(0.0) {
+  fStringOffsets.push_back(0);
+  fDictionaryOffsets.push_back(0);
+}
+
+FlightColumn::FlightColumn(OutputColumn const& outputColumn, FlightColumnType type,
+			   unsigned length, unsigned nullCount, FlightColumnBuffers const& buffers)
+  : nextWithSameLabel(NULL), fOutputColumn(outputColumn), fInterpretationTable(NULL),
+    fType(type), fLength(length), fNullCount(nullCount),
+    fIsMapped(1), fMapped(buffers), fHasCurrentValue(0), fCurrentInt64(0), fCurrentDouble(0.0) {
+}
+
+FlightColumn::~FlightColumn() {
+}
+
+void FlightColumn::setValue(FieldSnapshot const& field, OutputBuffer& scratch) {
+  if (fType == FlightColumnNull && field.isPresent) chooseType(field);
+
+  fHasCurrentValue = field.isPresent && fType != FlightColumnNull && convertValue(field, scratch);
+}
+
+void FlightColumn::appendCurrentValue() {
+  if ((fLength&7) == 0) fValidity.push_back(0);
+  if (fHasCurrentValue) {
+    fValidity[fLength>>3] |= 1<<(fLength&7);
+    switch (fType) {
+      case FlightColumnInt64:
+      case FlightColumnTimestamp: { fInt64s.push_back(fCurrentInt64); break; }
+      case FlightColumnDouble: { fDoubles.push_back(fCurrentDouble); break; }
+      case FlightColumnBoolean: { fBooleans.push_back((u_int8_t)fCurrentInt64); break; }
+      case FlightColumnString: {
+	fStringData.insert(fStringData.end(), fCurrentString.begin(), fCurrentString.end());
+	fStringOffsets.push_back(fStringData.size());
+	break;
+      }
+      case FlightColumnDictionary: { fDictionaryIndices.push_back((int32_t)fCurrentInt64); break; }
+      default: { break; }
+    }
+  } else {
+    appendNull();
+    ++fNullCount;
+  }
+  ++fLength;
+}
+
+void FlightColumn::chooseType(FieldSnapshot const& field) {
+  switch (fOutputColumn.kind) {
+    case ColumnBoolean: {
+      fType = FlightColumnBoolean;
+      break;
+    }
+    case ColumnInterpreted: {
+      fType = FlightColumnDictionary;
+      break;
+    }
+    case ColumnPlain: {
+      switch (field.fType) {
+	case IntegerByteUnsigned:
+	case IntegerByteSigned:
+	case Integer2ByteUnsigned:
+	case Integer2ByteSigned:
+	case Integer4ByteUnsigned:
+	case Integer4ByteSigned: {
+	  fType = FlightColumnInt64;
+	  break;
+	}
+	case Float:
+	case Double: {
+	  fType = FlightColumnDouble;
+	  break;
+	}
+	case Timestamp8ByteInSeconds:
+	case Timestamp8ByteInMilliseconds: {
+	  fType = FlightColumnTimestamp;
+	  break;
+	}
+	default: { // "Date2Byte", "Version4Byte", "String": we store these as (formatted) strings
+	  fType = FlightColumnString;
+	  break;
+	}
+      }
+      break;
+    }
+  }
+
+  // Fill in placeholder values for the (null) rows that preceded this one:
+  for (unsigned i = 0; i < fLength; ++i) appendNull();
+}
+
+void FlightColumn::appendNull() {
+  switch (fType) {
+    case FlightColumnInt64:
+    case FlightColumnTimestamp: { fInt64s.push_back(0); break; }
+    case FlightColumnDouble: { fDoubles.push_back(0.0); break; }
+    case FlightColumnBoolean: { fBooleans.push_back(0); break; }
+    case FlightColumnString: { fStringOffsets.push_back(fStringData.size()); break; }
+    case FlightColumnDictionary: { fDictionaryIndices.push_back(0); break; }
+    default: { break; }
+  }
+}
+
+int FlightColumn::convertValue(FieldSnapshot const& field, OutputBuffer& scratch) {
+  switch (fType) {
+    case FlightColumnInt64:
+    case FlightColumnDouble: {
+      double value;
+      if (!FieldDatabase::numericValue(field, value)) return 0;
+      if (fType == FlightColumnInt64) fCurrentInt64 = (int64_t)value; else fCurrentDouble = value;
+      return 1;
+    }
+    case FlightColumnTimestamp: {
+      if (field.fType == Timestamp8ByteInMilliseconds) {
+	fCurrentInt64 = field.fBytes8;
+      } else if (field.fType == Timestamp8ByteInSeconds) {
+	fCurrentInt64 = field.fBytes8*1000;
+      } else {
+	return 0;
+      }
+      return 1;
+    }
+    case FlightColumnBoolean:
+    case FlightColumnDictionary: {
+      // These are formatted from integer values only (as in the CSV output):
+      u_int32_t intValue;
+      switch (field.fType) {
+	case IntegerByteUnsigned: case IntegerByteSigned: { intValue = field.fByte; break; }
+	case Integer2ByteUnsigned: case Integer2ByteSigned: { intValue = field.fBytes2; break; }
+	case Integer4ByteUnsigned: case Integer4ByteSigned: { intValue = field.fBytes4; break; }
+	default: { return 0; }
+      }
+
+      if (fType == FlightColumnBoolean) {
+	fCurrentInt64 = intValue != 0;
+	return 1;
+      }
+
+      // Interpreted values must be unsigned:
+      if (field.fType != IntegerByteUnsigned && field.fType != Integer2ByteUnsigned
+	  && field.fType != Integer4ByteUnsigned) return 0;
+      if (fInterpretationTable == NULL) return 0;
+
+      std::unordered_map<u_int32_t, int32_t>::iterator itr = fDictionaryLookup.find(intValue);
+      int32_t index;
+      if (itr != fDictionaryLookup.end()) {
+	index = itr->second;
+      } else {
+	// This is a new value.  Several values may have the same interpretation (e.g., the default),
+	// so add its interpretation to the (small) dictionary only if it's not already there:
+	char const* str = fInterpretationTable->lookup(intValue);
+	unsigned strLength = strlen(str);
+	unsigned dictionarySize = fDictionaryOffsets.size() - 1;
+	for (index = 0; index < (int32_t)dictionarySize; ++index) {
+	  u_int32_t offset = fDictionaryOffsets[index];
+	  if (fDictionaryOffsets[index+1] - offset == strLength
+	      && (strLength == 0 || memcmp(&fDictionaryData[offset], str, strLength) == 0)) break;
+	}
+	if (index == (int32_t)dictionarySize) {
+	  fDictionaryData.insert(fDictionaryData.end(), str, str + strLength);
+	  fDictionaryOffsets.push_back(fDictionaryData.size());
+	}
+	fDictionaryLookup[intValue] = index;
+      }
+      fCurrentInt64 = index;
+      return 1;
+    }
+    case FlightColumnString: {
+      // Format the value the same way as for CSV output:
+      scratch.reset();
+      FieldDatabase::formatField(scratch, field, fOutputColumn.numFractionalDigits);
+      fCurrentString.assign(scratch.data(), scratch.size());
+      return 1;
+    }
+    default: {
+      return 0;
+    }
+  }
+}
+
+
+////////// FlightTable implementation //////////
+
+FlightTable* FlightTable::createNew(OutputColumn const* columns, unsigned numColumns, FieldDatabase* fieldDatabase) {
+  return new FlightTable(columns, numColumns, fieldDatabase);
+}
+
+FlightTable::FlightTable(OutputColumn const* columns, unsigned numColumns, FieldDatabase* fieldDatabase)
+  : fOutputColumns(columns), fNumColumns(numColumns), fFieldDatabase(fieldDatabase),
+    fColumns(new FlightColumn*[numColumns]), fNumRows(0), fScratch(-1, 256),
+    fMappedFile(NULL), fMappedFileSize(0) {
+  StringArena strings;
+  FieldSnapshot field;
+  for (unsigned i = 0; i < numColumns; ++i) {
+    InterpretationTable* interpretationTable = columns[i].kind == ColumnInterpreted
+      ? fieldDatabase->lookupInterpretationTable(columns[i].interpretedLabel)
+      : NULL;
+    FlightColumn* column = fColumns[i] = new FlightColumn(columns[i], interpretationTable);
+
+    // Chain together the columns of each field:
+    FlightColumn*& first = fColumnsByLabel[columns[i].label]; // alias
+    column->nextWithSameLabel = first;
+    first = column;
+
+    // Start with the field's existing value (if any); after this, we're told when it changes:
+    fieldDatabase->snapshotField(columns[i].label, field, strings);
+    if (field.isPresent) column->setValue(field, fScratch);
+  }
+  fieldDatabase->setObserver(this);
+}
+
+FlightTable::FlightTable(unsigned numColumns, unsigned numRows, void* mappedFile, u_int64_t mappedFileSize)
+  : fOutputColumns(NULL), fNumColumns(numColumns), fFieldDatabase(NULL),
+    fColumns(new FlightColumn*[numColumns]), fNumRows(numRows), fScratch(-1, 16),
+    fMappedFile(mappedFile), fMappedFileSize(mappedFileSize) {
+  for (unsigned i = 0; i < numColumns; ++i) fColumns[i] = NULL;
+}
+
+FlightTable::~FlightTable() {
+  stopObserving();
+  for (unsigned i = 0; i < fNumColumns; ++i) delete fColumns[i];
+  delete[] fColumns;
+
+  if (fMappedFile != NULL) munmap(fMappedFile, fMappedFileSize);
+}
+
+FlightColumn const* FlightTable::lookupColumn(char const* name) const {
+  for (unsigned i = 0; i < fNumColumns; ++i) {
+    if (strcmp(fColumns[i]->name(), name) == 0) return fColumns[i];
+  }
+
+  return NULL;
+}
+
+void FlightTable::appendRow() {
+  if (fMappedFile != NULL) return; // our data is read-only
+  for (unsigned i = 0; i < fNumColumns; ++i) fColumns[i]->appendCurrentValue();
+
+  ++fNumRows;
+}
+
+void FlightTable::stopObserving() {
+  if (fFieldDatabase != NULL) fFieldDatabase->setObserver(NULL);
+  fFieldDatabase = NULL;
+}
+
+void FlightTable::fieldChanged(char const* label, FieldSnapshot const& value) {
+  std::unordered_map<char const*, FlightColumn*>::iterator itr = fColumnsByLabel.find(label);
+  if (itr == fColumnsByLabel.end()) return; // the field isn't output
+
+  for (FlightColumn* column = itr->second; column != NULL; column = column->nextWithSameLabel) {
+    column->setValue(value, fScratch);
+  }
+}
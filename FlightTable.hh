@@ -0,0 +1,181 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A columnar (in-memory) table of the rows parsed from a DJI ".txt" file.
+    Header File.
+*/
+
+#ifndef _FLIGHT_TABLE_HH
+#define _FLIGHT_TABLE_HH
+
+#ifndef _ROW_WRITER_HH
+#include "RowWriter.hh"
+#endif
+
+#include <vector>
+#include <string>
+
+// How each column's values are stored:
+enum FlightColumnType {
+  FlightColumnNull, // no value has been seen (yet) for this column
+  FlightColumnInt64, // "int64Values()"
+  FlightColumnDouble, // "doubleValues()"
+  FlightColumnBoolean, // "booleanValues()" (one byte per value)
+  FlightColumnTimestamp, // "int64Values()", in milliseconds since the Unix epoch
+  FlightColumnString, // "stringOffsets()" and "stringData()"
+  FlightColumnDictionary // "dictionaryIndices()" into a set of strings ("dictionaryOffsets()", "dictionaryData()")
+};
+
+// The (read-only) data of a column that's stored elsewhere (e.g., in a memory-mapped "FlightCache" file):
+class FlightColumnBuffers {
+public:
+  u_int8_t const* validity;
+  void const* values; // int64, double, boolean (one byte per value), or dictionary index values
+  u_int32_t const* offsets; // string offsets, or dictionary offsets
+  char const* data; // string data, or dictionary data
+  unsigned dictionarySize;
+};
+
+class FlightColumn {
+public:
+  FlightColumn(OutputColumn const& outputColumn, InterpretationTable* interpretationTable);
+  FlightColumn(OutputColumn const& outputColumn, FlightColumnType type,
+	       unsigned length, unsigned nullCount, FlightColumnBuffers const& buffers);
+      // a column whose data is stored elsewhere; it can't be appended to
+  virtual ~FlightColumn();
+
+  char const* name() const { return fOutputColumn.columnName(); }
+  FlightColumnType type() const { return fType; }
+  unsigned numFractionalDigits() const { return fOutputColumn.numFractionalDigits; }
+  unsigned length() const { return fLength; }
+  unsigned nullCount() const { return fNullCount; }
+
+  // Bit "i" (least-significant bit first, within each byte) is set iff row "i" has a value:
+  u_int8_t const* validityBitmap() const { return fIsMapped ? fMapped.validity : &fValidity[0]; }
+  int isValid(unsigned row) const { return (validityBitmap()[row>>3]>>(row&7))&1; }
+
+  int64_t const* int64Values() const {
+    return fIsMapped ? (int64_t const*)fMapped.values : &fInt64s[0];
+  }
+  double const* doubleValues() const {
+    return fIsMapped ? (double const*)fMapped.values : &fDoubles[0];
+  }
+  u_int8_t const* booleanValues() const {
+    return fIsMapped ? (u_int8_t const*)fMapped.values : &fBooleans[0];
+  }
+  u_int32_t const* stringOffsets() const { // "length()"+1 offsets
+    return fIsMapped ? fMapped.offsets : &fStringOffsets[0];
+  }
+  char const* stringData() const {
+    return fIsMapped ? fMapped.data : fStringData.empty() ? "" : &fStringData[0];
+  }
+  int32_t const* dictionaryIndices() const {
+    return fIsMapped ? (int32_t const*)fMapped.values : &fDictionaryIndices[0];
+  }
+  unsigned dictionarySize() const { return fIsMapped ? fMapped.dictionarySize : fDictionaryOffsets.size() - 1; }
+  u_int32_t const* dictionaryOffsets() const { return fIsMapped ? fMapped.offsets : &fDictionaryOffsets[0]; }
+  char const* dictionaryData() const {
+    return fIsMapped ? fMapped.data : fDictionaryData.empty() ? "" : &fDictionaryData[0];
+  }
+
+  // Sets the column's current value (converted to the column's type; "scratch" is used to format strings),
+  // which is then appended to the column for each row, until the value changes again:
+  void setValue(FieldSnapshot const& field, OutputBuffer& scratch);
+  void appendCurrentValue();
+
+  FlightColumn* nextWithSameLabel; // another column (if any) of the same field, e.g., interpreted
+
+private:
+  void chooseType(FieldSnapshot const& field); // called when we see the column's first value
+  void appendNull();
+  int convertValue(FieldSnapshot const& field, OutputBuffer& scratch); // returns 0 if it couldn't be converted
+
+private:
+  OutputColumn fOutputColumn;
+  InterpretationTable* fInterpretationTable; // used only while the column is being filled in
+  FlightColumnType fType;
+  unsigned fLength, fNullCount;
+  int fIsMapped;
+  FlightColumnBuffers fMapped; // used only if "fIsMapped"
+
+  // The current value (set by "setValue()"), in the form in which it's appended:
+  int fHasCurrentValue;
+  int64_t fCurrentInt64; // also a boolean, or a dictionary index
+  double fCurrentDouble;
+  std::string fCurrentString;
+
+  std::vector<u_int8_t> fValidity;
+  std::vector<int64_t> fInt64s;
+  std::vector<double> fDoubles;
+  std::vector<u_int8_t> fBooleans;
+  std::vector<u_int32_t> fStringOffsets;
+  std::vector<char> fStringData;
+  std::vector<int32_t> fDictionaryIndices;
+  std::vector<u_int32_t> fDictionaryOffsets;
+  std::vector<char> fDictionaryData;
+  std::unordered_map<u_int32_t, int32_t> fDictionaryLookup; // raw field value => dictionary index
+};
+
+// A table of a flight's rows, with one (typed) column for each output column.  While it's being filled in, the
+// table observes the "FieldDatabase" - so each value is converted (or formatted) only when it changes, as it's
+// entered by a record parser - and each new row appends each column's current value.  The columns grow
+// (geometrically) as needed, so the number of rows doesn't need to be known in advance:
+class FlightTable: public FieldObserver {
+public:
+  static FlightTable* createNew(OutputColumn const* columns, unsigned numColumns, FieldDatabase* fieldDatabase);
+      // The table observes "fieldDatabase" until "stopObserving()" is called (or it's deleted).
+
+  virtual ~FlightTable();
+
+  unsigned numRows() const { return fNumRows; }
+  unsigned numColumns() const { return fNumColumns; }
+  FlightColumn const* column(unsigned i) const { return fColumns[i]; }
+  FlightColumn const* lookupColumn(char const* name) const; // returns NULL if not found
+
+  // Appends a row containing the current value of each field.
+  // (Not allowed for a table that was opened from a "FlightCache" file.)
+  void appendRow();
+
+  void stopObserving(); // called when the table is complete
+
+private: // redefined virtual functions:
+  virtual void fieldChanged(char const* label, FieldSnapshot const& value);
+
+private:
+  friend class FlightCache;
+  FlightTable(OutputColumn const* columns, unsigned numColumns,
+	      FieldDatabase* fieldDatabase); // called only by "createNew()"
+  FlightTable(unsigned numColumns, unsigned numRows, void* mappedFile, u_int64_t mappedFileSize);
+      // called only by "FlightCache", which then creates each of our columns
+
+private:
+  OutputColumn const* fOutputColumns;
+  unsigned fNumColumns;
+  FieldDatabase* fFieldDatabase; // used only while the table is being filled in
+  FlightColumn** fColumns;
+  std::unordered_map<char const*, FlightColumn*> fColumnsByLabel; // the first column (if any) of each field
+  unsigned fNumRows;
+  OutputBuffer fScratch; // (in memory) used to format string values
+  void* fMappedFile; // if non-NULL, our columns' data; unmapped when we're deleted
+  u_int64_t fMappedFileSize;
+};
+
+#endif
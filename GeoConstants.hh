@@ -0,0 +1,35 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    The Earth's (mean) radius, and conversions between degrees and distances on its surface.
+    Header File.
+*/
+
+#ifndef _GEO_CONSTANTS_HH
+#define _GEO_CONSTANTS_HH
+
+#include <math.h>
+
+#define EARTH_RADIUS 6371008.8 // meters (mean)
+#define METERS_PER_DEGREE (EARTH_RADIUS*M_PI/180.0) // of latitude (or of longitude, at the equator)
+#define RADIANS_PER_DEGREE (M_PI/180.0)
+
+#endif
@@ -0,0 +1,292 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Geofences: polygonal zones (with a grid index), and the detection of a flight's entries into and exits from them.
+    Implementation.
+*/
+
+#include "Geofence.hh"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+
+#define NUM_GRID_ROWS ((int)(180.0/GEOFENCE_GRID_CELL_SIZE + 0.5))
+#define NUM_GRID_COLUMNS ((int)(360.0/GEOFENCE_GRID_CELL_SIZE + 0.5))
+
+static int gridRow(double latitude) {
+  int row = (int)floor((latitude + 90.0)/GEOFENCE_GRID_CELL_SIZE);
+  return row < 0 ? 0 : row >= NUM_GRID_ROWS ? NUM_GRID_ROWS-1 : row;
+}
+
+static int gridColumn(double longitude) { // (the longitude may be 'unwrapped' - i.e., beyond +/-180)
+  int column = (int)floor((longitude + 180.0)/GEOFENCE_GRID_CELL_SIZE)%NUM_GRID_COLUMNS;
+  return column < 0 ? column + NUM_GRID_COLUMNS : column;
+}
+
+////////// GeofenceZones implementation //////////
+
+GeofenceZones* GeofenceZones::createNew(char const* fileName) {
+  FILE* fid = fopen(fileName, "r");
+  if (fid == NULL) {
+    fprintf(stderr, "Failed to open geofence file \"%s\": %s\n", fileName, strerror(errno));
+    return NULL;
+  }
+
+  GeofenceZones* zones = new GeofenceZones;
+  char* line = NULL;
+  size_t lineSize = 0;
+  unsigned lineNumber = 0;
+  int isOK = 1;
+  while (isOK && getline(&line, &lineSize, fid) >= 0) {
+    ++lineNumber;
+    char* savePtr;
+    char const* name = strtok_r(line, " \t\r\n", &savePtr);
+    if (name == NULL || name[0] == '#') continue; // a blank line, or a comment
+
+    std::vector<double> latitudes, longitudes;
+    char const* vertex;
+    while ((vertex = strtok_r(NULL, " \t\r\n", &savePtr)) != NULL) {
+      double latitude, longitude;
+      int numChars = 0;
+      if (sscanf(vertex, "%lf,%lf%n", &latitude, &longitude, &numChars) != 2 || vertex[numChars] != '\0'
+	  || !(fabs(latitude) <= 90.0 && fabs(longitude) <= 180.0)) {
+	fprintf(stderr, "Geofence file \"%s\", line %u: bad vertex \"%s\" (expected \"<latitude>,<longitude>\")\n",
+		fileName, lineNumber, vertex);
+	isOK = 0;
+	break;
+      }
+      latitudes.push_back(latitude);
+      longitudes.push_back(longitude);
+    }
+    if (isOK && !zones->addZone(name, latitudes, longitudes)) {
+      fprintf(stderr, "Geofence file \"%s\", line %u: zone \"%s\" needs at least 3 vertices\n",
+	      fileName, lineNumber, name);
+      isOK = 0;
+    }
+  }
+  free(line);
+  fclose(fid);
+
+  if (isOK && zones->numZones() == 0) {
+    fprintf(stderr, "Geofence file \"%s\" has no zones\n", fileName);
+    isOK = 0;
+  }
+  if (!isOK) {
+    delete zones;
+    return NULL;
+  }
+
+  return zones;
+}
+
+GeofenceZones::GeofenceZones() {
+}
+
+GeofenceZones::~GeofenceZones() {
+}
+
+int GeofenceZones::addZone(char const* name, std::vector<double> const& latitudes,
+			   std::vector<double> const& longitudes) {
+  fZones.push_back(Zone());
+  Zone& zone = fZones.back(); // alias
+  zone.name = name;
+  zone.latitudes = latitudes;
+  zone.longitudes = longitudes;
+
+  // If the polygon is 'closed' (its last vertex repeats its first), drop the last vertex:
+  unsigned numVertices = latitudes.size();
+  if (numVertices > 1 && latitudes[0] == latitudes[numVertices-1] && longitudes[0] == longitudes[numVertices-1]) {
+    zone.latitudes.pop_back();
+    zone.longitudes.pop_back();
+    --numVertices;
+  }
+  if (numVertices < 3) {
+    fZones.pop_back();
+    return 0;
+  }
+
+  // 'Unwrap' the longitudes, so that no edge is more than 180 degrees long (i.e., an edge that crosses
+  // the 180th meridian goes beyond it, rather than around the world):
+  for (unsigned i = 1; i < numVertices; ++i) {
+    while (zone.longitudes[i] - zone.longitudes[i-1] > 180.0) zone.longitudes[i] -= 360.0;
+    while (zone.longitudes[i] - zone.longitudes[i-1] < -180.0) zone.longitudes[i] += 360.0;
+  }
+
+  zone.minLatitude = zone.maxLatitude = zone.latitudes[0];
+  zone.minLongitude = zone.maxLongitude = zone.longitudes[0];
+  for (unsigned i = 1; i < numVertices; ++i) {
+    if (zone.latitudes[i] < zone.minLatitude) zone.minLatitude = zone.latitudes[i];
+    if (zone.latitudes[i] > zone.maxLatitude) zone.maxLatitude = zone.latitudes[i];
+    if (zone.longitudes[i] < zone.minLongitude) zone.minLongitude = zone.longitudes[i];
+    if (zone.longitudes[i] > zone.maxLongitude) zone.maxLongitude = zone.longitudes[i];
+  }
+
+  // Add the zone to each grid cell that its bounding box overlaps:
+  unsigned const zoneIndex = fZones.size() - 1;
+  int const lastRow = gridRow(zone.maxLatitude);
+  int const firstColumn = (int)floor((zone.minLongitude + 180.0)/GEOFENCE_GRID_CELL_SIZE);
+  int lastColumn = (int)floor((zone.maxLongitude + 180.0)/GEOFENCE_GRID_CELL_SIZE);
+  if (lastColumn - firstColumn >= NUM_GRID_COLUMNS) lastColumn = firstColumn + NUM_GRID_COLUMNS - 1;
+  for (int row = gridRow(zone.minLatitude); row <= lastRow; ++row) {
+    for (int column = firstColumn; column <= lastColumn; ++column) {
+      int wrappedColumn = column%NUM_GRID_COLUMNS;
+      if (wrappedColumn < 0) wrappedColumn += NUM_GRID_COLUMNS;
+      fGrid[row*NUM_GRID_COLUMNS + wrappedColumn].push_back(zoneIndex);
+    }
+  }
+
+  return 1;
+}
+
+std::vector<unsigned> const* GeofenceZones::candidates(double latitude, double longitude) const {
+  std::unordered_map<u_int32_t, std::vector<unsigned> >::const_iterator itr
+    = fGrid.find(gridRow(latitude)*NUM_GRID_COLUMNS + gridColumn(longitude));
+  return itr == fGrid.end() ? NULL : &itr->second;
+}
+
+int GeofenceZones::contains(unsigned zoneIndex, double latitude, double longitude) const {
+  Zone const& zone = fZones[zoneIndex]; // alias
+  if (latitude < zone.minLatitude || latitude > zone.maxLatitude) return 0;
+
+  // Use the longitude - possibly 'unwrapped' (by 360 degrees) - that lies within the zone's bounding box:
+  if (longitude < zone.minLongitude) longitude += 360.0;
+  else if (longitude > zone.maxLongitude) longitude -= 360.0;
+  if (longitude < zone.minLongitude || longitude > zone.maxLongitude) return 0;
+
+  // Count the edges that a line from the position (westwards) crosses; it's inside iff this is odd:
+  int isInside = 0;
+  unsigned const numVertices = zone.latitudes.size();
+  for (unsigned i = 0, j = numVertices-1; i < numVertices; j = i++) {
+    double const latitudeI = zone.latitudes[i];
+    double const latitudeJ = zone.latitudes[j];
+    if ((latitudeI > latitude) != (latitudeJ > latitude)) {
+      double const crossingLongitude = zone.longitudes[i]
+	+ (latitude - latitudeI)*(zone.longitudes[j] - zone.longitudes[i])/(latitudeJ - latitudeI);
+      if (crossingLongitude < longitude) isInside = !isInside;
+    }
+  }
+
+  return isInside;
+}
+
+////////// GeofenceMonitor implementation //////////
+
+GeofenceMonitor::GeofenceMonitor(GeofenceZones const& zones, OutputBuffer& out)
+  : fZones(zones), fOut(out), fFieldDatabase(NULL), fVisits(zones.numZones()), fNumPositions(0) {
+}
+
+GeofenceMonitor::~GeofenceMonitor() {
+}
+
+void GeofenceMonitor::outputHeader(OutputBuffer& out) {
+  out.append("file,zone,entryTime,exitTime,duration,maxHeight\n");
+}
+
+void GeofenceMonitor::setFlightName(char const* flightName) {
+  fFlightName = flightName;
+}
+
+int GeofenceMonitor::startFlight(FieldDatabase* fieldDatabase, OutputColumn const* /*columns*/,
+				 unsigned /*numColumns*/) {
+  fFieldDatabase = fieldDatabase;
+  for (unsigned i = 0; i < fVisits.size(); ++i) fVisits[i].isInside = 0;
+  fZonesInside.clear();
+  fNumPositions = 0;
+  return 1;
+}
+
+void GeofenceMonitor::noteRow(int isColumnLabels) {
+  // (We look at each row once it's complete, so that its position and time - from the 'CUSTOM' record that
+  // follows its 'OSD' record - go together.):
+  if (isColumnLabels) return;
+
+  double latitude, longitude, height, time;
+  if (!fFieldDatabase->getFieldAsDouble("OSD.latitude", latitude)
+      || !fFieldDatabase->getFieldAsDouble("OSD.longitude", longitude)) return;
+  // Ignore positions that are obviously bad, or are (0,0) - i.e., from before there was a GPS fix:
+  if (!(fabs(latitude) <= 90.0 && fabs(longitude) <= 180.0)) return; // (also rejects NaN)
+  if (latitude == 0.0 && longitude == 0.0) return;
+  if (!fFieldDatabase->getFieldAsDouble("OSD.height", height)) height = 0.0;
+  if (!fFieldDatabase->getFieldAsDouble("CUSTOM.updateTime", time) || time < 0.0) time = 0.0; // not known (yet)
+
+  notePosition(latitude, longitude, height, (int64_t)time);
+}
+
+void GeofenceMonitor::endFlight() {
+  for (unsigned i = 0; i < fZonesInside.size(); ++i) outputVisit(fZonesInside[i], -1/*no exit*/);
+  fZonesInside.clear();
+}
+
+void GeofenceMonitor::notePosition(double latitude, double longitude, double height, int64_t time) {
+  ++fNumPositions;
+
+  // Note the zones that contain the position (entering those that we weren't already in):
+  std::vector<unsigned> const* candidates = fZones.candidates(latitude, longitude);
+  for (unsigned i = 0; candidates != NULL && i < candidates->size(); ++i) {
+    unsigned const zone = (*candidates)[i];
+    if (!fZones.contains(zone, latitude, longitude)) continue;
+
+    Visit& visit = fVisits[zone]; // alias
+    if (!visit.isInside) {
+      visit.isInside = 1;
+      visit.entryTime = time;
+      visit.maxHeight = height;
+      fZonesInside.push_back(zone);
+    }
+    if (visit.entryTime == 0) visit.entryTime = time; // the first known time (if it wasn't known on entry)
+    visit.lastSeen = fNumPositions;
+    visit.lastTime = time;
+    if (height > visit.maxHeight) visit.maxHeight = height;
+  }
+
+  // Then, exit the zones that no longer contain it:
+  for (unsigned i = 0; i < fZonesInside.size(); ) {
+    unsigned const zone = fZonesInside[i];
+    if (fVisits[zone].lastSeen == fNumPositions) {
+      ++i;
+    } else {
+      outputVisit(zone, time);
+      fZonesInside.erase(fZonesInside.begin() + i); // (this list is short, so this is cheap)
+    }
+  }
+}
+
+void GeofenceMonitor::outputVisit(unsigned zone, int64_t exitTime) {
+  Visit& visit = fVisits[zone]; // alias
+  visit.isInside = 0;
+
+  fOut.appendCSVString(fFlightName.c_str());
+  fOut.appendChar(',');
+  fOut.appendCSVString(fZones.zoneName(zone));
+  fOut.appendChar(',');
+  fOut.appendTime(visit.entryTime);
+  fOut.appendChar(',');
+  if (exitTime >= 0) fOut.appendTime(exitTime);
+  fOut.appendChar(',');
+  int64_t const endTime = exitTime >= 0 ? exitTime : visit.lastTime;
+  if (visit.entryTime > 0 && endTime >= visit.entryTime) fOut.appendFixed((endTime - visit.entryTime)/1000.0, 1);
+  fOut.appendChar(',');
+  fOut.appendFixed(visit.maxHeight, 1);
+  fOut.appendChar('\n');
+}
@@ -0,0 +1,124 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Geofences: polygonal zones (with a grid index), and the detection of a flight's entries into and exits from them.
+    Header File.
+*/
+
+#ifndef _GEOFENCE_HH
+#define _GEOFENCE_HH
+
+#ifndef _FLIGHT_OBSERVER_HH
+#include "FlightObserver.hh"
+#endif
+
+#ifndef _OUTPUT_BUFFER_HH
+#include "OutputBuffer.hh"
+#endif
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define GEOFENCE_GRID_CELL_SIZE 0.1 // degrees
+
+// A set of polygonal zones (e.g., sites, no-fly zones, or customer boundaries), read from a text file with
+// one zone per line: its name (with no spaces), then its vertices, each as "<latitude>,<longitude>" (in
+// degrees), separated by spaces.  (Blank lines, and lines beginning with '#', are ignored.)  For example:
+//	lake-geneva-site 46.51,6.62 46.52,6.62 46.52,6.64 46.51,6.64
+// The edges are straight lines in latitude and longitude (which is accurate enough for zones of up to
+// several kilometers); a zone may cross the 180th meridian.
+//
+// The zones are indexed by a grid (of GEOFENCE_GRID_CELL_SIZE degrees): each cell lists the zones whose
+// bounding boxes overlap it, so each position is tested against only the few zones near it:
+class GeofenceZones {
+public:
+  static GeofenceZones* createNew(char const* fileName);
+      // Returns NULL (after reporting an error) if the file can't be read, or is bad
+
+  virtual ~GeofenceZones();
+
+  unsigned numZones() const { return fZones.size(); }
+  char const* zoneName(unsigned zone) const { return fZones[zone].name.c_str(); }
+
+  // The zones (if any) that might contain a position (i.e., that are listed in its grid cell):
+  std::vector<unsigned> const* candidates(double latitude, double longitude) const;
+  int contains(unsigned zone, double latitude, double longitude) const;
+
+private:
+  GeofenceZones(); // called only by "createNew()"
+
+  int addZone(char const* name, std::vector<double> const& latitudes, std::vector<double> const& longitudes);
+
+  class Zone {
+  public:
+    std::string name;
+    std::vector<double> latitudes, longitudes; // the vertices (the longitudes 'unwrapped', if the zone crosses 180)
+    double minLatitude, maxLatitude, minLongitude, maxLongitude;
+  };
+
+private:
+  std::vector<Zone> fZones;
+  std::unordered_map<u_int32_t, std::vector<unsigned> > fGrid; // cell -> zones
+};
+
+// Follows the aircraft (its 'OSD' positions) through the zones, as a flight is parsed (see
+// "DJITxtParser::addFlightObserver()"), outputting (as CSV rows) each visit to a zone: its entry and exit
+// times (of the first positions inside and then outside it), its duration (in seconds), and the aircraft's
+// maximum height while inside it.  A visit that's still in progress at the end of the log is output (with no
+// exit time) at the end of the flight:
+class GeofenceMonitor: public FlightObserver {
+public:
+  GeofenceMonitor(GeofenceZones const& zones, OutputBuffer& out);
+  virtual ~GeofenceMonitor();
+
+  static void outputHeader(OutputBuffer& out);
+
+  void setFlightName(char const* flightName); // (for the first column of the output; e.g., the file name)
+
+private: // redefined virtual functions:
+  virtual int startFlight(FieldDatabase* fieldDatabase, OutputColumn const* columns, unsigned numColumns);
+  virtual void noteRow(int isColumnLabels);
+  virtual void endFlight();
+
+private:
+  void notePosition(double latitude, double longitude, double height, int64_t time);
+  void outputVisit(unsigned zone, int64_t exitTime);
+
+  class Visit {
+  public:
+    int isInside;
+    unsigned lastSeen; // the number of the last position that was inside the zone
+    int64_t entryTime, lastTime;
+    double maxHeight;
+  };
+
+private:
+  GeofenceZones const& fZones;
+  OutputBuffer& fOut;
+  std::string fFlightName;
+  FieldDatabase* fFieldDatabase;
+  std::vector<Visit> fVisits; // for each zone
+  std::vector<unsigned> fZonesInside; // the zones that the aircraft is in now
+  unsigned fNumPositions;
+};
+
+#endif
@@ -0,0 +1,149 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    An input stream that's decompressed (using "zlib") in a separate thread: gzip data, or a member of a zip archive.
+    Implementation.
+*/
+
+#include "InflateInputStream.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#define MAX_INFLATE_INPUT_SIZE (1<<30) // the most that we give "zlib" at once (because its sizes are 32-bit)
+
+InflateInputStream* InflateInputStream::createNew(InputStream* source) {
+  InflateInputStream* inputStream = new InflateInputStream(source, NULL, 0, 1, 0);
+  inputStream->startThread();
+
+  return inputStream;
+}
+
+InflateInputStream* InflateInputStream
+::createNew(u_int8_t const* data, u_int64_t size, int isDeflated, u_int32_t crc) {
+  InflateInputStream* inputStream = new InflateInputStream(NULL, data, size, isDeflated, crc);
+  inputStream->startThread();
+
+  return inputStream;
+}
+
+int InflateInputStream::isGzipData(u_int8_t const* data, unsigned size) {
+  return size >= 2 && data[0] == 0x1F && data[1] == 0x8B;
+}
+
+InflateInputStream::InflateInputStream(InputStream* source, u_int8_t const* data, u_int64_t size,
+				       int isDeflated, u_int32_t crc)
+  : InputStream(-1), fSource(source), fData(data), fDataSize(size), fIsDeflated(isDeflated), fCRC(crc),
+    fNumSourceBytesInUse(0) {
+}
+
+InflateInputStream::~InflateInputStream() {
+  stopThread(); // before we delete the source that it reads from
+  delete fSource;
+}
+
+int InflateInputStream::getInput(u_int8_t const*& data, unsigned& numBytes) {
+  if (fSource != NULL) {
+    // Release the data that we got last time (which has now all been used), then get more:
+    fSource->endRead(fNumSourceBytesInUse);
+    data = fSource->beginRead(numBytes);
+    fNumSourceBytesInUse = numBytes;
+  } else {
+    data = fData;
+    numBytes = fDataSize < MAX_INFLATE_INPUT_SIZE ? fDataSize : MAX_INFLATE_INPUT_SIZE;
+    fData += numBytes; fDataSize -= numBytes;
+  }
+
+  return numBytes > 0;
+}
+
+void InflateInputStream::producerThread() {
+  z_stream zs;
+  memset(&zs, 0, sizeof zs);
+  // Gzip data has a header (which "zlib" can detect); the data of a zip member is 'raw' deflate data:
+  if (fIsDeflated && inflateInit2(&zs, fSource != NULL ? 15+32 : -15) != Z_OK) {
+    fprintf(stderr, "Failed to initialize decompression\n");
+    fReadFailed = 1;
+    fBuffer.setEndOfData();
+    return;
+  }
+
+  int streamEnded = !fIsDeflated; // for copied data, any end is OK
+  int anyMemberEnded = 0; // for gzip data, which may consist of several concatenated 'members'
+  uLong crc = crc32(0L, Z_NULL, 0);
+  while (1) {
+    if (zs.avail_in == 0) {
+      u_int8_t const* data;
+      unsigned numBytes;
+      if (!getInput(data, numBytes)) break;
+      zs.next_in = (Bytef*)data;
+      zs.avail_in = numBytes;
+    }
+
+    unsigned maxNumBytes;
+    u_int8_t* to = fBuffer.beginWrite(maxNumBytes);
+    if (to == NULL) break; // the consumer has stopped reading
+
+    unsigned numBytesOut;
+    int result = Z_OK;
+    if (!fIsDeflated) {
+      numBytesOut = zs.avail_in < maxNumBytes ? zs.avail_in : maxNumBytes;
+      memcpy(to, zs.next_in, numBytesOut);
+      zs.next_in += numBytesOut; zs.avail_in -= numBytesOut;
+    } else {
+      zs.next_out = to;
+      zs.avail_out = maxNumBytes;
+      result = inflate(&zs, Z_NO_FLUSH);
+      numBytesOut = maxNumBytes - zs.avail_out;
+    }
+    if (fSource == NULL) crc = crc32(crc, to, numBytesOut);
+    fBuffer.endWrite(numBytesOut);
+
+    if (result == Z_STREAM_END) {
+      streamEnded = anyMemberEnded = 1;
+      if (fSource == NULL) break; // a zip member has only one stream
+      inflateReset(&zs); // another gzip member might follow
+    } else if (result == Z_OK) {
+      if (fIsDeflated) streamEnded = 0;
+    } else if (anyMemberEnded && streamEnded) {
+      break; // ignore any data (e.g., padding) after the last gzip member
+    } else {
+      fprintf(stderr, "Failed to decompress the input: %s\n", zs.msg != NULL ? zs.msg : "bad data");
+      fReadFailed = 1;
+      break;
+    }
+  }
+
+  if (!fReadFailed && !fBuffer.isStopped()) {
+    if (!streamEnded) {
+      fprintf(stderr, "The compressed input ended prematurely\n");
+      fReadFailed = 1;
+    } else if (fSource == NULL && crc != fCRC) {
+      fprintf(stderr, "The decompressed data has a bad CRC\n");
+      fReadFailed = 1;
+    }
+  }
+  if (fSource != NULL && fSource->readFailed()) fReadFailed = 1;
+
+  if (fIsDeflated) inflateEnd(&zs);
+  fBuffer.setEndOfData();
+}
@@ -0,0 +1,65 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    An input stream that's decompressed (using "zlib") in a separate thread: gzip data, or a member of a zip archive.
+    Header File.
+*/
+
+#ifndef _INFLATE_INPUT_STREAM_HH
+#define _INFLATE_INPUT_STREAM_HH
+
+#ifndef _INPUT_STREAM_HH
+#include "InputStream.hh"
+#endif
+
+class InflateInputStream: public InputStream {
+public:
+  static InflateInputStream* createNew(InputStream* source);
+      // Decompresses gzip (or zlib) data - possibly several concatenated gzip members - read from "source"
+      // (which we then own)
+  static InflateInputStream* createNew(u_int8_t const* data, u_int64_t size, int isDeflated, u_int32_t crc);
+      // Decompresses (if "isDeflated"; otherwise just copies) the data of a zip archive member,
+      // which is in memory, then checks its CRC
+
+  static int isGzipData(u_int8_t const* data, unsigned size);
+
+  virtual ~InflateInputStream();
+
+protected:
+  InflateInputStream(InputStream* source, u_int8_t const* data, u_int64_t size, int isDeflated, u_int32_t crc);
+      // called only by "createNew()"
+
+private: // redefined virtual functions:
+  virtual void producerThread();
+
+private:
+  int getInput(u_int8_t const*& data, unsigned& numBytes); // returns 0 at the end of the input
+
+private:
+  InputStream* fSource; // NULL if the data is in memory:
+  u_int8_t const* fData;
+  u_int64_t fDataSize;
+  int fIsDeflated;
+  u_int32_t fCRC; // used only for data in memory
+  unsigned fNumSourceBytesInUse; // from "fSource->beginRead()"
+};
+
+#endif
@@ -0,0 +1,83 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A sequential input stream (e.g., from a pipe), read into a fixed-size buffer by a separate thread.
+    Implementation.
+*/
+
+#include "InputStream.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+InputStream* InputStream::createNew(int fd) {
+  InputStream* inputStream = new InputStream(fd);
+  inputStream->startThread();
+
+  return inputStream;
+}
+
+InputStream::InputStream(int fd)
+  : fFD(fd), fBuffer(INPUT_STREAM_BUFFER_SIZE), fReadFailed(0) {
+}
+
+InputStream::~InputStream() {
+  stopThread();
+}
+
+void InputStream::startThread() {
+  fThread = std::thread(&InputStream::producerThread, this);
+}
+
+void InputStream::stopThread() {
+  if (fThread.joinable()) {
+    fBuffer.stop();
+    fThread.join();
+  }
+}
+
+void InputStream::producerThread() {
+  while (1) {
+    unsigned maxNumBytes;
+    u_int8_t* to = fBuffer.beginWrite(maxNumBytes);
+    if (to == NULL) break; // the consumer has stopped reading
+
+    int numBytesRead = readFromFD(to, maxNumBytes);
+    if (numBytesRead <= 0) break;
+    fBuffer.endWrite(numBytesRead);
+  }
+
+  fBuffer.setEndOfData();
+}
+
+int InputStream::readFromFD(u_int8_t* to, unsigned maxNumBytes) {
+  while (1) {
+    ssize_t numBytesRead = read(fFD, to, maxNumBytes);
+    if (numBytesRead >= 0) return (int)numBytesRead;
+    if (errno == EINTR) continue;
+
+    fprintf(stderr, "Failed to read input: %s\n", strerror(errno));
+    fReadFailed = 1;
+    return -1;
+  }
+}
@@ -0,0 +1,70 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A sequential input stream (e.g., from a pipe), read into a fixed-size buffer by a separate thread.
+    Header File.
+*/
+
+#ifndef _INPUT_STREAM_HH
+#define _INPUT_STREAM_HH
+
+#ifndef _BYTE_RING_BUFFER_HH
+#include "ByteRingBuffer.hh"
+#endif
+
+#include <thread>
+
+#define INPUT_STREAM_BUFFER_SIZE (1024*1024) // must be a power of 2
+
+class InputStream {
+public:
+  static InputStream* createNew(int fd);
+      // Begins reading "fd" (which is not closed afterwards), from its current position
+
+  virtual ~InputStream(); // stops reading (even if the data hasn't all been read)
+
+  // The data is read by the consumer in (contiguous) pieces, using these functions:
+  u_int8_t const* beginRead(unsigned& numBytes, unsigned minNumBytes = 1) {
+    return fBuffer.beginRead(numBytes, minNumBytes);
+  }
+      // waits for data; "numBytes" is 0 at the end of the stream
+  void endRead(unsigned numBytes) { fBuffer.endRead(numBytes); }
+
+  int readFailed() const { return fReadFailed; } // check at the end of the stream
+
+protected:
+  InputStream(int fd); // called only by "createNew()" (or a subclass's)
+  void startThread(); // called by "createNew()", once the object has been constructed
+  void stopThread(); // called by the destructor (or by a subclass's, before it destroys its own state)
+
+  virtual void producerThread(); // fills in "fBuffer", then calls "setEndOfData()" on it
+  int readFromFD(u_int8_t* to, unsigned maxNumBytes); // returns the number of bytes read (0 at EOF); <0 on error
+
+protected:
+  int fFD;
+  ByteRingBuffer fBuffer;
+  std::atomic<int> fReadFailed;
+
+private:
+  std::thread fThread;
+};
+
+#endif
@@ -39,7 +39,8 @@ void InterpretationTable::add(u_int32_t intValue, char const* strValue) {
 }
 
 char const* InterpretationTable::lookup(u_int32_t intValue) {
-  char const* mapLookupResult = fUMap[intValue];
-  if (mapLookupResult == NULL) return fDefaultResultString;
-  return mapLookupResult;
+  // Note: We use "find()" rather than "[]", because lookups may be done concurrently (from an output thread):
+  std::unordered_map<u_int32_t, char const*>::const_iterator itr = fUMap.find(intValue);
+  if (itr == fUMap.end() || itr->second == NULL) return fDefaultResultString;
+  return itr->second;
 }
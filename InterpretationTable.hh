@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define _INTERPRETATION_TABLE_HH
 
 #include <sys/types.h>
+#include <stdlib.h>
 #include <unordered_map>
 
 class InterpretationTable {
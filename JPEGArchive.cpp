@@ -0,0 +1,175 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    An append-only (uncompressed 'tar') archive, into which embedded JPEG images are written.
+    Implementation.
+*/
+
+#include "JPEGArchive.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define TAR_BLOCK_SIZE 512
+#define ARCHIVE_BUFFER_SIZE (1024*1024) // we write the archive in chunks of (at least) this size
+
+////////// JPEGGeoTag implementation //////////
+
+JPEGGeoTag::JPEGGeoTag()
+  : hasPosition(0), latitude(0.0), longitude(0.0), height(0.0), captureTime(0) {
+}
+
+////////// JPEGArchive implementation //////////
+
+JPEGArchive* JPEGArchive::createNew(char const* fileName) {
+  int fd = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open output JPEG archive \"%s\": %s\n", fileName, strerror(errno));
+    return NULL;
+  }
+  fprintf(stderr, "\tOutputting embedded JPEG images to the archive \"%s\"\n", fileName);
+
+  return new JPEGArchive(fd);
+}
+
+JPEGArchive::JPEGArchive(int fd)
+  : fFD(fd), fWriteFailed(0), fNumImages(0),
+    fBuffer(new u_int8_t[ARCHIVE_BUFFER_SIZE]), fBufferFill(0) {
+}
+
+JPEGArchive::~JPEGArchive() {
+  // A 'tar' archive ends with two all-zero blocks:
+  u_int8_t trailer[2*TAR_BLOCK_SIZE];
+  memset(trailer, 0, sizeof trailer);
+  write(trailer, sizeof trailer);
+  flush();
+
+  close(fFD);
+  delete[] fBuffer;
+}
+
+static void appendPaxRecord(char* paxData, unsigned& paxSize, char const* keyword, char const* value) {
+  // Each 'pax' record is "<length> <keyword>=<value>\n", where <length> counts its own digits also:
+  unsigned sizeWithoutLength = strlen(keyword) + strlen(value) + 3; // ' ', '=', '\n'
+  unsigned recordSize;
+  for (unsigned numDigits = 1; ; ++numDigits) {
+    recordSize = sizeWithoutLength + numDigits;
+    char lengthStr[20];
+    if (sprintf(lengthStr, "%u", recordSize) == (int)numDigits) break;
+  }
+
+  paxSize += sprintf(&paxData[paxSize], "%u %s=%s\n", recordSize, keyword, value);
+}
+
+int JPEGArchive::addImage(u_int8_t const* data, unsigned size, JPEGGeoTag const* geoTag) {
+  ++fNumImages;
+  u_int64_t mtime = geoTag == NULL ? 0 : geoTag->captureTime;
+
+  if (geoTag != NULL && geoTag->hasPosition) {
+    // Precede the image with a 'pax extended header' that records the position at capture time.
+    // (We use the standard "comment" keyword, because 'tar' programs warn about unknown keywords.)
+    char paxData[TAR_BLOCK_SIZE];
+    unsigned paxSize = 0;
+    char value[200];
+    sprintf(value, "latitude=%.8f longitude=%.8f height=%.2f",
+	    geoTag->latitude, geoTag->longitude, geoTag->height);
+    appendPaxRecord(paxData, paxSize, "comment", value);
+
+    char paxName[100];
+    sprintf(paxName, "PaxHeaders/image%05u.jpg", fNumImages);
+    addEntry(paxName, 'x', (u_int8_t const*)paxData, paxSize, mtime);
+  }
+
+  char entryName[100];
+  sprintf(entryName, "image%05u.jpg", fNumImages);
+  addEntry(entryName, '0', data, size, mtime);
+
+  return !fWriteFailed;
+}
+
+void JPEGArchive::addEntry(char const* entryName, char typeFlag,
+			   u_int8_t const* data, unsigned size, u_int64_t mtime) {
+  // Construct a 'ustar' header block:
+  char header[TAR_BLOCK_SIZE];
+  memset(header, 0, sizeof header);
+  strncpy(&header[0], entryName, 99);
+  memcpy(&header[100], "0000644", 7); // mode
+  memcpy(&header[108], "0000000", 7); // uid
+  memcpy(&header[116], "0000000", 7); // gid
+  sprintf(&header[124], "%011o", size);
+  sprintf(&header[136], "%011llo", (unsigned long long)mtime);
+  header[156] = typeFlag;
+  memcpy(&header[257], "ustar", 6); // magic (including the trailing '\0')
+  memcpy(&header[263], "00", 2); // version
+
+  // The checksum is computed with the checksum field itself set to spaces:
+  memset(&header[148], ' ', 8);
+  unsigned checksum = 0;
+  for (unsigned i = 0; i < TAR_BLOCK_SIZE; ++i) checksum += (u_int8_t)header[i];
+  sprintf(&header[148], "%06o", checksum); // followed by '\0' ' '
+  header[155] = ' ';
+
+  write((u_int8_t const*)header, TAR_BLOCK_SIZE);
+  write(data, size);
+
+  // Pad the data to a multiple of the block size:
+  unsigned padding = (TAR_BLOCK_SIZE - size%TAR_BLOCK_SIZE)%TAR_BLOCK_SIZE;
+  u_int8_t zeros[TAR_BLOCK_SIZE];
+  memset(zeros, 0, padding);
+  write(zeros, padding);
+}
+
+void JPEGArchive::write(u_int8_t const* data, unsigned size) {
+  if (fBufferFill + size > ARCHIVE_BUFFER_SIZE) {
+    flush();
+
+    if (size >= ARCHIVE_BUFFER_SIZE) {
+      // Don't bother copying a large chunk of data; write it directly:
+      writeDirect(data, size);
+      return;
+    }
+  }
+
+  memcpy(&fBuffer[fBufferFill], data, size);
+  fBufferFill += size;
+}
+
+void JPEGArchive::flush() {
+  writeDirect(fBuffer, fBufferFill);
+  fBufferFill = 0;
+}
+
+void JPEGArchive::writeDirect(u_int8_t const* data, unsigned size) {
+  while (size > 0 && !fWriteFailed) {
+    ssize_t numWritten = ::write(fFD, data, size);
+    if (numWritten <= 0) {
+      if (numWritten < 0 && errno == EINTR) continue;
+      fprintf(stderr, "Write to JPEG archive failed: %s\n", strerror(errno));
+      fWriteFailed = 1;
+      break;
+    }
+    data += numWritten;
+    size -= numWritten;
+  }
+}
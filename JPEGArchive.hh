@@ -0,0 +1,71 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    An append-only (uncompressed 'tar') archive, into which embedded JPEG images are written.
+    Header File.
+*/
+
+#ifndef _JPEG_ARCHIVE_HH
+#define _JPEG_ARCHIVE_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+
+// An (optional) position and time at which an image was captured:
+class JPEGGeoTag {
+public:
+  JPEGGeoTag();
+
+public:
+  int hasPosition;
+  double latitude, longitude, height;
+  u_int64_t captureTime; // in seconds (Unix time); 0 if unknown
+};
+
+class JPEGArchive {
+public:
+  static JPEGArchive* createNew(char const* fileName); // returns NULL on failure
+
+  virtual ~JPEGArchive(); // writes the archive trailer, and closes the file
+
+  // Appends one complete JPEG image (from SOI through EOI) to the archive.  Returns 1 iff it succeeds.
+  int addImage(u_int8_t const* data, unsigned size, JPEGGeoTag const* geoTag = NULL);
+
+  unsigned numImages() const { return fNumImages; }
+
+private:
+  JPEGArchive(int fd); // called only by "createNew()"
+
+  void addEntry(char const* entryName, char typeFlag,
+		u_int8_t const* data, unsigned size, u_int64_t mtime);
+  void write(u_int8_t const* data, unsigned size);
+  void flush();
+  void writeDirect(u_int8_t const* data, unsigned size);
+
+private:
+  int fFD;
+  int fWriteFailed;
+  unsigned fNumImages;
+  u_int8_t* fBuffer;
+  unsigned fBufferFill;
+};
+
+#endif
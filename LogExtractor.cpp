@@ -0,0 +1,126 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Writing an excerpt of a DJI ".txt" file - some of its records - as a new (valid) ".txt" file.
+    Implementation.
+*/
+
+#include "LogExtractor.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+int LogExtractor::write(DJITxtFile const& source, char const* sourceFileName, char const* fileName,
+			std::vector<RecordExtent> const& extents) {
+  u_int64_t const headerSize = source.recordArea() - source.data();
+  u_int64_t const detailsAreaPosition = source.detailsArea() - source.data();
+  u_int64_t headerPlusRecordAreaSize = headerSize;
+  for (unsigned i = 0; i < extents.size(); ++i) {
+    RecordExtent const& extent = extents[i]; // alias
+    if (extent.position < headerSize || extent.endPosition < extent.position
+	|| extent.endPosition > detailsAreaPosition) {
+      fprintf(stderr, "LogExtractor::write(): Bad record extent [%llu,%llu)\n",
+	      (unsigned long long)extent.position, (unsigned long long)extent.endPosition);
+      return 0;
+    }
+    headerPlusRecordAreaSize += extent.endPosition - extent.position;
+  }
+
+  // We copy from the source file's descriptor (rather than from its mapping), so that the kernel can do the copying:
+  int sourceFD = open(sourceFileName, O_RDONLY);
+  if (sourceFD < 0) {
+    fprintf(stderr, "Failed to open \"%s\": %s\n", sourceFileName, strerror(errno));
+    return 0;
+  }
+
+  char tempFileName[strlen(fileName) + 30];
+  sprintf(tempFileName, "%s.%d.tmp", fileName, (int)getpid());
+  int fd = open(tempFileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open \"%s\": %s\n", tempFileName, strerror(errno));
+    close(sourceFD);
+    return 0;
+  }
+
+  // First, the header, with its first 8 bytes (little-endian) - the size of the header+record area - changed:
+  u_int8_t header[NEW_HEADER_SIZE];
+  memcpy(header, source.data(), headerSize);
+  for (unsigned i = 0; i < 8; ++i) {
+    header[i] = (u_int8_t)headerPlusRecordAreaSize;
+    headerPlusRecordAreaSize >>= 8;
+  }
+  int result = writeData(fd, header, headerSize);
+
+  // Then, the records, then the 'details' area:
+  for (unsigned i = 0; i < extents.size() && result; ++i) {
+    result = copyRange(sourceFD, source, extents[i].position, extents[i].endPosition, fd);
+  }
+  if (result) result = copyRange(sourceFD, source, detailsAreaPosition, source.size(), fd);
+  close(sourceFD);
+
+  if (close(fd) != 0 && result) {
+    fprintf(stderr, "Failed to write \"%s\": %s\n", tempFileName, strerror(errno));
+    result = 0;
+  }
+  if (result && rename(tempFileName, fileName) != 0) {
+    fprintf(stderr, "Failed to rename \"%s\": %s\n", tempFileName, strerror(errno));
+    result = 0;
+  }
+  if (!result) unlink(tempFileName);
+
+  return result;
+}
+
+int LogExtractor::copyRange(int sourceFD, DJITxtFile const& source, u_int64_t start, u_int64_t end, int fd) {
+  // Copy the range within the kernel, if we can:
+  loff_t position = start;
+  while ((u_int64_t)position < end) {
+    ssize_t numCopied = copy_file_range(sourceFD, &position, fd, NULL, end - position, 0);
+    if (numCopied > 0) continue; // ("position" has been advanced)
+    if (numCopied == 0) break; // shouldn't happen (the source file is at least "end" bytes long)
+    if (errno == EINTR) continue;
+    if (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP) {
+      break; // "copy_file_range()" can't be used here; copy the rest ourselves
+    }
+    fprintf(stderr, "Failed to copy to the extracted file: %s\n", strerror(errno));
+    return 0;
+  }
+
+  return writeData(fd, &source.data()[position], end - position);
+}
+
+int LogExtractor::writeData(int fd, u_int8_t const* data, u_int64_t size) {
+  while (size > 0) {
+    ssize_t numWritten = ::write(fd, data, size);
+    if (numWritten < 0 && errno == EINTR) continue;
+    if (numWritten <= 0) {
+      fprintf(stderr, "Failed to write the extracted file: %s\n", strerror(errno));
+      return 0;
+    }
+    data += numWritten;
+    size -= numWritten;
+  }
+
+  return 1;
+}
@@ -0,0 +1,55 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Writing an excerpt of a DJI ".txt" file - some of its records - as a new (valid) ".txt" file.
+    Header File.
+*/
+
+#ifndef _LOG_EXTRACTOR_HH
+#define _LOG_EXTRACTOR_HH
+
+#ifndef _DJI_TXT_FILE_HH
+#include "DJITxtFile.hh"
+#endif
+
+#ifndef _FLIGHT_SEGMENTER_HH
+#include "FlightSegmenter.hh"
+#endif
+
+// Writes a new ".txt" file that contains only some of another's records: its header (with the 'header+record-area'
+// size changed to match), the chosen records (e.g., those of one segment of the flight, and those that describe the
+// aircraft; see "FlightSegmenter.hh"), then its 'details' area.  The records are copied verbatim (so scrambled
+// records stay scrambled, and remain valid), and within the kernel (using "copy_file_range()"), if possible:
+class LogExtractor {
+public:
+  static int write(DJITxtFile const& source, char const* sourceFileName, char const* fileName,
+		   std::vector<RecordExtent> const& extents);
+      // "extents" (in the order in which they're to be written) must lie within "source"'s record area,
+      // and each must begin (and end) at a record boundary.
+      // (The file is written under a temporary name, then renamed, so readers never see a partial file.)
+      // Returns 1 iff it succeeds.
+
+private:
+  static int copyRange(int sourceFD, DJITxtFile const& source, u_int64_t start, u_int64_t end, int fd);
+  static int writeData(int fd, u_int8_t const* data, u_int64_t size);
+};
+
+#endif
@@ -0,0 +1,214 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A buffer that accumulates output text, and writes it (in large chunks) to a file descriptor.
+    Implementation.
+*/
+
+#include "OutputBuffer.hh"
+#include "OutputCompressor.hh"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+
+OutputBuffer::OutputBuffer(int fd, unsigned bufferSize, OutputCompressor* compressor)
+  : fFD(fd), fCompressor(compressor), fBuffer(new char[bufferSize]), fSize(bufferSize), fFill(0), fWriteFailed(0) {
+}
+
+OutputBuffer::~OutputBuffer() {
+  flush();
+  delete[] fBuffer;
+}
+
+void OutputBuffer::append(char const* data, unsigned size) {
+  while (size > 0) {
+    if (fFill == fSize) flush();
+
+    unsigned numToCopy = fSize - fFill;
+    if (numToCopy > size) numToCopy = size;
+    memcpy(&fBuffer[fFill], data, numToCopy);
+    fFill += numToCopy;
+    data += numToCopy;
+    size -= numToCopy;
+  }
+}
+
+void OutputBuffer::append(char const* str) {
+  append(str, strlen(str));
+}
+
+void OutputBuffer::appendCSVString(char const* data, unsigned size) {
+  unsigned i;
+  for (i = 0; i < size; ++i) {
+    if (data[i] == ',' || data[i] == '"' || data[i] == '\r' || data[i] == '\n') break;
+  }
+  if (i == size) { // the value doesn't need to be quoted
+    append(data, size);
+    return;
+  }
+
+  appendChar('"');
+  for (i = 0; i < size; ++i) {
+    if (data[i] == '"') appendChar('"');
+    appendChar(data[i]);
+  }
+  appendChar('"');
+}
+
+void OutputBuffer::appendCSVString(char const* str) {
+  appendCSVString(str, strlen(str));
+}
+
+void OutputBuffer::appendTime(int64_t time) {
+  if (time <= 0) return;
+
+  time_t timeInSeconds = time/1000;
+  struct tm tmResult;
+  if (gmtime_r(&timeInSeconds, &tmResult) == NULL) return;
+  appendf("%u/%02u/%02u %02u:%02u:%02u.%03u", tmResult.tm_year + 1900, tmResult.tm_mon + 1, tmResult.tm_mday,
+	  tmResult.tm_hour, tmResult.tm_min, tmResult.tm_sec, (unsigned)(time%1000));
+}
+
+void OutputBuffer::appendUnsigned(u_int64_t value) {
+  // Form the digits backwards, in a temporary buffer:
+  char digits[20];
+  unsigned numDigits = 0;
+  do {
+    digits[sizeof digits - ++numDigits] = '0' + value%10;
+    value /= 10;
+  } while (value > 0);
+
+  append(&digits[sizeof digits - numDigits], numDigits);
+}
+
+void OutputBuffer::appendSigned(int64_t value) {
+  if (value < 0) {
+    appendChar('-');
+    appendUnsigned(-(u_int64_t)value);
+  } else {
+    appendUnsigned(value);
+  }
+}
+
+static u_int64_t const powersOf10[] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+#define MAX_FAST_FRACTIONAL_DIGITS 9
+
+void OutputBuffer::appendFixed(double value, unsigned numFractionalDigits) {
+  // If the value (scaled to an integer) fits exactly in a "double", then format it ourselves.
+  // (Otherwise - e.g., for very large values, or NaN - use "printf()".):
+  double scaledValue = (value < 0 ? -value : value);
+  if (numFractionalDigits <= MAX_FAST_FRACTIONAL_DIGITS) scaledValue *= powersOf10[numFractionalDigits];
+  if (!(numFractionalDigits <= MAX_FAST_FRACTIONAL_DIGITS && scaledValue < 9007199254740992.0/*2^53*/)) {
+    appendf("%.*f", numFractionalDigits, value);
+    return;
+  }
+
+  u_int64_t const scaledInteger = (u_int64_t)(scaledValue + 0.5); // rounded
+  if (value < 0 && scaledInteger > 0) appendChar('-');
+  appendUnsigned(scaledInteger/powersOf10[numFractionalDigits]);
+  if (numFractionalDigits > 0) {
+    appendChar('.');
+
+    // Output the fractional part, with leading zeros:
+    char digits[MAX_FAST_FRACTIONAL_DIGITS];
+    u_int64_t fraction = scaledInteger%powersOf10[numFractionalDigits];
+    for (unsigned i = numFractionalDigits; i > 0; --i) {
+      digits[i-1] = '0' + fraction%10;
+      fraction /= 10;
+    }
+    append(digits, numFractionalDigits);
+  }
+}
+
+void OutputBuffer::appendf(char const* format, ...) {
+  va_list args;
+
+  // First, try to format directly into the buffer:
+  va_start(args, format);
+  int len = vsnprintf(&fBuffer[fFill], fSize - fFill, format, args);
+  va_end(args);
+  if (len < 0) return;
+  if ((unsigned)len < fSize - fFill) {
+    fFill += len;
+    return;
+  }
+
+  // There wasn't enough room.  Format into a temporary string instead, then copy it:
+  char str[len+1];
+  va_start(args, format);
+  vsnprintf(str, len+1, format, args);
+  va_end(args);
+  append(str, len);
+}
+
+void OutputBuffer::flush() {
+  if (fCompressor != NULL) {
+    fCompressor->write(fBuffer, fFill);
+    fFill = 0;
+    fWriteFailed = fCompressor->writeFailed();
+    return;
+  }
+
+  if (fFD < 0) {
+    // We're an in-memory buffer.  Make more room, rather than writing anything:
+    if (fFill < fSize) return;
+    char* newBuffer = new char[2*fSize];
+    memcpy(newBuffer, fBuffer, fFill);
+    delete[] fBuffer;
+    fBuffer = newBuffer;
+    fSize *= 2;
+    return;
+  }
+
+  char const* data = fBuffer;
+  unsigned size = fFill;
+  fFill = 0;
+
+  while (size > 0 && !fWriteFailed) {
+    ssize_t numWritten = write(fFD, data, size);
+    if (numWritten <= 0) {
+      if (numWritten < 0 && errno == EINTR) continue;
+      fprintf(stderr, "Output write failed: %s\n", strerror(errno));
+      fWriteFailed = 1;
+      break;
+    }
+    data += numWritten;
+    size -= numWritten;
+  }
+}
+
+void outputCSVString(FILE* fid, char const* str) {
+  OutputBuffer buffer(-1, 256);
+  buffer.appendCSVString(str);
+  fwrite(buffer.data(), 1, buffer.size(), fid);
+}
+
+void outputTime(FILE* fid, int64_t time) {
+  OutputBuffer buffer(-1, 32);
+  buffer.appendTime(time);
+  fwrite(buffer.data(), 1, buffer.size(), fid);
+}
@@ -0,0 +1,90 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A buffer that accumulates output text, and writes it (in large chunks) to a file descriptor.
+    Header File.
+*/
+
+#ifndef _OUTPUT_BUFFER_HH
+#define _OUTPUT_BUFFER_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define DEFAULT_OUTPUT_BUFFER_SIZE (1024*1024)
+
+class OutputCompressor; // forward
+
+class OutputBuffer {
+public:
+  OutputBuffer(int fd, unsigned bufferSize = DEFAULT_OUTPUT_BUFFER_SIZE, OutputCompressor* compressor = NULL);
+      // If "fd" is -1, the buffer is never written; instead, it grows as needed, and its contents
+      // can be accessed using "data()" and "size()" (e.g., to format a string in memory).
+      // If "compressor" is not NULL, the data is handed to it (to be compressed), instead of written to "fd"
+  virtual ~OutputBuffer(); // flushes any remaining data (but does not close "fd")
+
+  void append(char const* data, unsigned size);
+  void append(char const* str);
+  void appendChar(char c) {
+    if (fFill == fSize) flush();
+    fBuffer[fFill++] = c;
+  }
+  // Routines for formatting numbers (without using "printf()"):
+  void appendUnsigned(u_int64_t value);
+  void appendSigned(int64_t value);
+  void appendFixed(double value, unsigned numFractionalDigits); // like "%.*f"
+  // A CSV value - quoted (with each '"' doubled) if it contains a comma, a quote or a line break:
+  void appendCSVString(char const* data, unsigned size);
+  void appendCSVString(char const* str);
+  // A time (in milliseconds since the epoch), as in the CSV output.  (Nothing is appended if it's not positive.):
+  void appendTime(int64_t time);
+
+  void appendf(char const* format, ...)
+#ifdef __GNUC__
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+  void flush(); // writes all buffered data
+  void flushIfNearlyFull() { if (fFill > fSize - fSize/4) flush(); }
+
+  int writeFailed() const { return fWriteFailed; }
+
+  // Used only if "fd" was -1:
+  char const* data() const { return fBuffer; }
+  unsigned size() const { return fFill; }
+  void reset() { fFill = 0; }
+
+private:
+  int fFD;
+  OutputCompressor* fCompressor;
+  char* fBuffer;
+  unsigned fSize, fFill;
+  int fWriteFailed;
+};
+
+// Output a CSV value (as "OutputBuffer::appendCSVString()" does), or a time (as "OutputBuffer::appendTime()" does),
+// to a 'stdio' file:
+void outputCSVString(FILE* fid, char const* str);
+void outputTime(FILE* fid, int64_t time);
+
+#endif
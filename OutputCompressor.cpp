@@ -0,0 +1,255 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Compression (gzip or LZ4) of output, using a separate 'compression' thread.
+    Implementation.
+*/
+
+#include "OutputCompressor.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+OutputCompressor* OutputCompressor::createNew(int fd, int method, int level) {
+  return new OutputCompressor(fd, method, level);
+}
+
+OutputCompressor::OutputCompressor(int fd, int method, int level)
+  : fMethod(method), fLevel(level), fBuffer(OUTPUT_COMPRESSOR_BUFFER_SIZE), fOutput(fd), fWriteFailed(0) {
+  fThread = std::thread(method == COMPRESSION_LZ4 ? &OutputCompressor::lz4Thread : &OutputCompressor::gzipThread,
+			this);
+}
+
+OutputCompressor::~OutputCompressor() {
+  finish();
+}
+
+void OutputCompressor::finish() {
+  if (fThread.joinable()) {
+    fBuffer.setEndOfData();
+    fThread.join();
+  }
+}
+
+void OutputCompressor::write(char const* data, unsigned size) {
+  while (size > 0) {
+    unsigned maxNumBytes;
+    u_int8_t* to = fBuffer.beginWrite(maxNumBytes);
+    if (to == NULL) return; // the compression thread has stopped (because writing failed)
+
+    unsigned numBytes = size < maxNumBytes ? size : maxNumBytes;
+    memcpy(to, data, numBytes);
+    fBuffer.endWrite(numBytes);
+    data += numBytes;
+    size -= numBytes;
+  }
+}
+
+char const* OutputCompressor::fileNameSuffix(int method) {
+  switch (method) {
+    case COMPRESSION_GZIP: return ".gz";
+    case COMPRESSION_LZ4: return ".lz4";
+    default: return "";
+  }
+}
+
+void OutputCompressor::gzipThread() {
+  z_stream zs;
+  memset(&zs, 0, sizeof zs);
+  if (deflateInit2(&zs, fLevel, Z_DEFLATED, 15+16/*gzip header*/, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    fprintf(stderr, "Failed to initialize compression\n");
+    fWriteFailed = 1;
+    fBuffer.stop();
+    return;
+  }
+
+  u_int8_t out[64*1024];
+  unsigned numBytes;
+  int flush;
+  do {
+    u_int8_t const* data = fBuffer.beginRead(numBytes);
+    flush = numBytes == 0 ? Z_FINISH : Z_NO_FLUSH; // at the end of the data, write the gzip trailer
+    zs.next_in = (Bytef*)data;
+    zs.avail_in = numBytes;
+    do {
+      zs.next_out = out;
+      zs.avail_out = sizeof out;
+      deflate(&zs, flush);
+      fOutput.append((char const*)out, sizeof out - zs.avail_out);
+    } while (zs.avail_out == 0);
+    fBuffer.endRead(numBytes);
+
+    fOutput.flushIfNearlyFull();
+    if (fOutput.writeFailed()) break;
+  } while (flush != Z_FINISH);
+
+  deflateEnd(&zs);
+  fOutput.flush();
+  if (fOutput.writeFailed()) {
+    fWriteFailed = 1;
+    fBuffer.stop(); // so that the producer doesn't wait for us
+  }
+}
+
+////////// LZ4 compression //////////
+
+// We write a LZ4 'frame' of independent blocks (each of up to 1 MByte), without checksums:
+#define LZ4_BLOCK_SIZE (1024*1024)
+static u_int8_t const lz4FrameHeader[7] = {
+  0x04, 0x22, 0x4D, 0x18, // magic number
+  0x60, // version 01; blocks are independent; no checksums; no content size
+  0x60, // maximum block size: 1 MByte
+  0x51 // header checksum: the second byte of XXH32() of the preceding 2 bytes
+};
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5 // the last 5 bytes of a block are always literals
+#define LZ4_MATCH_FIND_LIMIT 12 // the last match begins at least 12 bytes before the end of a block
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_LOG 16
+
+static u_int32_t read32(u_int8_t const* ptr) {
+  u_int32_t result;
+  memcpy(&result, ptr, 4);
+  return result;
+}
+
+static unsigned lz4Hash(u_int32_t sequence) {
+  return (sequence*2654435761U) >> (32-LZ4_HASH_LOG);
+}
+
+// Outputs a length (beyond what fits in a token's 4 bits) as a sequence of bytes:
+static u_int8_t* putLength(u_int8_t* to, unsigned length) {
+  for (; length >= 255; length -= 255) *to++ = 255;
+  *to++ = length;
+  return to;
+}
+
+// Outputs one 'sequence': literals, followed by a match (unless "matchLength" is 0, for the last sequence):
+static u_int8_t* putSequence(u_int8_t* to, u_int8_t const* literals, unsigned numLiterals,
+			     unsigned offset, unsigned matchLength) {
+  u_int8_t* token = to++;
+  *token = (numLiterals < 15 ? numLiterals : 15) << 4;
+  if (numLiterals >= 15) to = putLength(to, numLiterals - 15);
+  memcpy(to, literals, numLiterals);
+  to += numLiterals;
+
+  if (matchLength > 0) {
+    *to++ = offset; *to++ = offset>>8;
+    matchLength -= LZ4_MIN_MATCH;
+    *token |= matchLength < 15 ? matchLength : 15;
+    if (matchLength >= 15) to = putLength(to, matchLength - 15);
+  }
+
+  return to;
+}
+
+// Compresses one block (using a simple, greedy, match search), returning the size of the compressed data.
+// ("to" must have room for at least "size + size/255 + 16" bytes.):
+static unsigned lz4CompressBlock(u_int8_t const* from, unsigned size, u_int8_t* to, u_int32_t* hashTable) {
+  u_int8_t* const toStart = to;
+  unsigned anchor = 0; // the start of the literals that haven't yet been output
+
+  if (size > LZ4_MATCH_FIND_LIMIT) {
+    memset(hashTable, 0xFF, (1<<LZ4_HASH_LOG)*sizeof hashTable[0]); // i.e., no previous positions
+    unsigned const matchFindLimit = size - LZ4_MATCH_FIND_LIMIT;
+    unsigned const matchLimit = size - LZ4_LAST_LITERALS;
+    unsigned pos = 0;
+
+    while (pos < matchFindLimit) {
+      u_int32_t const sequence = read32(&from[pos]);
+      unsigned const hash = lz4Hash(sequence);
+      u_int32_t const ref = hashTable[hash];
+      hashTable[hash] = pos;
+
+      if (ref == 0xFFFFFFFF || pos - ref > LZ4_MAX_OFFSET || read32(&from[ref]) != sequence) {
+	// No match.  Skip ahead faster as we go further without finding one (e.g., in incompressible data):
+	pos += 1 + ((pos - anchor) >> 6);
+	continue;
+      }
+
+      unsigned matchLength = LZ4_MIN_MATCH;
+      while (pos + matchLength < matchLimit && from[ref + matchLength] == from[pos + matchLength]) ++matchLength;
+
+      to = putSequence(to, &from[anchor], pos - anchor, pos - ref, matchLength);
+      pos += matchLength;
+      anchor = pos;
+      if (pos - 2 < matchFindLimit) hashTable[lz4Hash(read32(&from[pos-2]))] = pos - 2;
+    }
+  }
+
+  to = putSequence(to, &from[anchor], size - anchor, 0, 0);
+  return to - toStart;
+}
+
+static void put4BytesLE(u_int8_t* to, u_int32_t value) {
+  to[0] = value; to[1] = value>>8; to[2] = value>>16; to[3] = value>>24;
+}
+
+void OutputCompressor::lz4Thread() {
+  u_int8_t* block = new u_int8_t[LZ4_BLOCK_SIZE];
+  u_int8_t* compressedBlock = new u_int8_t[4 + LZ4_BLOCK_SIZE + LZ4_BLOCK_SIZE/255 + 16];
+  u_int32_t* hashTable = new u_int32_t[1<<LZ4_HASH_LOG];
+
+  fOutput.append((char const*)lz4FrameHeader, sizeof lz4FrameHeader);
+
+  unsigned numBytes;
+  do {
+    // Fill a block (or whatever is left):
+    unsigned blockSize = 0;
+    while (blockSize < LZ4_BLOCK_SIZE) {
+      u_int8_t const* data = fBuffer.beginRead(numBytes);
+      if (numBytes == 0) break; // end of data
+      if (numBytes > LZ4_BLOCK_SIZE - blockSize) numBytes = LZ4_BLOCK_SIZE - blockSize;
+      memcpy(&block[blockSize], data, numBytes);
+      fBuffer.endRead(numBytes);
+      blockSize += numBytes;
+    }
+    if (blockSize == 0) break;
+
+    unsigned compressedSize = lz4CompressBlock(block, blockSize, &compressedBlock[4], hashTable);
+    if (compressedSize < blockSize) {
+      put4BytesLE(compressedBlock, compressedSize);
+      fOutput.append((char const*)compressedBlock, 4 + compressedSize);
+    } else {
+      // The block didn't compress, so store it as is:
+      put4BytesLE(compressedBlock, blockSize | 0x80000000);
+      fOutput.append((char const*)compressedBlock, 4);
+      fOutput.append((char const*)block, blockSize);
+    }
+
+    fOutput.flushIfNearlyFull();
+    if (fOutput.writeFailed()) break;
+  } while (numBytes > 0);
+
+  u_int8_t endMark[4] = { 0, 0, 0, 0 };
+  fOutput.append((char const*)endMark, sizeof endMark);
+  fOutput.flush();
+  if (fOutput.writeFailed()) {
+    fWriteFailed = 1;
+    fBuffer.stop(); // so that the producer doesn't wait for us
+  }
+
+  delete[] hashTable;
+  delete[] compressedBlock;
+  delete[] block;
+}
@@ -0,0 +1,79 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Compression (gzip or LZ4) of output, using a separate 'compression' thread.
+    Header File.
+*/
+
+#ifndef _OUTPUT_COMPRESSOR_HH
+#define _OUTPUT_COMPRESSOR_HH
+
+#ifndef _OUTPUT_BUFFER_HH
+#include "OutputBuffer.hh"
+#endif
+
+#ifndef _BYTE_RING_BUFFER_HH
+#include "ByteRingBuffer.hh"
+#endif
+
+#include <thread>
+
+// Compression methods:
+#define COMPRESSION_NONE 0
+#define COMPRESSION_GZIP 1
+#define COMPRESSION_LZ4 2 // the LZ4 'frame' format (as written by the "lz4" command); faster, but less compact
+
+#define OUTPUT_COMPRESSOR_BUFFER_SIZE (4*1024*1024) // uncompressed data waiting to be compressed
+
+class OutputCompressor {
+public:
+  static OutputCompressor* createNew(int fd, int method, int level = -1);
+      // Compressed data is written to "fd".  "level" (1-9, or -1 for the default) is used only for gzip
+
+  virtual ~OutputCompressor(); // calls "finish()" (if it hasn't already been called)
+
+  // Compresses (and writes) any remaining data, then stops the compression thread (but does not close "fd"):
+  void finish();
+
+  // Hands over (a copy of) data to be compressed.  Called by only one thread at a time (e.g., by
+  // an "OutputBuffer", when it's flushed).  If the compression thread falls behind, we wait for it here:
+  void write(char const* data, unsigned size);
+
+  int writeFailed() const { return fWriteFailed.load(std::memory_order_acquire); }
+
+  static char const* fileNameSuffix(int method); // e.g., ".gz"
+
+private:
+  OutputCompressor(int fd, int method, int level); // called only by "createNew()"
+
+  // The compression thread's main loop, for each method:
+  void gzipThread();
+  void lz4Thread();
+
+private:
+  int fMethod, fLevel;
+  ByteRingBuffer fBuffer; // uncompressed data: producer => compression thread
+  OutputBuffer fOutput; // compressed data; used only by the compression thread
+  std::atomic<int> fWriteFailed;
+  std::thread fThread;
+};
+
+#endif
@@ -0,0 +1,612 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Writing a "FlightTable" as a Parquet file (with self-contained 'Thrift compact protocol' metadata).
+    Implementation.
+*/
+
+#include "ParquetWriter.hh"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+
+#define PARQUET_MAGIC "PAR1"
+#define MAX_DICTIONARY_SIZE (64*1024) // string columns with more distinct values are PLAIN-encoded
+
+// Parquet "Type" values:
+#define PARQUET_TYPE_BOOLEAN 0
+#define PARQUET_TYPE_INT64 2
+#define PARQUET_TYPE_DOUBLE 5
+#define PARQUET_TYPE_BYTE_ARRAY 6
+
+// Parquet "Encoding" values:
+#define PARQUET_ENCODING_PLAIN 0
+#define PARQUET_ENCODING_RLE 3
+#define PARQUET_ENCODING_DELTA_BINARY_PACKED 5
+#define PARQUET_ENCODING_RLE_DICTIONARY 8
+
+// Parquet "PageType" values:
+#define PARQUET_PAGE_TYPE_DATA_PAGE 0
+#define PARQUET_PAGE_TYPE_DICTIONARY_PAGE 2
+
+// Parquet "FieldRepetitionType", "ConvertedType" and "CompressionCodec" values:
+#define PARQUET_REPETITION_OPTIONAL 1
+#define PARQUET_CONVERTED_TYPE_UTF8 0
+#define PARQUET_CONVERTED_TYPE_TIMESTAMP_MILLIS 9
+#define PARQUET_CODEC_UNCOMPRESSED 0
+
+////////// Low-level encoding routines //////////
+
+static void putVarint(OutputBuffer& out, u_int64_t value) {
+  while (value >= 0x80) {
+    out.appendChar((char)((value&0x7F)|0x80));
+    value >>= 7;
+  }
+  out.appendChar((char)value);
+}
+
+static void putZigZag(OutputBuffer& out, int64_t value) {
+  putVarint(out, ((u_int64_t)value<<1) ^ (u_int64_t)(value>>63));
+}
+
+static void put4BytesLE(OutputBuffer& out, u_int32_t value) {
+  char bytes[4] = { (char)value, (char)(value>>8), (char)(value>>16), (char)(value>>24) };
+  out.append(bytes, 4);
+}
+
+static void put8BytesLE(OutputBuffer& out, u_int64_t value) {
+  put4BytesLE(out, (u_int32_t)value);
+  put4BytesLE(out, (u_int32_t)(value>>32));
+}
+
+static unsigned bitWidth(u_int64_t maxValue) {
+  unsigned width = 0;
+  while (maxValue > 0) { ++width; maxValue >>= 1; }
+  return width;
+}
+
+// Packs values (each "width" bits) into bytes, least-significant bit first:
+class BitPacker {
+public:
+  BitPacker(OutputBuffer& out): fOut(out), fByte(0), fNumBits(0) {}
+  ~BitPacker() { flush(); }
+
+  void put(u_int64_t value, unsigned width) {
+    while (width > 0) {
+      unsigned numBits = 8 - fNumBits;
+      if (numBits > width) numBits = width;
+      fByte |= (value & ((1u<<numBits)-1)) << fNumBits;
+      fNumBits += numBits;
+      value >>= numBits;
+      width -= numBits;
+      if (fNumBits == 8) flush();
+    }
+  }
+  void flush() {
+    if (fNumBits > 0) fOut.appendChar((char)fByte);
+    fByte = 0;
+    fNumBits = 0;
+  }
+
+private:
+  OutputBuffer& fOut;
+  unsigned fByte, fNumBits;
+};
+
+// The 'RLE/bit-packing hybrid' encoding (used for definition levels, and dictionary indices).
+// Repeated values are written as 'RLE' runs; other values as 'bit-packed' runs (of multiples of 8 values):
+static void putBitPackedRun(OutputBuffer& out, u_int32_t const* values, unsigned numValues, unsigned width) {
+  if (numValues == 0) return;
+
+  unsigned numGroups = (numValues+7)/8; // only the last run in the data may have padding
+  putVarint(out, (numGroups<<1)|1);
+  BitPacker packer(out);
+  for (unsigned i = 0; i < numGroups*8; ++i) packer.put(i < numValues ? values[i] : 0, width);
+}
+
+static void encodeRLEHybrid(OutputBuffer& out, u_int32_t const* values, unsigned numValues, unsigned width) {
+  unsigned literalStart = 0, numLiterals = 0;
+  unsigned i = 0;
+  while (i < numValues) {
+    unsigned runLength = 1;
+    while (i+runLength < numValues && values[i+runLength] == values[i]) ++runLength;
+
+    if (numLiterals == 0) literalStart = i;
+    if (runLength >= 8) {
+      // First, use some of the run to complete the current group of 8 literals (if any):
+      unsigned numToComplete = (8 - numLiterals%8)%8;
+      numLiterals += numToComplete;
+      i += numToComplete;
+      runLength -= numToComplete;
+    }
+    if (runLength >= 8) {
+      putBitPackedRun(out, &values[literalStart], numLiterals, width);
+      numLiterals = 0;
+
+      putVarint(out, runLength<<1);
+      for (unsigned b = 0; b < (width+7)/8; ++b) out.appendChar((char)(values[i]>>(8*b)));
+    } else {
+      numLiterals += runLength;
+    }
+    i += runLength;
+  }
+  putBitPackedRun(out, &values[literalStart], numLiterals, width);
+}
+
+// The 'DELTA_BINARY_PACKED' encoding (used for integers), with blocks of 128 values, each containing
+// 4 'miniblocks' of 32 values:
+#define DELTA_BLOCK_SIZE 128
+#define DELTA_MINIBLOCKS_PER_BLOCK 4
+#define DELTA_MINIBLOCK_SIZE (DELTA_BLOCK_SIZE/DELTA_MINIBLOCKS_PER_BLOCK)
+
+static void encodeDeltaBinaryPacked(OutputBuffer& out, int64_t const* values, unsigned numValues) {
+  putVarint(out, DELTA_BLOCK_SIZE);
+  putVarint(out, DELTA_MINIBLOCKS_PER_BLOCK);
+  putVarint(out, numValues);
+  putZigZag(out, numValues > 0 ? values[0] : 0);
+
+  // (Deltas are computed modulo 2^64, as the encoding requires.)
+  u_int64_t deltas[DELTA_BLOCK_SIZE];
+  for (unsigned blockStart = 1; blockStart < numValues; blockStart += DELTA_BLOCK_SIZE) {
+    unsigned numDeltas = numValues - blockStart;
+    if (numDeltas > DELTA_BLOCK_SIZE) numDeltas = DELTA_BLOCK_SIZE;
+
+    int64_t minDelta = 0;
+    for (unsigned i = 0; i < numDeltas; ++i) {
+      int64_t delta = (int64_t)((u_int64_t)values[blockStart+i] - (u_int64_t)values[blockStart+i-1]);
+      deltas[i] = (u_int64_t)delta;
+      if (i == 0 || delta < minDelta) minDelta = delta;
+    }
+    putZigZag(out, minDelta);
+
+    unsigned widths[DELTA_MINIBLOCKS_PER_BLOCK];
+    for (unsigned m = 0; m < DELTA_MINIBLOCKS_PER_BLOCK; ++m) {
+      u_int64_t maxValue = 0;
+      for (unsigned i = m*DELTA_MINIBLOCK_SIZE; i < (m+1)*DELTA_MINIBLOCK_SIZE && i < numDeltas; ++i) {
+	deltas[i] -= (u_int64_t)minDelta;
+	if (deltas[i] > maxValue) maxValue = deltas[i];
+      }
+      widths[m] = bitWidth(maxValue);
+      out.appendChar((char)widths[m]);
+    }
+
+    // Write each miniblock that contains any values (padding the last one to its full size):
+    BitPacker packer(out);
+    for (unsigned m = 0; m*DELTA_MINIBLOCK_SIZE < numDeltas; ++m) {
+      for (unsigned i = m*DELTA_MINIBLOCK_SIZE; i < (m+1)*DELTA_MINIBLOCK_SIZE; ++i) {
+	packer.put(i < numDeltas ? deltas[i] : 0, widths[m]);
+      }
+    }
+  }
+}
+
+////////// A writer for the 'Thrift compact protocol' (used for Parquet metadata) //////////
+
+#define THRIFT_TYPE_BOOLEAN_TRUE 1
+#define THRIFT_TYPE_BOOLEAN_FALSE 2
+#define THRIFT_TYPE_I32 5
+#define THRIFT_TYPE_I64 6
+#define THRIFT_TYPE_BINARY 8
+#define THRIFT_TYPE_LIST 9
+#define THRIFT_TYPE_STRUCT 12
+
+#define THRIFT_MAX_STRUCT_DEPTH 10
+
+class ThriftCompactWriter {
+public:
+  ThriftCompactWriter(OutputBuffer& out): fOut(out), fDepth(0) {}
+
+  void beginStruct() { fLastFieldId[++fDepth] = 0; }
+  void endStruct() { fOut.appendChar(0); --fDepth; }
+
+  void fieldBoolean(int16_t id, int value) {
+    fieldHeader(id, value ? THRIFT_TYPE_BOOLEAN_TRUE : THRIFT_TYPE_BOOLEAN_FALSE);
+  }
+  void fieldI32(int16_t id, int32_t value) { fieldHeader(id, THRIFT_TYPE_I32); putZigZag(fOut, value); }
+  void fieldI64(int16_t id, int64_t value) { fieldHeader(id, THRIFT_TYPE_I64); putZigZag(fOut, value); }
+  void fieldString(int16_t id, char const* str) { fieldHeader(id, THRIFT_TYPE_BINARY); listString(str); }
+  void beginFieldStruct(int16_t id) { fieldHeader(id, THRIFT_TYPE_STRUCT); beginStruct(); }
+  void beginFieldList(int16_t id, u_int8_t elementType, unsigned size) {
+    fieldHeader(id, THRIFT_TYPE_LIST);
+    if (size < 15) {
+      fOut.appendChar((char)((size<<4)|elementType));
+    } else {
+      fOut.appendChar((char)(0xF0|elementType));
+      putVarint(fOut, size);
+    }
+  }
+
+  // List elements (other than structs, which use "beginStruct()" and "endStruct()"):
+  void listI32(int32_t value) { putZigZag(fOut, value); }
+  void listString(char const* str) {
+    unsigned length = strlen(str);
+    putVarint(fOut, length);
+    fOut.append(str, length);
+  }
+
+private:
+  void fieldHeader(int16_t id, u_int8_t type) {
+    int delta = id - fLastFieldId[fDepth];
+    if (delta > 0 && delta <= 15) {
+      fOut.appendChar((char)((delta<<4)|type));
+    } else {
+      fOut.appendChar((char)type);
+      putZigZag(fOut, id);
+    }
+    fLastFieldId[fDepth] = id;
+  }
+
+private:
+  OutputBuffer& fOut;
+  unsigned fDepth;
+  int16_t fLastFieldId[THRIFT_MAX_STRUCT_DEPTH+1];
+};
+
+////////// ParquetWriter implementation //////////
+
+static int physicalType(FlightColumnType type) {
+  switch (type) {
+    case FlightColumnInt64:
+    case FlightColumnTimestamp: { return PARQUET_TYPE_INT64; }
+    case FlightColumnDouble: { return PARQUET_TYPE_DOUBLE; }
+    case FlightColumnBoolean: { return PARQUET_TYPE_BOOLEAN; }
+    default: { return PARQUET_TYPE_BYTE_ARRAY; } // strings, and (all null) columns with no type
+  }
+}
+
+class ColumnChunkInfo {
+public:
+  int physicalType;
+  unsigned encodings; // a bitmask of "PARQUET_ENCODING_*" values
+  u_int64_t fileOffset, totalSize;
+  u_int64_t dictionaryPageOffset; // 0 if there's no dictionary page
+  u_int64_t dataPageOffset;
+};
+
+class RowGroupInfo {
+public:
+  RowGroupInfo(): columns(NULL) {}
+  ~RowGroupInfo() { delete[] columns; }
+
+  unsigned numRows;
+  u_int64_t totalByteSize;
+  ColumnChunkInfo* columns;
+};
+
+ParquetWriter* ParquetWriter::createNew(int fd, unsigned rowGroupSize) {
+  if (rowGroupSize == 0 || rowGroupSize%8 != 0) rowGroupSize = DEFAULT_PARQUET_ROW_GROUP_SIZE;
+  return new ParquetWriter(fd, rowGroupSize);
+}
+
+ParquetWriter::ParquetWriter(int fd, unsigned rowGroupSize)
+  : fOutput(fd), fOutputOffset(0), fRowGroupSize(rowGroupSize), fPage(-1), fHeader(-1, 64*1024),
+    fRowGroups(NULL), fNumRowGroups(0) {
+}
+
+ParquetWriter::~ParquetWriter() {
+  delete[] fRowGroups;
+}
+
+int ParquetWriter::writeTable(FlightTable const& table) {
+  unsigned numRows = table.numRows();
+  delete[] fRowGroups;
+  fNumRowGroups = (numRows + fRowGroupSize-1)/fRowGroupSize;
+  fRowGroups = new RowGroupInfo[fNumRowGroups];
+
+  write(PARQUET_MAGIC, 4);
+  for (unsigned i = 0; i < fNumRowGroups; ++i) {
+    unsigned firstRow = i*fRowGroupSize;
+    writeRowGroup(table, firstRow, numRows - firstRow < fRowGroupSize ? numRows - firstRow : fRowGroupSize);
+  }
+  writeFileMetaData(table, numRows);
+
+  fOutput.flush();
+  return !fOutput.writeFailed();
+}
+
+void ParquetWriter::writeRowGroup(FlightTable const& table, unsigned firstRow, unsigned numRows) {
+  RowGroupInfo& rowGroup = fRowGroups[firstRow/fRowGroupSize];
+  rowGroup.numRows = numRows;
+  rowGroup.totalByteSize = 0;
+  rowGroup.columns = new ColumnChunkInfo[table.numColumns()];
+
+  for (unsigned i = 0; i < table.numColumns(); ++i) {
+    ColumnChunkInfo& info = rowGroup.columns[i];
+    info.fileOffset = fOutputOffset;
+    info.dictionaryPageOffset = 0;
+    info.encodings = 1<<PARQUET_ENCODING_RLE; // for the definition levels
+
+    writeColumnChunk(table.column(i), firstRow, numRows, info);
+
+    info.totalSize = fOutputOffset - info.fileOffset;
+    rowGroup.totalByteSize += info.totalSize;
+  }
+}
+
+void ParquetWriter::writeColumnChunk(FlightColumn const* column, unsigned firstRow, unsigned numRows,
+				     ColumnChunkInfo& info) {
+  unsigned const limit = firstRow + numRows;
+  info.physicalType = physicalType(column->type());
+
+  switch (column->type()) {
+    case FlightColumnInt64:
+    case FlightColumnTimestamp: {
+      info.encodings |= 1<<PARQUET_ENCODING_DELTA_BINARY_PACKED;
+      info.dataPageOffset = fOutputOffset;
+
+      writeDefinitionLevels(column, firstRow, numRows);
+      int64_t* values = new int64_t[numRows];
+      unsigned numValues = 0;
+      for (unsigned row = firstRow; row < limit; ++row) {
+	if (column->isValid(row)) values[numValues++] = column->int64Values()[row];
+      }
+      encodeDeltaBinaryPacked(fPage, values, numValues);
+      delete[] values;
+      writePage(0, numRows, PARQUET_ENCODING_DELTA_BINARY_PACKED);
+      break;
+    }
+    case FlightColumnDouble: {
+      info.encodings |= 1<<PARQUET_ENCODING_PLAIN;
+      info.dataPageOffset = fOutputOffset;
+
+      writeDefinitionLevels(column, firstRow, numRows);
+      for (unsigned row = firstRow; row < limit; ++row) {
+	if (!column->isValid(row)) continue;
+	u_int64_t bits;
+	memcpy(&bits, &column->doubleValues()[row], sizeof bits);
+	put8BytesLE(fPage, bits);
+      }
+      writePage(0, numRows, PARQUET_ENCODING_PLAIN);
+      break;
+    }
+    case FlightColumnBoolean: {
+      info.encodings |= 1<<PARQUET_ENCODING_PLAIN;
+      info.dataPageOffset = fOutputOffset;
+
+      writeDefinitionLevels(column, firstRow, numRows);
+      {
+	BitPacker packer(fPage);
+	for (unsigned row = firstRow; row < limit; ++row) {
+	  if (column->isValid(row)) packer.put(column->booleanValues()[row], 1);
+	}
+      }
+      writePage(0, numRows, PARQUET_ENCODING_PLAIN);
+      break;
+    }
+    case FlightColumnDictionary:
+    case FlightColumnString: {
+      writeStringValues(column, firstRow, numRows, info);
+      break;
+    }
+    default: { // FlightColumnNull: only (all zero) definition levels
+      info.encodings |= 1<<PARQUET_ENCODING_PLAIN;
+      info.dataPageOffset = fOutputOffset;
+
+      writeDefinitionLevels(column, firstRow, numRows);
+      writePage(0, numRows, PARQUET_ENCODING_PLAIN);
+      break;
+    }
+  }
+}
+
+void ParquetWriter::writeDefinitionLevels(FlightColumn const* column, unsigned firstRow, unsigned numRows) {
+  // Each (optional) column's values are preceded by their 'definition levels': 1 for a value; 0 for null:
+  u_int32_t* levels = new u_int32_t[numRows];
+  for (unsigned i = 0; i < numRows; ++i) {
+    levels[i] = column->type() != FlightColumnNull && column->isValid(firstRow+i);
+  }
+
+  OutputBuffer encodedLevels(-1, 1024);
+  encodeRLEHybrid(encodedLevels, levels, numRows, 1);
+  delete[] levels;
+
+  put4BytesLE(fPage, encodedLevels.size());
+  fPage.append(encodedLevels.data(), encodedLevels.size());
+}
+
+void ParquetWriter::writeStringValues(FlightColumn const* column, unsigned firstRow, unsigned numRows,
+				      ColumnChunkInfo& info) {
+  unsigned const limit = firstRow + numRows;
+
+  // Dictionary-encode the values.  For a "FlightColumnDictionary" column, we use the column's own
+  // dictionary; otherwise, we build one (unless there turn out to be too many distinct values):
+  std::vector<std::string> dictionary;
+  u_int32_t* indices = new u_int32_t[numRows];
+  unsigned numValues = 0;
+  int useDictionary = 1;
+  if (column->type() == FlightColumnDictionary) {
+    u_int32_t const* offsets = column->dictionaryOffsets();
+    for (unsigned i = 0; i < column->dictionarySize(); ++i) {
+      dictionary.push_back(std::string(&column->dictionaryData()[offsets[i]], offsets[i+1] - offsets[i]));
+    }
+    for (unsigned row = firstRow; row < limit; ++row) {
+      if (column->isValid(row)) indices[numValues++] = column->dictionaryIndices()[row];
+    }
+  } else {
+    std::unordered_map<std::string, u_int32_t> lookup;
+    u_int32_t const* offsets = column->stringOffsets();
+    for (unsigned row = firstRow; row < limit && useDictionary; ++row) {
+      if (!column->isValid(row)) continue;
+
+      std::string value(&column->stringData()[offsets[row]], offsets[row+1] - offsets[row]);
+      std::unordered_map<std::string, u_int32_t>::iterator itr = lookup.find(value);
+      if (itr != lookup.end()) {
+	indices[numValues++] = itr->second;
+      } else if (dictionary.size() == MAX_DICTIONARY_SIZE) {
+	useDictionary = 0;
+      } else {
+	lookup[value] = indices[numValues++] = dictionary.size();
+	dictionary.push_back(value);
+      }
+    }
+  }
+
+  if (useDictionary) {
+    // Write the 'dictionary page' (PLAIN-encoded), then a 'data page' of indices into it:
+    info.encodings |= (1<<PARQUET_ENCODING_PLAIN)|(1<<PARQUET_ENCODING_RLE_DICTIONARY);
+    info.dictionaryPageOffset = fOutputOffset;
+    for (unsigned i = 0; i < dictionary.size(); ++i) {
+      put4BytesLE(fPage, dictionary[i].size());
+      fPage.append(dictionary[i].data(), dictionary[i].size());
+    }
+    writePage(1, dictionary.size(), PARQUET_ENCODING_PLAIN);
+
+    info.dataPageOffset = fOutputOffset;
+    writeDefinitionLevels(column, firstRow, numRows);
+    unsigned width = bitWidth(dictionary.size() > 0 ? dictionary.size()-1 : 0);
+    fPage.appendChar((char)width);
+    encodeRLEHybrid(fPage, indices, numValues, width);
+    writePage(0, numRows, PARQUET_ENCODING_RLE_DICTIONARY);
+  } else {
+    info.encodings |= 1<<PARQUET_ENCODING_PLAIN;
+    info.dataPageOffset = fOutputOffset;
+    writeDefinitionLevels(column, firstRow, numRows);
+    u_int32_t const* offsets = column->stringOffsets();
+    for (unsigned row = firstRow; row < limit; ++row) {
+      if (!column->isValid(row)) continue;
+      put4BytesLE(fPage, offsets[row+1] - offsets[row]);
+      fPage.append(&column->stringData()[offsets[row]], offsets[row+1] - offsets[row]);
+    }
+    writePage(0, numRows, PARQUET_ENCODING_PLAIN);
+  }
+
+  delete[] indices;
+}
+
+void ParquetWriter::writePage(int isDictionaryPage, unsigned numValues, int encoding) {
+  // The page header (a Thrift "PageHeader" struct):
+  fHeader.reset();
+  ThriftCompactWriter header(fHeader);
+  header.beginStruct();
+  header.fieldI32(1, isDictionaryPage ? PARQUET_PAGE_TYPE_DICTIONARY_PAGE : PARQUET_PAGE_TYPE_DATA_PAGE);
+  header.fieldI32(2, fPage.size()); // uncompressed_page_size
+  header.fieldI32(3, fPage.size()); // compressed_page_size
+  if (isDictionaryPage) {
+    header.beginFieldStruct(7); // dictionary_page_header
+    header.fieldI32(1, numValues);
+    header.fieldI32(2, encoding);
+    header.endStruct();
+  } else {
+    header.beginFieldStruct(5); // data_page_header
+    header.fieldI32(1, numValues);
+    header.fieldI32(2, encoding);
+    header.fieldI32(3, PARQUET_ENCODING_RLE); // definition_level_encoding
+    header.fieldI32(4, PARQUET_ENCODING_RLE); // repetition_level_encoding (unused)
+    header.endStruct();
+  }
+  header.endStruct();
+
+  write(fHeader.data(), fHeader.size());
+  write(fPage.data(), fPage.size());
+  fPage.reset();
+}
+
+void ParquetWriter::writeFileMetaData(FlightTable const& table, unsigned numRows) {
+  // The file ends with a Thrift "FileMetaData" struct, its 4-byte length, and the 'magic' bytes again:
+  fHeader.reset();
+  ThriftCompactWriter metaData(fHeader);
+  metaData.beginStruct();
+  metaData.fieldI32(1, 1); // version
+
+  // schema: a root element, followed by one element for each column:
+  metaData.beginFieldList(2, THRIFT_TYPE_STRUCT, table.numColumns()+1);
+  metaData.beginStruct();
+  metaData.fieldString(4, "schema");
+  metaData.fieldI32(5, table.numColumns());
+  metaData.endStruct();
+  for (unsigned i = 0; i < table.numColumns(); ++i) {
+    FlightColumn const* column = table.column(i);
+    FlightColumnType type = column->type();
+    metaData.beginStruct();
+    metaData.fieldI32(1, physicalType(type));
+    metaData.fieldI32(3, PARQUET_REPETITION_OPTIONAL);
+    metaData.fieldString(4, column->name());
+    if (type == FlightColumnTimestamp) {
+      metaData.fieldI32(6, PARQUET_CONVERTED_TYPE_TIMESTAMP_MILLIS);
+      metaData.beginFieldStruct(10); // logicalType
+      metaData.beginFieldStruct(8); // TIMESTAMP
+      metaData.fieldBoolean(1, 1); // isAdjustedToUTC
+      metaData.beginFieldStruct(2); // unit
+      metaData.beginFieldStruct(1); // MILLIS
+      metaData.endStruct();
+      metaData.endStruct();
+      metaData.endStruct();
+      metaData.endStruct();
+    } else if (type == FlightColumnString || type == FlightColumnDictionary || type == FlightColumnNull) {
+      metaData.fieldI32(6, PARQUET_CONVERTED_TYPE_UTF8);
+      metaData.beginFieldStruct(10); // logicalType
+      metaData.beginFieldStruct(1); // STRING
+      metaData.endStruct();
+      metaData.endStruct();
+    }
+    metaData.endStruct();
+  }
+
+  metaData.fieldI64(3, numRows);
+
+  metaData.beginFieldList(4, THRIFT_TYPE_STRUCT, fNumRowGroups); // row_groups
+  for (unsigned g = 0; g < fNumRowGroups; ++g) {
+    RowGroupInfo const& rowGroup = fRowGroups[g];
+    metaData.beginStruct();
+    metaData.beginFieldList(1, THRIFT_TYPE_STRUCT, table.numColumns()); // columns
+    for (unsigned i = 0; i < table.numColumns(); ++i) {
+      ColumnChunkInfo const& info = rowGroup.columns[i];
+      metaData.beginStruct();
+      metaData.fieldI64(2, info.fileOffset);
+      metaData.beginFieldStruct(3); // meta_data
+      metaData.fieldI32(1, info.physicalType);
+      unsigned numEncodings = 0;
+      for (unsigned e = 0; e < 32; ++e) numEncodings += (info.encodings>>e)&1;
+      metaData.beginFieldList(2, THRIFT_TYPE_I32, numEncodings);
+      for (unsigned e = 0; e < 32; ++e) {
+	if ((info.encodings>>e)&1) metaData.listI32(e);
+      }
+      metaData.beginFieldList(3, THRIFT_TYPE_BINARY, 1); // path_in_schema
+      metaData.listString(table.column(i)->name());
+      metaData.fieldI32(4, PARQUET_CODEC_UNCOMPRESSED);
+      metaData.fieldI64(5, rowGroup.numRows); // num_values
+      metaData.fieldI64(6, info.totalSize); // total_uncompressed_size
+      metaData.fieldI64(7, info.totalSize); // total_compressed_size
+      metaData.fieldI64(9, info.dataPageOffset);
+      if (info.dictionaryPageOffset != 0) metaData.fieldI64(11, info.dictionaryPageOffset);
+      metaData.endStruct();
+      metaData.endStruct();
+    }
+    metaData.fieldI64(2, rowGroup.totalByteSize);
+    metaData.fieldI64(3, rowGroup.numRows);
+    metaData.endStruct();
+  }
+
+  metaData.fieldString(6, "djiparsetxt version 2019-02-08"); // created_by
+  metaData.endStruct();
+
+  write(fHeader.data(), fHeader.size());
+  char length[4] = { (char)fHeader.size(), (char)(fHeader.size()>>8),
+		     (char)(fHeader.size()>>16), (char)(fHeader.size()>>24) };
+  write(length, 4);
+  write(PARQUET_MAGIC, 4);
+}
+
+void ParquetWriter::write(char const* data, unsigned size) {
+  fOutput.append(data, size);
+  fOutputOffset += size;
+}
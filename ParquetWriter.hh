@@ -0,0 +1,76 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Writing a "FlightTable" as a Parquet file (with self-contained 'Thrift compact protocol' metadata).
+    Header File.
+*/
+
+#ifndef _PARQUET_WRITER_HH
+#define _PARQUET_WRITER_HH
+
+#ifndef _FLIGHT_TABLE_HH
+#include "FlightTable.hh"
+#endif
+
+#define DEFAULT_PARQUET_ROW_GROUP_SIZE (64*1024) // rows; must be a multiple of 8
+
+class ColumnChunkInfo; // forward; used only by the implementation
+class RowGroupInfo; // ditto
+
+class ParquetWriter {
+public:
+  static ParquetWriter* createNew(int fd, unsigned rowGroupSize = DEFAULT_PARQUET_ROW_GROUP_SIZE);
+
+  virtual ~ParquetWriter(); // flushes any remaining data (but does not close "fd")
+
+  // Writes a complete Parquet file (containing "table", in one or more row groups) to our "fd".
+  // Each column is 'optional' (i.e., nullable), and is encoded as follows:
+  //	int64, timestamp => INT64, DELTA_BINARY_PACKED;  double => DOUBLE, PLAIN;
+  //	boolean => BOOLEAN, PLAIN;  dictionary, string => BYTE_ARRAY (UTF8), dictionary-encoded
+  //	(except for a string column with too many distinct values, which is PLAIN-encoded).
+  // Returns 1 iff it succeeds:
+  int writeTable(FlightTable const& table);
+
+private:
+  ParquetWriter(int fd, unsigned rowGroupSize); // called only by "createNew()"
+
+  void writeRowGroup(FlightTable const& table, unsigned firstRow, unsigned numRows);
+  void writeColumnChunk(FlightColumn const* column, unsigned firstRow, unsigned numRows,
+			ColumnChunkInfo& info);
+  void writeDefinitionLevels(FlightColumn const* column, unsigned firstRow, unsigned numRows);
+  void writeStringValues(FlightColumn const* column, unsigned firstRow, unsigned numRows,
+			 ColumnChunkInfo& info); // also chooses the encoding
+  void writePage(int isDictionaryPage, unsigned numValues, int encoding);
+      // writes a page header, followed by (then resets) "fPage"
+  void writeFileMetaData(FlightTable const& table, unsigned numRows);
+  void write(char const* data, unsigned size);
+
+private:
+  OutputBuffer fOutput;
+  u_int64_t fOutputOffset; // the number of bytes written to "fOutput" so far
+  unsigned fRowGroupSize;
+  OutputBuffer fPage; // in memory; the data for the page that we're currently writing
+  OutputBuffer fHeader; // in memory; used to form each page header (and the file's metadata)
+  RowGroupInfo* fRowGroups;
+  unsigned fNumRowGroups;
+};
+
+#endif
@@ -26,8 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "RecordAndDetailsParser.hh"
 #include <stdio.h>
 
-DJITxtParser* DJITxtParser::createNew() {
-  return new RecordAndDetailsParser;
+DJITxtParser* DJITxtParser::createNew(int rowOutput, int outputFD, OutputCompressor* compressor) {
+  return new RecordAndDetailsParser(rowOutput, outputFD, compressor);
 }
 
 ////////// RecordTypeStat implementation //////////
@@ -38,8 +38,16 @@ RecordTypeStat::RecordTypeStat()
 
 ////////// RecordAndDetailsParser implementation //////////
 
-RecordAndDetailsParser::RecordAndDetailsParser()
-  : fNumRecords(0), fMaxNumRecordsForOneType(0), fFieldDatabase(new FieldDatabase) {
+RecordAndDetailsParser::RecordAndDetailsParser(int rowOutput, int outputFD, OutputCompressor* compressor)
+  : fNumRecords(0), fMaxNumRecordsForOneType(0), fNumOSDRecordsDecoded(0),
+    fRecordViews(NULL), fStopScanning(0), fScanEndPtr(NULL),
+    fFieldDatabase(new FieldDatabase), fRowWriter(NULL),
+    fRowFormat(rowOutput == ROW_OUTPUT_CSV_CHANGES ? RowFormatCSVChanges
+	       : rowOutput == ROW_OUTPUT_JSON_LINES ? RowFormatJSONLines : RowFormatCSV),
+    fFlightTableIsEnabled(0), fFlightTable(NULL),
+    fJPEGArchive(NULL), fJPEGArchiveFailed(0), fOutputJPEGImages(1) {
+  if (rowOutput != ROW_OUTPUT_NONE) fRowWriter = createRowWriter(outputFD, compressor);
+
 #ifdef DEBUG_RECORD_PARSING
   // Initialize "fRecordTypeName":
   for (unsigned i = 0; i < 256; ++i) {
@@ -77,5 +85,24 @@ RecordAndDetailsParser::RecordAndDetailsParser()
 }
 
 RecordAndDetailsParser::~RecordAndDetailsParser() {
+  for (unsigned i = 0; i < fFlightObservers.size(); ++i) fFlightObservers[i]->endFlight(); // using the fields' final values
+  delete fRowWriter; // also outputs any remaining rows
+  delete fFlightTable;
+  for (unsigned i = 0; i < fOwnedFlightObservers.size(); ++i) {
+    delete fOwnedFlightObservers[i]; // also outputs any remaining rows (or finishes writing the track)
+  }
+  delete fJPEGArchive; // also finishes writing the archive
   delete fFieldDatabase;
 }
+
+void RecordAndDetailsParser::enableFlightTable() {
+  fFlightTableIsEnabled = 1;
+}
+
+FlightTable* RecordAndDetailsParser::detachFlightTable() {
+  FlightTable* result = fFlightTable;
+  if (result != NULL) result->stopObserving(); // our fields are no longer needed
+  fFlightTable = NULL;
+
+  return result;
+}
@@ -34,6 +34,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "FieldDatabase.hh"
 #endif
 
+#ifndef _FLIGHT_TABLE_HH
+#include "FlightTable.hh"
+#endif
+
+#ifndef _JPEG_ARCHIVE_HH
+#include "JPEGArchive.hh"
+#endif
+
+#ifndef _RECORD_STREAMS_HH
+#include "RecordStreams.hh"
+#endif
+
+#ifndef _TRACK_EXPORTER_HH
+#include "TrackExporter.hh"
+#endif
+
+#include <vector>
+
 class RecordTypeStat {
 public:
   RecordTypeStat();
@@ -42,20 +60,57 @@ public:
   unsigned count, minLength, maxLength;
 };
 
+// The location of a record's data (unscrambled, if necessary), as found by "scanRecord()":
+class RecordView {
+public:
+  u_int8_t recordType;
+  u_int8_t const* data; // points either into the file, or into "unscrambledData"
+  unsigned length;
+  u_int8_t const* nextRecord; // where the following record (if any) begins in the file
+  u_int64_t position, endPosition; // of the record (and the following record) in the file
+  int isEnd; // used only to mark the end of a sequence of records
+  u_int8_t unscrambledData[256];
+};
+
+#define NUM_RECORD_VIEWS 1024 // the capacity of the queue between the 'scan' and 'decode' stages
+
 class RecordAndDetailsParser: public DJITxtParser {
 public:
-  RecordAndDetailsParser();
+  RecordAndDetailsParser(int rowOutput, int outputFD, OutputCompressor* compressor);
   virtual ~RecordAndDetailsParser();
 
   int parseJPEGRecord(u_int8_t const*& ptr, u_int8_t const* limit);
 
 private: // redefined virtual functions:
+  virtual void enableFlightTable();
+  virtual FlightTable* detachFlightTable();
+  virtual void enableRecordStreams(char const* fileNamePrefix, char const* fileNameSuffix,
+				   int compressionMethod, int compressionLevel); // implemented in "rowOutput.cpp"
+  virtual int enableTrackExport(char const* fileName, int trackFormat, double minDistance,
+				double const* lodTolerances, unsigned numLODLevels); // implemented in "rowOutput.cpp"
+  virtual int addFlightObserver(FlightObserver* observer); // implemented in "rowOutput.cpp"
+  virtual void disableJPEGOutput(); // implemented in "rowOutput.cpp"
+  virtual int jpegArchiveResult() const; // implemented in "rowOutput.cpp"
+  virtual int getFieldValue(char const* fieldName, double& result); // implemented in "rowOutput.cpp"
+  virtual int getFieldValue(char const* fieldName, std::string& result); // implemented in "rowOutput.cpp"
   virtual void parseDetailsArea(u_int8_t const*& ptr, u_int8_t const* limit);
+  virtual void prepareToParseRecords(u_int8_t const* ptr, u_int8_t const* limit);
   virtual int parseRecord(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled);
+  virtual void parseRecordsInParallel(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled);
   virtual void summarizeRecordParsing();
+  virtual int checkRecord(u_int8_t const* ptr, u_int8_t const* limit);
   virtual void outputOneRow(int outputColumnLabels);
+  virtual void flushRows();
 
 private:
+  RowWriter* createRowWriter(int fd, OutputCompressor* compressor); // implemented in "rowOutput.cpp"
+  FlightTable* createFlightTable(); // implemented in "rowOutput.cpp"
+
+  // Parsing a record is done in two steps - which may be done in separate threads:
+  int scanRecord(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled, RecordView& recordView);
+  int decodeRecord(RecordView const& recordView);
+  void scannerThread(u_int8_t const* ptr, u_int8_t const* limit, int isScrambled); // used by "parseRecordsInParallel()"
+
   // Routines for parsing specific types of record:
   void parseRecord_OSD(u_int8_t const*& ptr, u_int8_t const* limit);
   void parseRecord_HOME(u_int8_t const*& ptr, u_int8_t const* limit);
@@ -70,7 +125,8 @@ private:
   void parseRecord_RECOVER(u_int8_t const*& ptr, u_int8_t const* limit);
   void parseRecord_APP_GPS(u_int8_t const*& ptr, u_int8_t const* limit);
   void parseRecord_FIRMWARE(u_int8_t const*& ptr, u_int8_t const* limit);
-  int parseRecord_JPEG(u_int8_t const*& ptr, u_int8_t const* limit);
+  int parseRecord_JPEG(u_int8_t const*& ptr, u_int8_t const* limit, int outputImages);
+  void outputJPEGImage(u_int8_t const* imageStart, u_int8_t const* imageEnd); // used by the above
   void parseRecordUnknownFormat(char const* recordTypeName, u_int8_t const*& ptr, u_int8_t const* limit);
 
   // Routines for parsing various types of fields within a record:
@@ -110,8 +166,25 @@ private:
   RecordTypeStat fRecordTypeStats[256];
   char const* fRecordTypeName[256];
   unsigned fMaxNumRecordsForOneType;
+  unsigned fNumOSDRecordsDecoded;
+
+  // Used only by "parseRecordsInParallel()":
+  SPSCQueue<RecordView, NUM_RECORD_VIEWS>* fRecordViews; // 'scan' => 'decode'
+  std::atomic<int> fStopScanning;
+  u_int8_t const* fScanEndPtr; // where the 'scan' stage stopped
 
   FieldDatabase* fFieldDatabase;
+  RowWriter* fRowWriter; // NULL if we're not outputting CSV (or JSON)
+  RowFormat fRowFormat; // also used for any "RecordStreams"
+  int fFlightTableIsEnabled;
+  FlightTable* fFlightTable;
+  std::vector<FlightObserver*> fFlightObservers; // in the order in which they were added
+  std::vector<FlightObserver*> fOwnedFlightObservers;
+      // those (also in "fFlightObservers") that we created: by "enableRecordStreams()" and "enableTrackExport()"
+
+  JPEGArchive* fJPEGArchive; // created when we see the first embedded image
+  int fJPEGArchiveFailed;
+  int fOutputJPEGImages; // 0 iff "disableJPEGOutput()" was called
 };
 
 #endif
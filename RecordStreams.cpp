@@ -0,0 +1,193 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Output of a separate (narrow) CSV stream for each type of record, with a row for every record.
+    Implementation.
+*/
+
+#include "RecordStreams.hh"
+#include "OutputCompressor.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+// The record types whose fields are output (see "parseRecord.cpp"):
+static struct { u_int8_t recordType; char const* name; } const recordTypeNames[] = {
+  { 0x01, "OSD" },
+  { 0x02, "HOME" },
+  { 0x03, "GIMBAL" },
+  { 0x04, "RC" },
+  { 0x05, "CUSTOM" },
+  { 0x06, "DEFORM" },
+  { 0x07, "CENTER_BATTERY" },
+  { 0x08, "SMART_BATTERY" },
+  { 0x09, "APP_TIP" },
+  { 0x0A, "APP_WARN" },
+  { 0x0D, "RECOVER" },
+  { 0x0E, "APP_GPS" },
+  { 0x0F, "FIRMWARE" }
+};
+#define NUM_RECORD_TYPE_NAMES (sizeof recordTypeNames/sizeof recordTypeNames[0])
+
+// The fields (set by us) at the start of each stream's rows:
+static char const* const sequenceNumberLabel = "seq";
+static char const* const osdRowLabel = "osdRow"; // the number of the most recent (CSV) row
+static char const* const osdTimeLabel = "OSD.flyTime"; // from that row
+
+class RecordStreams::Stream {
+public:
+  Stream(OutputColumn* columns, unsigned numColumns, FieldDatabase* fieldDatabase, RowFormat format,
+	 int fd, OutputCompressor* compressor);
+  virtual ~Stream();
+
+public:
+  unsigned numRecords;
+  RowWriter* writer;
+
+private:
+  OutputColumn* fColumns;
+  int fFD;
+  OutputCompressor* fCompressor;
+};
+
+RecordStreams::Stream::Stream(OutputColumn* columns, unsigned numColumns, FieldDatabase* fieldDatabase,
+			      RowFormat format, int fd, OutputCompressor* compressor)
+  : numRecords(0), writer(RowWriter::createNew(columns, numColumns, fieldDatabase, fd, compressor, format)),
+    fColumns(columns), fFD(fd), fCompressor(compressor) {
+  writer->outputRow(1); // column labels (if the format has them)
+}
+
+RecordStreams::Stream::~Stream() {
+  delete writer; // also outputs any remaining rows
+  delete fCompressor; // also finishes writing the compressed data
+  close(fFD);
+  delete[] fColumns; // used by "writer"
+}
+
+
+////////// RecordStreams implementation //////////
+
+RecordStreams* RecordStreams::createNew(char const* fileNamePrefix, char const* fileNameSuffix,
+					OutputColumn const* columns, unsigned numColumns, FieldDatabase* fieldDatabase,
+					RowFormat format, int compressionMethod, int compressionLevel) {
+  return new RecordStreams(fileNamePrefix, fileNameSuffix, columns, numColumns, fieldDatabase,
+			   format, compressionMethod, compressionLevel);
+}
+
+RecordStreams::RecordStreams(char const* fileNamePrefix, char const* fileNameSuffix,
+			     OutputColumn const* columns, unsigned numColumns, FieldDatabase* fieldDatabase,
+			     RowFormat format, int compressionMethod, int compressionLevel)
+  : fFileNamePrefix(strdup(fileNamePrefix)), fFileNameSuffix(strdup(fileNameSuffix)),
+    fColumns(columns), fNumColumns(numColumns), fFieldDatabase(fieldDatabase), fFormat(format),
+    fCompressionMethod(compressionMethod), fCompressionLevel(compressionLevel), fFailed(0),
+    fNumRows(0) {
+  for (unsigned i = 0; i < 256; ++i) {
+    fStreams[i] = NULL;
+    fHaveNoStream[i] = 0;
+  }
+}
+
+RecordStreams::~RecordStreams() {
+  for (unsigned i = 0; i < 256; ++i) delete fStreams[i];
+  free(fFileNameSuffix);
+  free(fFileNamePrefix);
+}
+
+void RecordStreams::noteRecord(u_int8_t recordType, u_int64_t /*position*/, u_int64_t /*endPosition*/) {
+  Stream* stream = fStreams[recordType];
+  if (stream == NULL) {
+    if (fHaveNoStream[recordType]) return;
+    stream = fStreams[recordType] = createStream(recordType);
+    if (stream == NULL) {
+      fHaveNoStream[recordType] = 1;
+      return;
+    }
+  }
+
+  fFieldDatabase->add4ByteField(sequenceNumberLabel, stream->numRecords++, 0);
+  if (fNumRows > 0) fFieldDatabase->add4ByteField(osdRowLabel, fNumRows - 1, 0);
+  stream->writer->outputRow(0);
+}
+
+void RecordStreams::noteRow(int /*isColumnLabels*/) {
+  // (A row is output as each 'OSD' record is parsed, so this is also the number of 'OSD' records so far.)
+  ++fNumRows;
+}
+
+void RecordStreams::flush() {
+  for (unsigned i = 0; i < 256; ++i) {
+    if (fStreams[i] != NULL) fStreams[i]->writer->flush();
+  }
+}
+
+RecordStreams::Stream* RecordStreams::createStream(u_int8_t recordType) {
+  char const* name = NULL;
+  for (unsigned i = 0; i < NUM_RECORD_TYPE_NAMES; ++i) {
+    if (recordTypeNames[i].recordType == recordType) {
+      name = recordTypeNames[i].name;
+      break;
+    }
+  }
+  if (name == NULL) return NULL;
+
+  // Our columns are the sequence number, the most recent row (and its time), then the record's own fields:
+  OutputColumn* columns = new OutputColumn[3 + fNumColumns];
+  unsigned numColumns = 0;
+  OutputColumn const plainColumn = { NULL, NULL, ColumnPlain, 0 };
+  columns[numColumns] = plainColumn; columns[numColumns++].label = sequenceNumberLabel;
+  columns[numColumns] = plainColumn; columns[numColumns++].label = osdRowLabel;
+  unsigned const nameLength = strlen(name);
+  for (unsigned i = 0; i < fNumColumns; ++i) {
+    if (strcmp(fColumns[i].label, osdTimeLabel) == 0 && recordType != 0x01/*OSD*/) {
+      columns[numColumns++] = fColumns[i];
+    }
+  }
+  unsigned const numRecordColumns = numColumns;
+  for (unsigned i = 0; i < fNumColumns; ++i) {
+    if (strncmp(fColumns[i].label, name, nameLength) == 0 && fColumns[i].label[nameLength] == '.') {
+      columns[numColumns++] = fColumns[i];
+    }
+  }
+  if (numColumns == numRecordColumns) { // none of the record's fields are output
+    delete[] columns;
+    return NULL;
+  }
+
+  char fileName[strlen(fFileNamePrefix) + nameLength + strlen(fFileNameSuffix) + 1];
+  sprintf(fileName, "%s%s%s", fFileNamePrefix, name, fFileNameSuffix);
+  int fd = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open \"%s\": %s\n", fileName, strerror(errno));
+    fFailed = 1;
+    delete[] columns;
+    return NULL;
+  }
+
+  OutputCompressor* compressor = fCompressionMethod == COMPRESSION_NONE ? NULL
+    : OutputCompressor::createNew(fd, fCompressionMethod, fCompressionLevel);
+  // (Unlike the normal CSV output, values - e.g., an 'APP_TIP' record's text - are quoted, if necessary, so that the
+  // streams are lossless:)
+  RowFormat const format = fFormat == RowFormatCSV ? RowFormatQuotedCSV : fFormat;
+  return new Stream(columns, numColumns, fFieldDatabase, format, fd, compressor);
+}
@@ -0,0 +1,85 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Output of a separate (narrow) CSV stream for each type of record, with a row for every record.
+    Header File.
+*/
+
+#ifndef _RECORD_STREAMS_HH
+#define _RECORD_STREAMS_HH
+
+#ifndef _ROW_WRITER_HH
+#include "RowWriter.hh"
+#endif
+#ifndef _FLIGHT_OBSERVER_HH
+#include "FlightObserver.hh"
+#endif
+
+class OutputCompressor; // forward
+
+// Rows are output only when an 'OSD' record arrives, so records of other types that arrive
+// more often (e.g., 'GIMBAL' or 'RC') are 'sampled', and some of their values never get output.
+// Instead, we can output - to a separate file for each record type - a row for every record of that
+// type.  Each row also contains the record's sequence number (within its type), and the number (and
+// "OSD.flyTime") of the most recent output row (i.e., 'OSD' record):
+class RecordStreams: public FlightObserver {
+public:
+  static RecordStreams* createNew(char const* fileNamePrefix, char const* fileNameSuffix,
+				  OutputColumn const* columns, unsigned numColumns, FieldDatabase* fieldDatabase,
+				  RowFormat format, int compressionMethod, int compressionLevel);
+      // Each record type's stream is written to the file "<fileNamePrefix><recordTypeName><fileNameSuffix>"
+      // (created when the first record of that type is seen).  Its columns are those (of "columns")
+      // whose labels begin with "<recordTypeName>."
+
+  virtual ~RecordStreams(); // finishes writing each stream
+
+  int failed() const { return fFailed; } // whether any of the stream files couldn't be created
+
+private: // redefined virtual functions:
+  virtual void noteRecord(u_int8_t recordType, u_int64_t position, u_int64_t endPosition);
+      // outputs a row (of the record's fields) to the record type's stream
+  virtual void noteRow(int isColumnLabels);
+  virtual void flush(); // has each stream's rows (so far) written out
+
+private:
+  RecordStreams(char const* fileNamePrefix, char const* fileNameSuffix,
+		OutputColumn const* columns, unsigned numColumns, FieldDatabase* fieldDatabase,
+		RowFormat format, int compressionMethod, int compressionLevel); // called only by "createNew()"
+
+  class Stream; // forward
+  Stream* createStream(u_int8_t recordType); // returns NULL if we have no stream for this type
+
+private:
+  char* fFileNamePrefix;
+  char* fFileNameSuffix;
+  OutputColumn const* fColumns;
+  unsigned fNumColumns;
+  FieldDatabase* fFieldDatabase;
+  RowFormat fFormat;
+  int fCompressionMethod, fCompressionLevel;
+  int fFailed;
+  unsigned fNumRows; // the number of rows (including the column labels) that the parser has output so far
+
+  Stream* fStreams[256]; // indexed by record type
+  u_int8_t fHaveNoStream[256]; // set if we've already found that we have no stream for this record type
+};
+
+#endif
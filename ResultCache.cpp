@@ -0,0 +1,213 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A directory of previously produced outputs, indexed by a hash of each (input) ".txt" file's contents.
+    Implementation.
+*/
+
+#include "ResultCache.hh"
+#include "DJITxtFile.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <errno.h>
+
+ResultCache* ResultCache::createNew(char const* directoryName) {
+  if (mkdir(directoryName, 0755) != 0 && errno != EEXIST) {
+    fprintf(stderr, "Failed to create the result cache directory \"%s\": %s\n", directoryName, strerror(errno));
+    return NULL;
+  }
+
+  struct stat sb;
+  if (stat(directoryName, &sb) != 0 || !S_ISDIR(sb.st_mode)) {
+    fprintf(stderr, "\"%s\" is not a directory\n", directoryName);
+    return NULL;
+  }
+
+  return new ResultCache(directoryName);
+}
+
+ResultCache::ResultCache(char const* directoryName)
+  : fDirectoryName(strdup(directoryName)), fEntryName(NULL), fTempEntryName(NULL), fTempFD(-1) {
+}
+
+ResultCache::~ResultCache() {
+  if (fTempEntryName != NULL) {
+    close(fTempFD);
+    unlink(fTempEntryName);
+    free(fTempEntryName);
+  }
+  free(fEntryName);
+  free(fDirectoryName);
+}
+
+void ResultCache::formEntryName(DJITxtFile const& source, char const* suffix) {
+  // Each entry is named by the source file's content hash and size (and the type of result):
+  free(fEntryName);
+  fEntryName = (char*)malloc(strlen(fDirectoryName) + strlen(suffix) + 60);
+  sprintf(fEntryName, "%s/%016llx-%llu-v%d.%s", fDirectoryName,
+	  (unsigned long long)source.contentHash(), (unsigned long long)source.size(),
+	  RESULT_CACHE_VERSION, suffix);
+}
+
+int ResultCache::lookup(DJITxtFile const& source, char const* suffix, int outputFD) {
+  formEntryName(source, suffix);
+  int fd = open(fEntryName, O_RDONLY);
+  if (fd < 0) return 0; // not in the cache
+
+  fprintf(stderr, "Using the cached result \"%s\"\n", fEntryName);
+  int result = copyFile(fd, outputFD);
+  close(fd);
+
+  return result;
+}
+
+// A result that's a separate file is stored as a copy of the file, or - if no file was produced - as an
+// empty entry.  (Neither of the files that we cache - JPEG archives - can be empty.)
+
+int ResultCache::lookupFile(DJITxtFile const& source, char const* suffix, char const* fileName) {
+  formEntryName(source, suffix);
+  int fd = open(fEntryName, O_RDONLY);
+  if (fd < 0) return 0; // not in the cache
+
+  struct stat sb;
+  int result = 0;
+  if (fstat(fd, &sb) == 0) {
+    if (sb.st_size == 0) {
+      result = 1; // no file was produced
+    } else {
+      fprintf(stderr, "Using the cached result \"%s\" for \"%s\"\n", fEntryName, fileName);
+      int outputFD = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+      if (outputFD < 0) {
+	fprintf(stderr, "Failed to open \"%s\": %s\n", fileName, strerror(errno));
+      } else {
+	result = copyFile(fd, outputFD);
+	if (close(outputFD) != 0) result = 0;
+      }
+    }
+  }
+  close(fd);
+
+  return result;
+}
+
+int ResultCache::addFile(DJITxtFile const& source, char const* suffix, char const* fileName) {
+  int inputFD = -1;
+  if (fileName != NULL) {
+    inputFD = open(fileName, O_RDONLY);
+    if (inputFD < 0) {
+      fprintf(stderr, "Failed to open \"%s\": %s\n", fileName, strerror(errno));
+      return 0;
+    }
+  }
+
+  int fd = beginResult(source, suffix);
+  int result = fd >= 0 && (inputFD < 0 || copyFile(inputFD, fd));
+  if (inputFD >= 0) close(inputFD);
+  if (fd < 0) return 0;
+
+  // Add the entry (unless the copy failed):
+  if (result && rename(fTempEntryName, fEntryName) != 0) {
+    fprintf(stderr, "Failed to rename \"%s\": %s\n", fTempEntryName, strerror(errno));
+    result = 0;
+  }
+  if (!result) unlink(fTempEntryName);
+  close(fTempFD);
+  fTempFD = -1;
+  free(fTempEntryName); fTempEntryName = NULL;
+
+  return result;
+}
+
+int ResultCache::beginResult(DJITxtFile const& source, char const* suffix) {
+  if (fTempEntryName != NULL) return -1; // we've already begun a result
+
+  formEntryName(source, suffix);
+  fTempEntryName = (char*)malloc(strlen(fEntryName) + 30);
+  sprintf(fTempEntryName, "%s.%d.tmp", fEntryName, (int)getpid());
+  fTempFD = open(fTempEntryName, O_RDWR|O_CREAT|O_TRUNC, 0644);
+  if (fTempFD < 0) {
+    fprintf(stderr, "Failed to open \"%s\": %s\n", fTempEntryName, strerror(errno));
+    free(fTempEntryName); fTempEntryName = NULL;
+    return -1;
+  }
+
+  return fTempFD;
+}
+
+int ResultCache::finishResult(int outputFD) {
+  if (fTempEntryName == NULL) return 0;
+
+  // Add the (now complete) result to the cache, then output it:
+  int result = 0;
+  if (rename(fTempEntryName, fEntryName) != 0) {
+    fprintf(stderr, "Failed to rename \"%s\": %s\n", fTempEntryName, strerror(errno));
+    unlink(fTempEntryName);
+  } else {
+    result = lseek(fTempFD, 0, SEEK_SET) == 0 && copyFile(fTempFD, outputFD);
+  }
+
+  close(fTempFD);
+  fTempFD = -1;
+  free(fTempEntryName); fTempEntryName = NULL;
+
+  return result;
+}
+
+int ResultCache::copyFile(int fd, int outputFD) {
+  // Copy the file within the kernel, if we can:
+  while (1) {
+    ssize_t numCopied = sendfile(outputFD, fd, NULL, 1<<30);
+    if (numCopied == 0) return 1; // we're done
+    if (numCopied > 0) continue;
+    if (errno == EINTR) continue;
+    if (errno == EINVAL || errno == ENOSYS) break; // "sendfile()" can't be used here; copy the file ourselves
+    fprintf(stderr, "Failed to output the cached result: %s\n", strerror(errno));
+    return 0;
+  }
+
+  char buffer[64*1024];
+  while (1) {
+    ssize_t numRead = read(fd, buffer, sizeof buffer);
+    if (numRead == 0) return 1;
+    if (numRead < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (char const* ptr = buffer; numRead > 0; ) {
+      ssize_t numWritten = write(outputFD, ptr, numRead);
+      if (numWritten < 0 && errno == EINTR) continue;
+      if (numWritten <= 0) {
+	fprintf(stderr, "Failed to output the cached result: %s\n", strerror(errno));
+	return 0;
+      }
+      ptr += numWritten;
+      numRead -= numWritten;
+    }
+  }
+
+  fprintf(stderr, "Failed to read the cached result: %s\n", strerror(errno));
+  return 0;
+}
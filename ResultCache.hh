@@ -0,0 +1,77 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A directory of previously produced outputs, indexed by a hash of each (input) ".txt" file's contents.
+    Header File.
+*/
+
+#ifndef _RESULT_CACHE_HH
+#define _RESULT_CACHE_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+
+#define RESULT_CACHE_VERSION 2 // change this whenever the output for a given input file changes
+
+class DJITxtFile; // forward
+
+class ResultCache {
+public:
+  static ResultCache* createNew(char const* directoryName);
+      // creates the directory, if it doesn't already exist; returns NULL on failure
+
+  virtual ~ResultCache(); // abandons any result that was begun, but not finished
+
+  // Each result has a type ("suffix" - e.g., "csv"), which also names any options that affect its
+  // contents (e.g., "z9.csv.gz" for CSV compressed at level 9).
+
+  // If we have a result (of type "suffix") for "source", copy it to "outputFD".
+  // Returns 1 iff we had one (and copied it successfully):
+  int lookup(DJITxtFile const& source, char const* suffix, int outputFD);
+
+  // The same, for a result that's a separate file (e.g., a JPEG archive), which is copied to a file named
+  // "fileName".  (If the result is that no such file was produced, no file is created.)
+  int lookupFile(DJITxtFile const& source, char const* suffix, char const* fileName);
+  // Adds such a result - the file named "fileName", or (if "fileName" is NULL) that no file was produced -
+  // to the cache.  Returns 1 iff it succeeds:
+  int addFile(DJITxtFile const& source, char const* suffix, char const* fileName);
+
+  // Begins a new result (of type "suffix") for "source", returning a file descriptor to which the
+  // result should be written, or -1 on failure:
+  int beginResult(DJITxtFile const& source, char const* suffix);
+  // Once the result has been written, adds it to the cache (atomically), then copies it to "outputFD".
+  // Returns 1 iff it succeeds:
+  int finishResult(int outputFD);
+
+private:
+  ResultCache(char const* directoryName); // called only by "createNew()"
+
+  void formEntryName(DJITxtFile const& source, char const* suffix); // sets "fEntryName"
+  static int copyFile(int fd, int outputFD);
+
+private:
+  char* fDirectoryName;
+  char* fEntryName;
+  char* fTempEntryName; // non-NULL while a result is being written
+  int fTempFD;
+};
+
+#endif
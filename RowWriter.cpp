@@ -0,0 +1,267 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Output of rows of field values (as CSV), using a separate 'writer' thread.
+    Implementation.
+*/
+
+#include "RowWriter.hh"
+#include <string.h>
+
+////////// RowBatch implementation //////////
+
+RowBatch::RowBatch(unsigned numColumns)
+  : fNumColumns(numColumns), fNumRows(0), fFlushWhenWritten(0),
+    fFields(new FieldSnapshot[ROW_BATCH_SIZE*numColumns]) {
+}
+
+RowBatch::~RowBatch() {
+  delete[] fFields;
+}
+
+void RowBatch::reset() {
+  fNumRows = 0;
+  fFlushWhenWritten = 0;
+  fStrings.reset();
+}
+
+FieldSnapshot* RowBatch::addRow(int isColumnLabels) {
+  fRowIsColumnLabels[fNumRows] = isColumnLabels;
+  return &fFields[(fNumRows++)*fNumColumns];
+}
+
+
+////////// RowWriter implementation //////////
+
+RowWriter* RowWriter::createNew(OutputColumn const* columns, unsigned numColumns,
+				FieldDatabase* fieldDatabase, int fd, OutputCompressor* compressor,
+				RowFormat format) {
+  return new RowWriter(columns, numColumns, fieldDatabase, fd, compressor, format);
+}
+
+RowWriter::RowWriter(OutputColumn const* columns, unsigned numColumns,
+		     FieldDatabase* fieldDatabase, int fd, OutputCompressor* compressor,
+		     RowFormat format)
+  : fColumns(columns), fNumColumns(numColumns), fFieldDatabase(fieldDatabase),
+    fInterpretationTables(new InterpretationTable*[numColumns]), fFormat(format),
+    fOutput(fd, DEFAULT_OUTPUT_BUFFER_SIZE, compressor),
+    fNumRowsFormatted(0), fFormattedValue(-1, 256), fPrevFormattedValues(NULL),
+    fJSONNames(-1, 1024), fJSONNameOffsets(NULL) {
+  for (unsigned i = 0; i < numColumns; ++i) {
+    fInterpretationTables[i] = columns[i].kind == ColumnInterpreted
+      ? fieldDatabase->lookupInterpretationTable(columns[i].interpretedLabel)
+      : NULL;
+  }
+
+  // Begin with one batch for the parser to fill in, and the rest available for later:
+  fCurrentBatch = new RowBatch(numColumns);
+  for (unsigned i = 1; i < NUM_ROW_BATCHES; ++i) fFreeBatches.push(new RowBatch(numColumns));
+
+  if (format == RowFormatCSVChanges) {
+    fPrevFormattedValues = new OutputBuffer*[numColumns];
+    for (unsigned i = 0; i < numColumns; ++i) fPrevFormattedValues[i] = new OutputBuffer(-1, 64);
+  } else if (format == RowFormatJSONLines) {
+    fJSONNameOffsets = new unsigned[numColumns+1];
+    for (unsigned i = 0; i < numColumns; ++i) {
+      fJSONNameOffsets[i] = fJSONNames.size();
+      FieldDatabase::formatJSONString(fJSONNames, columns[i].columnName());
+      fJSONNames.appendChar(':');
+    }
+    fJSONNameOffsets[numColumns] = fJSONNames.size();
+  }
+
+  fThread = std::thread(&RowWriter::writerThread, this);
+}
+
+RowWriter::~RowWriter() {
+  // Hand over any partially-filled batch, then tell the writer thread that there are no more:
+  if (fCurrentBatch->numRows() > 0) {
+    fFilledBatches.pushWait(fCurrentBatch);
+  } else {
+    delete fCurrentBatch;
+  }
+  fFilledBatches.pushWait(NULL);
+  fThread.join();
+
+  RowBatch* batch;
+  while (fFreeBatches.pop(batch)) delete batch;
+  delete[] fInterpretationTables;
+  if (fPrevFormattedValues != NULL) {
+    for (unsigned i = 0; i < fNumColumns; ++i) delete fPrevFormattedValues[i];
+    delete[] fPrevFormattedValues;
+  }
+  delete[] fJSONNameOffsets;
+}
+
+void RowWriter::outputRow(int outputColumnLabels) {
+  FieldSnapshot* row = fCurrentBatch->addRow(outputColumnLabels);
+  if (!outputColumnLabels) {
+    for (unsigned i = 0; i < fNumColumns; ++i) {
+      fFieldDatabase->snapshotField(fColumns[i].label, row[i], fCurrentBatch->strings());
+    }
+    if (fFormat == RowFormatCSVChanges) {
+      fFieldDatabase->markAllUnchanged(); // so that the next row's snapshot notes what has changed
+    }
+  }
+
+  if (fCurrentBatch->isFull()) handOverCurrentBatch();
+}
+
+void RowWriter::flush() {
+  fCurrentBatch->setFlushWhenWritten();
+  handOverCurrentBatch();
+}
+
+void RowWriter::handOverCurrentBatch() {
+  // There's always room in "fFilledBatches", because there are only "NUM_ROW_BATCHES" batches in all:
+  fFilledBatches.pushWait(fCurrentBatch);
+
+  // Get a new batch to fill in.  If the writer has fallen behind, we'll wait for it here:
+  fFreeBatches.popWait(fCurrentBatch);
+}
+
+void RowWriter::writerThread() {
+  while (1) {
+    RowBatch* batch;
+    fFilledBatches.popWait(batch);
+    if (batch == NULL) break; // there are no more batches
+
+    for (unsigned i = 0; i < batch->numRows(); ++i) {
+      switch (fFormat) {
+	case RowFormatCSV:
+	case RowFormatQuotedCSV: { formatRow(*batch, i); break; }
+	case RowFormatCSVChanges: { formatChangedFields(*batch, i); break; }
+	case RowFormatJSONLines: { formatRowAsJSON(*batch, i); break; }
+      }
+    }
+    if (batch->flushWhenWritten()) {
+      fOutput.flush();
+    } else {
+      fOutput.flushIfNearlyFull();
+    }
+
+    batch->reset();
+    if (!fFreeBatches.push(batch)) delete batch; // can't happen
+  }
+
+  fOutput.flush();
+}
+
+void RowWriter::formatRow(RowBatch const& batch, unsigned rowNum) {
+  int isColumnLabels = batch.rowIsColumnLabels(rowNum);
+  FieldSnapshot const* row = batch.row(rowNum);
+
+  for (unsigned i = 0; i < fNumColumns; ++i) {
+    if (i > 0) fOutput.appendChar(',');
+
+    OutputColumn const& column = fColumns[i]; // alias
+    if (isColumnLabels) {
+      fOutput.append(column.columnName());
+    } else if (fFormat == RowFormatQuotedCSV) {
+      fFormattedValue.reset();
+      formatField(fFormattedValue, i, row[i]);
+      fOutput.appendCSVString(fFormattedValue.data(), fFormattedValue.size());
+    } else {
+      formatField(fOutput, i, row[i]);
+    }
+  }
+  fOutput.appendChar('\n');
+}
+
+void RowWriter::formatChangedFields(RowBatch const& batch, unsigned rowNum) {
+  if (batch.rowIsColumnLabels(rowNum)) {
+    fOutput.append("row,column,value\n");
+    return;
+  }
+  FieldSnapshot const* row = batch.row(rowNum);
+
+  for (unsigned i = 0; i < fNumColumns; ++i) {
+    // Fields whose (raw) value hasn't changed are skipped without being formatted.  Those that have
+    // changed are output only if their formatted value has changed (e.g., not just a float's 7th digit):
+    if (!row[i].isChanged) continue;
+
+    fFormattedValue.reset();
+    formatField(fFormattedValue, i, row[i]);
+    OutputBuffer& prev = *fPrevFormattedValues[i]; // alias
+    if (fFormattedValue.size() == prev.size()
+	&& memcmp(fFormattedValue.data(), prev.data(), prev.size()) == 0) continue;
+    prev.reset();
+    prev.append(fFormattedValue.data(), fFormattedValue.size());
+
+    fOutput.appendf("%u,", fNumRowsFormatted);
+    fOutput.append(fColumns[i].columnName());
+    fOutput.appendChar(',');
+    fOutput.append(fFormattedValue.data(), fFormattedValue.size());
+    fOutput.appendChar('\n');
+  }
+  ++fNumRowsFormatted;
+}
+
+void RowWriter::formatRowAsJSON(RowBatch const& batch, unsigned rowNum) {
+  if (batch.rowIsColumnLabels(rowNum)) return; // JSON objects name their members, so there's no header line
+  FieldSnapshot const* row = batch.row(rowNum);
+
+  fOutput.appendChar('{');
+  int isFirst = 1;
+  for (unsigned i = 0; i < fNumColumns; ++i) {
+    if (!row[i].isPresent) continue; // omit fields that don't (yet) have a value
+
+    if (!isFirst) fOutput.appendChar(',');
+    isFirst = 0;
+    fOutput.append(fJSONNames.data() + fJSONNameOffsets[i], fJSONNameOffsets[i+1] - fJSONNameOffsets[i]);
+
+    OutputColumn const& column = fColumns[i]; // alias
+    switch (column.kind) {
+      case ColumnPlain: {
+	FieldDatabase::formatFieldAsJSON(fOutput, row[i], column.numFractionalDigits);
+	break;
+      }
+      case ColumnBoolean: {
+	FieldDatabase::formatFieldAsJSONBoolean(fOutput, row[i]);
+	break;
+      }
+      case ColumnInterpreted: {
+	FieldDatabase::formatFieldAsJSONInterpreted(fOutput, row[i], fInterpretationTables[i]);
+	break;
+      }
+    }
+  }
+  fOutput.append("}\n", 2);
+}
+
+void RowWriter::formatField(OutputBuffer& out, unsigned columnNum, FieldSnapshot const& field) {
+  OutputColumn const& column = fColumns[columnNum]; // alias
+
+  switch (column.kind) {
+    case ColumnPlain: {
+      FieldDatabase::formatField(out, field, column.numFractionalDigits);
+      break;
+    }
+    case ColumnBoolean: {
+      FieldDatabase::formatFieldAsBoolean(out, field);
+      break;
+    }
+    case ColumnInterpreted: {
+      FieldDatabase::formatFieldInterpreted(out, field, fInterpretationTables[columnNum]);
+      break;
+    }
+  }
+}
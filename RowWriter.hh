@@ -0,0 +1,150 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Output of rows of field values (as CSV), using a separate 'writer' thread.
+    Header File.
+*/
+
+#ifndef _ROW_WRITER_HH
+#define _ROW_WRITER_HH
+
+#ifndef _FIELD_DATABASE_HH
+#include "FieldDatabase.hh"
+#endif
+
+#ifndef _SPSC_QUEUE_HH
+#include "SPSCQueue.hh"
+#endif
+
+#include <thread>
+
+// How each output column is formatted:
+enum OutputColumnKind {
+  ColumnPlain,
+  ColumnBoolean,
+  ColumnInterpreted
+};
+
+// A description of one output column:
+class OutputColumn {
+public:
+  char const* label; // the field that the column contains
+  char const* interpretedLabel; // used only by "ColumnInterpreted" columns
+  OutputColumnKind kind;
+  unsigned numFractionalDigits;
+
+  char const* columnName() const { return kind == ColumnInterpreted ? interpretedLabel : label; }
+};
+
+#define ROW_BATCH_SIZE 256 // rows
+
+// A fixed-size batch of rows (snapshots of field values), handed from the parser to the writer:
+class RowBatch {
+public:
+  RowBatch(unsigned numColumns);
+  virtual ~RowBatch();
+
+  void reset();
+  int isFull() const { return fNumRows == ROW_BATCH_SIZE; }
+  void setFlushWhenWritten() { fFlushWhenWritten = 1; }
+  int flushWhenWritten() const { return fFlushWhenWritten; }
+  unsigned numRows() const { return fNumRows; }
+
+  FieldSnapshot* addRow(int isColumnLabels); // returns an array of "numColumns" snapshots, to fill in
+  int rowIsColumnLabels(unsigned i) const { return fRowIsColumnLabels[i]; }
+  FieldSnapshot const* row(unsigned i) const { return &fFields[i*fNumColumns]; }
+
+  StringArena& strings() { return fStrings; }
+
+private:
+  unsigned fNumColumns, fNumRows;
+  int fFlushWhenWritten; // if set, the writer writes out all of its output after formatting this batch
+  FieldSnapshot* fFields;
+  u_int8_t fRowIsColumnLabels[ROW_BATCH_SIZE];
+  StringArena fStrings;
+};
+
+#define NUM_ROW_BATCHES 4 // the number of batches that may be 'in flight' at once (must be a power of 2)
+
+// How rows are output:
+enum RowFormat {
+  RowFormatCSV, // one line per row, with a value for each column
+  RowFormatQuotedCSV, // ditto, but with values that contain a comma, a quote or a line break quoted.  (The normal
+                      // CSV output isn't quoted, for compatibility with earlier versions of the program.)
+  RowFormatCSVChanges, // a 'long' CSV table - "row,column,value" - with a line for each column whose value
+                       // differs from the previous row's.  (So most rows produce only a few lines.)
+  RowFormatJSONLines // one JSON object per row (with a member for each column that has a value)
+};
+
+class RowWriter {
+public:
+  static RowWriter* createNew(OutputColumn const* columns, unsigned numColumns,
+			      FieldDatabase* fieldDatabase, int fd, OutputCompressor* compressor = NULL,
+			      RowFormat format = RowFormatCSV);
+      // If "compressor" is not NULL, the output is compressed by it (rather than written directly to "fd")
+
+  virtual ~RowWriter(); // outputs any remaining rows, then stops the writer thread
+
+  // Called by the parser to output a row.  Fills in (then hands over) a snapshot of the row's fields:
+  void outputRow(int outputColumnLabels);
+
+  // Hands over any rows that have been output so far (even if the current batch isn't full), and
+  // has the writer thread write them out (rather than waiting until its buffer is nearly full):
+  void flush();
+
+private:
+  RowWriter(OutputColumn const* columns, unsigned numColumns,
+	    FieldDatabase* fieldDatabase, int fd, OutputCompressor* compressor,
+	    RowFormat format); // called only by "createNew()"
+
+  void handOverCurrentBatch();
+
+  void writerThread(); // the 'writer' thread's main loop
+  void formatRow(RowBatch const& batch, unsigned rowNum);
+  void formatChangedFields(RowBatch const& batch, unsigned rowNum); // used for "RowFormatCSVChanges"
+  void formatRowAsJSON(RowBatch const& batch, unsigned rowNum); // used for "RowFormatJSONLines"
+  void formatField(OutputBuffer& out, unsigned columnNum, FieldSnapshot const& field);
+
+private:
+  OutputColumn const* fColumns;
+  unsigned fNumColumns;
+  FieldDatabase* fFieldDatabase;
+  InterpretationTable** fInterpretationTables; // one for each column (looked up in advance)
+  RowFormat fFormat;
+
+  RowBatch* fCurrentBatch; // the batch that the parser is currently filling in
+  SPSCQueue<RowBatch*, NUM_ROW_BATCHES> fFilledBatches; // parser => writer; NULL means 'no more'
+  SPSCQueue<RowBatch*, NUM_ROW_BATCHES> fFreeBatches; // writer => parser
+
+  OutputBuffer fOutput; // used only by the writer thread
+
+  // Used only by the writer thread, for "RowFormatCSVChanges":
+  unsigned fNumRowsFormatted;
+  OutputBuffer fFormattedValue; // in memory
+  OutputBuffer** fPrevFormattedValues; // one for each column (each in memory)
+
+  // Used only for "RowFormatJSONLines": each column's (escaped) member name, formatted in advance:
+  OutputBuffer fJSONNames; // in memory; each one is "\"<name>\":"
+  unsigned* fJSONNameOffsets; // where (in "fJSONNames") each column's name begins; there are "numColumns"+1
+  std::thread fThread;
+};
+
+#endif
@@ -0,0 +1,105 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A bounded, lock-free queue between exactly one producer thread and one consumer thread.
+    Header File.
+*/
+
+#ifndef _SPSC_QUEUE_HH
+#define _SPSC_QUEUE_HH
+
+#include <atomic>
+#include <sched.h>
+#include <unistd.h>
+
+// "capacity" must be a power of 2.
+template <class T, unsigned capacity>
+class SPSCQueue {
+public:
+  SPSCQueue() : fHead(0), fTail(0) {}
+
+  // Called only by the producer thread.  Returns 1 iff there was room for "item":
+  int push(T const& item) {
+    unsigned tail = fTail.load(std::memory_order_relaxed);
+    if (tail - fHead.load(std::memory_order_acquire) == capacity) return 0; // full
+    fItems[tail&(capacity-1)] = item;
+    fTail.store(tail+1, std::memory_order_release);
+    return 1;
+  }
+
+  // Called only by the consumer thread.  Returns 1 iff an item was available:
+  int pop(T& item) {
+    unsigned head = fHead.load(std::memory_order_relaxed);
+    if (fTail.load(std::memory_order_acquire) == head) return 0; // empty
+    item = fItems[head&(capacity-1)];
+    fHead.store(head+1, std::memory_order_release);
+    return 1;
+  }
+
+  // Alternatively, items can be filled in (or used) in place, avoiding a copy.
+  // These are the blocking equivalents of "push()" and "pop()", split into two steps:
+  T& beginPushWait() { // producer: wait for room, then fill in the returned item...
+    unsigned tail = fTail.load(std::memory_order_relaxed);
+    for (unsigned numTries = 0; tail - fHead.load(std::memory_order_acquire) == capacity; ++numTries) {
+      backOff(numTries);
+    }
+    return fItems[tail&(capacity-1)];
+  }
+  void endPush() { // ...then make it available to the consumer
+    fTail.store(fTail.load(std::memory_order_relaxed)+1, std::memory_order_release);
+  }
+  T& beginPopWait() { // consumer: wait for an item, then use the returned item...
+    unsigned head = fHead.load(std::memory_order_relaxed);
+    for (unsigned numTries = 0; fTail.load(std::memory_order_acquire) == head; ++numTries) {
+      backOff(numTries);
+    }
+    return fItems[head&(capacity-1)];
+  }
+  void endPop() { // ...then release it back to the producer
+    fHead.store(fHead.load(std::memory_order_relaxed)+1, std::memory_order_release);
+  }
+
+  // Blocking versions of "push()" and "pop()".  (These are how 'back-pressure' is applied to the other thread.)
+  void pushWait(T const& item) {
+    for (unsigned numTries = 0; !push(item); ++numTries) backOff(numTries);
+  }
+  void popWait(T& item) {
+    for (unsigned numTries = 0; !pop(item); ++numTries) backOff(numTries);
+  }
+
+  int isEmpty() const {
+    return fTail.load(std::memory_order_acquire) == fHead.load(std::memory_order_acquire);
+  }
+
+private:
+  static void backOff(unsigned numTries) {
+    // Spin (yielding the CPU) briefly, then sleep, so that a waiting thread doesn't monopolize a core:
+    if (numTries < 64) sched_yield(); else usleep(100);
+  }
+
+private:
+  T fItems[capacity];
+  // Keep the producer's and the consumer's indices in separate cache lines:
+  alignas(64) std::atomic<unsigned> fHead;
+  alignas(64) std::atomic<unsigned> fTail;
+};
+
+#endif
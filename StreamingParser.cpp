@@ -0,0 +1,302 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Parsing a DJI ".txt" file that's delivered in chunks (the 'push' interface).
+    Implementation.
+*/
+
+#include "StreamingParser.hh"
+#include "DJITxtFile.hh"
+
+#include <stdio.h>
+#include <string.h>
+
+#define RECORD_TYPE_JPEG 0x39
+#define JPEG_SOI_BYTE 0xD8
+
+// The states of a 'feed':
+#define FEED_STATE_HEADER 0 // collecting the header
+#define FEED_STATE_RECORDS 1
+#define FEED_STATE_SKIPPING 2 // skipping the rest of the record area, after a bad record
+#define FEED_STATE_DETAILS 3 // collecting the 'details' area (parsed by "endFeed()")
+
+// Parsing an old-style JPEG record (starting with 0xFF 0xD8) backs up over the preceding 2 bytes
+// (which it ignores), so a partial record that we save is preceded by this many (dummy) bytes:
+#define FEED_PRECEDING_BYTES 2
+
+// We don't expect the 'details' area to be any larger than this; any more data is ignored:
+#define MAX_FEED_DETAILS_SIZE 65536
+
+extern u_int32_t fileVersionNumber;
+
+static int isJPEGRecord(u_int8_t recordType, u_int8_t recordLength) {
+  return recordType == RECORD_TYPE_JPEG || (recordType == 0xFF && recordLength == JPEG_SOI_BYTE);
+}
+
+StreamingParser::StreamingParser(DJITxtParser& parser)
+  : fParser(parser),
+    fState(FEED_STATE_HEADER), fBuffer(NULL), fBufferSize(0), fBufferFill(0), fHeaderSize(0),
+    fIsScrambled(0), fPosition(0), fRecordAreaEnd(0), fResult(1) {
+}
+
+StreamingParser::~StreamingParser() {
+  delete[] fBuffer;
+}
+
+int StreamingParser::feed(u_int8_t const* data, unsigned numBytes) {
+  u_int8_t const* const end = data + numBytes;
+  while (data < end) {
+    switch (fState) {
+      case FEED_STATE_HEADER: {
+	// We need the first 12 bytes to tell us the header size, then the rest of the header:
+	unsigned headerSize = fHeaderSize == 0 ? OLD_HEADER_SIZE : fHeaderSize;
+	unsigned n = headerSize - fBufferFill;
+	if (n > (unsigned)(end - data)) n = end - data;
+	saveBytes(data, n);
+	data += n; fPosition += n;
+	if (fBufferFill < headerSize) break;
+
+	u_int8_t const* ptr = fBuffer;
+	u_int64_t headerPlusRecordAreaSize = getWord64LE(ptr);
+	if (fHeaderSize == 0) {
+	  fileVersionNumber = getWord32BE(ptr);
+	  fprintf(stderr, "File version number: 0x%08x\n", fileVersionNumber);
+	  if (DJITxtFile::versionHasNewHeader(fileVersionNumber)) {
+	    fHeaderSize = NEW_HEADER_SIZE;
+	    fIsScrambled = 1;
+	  } else {
+	    fHeaderSize = OLD_HEADER_SIZE;
+	    fIsScrambled = 0;
+	  }
+	  if (fBufferFill < fHeaderSize) break; // we need the rest of the header
+	}
+
+	// We have the whole header.  The 'header+record-area size' is not valid in a file that was
+	// still being written; in that case, the records extend (as far as we know) to the end of the data:
+	if (headerPlusRecordAreaSize >= fHeaderSize + MIN_RECORD_SIZE) {
+	  fRecordAreaEnd = headerPlusRecordAreaSize;
+	}
+	fBufferFill = 0;
+	u_int8_t const precedingBytes[FEED_PRECEDING_BYTES] = {0};
+	saveBytes(precedingBytes, FEED_PRECEDING_BYTES);
+	fParser.prepareToParseRecords(data, data); // we can't see the records in advance
+	fState = FEED_STATE_RECORDS;
+	break;
+      }
+
+      case FEED_STATE_RECORDS: {
+	if (fRecordAreaEnd != 0 && fPosition >= fRecordAreaEnd) {
+	  fBufferFill = 0;
+	  fState = FEED_STATE_DETAILS;
+	  break;
+	}
+
+	// Don't go past the end of the record area (if we know it):
+	int const limitIsEndOfRecords
+	  = fRecordAreaEnd != 0 && fRecordAreaEnd - fPosition <= (u_int64_t)(end - data);
+	u_int8_t const* limit = limitIsEndOfRecords ? data + (fRecordAreaEnd - fPosition) : end;
+
+	if (fBufferFill > FEED_PRECEDING_BYTES) {
+	  // First, complete the partial record that we saved from the previous chunk.  Add only as
+	  // many bytes as it needs (which, for a JPEG record, we don't know in advance):
+	  u_int8_t const* record = &fBuffer[FEED_PRECEDING_BYTES];
+	  unsigned savedSize = fBufferFill - FEED_PRECEDING_BYTES;
+	  unsigned n = limit - data;
+	  if (savedSize < 2) {
+	    if (n > 2 - savedSize) n = 2 - savedSize;
+	  } else if (!isJPEGRecord(record[0], record[1])) {
+	    unsigned recordSize = 2 + record[1] + 1;
+	    if (n > recordSize - savedSize) n = recordSize - savedSize;
+	  }
+	  saveBytes(data, n);
+	  record = &fBuffer[FEED_PRECEDING_BYTES]; // in case the buffer moved
+	  int const recordMustEnd = limitIsEndOfRecords && data + n == limit;
+
+	  if (fBufferFill - FEED_PRECEDING_BYTES < 2 && !recordMustEnd) {
+	    data += n; fPosition += n;
+	    break;
+	  }
+	  u_int8_t const* ptr = record;
+	  int status = parseRecord(ptr, &fBuffer[fBufferFill], recordMustEnd, fPosition - savedSize);
+	  if (status == RECORD_IS_COMPLETE) {
+	    // Some of the bytes that we added (or even some that we'd saved earlier, if it's a JPEG record)
+	    // might be past the end of the record:
+	    unsigned recordSize = ptr - record;
+	    if (recordSize >= savedSize) {
+	      n = recordSize - savedSize;
+	      fBufferFill = FEED_PRECEDING_BYTES;
+	    } else {
+	      memmove(fBuffer + FEED_PRECEDING_BYTES, ptr, savedSize - recordSize);
+	      fBufferFill = FEED_PRECEDING_BYTES + savedSize - recordSize;
+	      n = 0;
+	    }
+	  }
+	  data += n; fPosition += n;
+
+	  if (status == RECORD_IS_BAD) {
+	    // Keep the record's data, in case it's actually the start of the 'details' area:
+	    memmove(fBuffer, record, fBufferFill - FEED_PRECEDING_BYTES);
+	    fBufferFill -= FEED_PRECEDING_BYTES;
+	    noteBadRecord(fPosition - fBufferFill);
+	  }
+	  break;
+	}
+
+	// Parse records directly from the chunk, for as long as they're complete:
+	u_int8_t const* ptr = data;
+	int status = RECORD_IS_COMPLETE;
+	while (ptr < limit) {
+	  if (ptr < data + FEED_PRECEDING_BYTES && limit - ptr >= 2 && ptr[0] == 0xFF && ptr[1] == JPEG_SOI_BYTE) {
+	    // Parsing this record would back up past the start of the chunk, so save it instead:
+	    status = RECORD_IS_INCOMPLETE;
+	    break;
+	  }
+	  status = parseRecord(ptr, limit, limitIsEndOfRecords, fPosition + (ptr - data));
+	  if (status != RECORD_IS_COMPLETE) break;
+	}
+	fPosition += ptr - data;
+	data = ptr;
+
+	if (status == RECORD_IS_INCOMPLETE) {
+	  // Save the rest of the chunk (the start of a record), to be completed by the next chunk:
+	  saveBytes(data, limit - data);
+	  fPosition += limit - data;
+	  data = limit;
+	} else if (status == RECORD_IS_BAD) {
+	  fBufferFill = 0;
+	  noteBadRecord(fPosition);
+	}
+	break;
+      }
+
+      case FEED_STATE_SKIPPING: {
+	u_int64_t n = fRecordAreaEnd - fPosition;
+	if (n > (u_int64_t)(end - data)) n = end - data;
+	data += n; fPosition += n;
+	if (fPosition == fRecordAreaEnd) fState = FEED_STATE_DETAILS;
+	break;
+      }
+
+      case FEED_STATE_DETAILS: {
+	unsigned n = end - data;
+	if (fBufferFill + n > MAX_FEED_DETAILS_SIZE) {
+	  n = fBufferFill < MAX_FEED_DETAILS_SIZE ? MAX_FEED_DETAILS_SIZE - fBufferFill : 0;
+	}
+	saveBytes(data, n);
+	fPosition += end - data;
+	data = end;
+	break;
+      }
+    }
+  }
+
+  return fResult;
+}
+
+int StreamingParser::endFeed() {
+  if (fState == FEED_STATE_HEADER) {
+    fprintf(stderr, "The data ended within the file header\n");
+    return 0;
+  }
+
+  if (fState == FEED_STATE_RECORDS) {
+    if (fBufferFill > FEED_PRECEDING_BYTES) {
+      // The data ended within a record.  (It might be a complete JPEG record, though.)
+      u_int8_t const* record = &fBuffer[FEED_PRECEDING_BYTES];
+      u_int8_t const* ptr = record;
+      if (parseRecord(ptr, &fBuffer[fBufferFill], 1/*limitIsEndOfRecords*/,
+			  fPosition - (fBufferFill - FEED_PRECEDING_BYTES)) == RECORD_IS_BAD) {
+	memmove(fBuffer, record, fBufferFill - FEED_PRECEDING_BYTES);
+	fBufferFill -= FEED_PRECEDING_BYTES;
+	noteBadRecord(fPosition - fBufferFill);
+      }
+    } else if (fRecordAreaEnd != 0 && fPosition < fRecordAreaEnd) {
+      fprintf(stderr, "The data ended at file position %llu, before the end of the record area\n",
+	      (unsigned long long)fPosition);
+      fResult = 0;
+    }
+  }
+
+  if (fState == FEED_STATE_DETAILS && fBufferFill > 0) {
+    u_int8_t const* ptr = fBuffer;
+    try {
+      fParser.parseDetailsArea(ptr, &fBuffer[fBufferFill]);
+    } catch (int /*e*/) {
+      fprintf(stderr, "Unexpected error in parsing the 'details' area\n");
+    }
+  }
+
+  fParser.outputOneRow(); // the final row of data
+  fParser.summarizeRecordParsing();
+
+  return fResult;
+}
+
+int StreamingParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* limit, int limitIsEndOfRecords,
+				 u_int64_t position) {
+  // Unless "limit" is the end of the record area, the record might continue past it:
+  if (!limitIsEndOfRecords) {
+    int status = fParser.checkRecord(ptr, limit);
+    if (status != RECORD_IS_COMPLETE) return status;
+  } else if (fRecordAreaEnd == 0 && fParser.checkRecord(ptr, limit) == RECORD_IS_BAD) {
+    return RECORD_IS_BAD; // probably the start of the 'details' area
+  }
+
+  u_int8_t const* recordStart = ptr;
+  fParser.setPositionBase(recordStart, position);
+  if (!fParser.parseRecord(ptr, limit, fIsScrambled)) {
+    ptr = recordStart;
+    return RECORD_IS_BAD;
+  }
+
+  return RECORD_IS_COMPLETE;
+}
+
+void StreamingParser::saveBytes(u_int8_t const* data, unsigned numBytes) {
+  if (fBufferFill + numBytes > fBufferSize) {
+    unsigned newSize = 2*fBufferSize;
+    if (newSize < fBufferFill + numBytes) newSize = fBufferFill + numBytes;
+    if (newSize < 256) newSize = 256;
+
+    u_int8_t* newBuffer = new u_int8_t[newSize];
+    memcpy(newBuffer, fBuffer, fBufferFill);
+    delete[] fBuffer;
+    fBuffer = newBuffer; fBufferSize = newSize;
+  }
+
+  memcpy(&fBuffer[fBufferFill], data, numBytes);
+  fBufferFill += numBytes;
+}
+
+void StreamingParser::noteBadRecord(u_int64_t streamPosition) {
+  // The data (now in "fBuffer") at "streamPosition" is not a valid record.  If we know where the
+  // record area ends, then this is an error; skip to the 'details' area.  Otherwise, assume that the
+  // 'details' area starts here:
+  if (fRecordAreaEnd != 0) {
+    fprintf(stderr, "Premature end of record parsing at file position %llu (0x%08llx)\n",
+	    (unsigned long long)streamPosition, (unsigned long long)streamPosition);
+    fResult = 0;
+    fBufferFill = 0;
+    fState = fPosition < fRecordAreaEnd ? FEED_STATE_SKIPPING : FEED_STATE_DETAILS;
+  } else {
+    fState = FEED_STATE_DETAILS;
+  }
+}
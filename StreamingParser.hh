@@ -0,0 +1,62 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Parsing a DJI ".txt" file that's delivered in chunks (the 'push' interface).
+    Header File.
+*/
+
+#ifndef _STREAMING_PARSER_HH
+#define _STREAMING_PARSER_HH
+
+#ifndef _DJI_TXT_PARSER_HH
+#include "DJITxtParser.hh"
+#endif
+
+// Feeds a file that's delivered as a sequence of chunks (of any size) - e.g., from a network stream or a
+// decompressor - to a parser.  Rows are output as soon as their records are complete; only a record that's
+// split by the end of a chunk is copied (and saved until the next chunk).  Because the 'details' area comes
+// at the end of the file, its fields get values only in the final row (output by "endFeed()"):
+class StreamingParser {
+public:
+  StreamingParser(DJITxtParser& parser);
+  virtual ~StreamingParser();
+
+  int feed(u_int8_t const* data, unsigned numBytes); // returns 0 iff the data is bad
+  int endFeed(); // call after the last chunk; returns 1 iff all of the records were parsed successfully
+
+private:
+  int parseRecord(u_int8_t const*& ptr, u_int8_t const* limit, int limitIsEndOfRecords, u_int64_t position);
+  void saveBytes(u_int8_t const* data, unsigned numBytes);
+  void noteBadRecord(u_int64_t streamPosition);
+
+private:
+  DJITxtParser& fParser;
+  int fState; // see "StreamingParser.cpp"
+  u_int8_t* fBuffer; // the header, a partial record (at the end of a chunk), or the 'details' area
+  unsigned fBufferSize, fBufferFill;
+  unsigned fHeaderSize;
+  int fIsScrambled;
+  u_int64_t fPosition; // the position (in the file) of the next byte to be fed
+  u_int64_t fRecordAreaEnd; // from the header; 0 if it's not (yet) valid
+  int fResult;
+};
+
+#endif
@@ -0,0 +1,105 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    The grid cells that a flight's track passes through (and when), for indexing.
+    Implementation.
+*/
+
+#include "TrackCells.hh"
+
+#include <math.h>
+
+#define NUM_LATITUDE_CELLS ((unsigned)(180.0/TRACK_CELL_SIZE + 0.5))
+#define NUM_LONGITUDE_CELLS ((unsigned)(360.0/TRACK_CELL_SIZE + 0.5))
+
+TrackCells::TrackCells()
+  : fFieldDatabase(NULL), fCurrentPosting(-1), fHaveTime(0) {
+}
+
+TrackCells::~TrackCells() {
+}
+
+u_int32_t TrackCells::cellContaining(double latitude, double longitude) {
+  int row = (int)floor((latitude + 90.0)/TRACK_CELL_SIZE);
+  int column = (int)floor((longitude + 180.0)/TRACK_CELL_SIZE);
+  if (row < 0) row = 0; else if (row >= (int)NUM_LATITUDE_CELLS) row = NUM_LATITUDE_CELLS-1;
+  if (column < 0) column = 0; else if (column >= (int)NUM_LONGITUDE_CELLS) column = NUM_LONGITUDE_CELLS-1;
+
+  return row*NUM_LONGITUDE_CELLS + column;
+}
+
+unsigned TrackCells::numLongitudeCells() {
+  return NUM_LONGITUDE_CELLS;
+}
+
+int TrackCells::startFlight(FieldDatabase* fieldDatabase, OutputColumn const* /*columns*/, unsigned /*numColumns*/) {
+  fFieldDatabase = fieldDatabase;
+  fPostings.clear();
+  fLastPostingForCell.clear();
+  fCurrentPosting = -1;
+  fHaveTime = 0;
+  return 1;
+}
+
+void TrackCells::noteRow(int isColumnLabels) {
+  // (We look at each row once it's complete, so that its position and time - from the 'CUSTOM' record that
+  // follows its 'OSD' record - go together.):
+  if (isColumnLabels) return;
+
+  double latitude, longitude, time;
+  if (!fFieldDatabase->getFieldAsDouble("OSD.latitude", latitude)
+      || !fFieldDatabase->getFieldAsDouble("OSD.longitude", longitude)) return;
+  // Ignore positions that are obviously bad, or are (0,0) - i.e., from before there was a GPS fix:
+  if (!(fabs(latitude) <= 90.0 && fabs(longitude) <= 180.0)) return; // (also rejects NaN)
+  if (latitude == 0.0 && longitude == 0.0) return;
+  if (!fFieldDatabase->getFieldAsDouble("CUSTOM.updateTime", time) || time <= 0.0) {
+    time = 0.0; // not known (yet)
+  } else if (!fHaveTime) {
+    // This is the first known time.  Use it also for the positions (if any) that came before it:
+    for (unsigned i = 0; i < fPostings.size(); ++i) fPostings[i].startTime = fPostings[i].endTime = (int64_t)time;
+    fHaveTime = 1;
+  }
+
+  u_int32_t const cell = cellContaining(latitude, longitude);
+  if (fCurrentPosting < 0 || fPostings[fCurrentPosting].cell != cell) {
+    // We've entered a different cell.  Continue our previous visit to it, if that was recent; otherwise, begin a new one:
+    std::unordered_map<u_int32_t, unsigned>::iterator itr = fLastPostingForCell.find(cell);
+    if (itr != fLastPostingForCell.end() && (int64_t)time - fPostings[itr->second].endTime <= TRACK_CELL_MERGE_GAP) {
+      fCurrentPosting = itr->second;
+    } else {
+      TrackCellPosting posting;
+      posting.cell = cell;
+      posting.flight = 0;
+      posting.startTime = posting.endTime = (int64_t)time;
+      posting.minLatitude = posting.maxLatitude = latitude;
+      posting.minLongitude = posting.maxLongitude = longitude;
+      fPostings.push_back(posting);
+      fCurrentPosting = fLastPostingForCell[cell] = fPostings.size() - 1;
+    }
+  }
+
+  TrackCellPosting& posting = fPostings[fCurrentPosting]; // alias
+  if ((int64_t)time > posting.endTime) posting.endTime = (int64_t)time;
+  if (latitude < posting.minLatitude) posting.minLatitude = latitude;
+  if (latitude > posting.maxLatitude) posting.maxLatitude = latitude;
+  if (longitude < posting.minLongitude) posting.minLongitude = longitude;
+  if (longitude > posting.maxLongitude) posting.maxLongitude = longitude;
+}
@@ -0,0 +1,73 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    The grid cells that a flight's track passes through (and when), for indexing.
+    Header File.
+*/
+
+#ifndef _TRACK_CELLS_HH
+#define _TRACK_CELLS_HH
+
+#ifndef _FLIGHT_OBSERVER_HH
+#include "FlightObserver.hh"
+#endif
+
+#include <vector>
+#include <unordered_map>
+
+#define TRACK_CELL_SIZE 0.01 // degrees (about 1.1 km of latitude)
+#define TRACK_CELL_MERGE_GAP 60000 // milliseconds; a return to a cell within this time extends its previous visit
+
+// One visit (or several close together in time) of a flight's track to a grid cell.  (This is also the
+// format of the postings in a fleet catalog's track index - see "FleetCatalog.hh".):
+class TrackCellPosting {
+public:
+  u_int32_t cell; // (latitude cell number)*(number of longitude cells) + (longitude cell number)
+  u_int32_t flight; // set by the user of "TrackCells"
+  int64_t startTime, endTime; // CUSTOM.updateTime (in milliseconds) of the first and last positions in the cell
+  float minLatitude, minLongitude, maxLatitude, maxLongitude; // the bounds of the positions in the cell
+};
+
+// Collects the grid cells (of TRACK_CELL_SIZE degrees of latitude and longitude) that the aircraft's track
+// passes through, as a flight is parsed (see "DJITxtParser::addFlightObserver()"):
+class TrackCells: public FlightObserver {
+public:
+  TrackCells();
+  virtual ~TrackCells();
+
+  static u_int32_t cellContaining(double latitude, double longitude);
+  static unsigned numLongitudeCells();
+
+  std::vector<TrackCellPosting> const& postings() const { return fPostings; }
+
+private: // redefined virtual functions:
+  virtual int startFlight(FieldDatabase* fieldDatabase, OutputColumn const* columns, unsigned numColumns);
+  virtual void noteRow(int isColumnLabels);
+
+private:
+  FieldDatabase* fFieldDatabase;
+  std::vector<TrackCellPosting> fPostings;
+  std::unordered_map<u_int32_t, unsigned> fLastPostingForCell; // index into "fPostings"
+  int fCurrentPosting; // index into "fPostings" of the cell that the track is in now, or -1 if none
+  int fHaveTime; // whether we've seen a (non-zero) CUSTOM.updateTime yet
+};
+
+#endif
@@ -0,0 +1,493 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Export of the flight's track (aircraft positions, home point, and app GPS positions) as GPX, KML or GeoJSON.
+    Implementation.
+*/
+
+#include "TrackExporter.hh"
+#include "GeoConstants.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+// The record types that we use (see "parseRecord.cpp"):
+#define RECORD_TYPE_HOME 0x02
+#define RECORD_TYPE_APP_GPS 0x0E
+
+// The (approximate, but good enough over short distances) distance, in meters, between two points:
+static double distanceBetween(TrackPoint const& a, TrackPoint const& b) {
+  double dx = (b.longitude - a.longitude)*RADIANS_PER_DEGREE*cos(a.latitude*RADIANS_PER_DEGREE)*EARTH_RADIUS;
+  double dy = (b.latitude - a.latitude)*RADIANS_PER_DEGREE*EARTH_RADIUS;
+  double dz = b.height - a.height;
+  return sqrt(dx*dx + dy*dy + dz*dz);
+}
+
+// Outputs a time (in milliseconds since the Unix epoch) in ISO 8601 format (as used by GPX and GeoJSON):
+static void appendISOTime(OutputBuffer& out, u_int64_t time) {
+  time_t timeInSeconds = time/1000;
+  struct tm tmResult;
+  if (gmtime_r(&timeInSeconds, &tmResult) == NULL) return;
+
+  out.appendf("%04u-%02u-%02uT%02u:%02u:%02u.%03uZ",
+	      tmResult.tm_year + 1900, tmResult.tm_mon + 1, tmResult.tm_mday,
+	      tmResult.tm_hour, tmResult.tm_min, tmResult.tm_sec, (unsigned)(time%1000));
+}
+
+// Outputs a position's coordinates (as used by KML and GeoJSON): longitude, latitude, and (optionally) height:
+static void appendCoordinates(OutputBuffer& out, TrackPoint const& point, int hasHeight) {
+  out.appendFixed(point.longitude, 6);
+  out.appendChar(',');
+  out.appendFixed(point.latitude, 6);
+  if (hasHeight) {
+    out.appendChar(',');
+    out.appendFixed(point.height, 1);
+  }
+}
+
+////////// TrackExporter::Track implementation //////////
+
+TrackExporter::Track::Track(OutputBuffer* out, char const* name, int hasHeight, double tolerance)
+  : out(out), hasHeight(hasHeight), tolerance(tolerance),
+    numPointsSeen(0), numPointsWritten(0), lastSeenWasWritten(0), haveFirstTime(0), firstTime(0) {
+  if (tolerance > 0.0) {
+    snprintf(this->name, sizeof this->name, "%s (simplified to %g m)", name, tolerance);
+  } else {
+    snprintf(this->name, sizeof this->name, "%s", name);
+  }
+}
+
+int TrackExporter::Track::notePoint(TrackPoint const& point, double minDistance) {
+  ++numPointsSeen;
+  lastSeen = point;
+  lastSeenWasWritten = 0;
+
+  return numPointsWritten == 0 || minDistance <= 0.0 || distanceBetween(lastWritten, point) >= minDistance;
+}
+
+
+////////// TrackExporter::DeferredSection implementation //////////
+
+#define DEFERRED_SECTION_BUFFER_SIZE (64*1024)
+
+TrackExporter::DeferredSection::DeferredSection()
+  : file(tmpfile()), output(file == NULL ? -1 : fileno(file), DEFERRED_SECTION_BUFFER_SIZE) {
+}
+
+TrackExporter::DeferredSection::~DeferredSection() {
+  output.reset(); // its data (if any) is no longer wanted
+  if (file != NULL) fclose(file);
+}
+
+int TrackExporter::DeferredSection::copyTo(OutputBuffer& out) {
+  if (file == NULL) {
+    out.append(output.data(), output.size());
+    return 1;
+  }
+
+  output.flush();
+  int const fd = fileno(file);
+  if (output.writeFailed() || lseek(fd, 0, SEEK_SET) != 0) return 0;
+
+  char buffer[DEFERRED_SECTION_BUFFER_SIZE];
+  ssize_t numBytesRead;
+  while ((numBytesRead = read(fd, buffer, sizeof buffer)) > 0) out.append(buffer, numBytesRead);
+  return numBytesRead == 0;
+}
+
+
+////////// TrackExporter::LODLevel implementation //////////
+
+TrackExporter::LODLevel::LODLevel(double tolerance)
+  : simplifier(tolerance), track(&section.output, "Aircraft", 1, tolerance) {
+}
+
+
+////////// TrackExporter implementation //////////
+
+TrackExporter* TrackExporter::createNew(char const* fileName, int format, FieldDatabase* fieldDatabase,
+					double minDistance, double const* lodTolerances, unsigned numLODLevels) {
+  int fd = open(fileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open \"%s\": %s\n", fileName, strerror(errno));
+    return NULL;
+  }
+
+  return new TrackExporter(fd, format, fieldDatabase, minDistance, lodTolerances, numLODLevels);
+}
+
+int TrackExporter::formatFromFileName(char const* fileName) {
+  static struct { char const* suffix; int format; } const suffixes[] = {
+    { ".gpx", TRACK_FORMAT_GPX },
+    { ".kml", TRACK_FORMAT_KML },
+    { ".geojson", TRACK_FORMAT_GEOJSON },
+    { ".json", TRACK_FORMAT_GEOJSON }
+  };
+
+  unsigned const fileNameLength = strlen(fileName);
+  for (unsigned i = 0; i < sizeof suffixes/sizeof suffixes[0]; ++i) {
+    unsigned const suffixLength = strlen(suffixes[i].suffix);
+    if (fileNameLength > suffixLength
+	&& strcasecmp(&fileName[fileNameLength - suffixLength], suffixes[i].suffix) == 0) {
+      return suffixes[i].format;
+    }
+  }
+  return -1;
+}
+
+TrackExporter::TrackExporter(int fd, int format, FieldDatabase* fieldDatabase, double minDistance,
+			     double const* lodTolerances, unsigned numLODLevels)
+  : fFD(fd), fFormat(format), fFieldDatabase(fieldDatabase), fMinDistance(minDistance),
+    fOutput(fd), fPendingAircraftTrackOutput(-1, 64*1024),
+    fAircraftTrack(&fPendingAircraftTrackOutput, "Aircraft", 1), fAppTrack(&fAppTrackSection.output, "App GPS", 0),
+    fNumLODLevels(numLODLevels), fHaveStartedOutput(0), fHaveHomePoint(0), fHomePointIsLate(0),
+    fHaveNewAppPosition(0), fDeferredSectionFailed(0) {
+  // Each level is simplified from the one before it, so order the levels by increasing tolerance:
+  std::vector<double> tolerances(lodTolerances, lodTolerances + numLODLevels);
+  std::sort(tolerances.begin(), tolerances.end());
+
+  fLODLevels = new LODLevel*[numLODLevels+1];
+  for (unsigned i = 0; i < numLODLevels; ++i) fLODLevels[i] = new LODLevel(tolerances[i]);
+}
+
+TrackExporter::~TrackExporter() {
+  finishOutput();
+  fOutput.flush();
+  close(fFD);
+
+  for (unsigned i = 0; i < fNumLODLevels; ++i) delete fLODLevels[i];
+  delete[] fLODLevels;
+}
+
+void TrackExporter::noteRecord(u_int8_t recordType, u_int64_t /*position*/, u_int64_t /*endPosition*/) {
+  switch (recordType) {
+    case RECORD_TYPE_HOME: {
+      // Use the first home point that's recorded:
+      if (!fHaveHomePoint && getPosition("HOME.latitude", "HOME.longitude", fHomePoint)) {
+	fHaveHomePoint = 1;
+	if (fHaveStartedOutput) {
+	  fHomePointIsLate = 1; // it'll be written at the end
+	} else {
+	  startOutput();
+	}
+      }
+      break;
+    }
+    case RECORD_TYPE_APP_GPS: {
+      fHaveNewAppPosition = 1; // it's written with the row's time, in "noteRow()"
+      break;
+    }
+  }
+}
+
+void TrackExporter::noteRow(int isColumnLabels) {
+  // The aircraft's (and app's) positions are written once their row is complete, so that each is given the
+  // row's time - from its 'CUSTOM' record, which follows the 'OSD' record that begins the row:
+  if (isColumnLabels) return;
+  TrackPoint point;
+
+  if (getPosition("OSD.latitude", "OSD.longitude", point)) {
+    if (!fFieldDatabase->getFieldAsDouble("OSD.height", point.height)) point.height = 0.0;
+
+    if (fAircraftTrack.notePoint(point, fMinDistance)) {
+      if (fAircraftTrack.numPointsWritten == 0) startTrack(fAircraftTrack);
+      outputPoint(fAircraftTrack, point);
+
+      // Don't hold the aircraft's positions indefinitely, if there's no home point:
+      if (!fHaveStartedOutput && fAircraftTrack.numPointsWritten >= MAX_PENDING_AIRCRAFT_POINTS) startOutput();
+    }
+    if (fNumLODLevels > 0) addLODPoint(0, point); // (simplifying the full - not decimated - track)
+  }
+
+  if (fHaveNewAppPosition) {
+    fHaveNewAppPosition = 0;
+    if (getPosition("APP_GPS.latitude", "APP_GPS.longitude", point)) {
+      point.height = 0.0; // not known
+
+      if (fAppTrack.notePoint(point, fMinDistance)) {
+	if (fAppTrack.numPointsWritten == 0) startTrack(fAppTrack);
+	outputPoint(fAppTrack, point);
+      }
+    }
+  }
+}
+
+void TrackExporter::addLODPoint(unsigned level, TrackPoint const& point) {
+  fLODLevels[level]->simplifier.addPoint(point);
+  outputLODPoints(level);
+}
+
+void TrackExporter::outputLODPoints(unsigned level) {
+  LODLevel& lodLevel = *fLODLevels[level]; // alias
+  TrackSimplifier& simplifier = lodLevel.simplifier; // alias
+
+  for (unsigned i = 0; i < simplifier.numOutputPoints(); ++i) {
+    TrackPoint const& point = simplifier.outputPoint(i);
+    if (lodLevel.track.numPointsWritten == 0) startTrack(lodLevel.track);
+    outputPoint(lodLevel.track, point);
+
+    // Each kept point is also input to the next (coarser) level:
+    if (level+1 < fNumLODLevels) addLODPoint(level+1, point);
+  }
+  simplifier.clearOutput();
+}
+
+void TrackExporter::flush() {
+  fOutput.flush();
+}
+
+int TrackExporter::getPosition(char const* latitudeLabel, char const* longitudeLabel, TrackPoint& point) {
+  if (!fFieldDatabase->getFieldAsDouble(latitudeLabel, point.latitude)
+      || !fFieldDatabase->getFieldAsDouble(longitudeLabel, point.longitude)) return 0;
+
+  // Ignore positions that are obviously bad, or are (0,0) - i.e., from before there was a GPS fix:
+  if (!(fabs(point.latitude) <= 90.0 && fabs(point.longitude) <= 180.0)) return 0; // (also rejects NaN)
+  if (point.latitude == 0.0 && point.longitude == 0.0) return 0;
+
+  double time;
+  point.time = fFieldDatabase->getFieldAsDouble("CUSTOM.updateTime", time) && time > 0.0 ? (u_int64_t)time : 0;
+  return 1;
+}
+
+void TrackExporter::startOutput() {
+  fHaveStartedOutput = 1;
+
+  switch (fFormat) {
+    case TRACK_FORMAT_GPX: {
+      fOutput.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		     "<gpx version=\"1.1\" creator=\"djiparsetxt\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n");
+      break;
+    }
+    case TRACK_FORMAT_KML: {
+      fOutput.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		     "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+		     "<Document>\n");
+      break;
+    }
+    case TRACK_FORMAT_GEOJSON: {
+      fOutput.append("{\"type\":\"FeatureCollection\",\"features\":[\n");
+      break;
+    }
+  }
+
+  if (fHaveHomePoint) {
+    outputHomePoint();
+    if (fFormat == TRACK_FORMAT_GEOJSON) fOutput.append(",\n"); // (the aircraft's track always follows)
+  }
+
+  // Output the aircraft's track so far, and from now on, output it directly:
+  fOutput.append(fPendingAircraftTrackOutput.data(), fPendingAircraftTrackOutput.size());
+  fPendingAircraftTrackOutput.reset();
+  fAircraftTrack.out = &fOutput;
+}
+
+void TrackExporter::outputHomePoint() {
+  switch (fFormat) {
+    case TRACK_FORMAT_GPX: {
+      fOutput.append("<wpt lat=\"");
+      fOutput.appendFixed(fHomePoint.latitude, 6);
+      fOutput.append("\" lon=\"");
+      fOutput.appendFixed(fHomePoint.longitude, 6);
+      fOutput.append("\"><name>Home</name></wpt>\n");
+      break;
+    }
+    case TRACK_FORMAT_KML: {
+      fOutput.append("<Placemark><name>Home</name><Point><coordinates>");
+      appendCoordinates(fOutput, fHomePoint, 0);
+      fOutput.append("</coordinates></Point></Placemark>\n");
+      break;
+    }
+    case TRACK_FORMAT_GEOJSON: {
+      fOutput.append("{\"type\":\"Feature\",\"properties\":{\"name\":\"Home\"},"
+		     "\"geometry\":{\"type\":\"Point\",\"coordinates\":[");
+      appendCoordinates(fOutput, fHomePoint, 0);
+      fOutput.append("]}}");
+      break;
+    }
+  }
+}
+
+void TrackExporter::startTrack(Track& track) {
+  OutputBuffer& out = *track.out; // alias
+
+  switch (fFormat) {
+    case TRACK_FORMAT_GPX: {
+      out.append("<trk><name>");
+      out.append(track.name);
+      out.append("</name><trkseg>\n");
+      break;
+    }
+    case TRACK_FORMAT_KML: {
+      out.append("<Placemark><name>");
+      out.append(track.name);
+      out.append("</name><LineString>");
+      // (The aircraft's height is relative to the take-off point, which is (approximately) on the ground.)
+      out.append(track.hasHeight ? "<altitudeMode>relativeToGround</altitudeMode>" : "<tessellate>1</tessellate>");
+      out.append("<coordinates>\n");
+      break;
+    }
+    case TRACK_FORMAT_GEOJSON: {
+      // (The feature's "properties" - which include the number of points - are output after its "geometry".)
+      out.append("{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\",\"coordinates\":[\n");
+      break;
+    }
+  }
+}
+
+void TrackExporter::outputPoint(Track& track, TrackPoint const& point) {
+  OutputBuffer& out = *track.out; // alias
+
+  switch (fFormat) {
+    case TRACK_FORMAT_GPX: {
+      out.append("<trkpt lat=\"");
+      out.appendFixed(point.latitude, 6);
+      out.append("\" lon=\"");
+      out.appendFixed(point.longitude, 6);
+      out.append("\">");
+      if (track.hasHeight) {
+	out.append("<ele>");
+	out.appendFixed(point.height, 1);
+	out.append("</ele>");
+      }
+      if (point.time != 0) {
+	out.append("<time>");
+	appendISOTime(out, point.time);
+	out.append("</time>");
+      }
+      out.append("</trkpt>\n");
+      break;
+    }
+    case TRACK_FORMAT_KML: {
+      appendCoordinates(out, point, track.hasHeight);
+      out.appendChar('\n');
+      break;
+    }
+    case TRACK_FORMAT_GEOJSON: {
+      if (track.numPointsWritten > 0) out.append(",\n");
+      out.appendChar('[');
+      appendCoordinates(out, point, track.hasHeight);
+      out.appendChar(']');
+      break;
+    }
+  }
+
+  if (!track.haveFirstTime && point.time != 0) {
+    track.firstTime = point.time;
+    track.haveFirstTime = 1;
+  }
+  ++track.numPointsWritten;
+  track.lastWritten = point;
+  track.lastSeenWasWritten = 1;
+}
+
+void TrackExporter::endTrack(Track& track) {
+  OutputBuffer& out = *track.out; // alias
+
+  switch (fFormat) {
+    case TRACK_FORMAT_GPX: {
+      out.append("</trkseg></trk>\n");
+      break;
+    }
+    case TRACK_FORMAT_KML: {
+      out.append("</coordinates></LineString></Placemark>\n");
+      break;
+    }
+    case TRACK_FORMAT_GEOJSON: {
+      out.append("\n]},\"properties\":{\"name\":\"");
+      out.append(track.name);
+      out.append("\",\"numPoints\":");
+      out.appendUnsigned(track.numPointsWritten);
+      if (track.tolerance > 0.0) out.appendf(",\"tolerance\":%g", track.tolerance);
+      if (track.haveFirstTime) {
+	out.append(",\"startTime\":\"");
+	appendISOTime(out, track.firstTime);
+	out.append("\"");
+      }
+      if (track.numPointsWritten > 0 && track.lastWritten.time != 0) {
+	out.append(",\"endTime\":\"");
+	appendISOTime(out, track.lastWritten.time);
+	out.append("\"");
+      }
+      out.append("}}");
+      break;
+    }
+  }
+}
+
+void TrackExporter::finishOutput() {
+  if (!fHaveStartedOutput) startOutput(); // there was no home point
+
+  // The last position of each track is always written (even if decimation would have skipped it):
+  if (fAircraftTrack.numPointsWritten == 0) startTrack(fAircraftTrack); // (it's empty)
+  if (fAircraftTrack.havePendingPoint()) outputPoint(fAircraftTrack, fAircraftTrack.lastSeen);
+  endTrack(fAircraftTrack);
+
+  // Then the simplified tracks (each level's final points are also input to the next level):
+  for (unsigned level = 0; level < fNumLODLevels; ++level) {
+    fLODLevels[level]->simplifier.finish();
+    outputLODPoints(level);
+  }
+  for (unsigned level = 0; level < fNumLODLevels; ++level) {
+    Track& track = fLODLevels[level]->track; // alias
+    if (track.numPointsWritten == 0) continue;
+
+    endTrack(track);
+    if (fFormat == TRACK_FORMAT_GEOJSON) fOutput.append(",\n");
+    if (!fLODLevels[level]->section.copyTo(fOutput)) fDeferredSectionFailed = 1;
+  }
+
+  if (fAppTrack.numPointsWritten > 0) {
+    if (fAppTrack.havePendingPoint()) outputPoint(fAppTrack, fAppTrack.lastSeen);
+    endTrack(fAppTrack);
+
+    if (fFormat == TRACK_FORMAT_GEOJSON) fOutput.append(",\n");
+    if (!fAppTrackSection.copyTo(fOutput)) fDeferredSectionFailed = 1;
+  }
+  if (fDeferredSectionFailed) fprintf(stderr, "Failed to read back a temporary file for the track\n");
+
+  if (fHomePointIsLate && fFormat != TRACK_FORMAT_GPX) {
+    if (fFormat == TRACK_FORMAT_GEOJSON) fOutput.append(",\n");
+    outputHomePoint();
+  }
+
+  switch (fFormat) {
+    case TRACK_FORMAT_GPX: {
+      fOutput.append("</gpx>\n");
+      break;
+    }
+    case TRACK_FORMAT_KML: {
+      fOutput.append("</Document>\n</kml>\n");
+      break;
+    }
+    case TRACK_FORMAT_GEOJSON: {
+      fOutput.append("\n]}\n");
+      break;
+    }
+  }
+}
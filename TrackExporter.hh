@@ -0,0 +1,161 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Export of the flight's track (aircraft positions, home point, and app GPS positions) as GPX, KML or GeoJSON.
+    Header File.
+*/
+
+#ifndef _TRACK_EXPORTER_HH
+#define _TRACK_EXPORTER_HH
+
+#ifndef _FLIGHT_OBSERVER_HH
+#include "FlightObserver.hh"
+#endif
+
+#ifndef _TRACK_SIMPLIFIER_HH
+#include "TrackSimplifier.hh"
+#endif
+
+#include <stdio.h>
+
+// Track formats (for "TrackExporter::createNew()"):
+#define TRACK_FORMAT_GPX 0
+#define TRACK_FORMAT_KML 1
+#define TRACK_FORMAT_GEOJSON 2
+#define NUM_TRACK_FORMATS 3
+
+#define MAX_PENDING_AIRCRAFT_POINTS 1000 // held in memory while we wait for the home point
+
+// Writes the flight's track - while the records are being parsed (i.e., in the same pass) - to a file:
+// the aircraft's positions (from 'OSD' records), the home point (from 'HOME' records), and the positions
+// of the mobile device running the app (from 'APP_GPS' records).  The home point is written first (as GPX
+// requires), so the aircraft's positions are held in memory until it's known (normally, soon after the
+// start of the log), and then written as they arrive.  If there's still no home point after
+// "MAX_PENDING_AIRCRAFT_POINTS" positions, we stop waiting for it; a home point that's recorded later is
+// then written at the end (except in GPX, where it can't follow the track).  The (less frequent) app positions
+// are written at the end.
+//
+// The aircraft's track can also be written at several 'levels of detail' (e.g., for different map zoom
+// levels), each simplified (see "TrackSimplifier.hh") with a different tolerance.  These are computed in the
+// same pass - each level from the one before it - and written (after the full track) at the end.
+//
+// Each part of the file that's written at the end is kept in a temporary file until then, so the memory that
+// we use doesn't grow with the length of the log.
+class TrackExporter: public FlightObserver {
+public:
+  static TrackExporter* createNew(char const* fileName, int format, FieldDatabase* fieldDatabase,
+				  double minDistance = 0.0,
+				  double const* lodTolerances = NULL, unsigned numLODLevels = 0);
+      // If "minDistance" (in meters) is not 0.0, the track is decimated: a position is written only if
+      // it's at least this far from the previously-written position (but the last position is always
+      // written).  "lodTolerances" (in meters; in any order) are the tolerances of the simplified tracks
+      // (if any).  Returns NULL (after reporting an error) if the file can't be created.
+  static int formatFromFileName(char const* fileName);
+      // from the file name's suffix (".gpx", ".kml", ".geojson" or ".json"); returns -1 if not recognized
+
+  virtual ~TrackExporter(); // finishes writing the file
+
+  int failed() const { return fOutput.writeFailed() || fDeferredSectionFailed; }
+
+private: // redefined virtual functions:
+  virtual void noteRecord(u_int8_t recordType, u_int64_t position, u_int64_t endPosition);
+  virtual void noteRow(int isColumnLabels);
+  virtual void flush(); // has the track (so far) written out
+
+private:
+  TrackExporter(int fd, int format, FieldDatabase* fieldDatabase, double minDistance,
+		double const* lodTolerances, unsigned numLODLevels); // called only by "createNew()"
+
+  // The state of each of our tracks (the aircraft's, any simplified versions of it, and the app's):
+  class Track {
+  public:
+    Track(OutputBuffer* out, char const* name, int hasHeight, double tolerance = 0.0);
+
+    int notePoint(TrackPoint const& point, double minDistance); // returns 1 iff the point is to be written
+    int havePendingPoint() const { return numPointsSeen > 0 && !lastSeenWasWritten; }
+        // whether the most recent point was skipped (by decimation), and so should be written at the end
+
+  public:
+    OutputBuffer* out;
+    char name[48];
+    int hasHeight;
+    double tolerance; // if the track has been simplified; otherwise 0.0
+    unsigned numPointsSeen, numPointsWritten;
+    TrackPoint lastWritten, lastSeen;
+    int lastSeenWasWritten;
+    int haveFirstTime;
+    u_int64_t firstTime; // (if "haveFirstTime") of the first point written that has a time
+  };
+
+  int getPosition(char const* latitudeLabel, char const* longitudeLabel, TrackPoint& point);
+  void startOutput(); // writes the file's header, the home point (if known), and any aircraft positions so far
+  void outputHomePoint(); // (for GeoJSON, without a separator)
+  void outputPoint(Track& track, TrackPoint const& point);
+  void startTrack(Track& track);
+  void endTrack(Track& track);
+  void addLODPoint(unsigned level, TrackPoint const& point);
+  void outputLODPoints(unsigned level); // those that its simplifier has kept
+  void finishOutput();
+
+  // A part of the file that's written at the end (a simplified track, or the app's track).  Until then,
+  // it's written to a temporary file, with only "output"s buffer held in memory:
+  class DeferredSection {
+  public:
+    DeferredSection();
+    virtual ~DeferredSection();
+
+    int copyTo(OutputBuffer& out); // returns 1 iff it succeeds
+
+  public:
+    FILE* file; // NULL if no temporary file could be created (in which case "output" is kept in memory)
+    OutputBuffer output;
+  };
+
+  // A simplified version of the aircraft's track:
+  class LODLevel {
+  public:
+    LODLevel(double tolerance);
+
+  public:
+    TrackSimplifier simplifier;
+    DeferredSection section;
+    Track track;
+  };
+
+private:
+  int fFD;
+  int fFormat;
+  FieldDatabase* fFieldDatabase;
+  double fMinDistance;
+  OutputBuffer fOutput; // the file
+  OutputBuffer fPendingAircraftTrackOutput; // in memory, until "startOutput()"
+  DeferredSection fAppTrackSection;
+  Track fAircraftTrack, fAppTrack;
+  LODLevel** fLODLevels; // in order of increasing tolerance
+  unsigned fNumLODLevels;
+  int fHaveStartedOutput;
+  int fHaveHomePoint, fHomePointIsLate; // the latter if it was recorded after "startOutput()"
+  TrackPoint fHomePoint;
+  int fHaveNewAppPosition; // if an 'APP_GPS' record has arrived during the current row
+  int fDeferredSectionFailed;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Streaming (windowed) Douglas-Peucker simplification of a track, using bounded memory.
+    Implementation.
+*/
+
+#include "TrackSimplifier.hh"
+#include "GeoConstants.hh"
+
+#include <math.h>
+
+// The square of the distance from point P to the line segment AB:
+static double squaredDistanceToSegment(double px, double py, double ax, double ay, double bx, double by) {
+  double dx = bx - ax, dy = by - ay;
+  double lengthSquared = dx*dx + dy*dy;
+  double t = lengthSquared > 0.0 ? ((px - ax)*dx + (py - ay)*dy)/lengthSquared : 0.0;
+  if (t < 0.0) t = 0.0; else if (t > 1.0) t = 1.0;
+
+  double ex = ax + t*dx - px, ey = ay + t*dy - py;
+  return ex*ex + ey*ey;
+}
+
+TrackSimplifier::TrackSimplifier(double tolerance, unsigned windowSize)
+  : fTolerance(tolerance), fWindowSize(windowSize < 4 ? 4 : windowSize),
+    fWindowFill(0), fHaveOrigin(0), fOriginLatitude(0.0), fOriginLongitude(0.0), fMetersPerDegreeLongitude(0.0),
+    fOutputFill(0) {
+  fWindow = new TrackPoint[fWindowSize];
+  fX = new double[fWindowSize];
+  fY = new double[fWindowSize];
+  fKeep = new u_int8_t[fWindowSize];
+  fStack = new unsigned[2*fWindowSize];
+  fOutput = new TrackPoint[fWindowSize];
+}
+
+TrackSimplifier::~TrackSimplifier() {
+  delete[] fOutput;
+  delete[] fStack;
+  delete[] fKeep;
+  delete[] fY;
+  delete[] fX;
+  delete[] fWindow;
+}
+
+void TrackSimplifier::addPoint(TrackPoint const& point) {
+  if (!fHaveOrigin) {
+    // This is the first point.  Positions (in meters) are measured from it:
+    fHaveOrigin = 1;
+    fOriginLatitude = point.latitude;
+    fOriginLongitude = point.longitude;
+    fMetersPerDegreeLongitude = METERS_PER_DEGREE*cos(point.latitude*RADIANS_PER_DEGREE);
+  }
+
+  fWindow[fWindowFill] = point;
+  fX[fWindowFill] = (point.longitude - fOriginLongitude)*fMetersPerDegreeLongitude;
+  fY[fWindowFill] = (point.latitude - fOriginLatitude)*METERS_PER_DEGREE;
+  ++fWindowFill;
+
+  if (fWindowFill == 1) {
+    keepPoint(0); // the first point is always kept
+  } else if (fWindowFill == fWindowSize) {
+    simplifyWindow(0);
+  }
+}
+
+void TrackSimplifier::finish() {
+  if (fWindowFill >= 2) simplifyWindow(1);
+  fWindowFill = 0;
+}
+
+void TrackSimplifier::simplifyWindow(int isFinal) {
+  unsigned const n = fWindowFill;
+  double const toleranceSquared = fTolerance*fTolerance;
+
+  // Run the Douglas-Peucker algorithm over the window (using our own stack, rather than recursion):
+  for (unsigned i = 0; i < n; ++i) fKeep[i] = 0;
+  fKeep[0] = fKeep[n-1] = 1;
+  unsigned stackSize = 0;
+  fStack[stackSize++] = 0; fStack[stackSize++] = n-1;
+  while (stackSize > 0) {
+    unsigned last = fStack[--stackSize];
+    unsigned first = fStack[--stackSize];
+
+    // Find the point (between "first" and "last") that's farthest from the line between them:
+    double maxDistanceSquared = 0.0;
+    unsigned farthest = first;
+    for (unsigned i = first+1; i < last; ++i) {
+      double distanceSquared
+	= squaredDistanceToSegment(fX[i], fY[i], fX[first], fY[first], fX[last], fY[last]);
+      if (distanceSquared > maxDistanceSquared) {
+	maxDistanceSquared = distanceSquared;
+	farthest = i;
+      }
+    }
+
+    if (maxDistanceSquared > toleranceSquared) {
+      // Keep this point, and simplify each side of it:
+      fKeep[farthest] = 1;
+      if (farthest - first > 1) { fStack[stackSize++] = first; fStack[stackSize++] = farthest; }
+      if (last - farthest > 1) { fStack[stackSize++] = farthest; fStack[stackSize++] = last; }
+    }
+  }
+
+  // Output the kept points (after the first, which has already been output).  Unless this is the final
+  // window, we stop at the first kept point in the second half of the window, because the window's last
+  // point is kept only because the window ends there.  The following points then start the next window:
+  unsigned end = n-1;
+  if (!isFinal) {
+    for (end = n/2; !fKeep[end]; ++end) {}
+  }
+  for (unsigned i = 1; i <= end; ++i) {
+    if (fKeep[i]) keepPoint(i);
+  }
+
+  unsigned const numRemaining = n - end;
+  for (unsigned i = 0; i < numRemaining; ++i) {
+    fWindow[i] = fWindow[end+i];
+    fX[i] = fX[end+i];
+    fY[i] = fY[end+i];
+  }
+  fWindowFill = numRemaining;
+}
+
+void TrackSimplifier::keepPoint(unsigned windowIndex) {
+  fOutput[fOutputFill++] = fWindow[windowIndex];
+}
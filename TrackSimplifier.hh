@@ -0,0 +1,82 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Streaming (windowed) Douglas-Peucker simplification of a track, using bounded memory.
+    Header File.
+*/
+
+#ifndef _TRACK_SIMPLIFIER_HH
+#define _TRACK_SIMPLIFIER_HH
+
+#include <sys/types.h>
+
+// A position (e.g., from an 'OSD', 'HOME' or 'APP_GPS' record):
+class TrackPoint {
+public:
+  double latitude, longitude; // in degrees
+  double height; // in meters, relative to the take-off point; used only for the aircraft's positions
+  u_int64_t time; // in milliseconds since the Unix epoch (from "CUSTOM.updateTime"); 0 if unknown
+};
+
+#define DEFAULT_SIMPLIFIER_WINDOW_SIZE 512
+
+// Simplifies a track - given one point at a time - using the Douglas-Peucker algorithm, applied to a sliding
+// window of (at most "windowSize") points.  Each point that's removed is within "tolerance" (meters,
+// horizontally) of the line between the two kept points on either side of it.  The first and last points
+// are always kept.  Kept points are made available (in order) as soon as they're known to be kept:
+class TrackSimplifier {
+public:
+  TrackSimplifier(double tolerance, unsigned windowSize = DEFAULT_SIMPLIFIER_WINDOW_SIZE);
+  virtual ~TrackSimplifier();
+
+  void addPoint(TrackPoint const& point);
+  void finish(); // call after the last point
+
+  double tolerance() const { return fTolerance; }
+
+  // The kept points that have become available since "clearOutput()" was last called:
+  unsigned numOutputPoints() const { return fOutputFill; }
+  TrackPoint const& outputPoint(unsigned i) const { return fOutput[i]; }
+  void clearOutput() { fOutputFill = 0; }
+
+private:
+  void simplifyWindow(int isFinal);
+  void keepPoint(unsigned windowIndex);
+
+private:
+  double fTolerance;
+  unsigned fWindowSize;
+
+  // The window: points (with their positions in meters, relative to the first point of the track) that
+  // follow the most recently output point (which is the window's first point):
+  TrackPoint* fWindow;
+  double* fX; double* fY;
+  u_int8_t* fKeep;
+  unsigned* fStack; // used by "simplifyWindow()"
+  unsigned fWindowFill;
+  int fHaveOrigin;
+  double fOriginLatitude, fOriginLongitude, fMetersPerDegreeLongitude;
+
+  TrackPoint* fOutput;
+  unsigned fOutputFill;
+};
+
+#endif
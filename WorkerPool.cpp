@@ -0,0 +1,180 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A pool of worker processes, which perform a numbered set of tasks (e.g., parsing each file in a directory).
+    Implementation.
+*/
+
+#include "WorkerPool.hh"
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <atomic>
+#include <new>
+#include <vector>
+
+// State that's shared (in memory mapped by all of them) between the worker processes:
+class WorkerPoolSharedState {
+public:
+  std::atomic<unsigned> nextTask;
+};
+
+// The report (through the pipe) that a task has been done:
+class WorkerTaskReport {
+public:
+  u_int32_t taskIndex;
+  u_int32_t succeeded;
+};
+
+WorkerPool::WorkerPool()
+  : fNumTasks(0), fShared(NULL), fNumWorkers(0), fNumFailedTasks(0) {
+}
+
+WorkerPool::~WorkerPool() {
+}
+
+int WorkerPool::finishWorker(FILE* /*resultFile*/) {
+  return 1;
+}
+
+void WorkerPool::taskDone(unsigned /*taskIndex*/, int /*succeeded*/) {
+}
+
+int WorkerPool::collectResults(FILE* /*resultFile*/) {
+  return 1;
+}
+
+int WorkerPool::runTasks(unsigned numTasks, unsigned maxNumWorkers) {
+  fNumTasks = numTasks;
+  fNumWorkers = 0;
+  fNumFailedTasks = numTasks; // until they're reported as done
+  if (numTasks == 0) return 1;
+  unsigned const numWorkersWanted = numTasks < maxNumWorkers ? numTasks : maxNumWorkers;
+
+  void* sharedMemory = mmap(NULL, sizeof (WorkerPoolSharedState), PROT_READ|PROT_WRITE,
+			    MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+  if (sharedMemory == MAP_FAILED) {
+    fprintf(stderr, "mmap() failed: %s\n", strerror(errno));
+    return 0;
+  }
+  fShared = new (sharedMemory) WorkerPoolSharedState;
+  fShared->nextTask = 0;
+
+  int reportFDs[2];
+  if (pipe(reportFDs) != 0) {
+    fprintf(stderr, "pipe() failed: %s\n", strerror(errno));
+    fShared->~WorkerPoolSharedState();
+    munmap(sharedMemory, sizeof (WorkerPoolSharedState));
+    return 0;
+  }
+
+  // Start the workers, each with a temporary file for returning its results:
+  std::vector<FILE*> resultFiles;
+  std::vector<pid_t> pids;
+  int result = 1;
+  fflush(NULL); // so that the workers don't inherit buffered output
+  for (unsigned i = 0; i < numWorkersWanted; ++i) {
+    FILE* resultFile = tmpfile();
+    if (resultFile == NULL) {
+      fprintf(stderr, "tmpfile() failed: %s\n", strerror(errno));
+      break;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(reportFDs[0]);
+      for (unsigned j = 0; j < resultFiles.size(); ++j) fclose(resultFiles[j]);
+      runWorker(reportFDs[1], resultFile);
+    }
+
+    if (pid < 0) {
+      fprintf(stderr, "fork() failed: %s\n", strerror(errno));
+      fclose(resultFile);
+      break;
+    }
+    resultFiles.push_back(resultFile);
+    pids.push_back(pid);
+  }
+  fNumWorkers = pids.size();
+  close(reportFDs[1]); // so that we see the end of the pipe once every worker has exited
+
+  // Read the workers' reports, until they've all exited:
+  std::vector<char> isDone(numTasks, 0);
+  WorkerTaskReport report;
+  unsigned reportFill = 0;
+  while (1) {
+    ssize_t numBytesRead = read(reportFDs[0], (char*)&report + reportFill, sizeof report - reportFill);
+    if (numBytesRead < 0 && errno == EINTR) continue;
+    if (numBytesRead <= 0) break;
+
+    reportFill += numBytesRead;
+    if (reportFill < sizeof report) continue;
+    reportFill = 0;
+    if (report.taskIndex >= numTasks || isDone[report.taskIndex]) continue;
+
+    isDone[report.taskIndex] = 1;
+    if (report.succeeded) --fNumFailedTasks;
+    taskDone(report.taskIndex, report.succeeded);
+  }
+  close(reportFDs[0]);
+
+  // Wait for the workers, then collect their results:
+  for (unsigned i = 0; i < pids.size(); ++i) {
+    int status;
+    pid_t waitResult;
+    while ((waitResult = waitpid(pids[i], &status, 0)) < 0 && errno == EINTR) {}
+    if (waitResult < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      fprintf(stderr, "A worker process failed; the results of the tasks that it did are missing\n");
+      result = 0;
+    } else {
+      rewind(resultFiles[i]);
+      if (!collectResults(resultFiles[i])) result = 0;
+    }
+    fclose(resultFiles[i]);
+  }
+
+  fShared->~WorkerPoolSharedState();
+  munmap(sharedMemory, sizeof (WorkerPoolSharedState));
+  fShared = NULL;
+
+  return result && fNumFailedTasks == 0;
+}
+
+void WorkerPool::runWorker(int reportFD, FILE* resultFile) {
+  // Do tasks until there are none left:
+  unsigned taskIndex;
+  while ((taskIndex = fShared->nextTask++) < fNumTasks) {
+    WorkerTaskReport report;
+    report.taskIndex = taskIndex;
+    report.succeeded = doTask(taskIndex, resultFile);
+
+    // (A write of this size to a pipe is atomic, so the reports from different workers don't get mixed.)
+    ssize_t numBytesWritten;
+    while ((numBytesWritten = write(reportFD, &report, sizeof report)) < 0 && errno == EINTR) {}
+  }
+
+  fflush(stdout); // because we exit using "_exit()"
+  int const succeeded = finishWorker(resultFile) && fflush(resultFile) == 0 && !ferror(resultFile);
+  _exit(succeeded ? 0 : 1);
+}
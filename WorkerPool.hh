@@ -0,0 +1,77 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A pool of worker processes, which perform a numbered set of tasks (e.g., parsing each file in a directory).
+    Header File.
+*/
+
+#ifndef _WORKER_POOL_HH
+#define _WORKER_POOL_HH
+
+#include <stdio.h>
+#include <sys/types.h>
+
+class WorkerPoolSharedState; // forward
+
+// Performs tasks 0 through "numTasks"-1 in worker processes.  (A parser uses global state, so tasks that parse
+// are done in separate processes, rather than threads.)  Each worker takes the next task (from a counter in
+// shared memory) until there are none left.  As each task is done, the worker reports it (through a pipe) to
+// our process, which calls "taskDone()".  A worker can also write results to its own temporary file, which
+// is given to "collectResults()" once the worker has exited.
+//
+// A subclass defines the tasks by redefining "doTask()" (and, if needed, the other virtual functions):
+class WorkerPool {
+public:
+  virtual ~WorkerPool();
+
+  // Performs the tasks, in up to "maxNumWorkers" worker processes.  Returns 1 iff every task succeeded,
+  // and every worker's results were collected:
+  int runTasks(unsigned numTasks, unsigned maxNumWorkers);
+
+  // After "runTasks()":
+  unsigned numWorkers() const { return fNumWorkers; } // the number that were started
+  unsigned numFailedTasks() const { return fNumFailedTasks; }
+      // including tasks that were never reported as done (e.g., because their worker crashed)
+
+protected:
+  WorkerPool(); // abstract base class
+
+  // Called in a worker process, for each task.  Returns 1 iff the task succeeded:
+  virtual int doTask(unsigned taskIndex, FILE* resultFile) = 0;
+  // Called in a worker process, after its last task.  Returns 1 iff it succeeded:
+  virtual int finishWorker(FILE* resultFile);
+
+  // Called in our process, as each task is reported as done:
+  virtual void taskDone(unsigned taskIndex, int succeeded);
+  // Called in our process, once all of the workers have exited, with the (rewound) results file of each
+  // worker that exited successfully.  Returns 1 iff it succeeded:
+  virtual int collectResults(FILE* resultFile);
+
+private:
+  void runWorker(int reportFD, FILE* resultFile); // in a worker process; doesn't return
+
+private:
+  unsigned fNumTasks;
+  WorkerPoolSharedState* fShared; // while "runTasks()" is running
+  unsigned fNumWorkers, fNumFailedTasks;
+};
+
+#endif
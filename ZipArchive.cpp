@@ -0,0 +1,209 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A zip archive (e.g., a bundle of ".txt" files exported by the app), mapped into memory.
+    Implementation.
+*/
+
+#include "ZipArchive.hh"
+#include "InflateInputStream.hh"
+#include "DJITxtParser.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+
+#define ZIP_LOCAL_HEADER_SIGNATURE 0x04034B50
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_CENTRAL_HEADER_SIGNATURE 0x02014B50
+#define ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06054B50
+#define ZIP_END_OF_CENTRAL_DIRECTORY_SIZE 22
+#define ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06064B50
+#define ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE 0x07064B50
+#define ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE 20
+#define ZIP64_EXTRA_FIELD_ID 0x0001
+#define ZIP_MAX_COMMENT_SIZE 0xFFFF
+
+#define ZIP_METHOD_STORED 0
+#define ZIP_METHOD_DEFLATED 8
+#define ZIP_FLAG_ENCRYPTED 0x0001
+
+ZipArchive* ZipArchive::createNew(char const* fileName) {
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open \"%s\"\n", fileName);
+    return NULL;
+  }
+
+  struct stat sb;
+  if (fstat(fd, &sb) != 0 || sb.st_size < ZIP_END_OF_CENTRAL_DIRECTORY_SIZE) {
+    fprintf(stderr, "\"%s\" is not a zip archive\n", fileName);
+    close(fd);
+    return NULL;
+  }
+
+  u_int8_t* const mappedFile = (u_int8_t*)mmap(0, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping remains valid
+  if (mappedFile == MAP_FAILED) {
+    fprintf(stderr, "mmap() call failed: %s\n", strerror(errno));
+    return NULL;
+  }
+
+  ZipArchive* archive = new ZipArchive(mappedFile, sb.st_size);
+  if (!archive->readCentralDirectory()) {
+    fprintf(stderr, "\"%s\" is not a valid zip archive\n", fileName);
+    delete archive;
+    return NULL;
+  }
+
+  return archive;
+}
+
+int ZipArchive::isZipData(u_int8_t const* data, unsigned size) {
+  return size >= 4 && data[0] == 'P' && data[1] == 'K' && data[2] == 3 && data[3] == 4;
+}
+
+ZipArchive::ZipArchive(u_int8_t* mappedFile, u_int64_t fileSize)
+  : fMappedFile(mappedFile), fFileSize(fileSize) {
+}
+
+ZipArchive::~ZipArchive() {
+  munmap(fMappedFile, fFileSize);
+}
+
+int ZipArchive::readCentralDirectory() {
+  u_int8_t const* const end = &fMappedFile[fFileSize];
+  try {
+    // Find the 'end of central directory' record, searching back from the end (past any comment):
+    u_int8_t const* eocd = end - ZIP_END_OF_CENTRAL_DIRECTORY_SIZE;
+    u_int8_t const* const minEOCD = fFileSize > ZIP_END_OF_CENTRAL_DIRECTORY_SIZE + ZIP_MAX_COMMENT_SIZE
+      ? end - (ZIP_END_OF_CENTRAL_DIRECTORY_SIZE + ZIP_MAX_COMMENT_SIZE) : fMappedFile;
+    while (1) {
+      u_int8_t const* ptr = eocd;
+      if (getWord32LE(ptr, end) == ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE) break;
+      if (eocd == minEOCD) return 0;
+      --eocd;
+    }
+
+    u_int8_t const* ptr = eocd + 10;
+    u_int64_t numEntries = get2BytesLE(ptr, end);
+    (void)getWord32LE(ptr, end); // the size of the central directory
+    u_int64_t centralDirectoryOffset = getWord32LE(ptr, end);
+
+    if ((numEntries == 0xFFFF || centralDirectoryOffset == 0xFFFFFFFF)
+	&& eocd - fMappedFile >= ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE) {
+      // This is a 'zip64' archive.  The real values are in the 'zip64 end of central directory' record:
+      ptr = eocd - ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE;
+      if (getWord32LE(ptr, end) == ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE) {
+	ptr += 4; // disk number
+	u_int64_t zip64EOCDOffset = getWord64LE(ptr, end);
+	if (zip64EOCDOffset > fFileSize) return 0;
+	ptr = &fMappedFile[zip64EOCDOffset];
+	if (getWord32LE(ptr, end) != ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE) return 0;
+	ptr += 8 + 2 + 2 + 4 + 4 + 8; // size, versions, disk numbers, entries on this disk
+	numEntries = getWord64LE(ptr, end);
+	(void)getWord64LE(ptr, end); // the size of the central directory
+	centralDirectoryOffset = getWord64LE(ptr, end);
+      }
+    }
+    if (centralDirectoryOffset > fFileSize) return 0;
+
+    // Read each entry in the central directory:
+    ptr = &fMappedFile[centralDirectoryOffset];
+    for (u_int64_t i = 0; i < numEntries; ++i) {
+      if (getWord32LE(ptr, end) != ZIP_CENTRAL_HEADER_SIGNATURE) return 0;
+
+      ZipMember member;
+      ptr += 4; // versions
+      member.flags = get2BytesLE(ptr, end);
+      member.compressionMethod = get2BytesLE(ptr, end);
+      ptr += 4; // modification time and date
+      member.crc = getWord32LE(ptr, end);
+      member.compressedSize = getWord32LE(ptr, end);
+      member.uncompressedSize = getWord32LE(ptr, end);
+      unsigned nameLength = get2BytesLE(ptr, end);
+      unsigned extraFieldLength = get2BytesLE(ptr, end);
+      unsigned commentLength = get2BytesLE(ptr, end);
+      ptr += 2 + 2 + 4; // disk number, and attributes
+      member.localHeaderOffset = getWord32LE(ptr, end);
+      if (ptr + nameLength + extraFieldLength + commentLength > end) return 0;
+      member.name.assign((char const*)ptr, nameLength);
+      ptr += nameLength;
+
+      // Any of the sizes (or the offset) that didn't fit are in a 'zip64' extra field (in this order):
+      u_int8_t const* const extraFieldEnd = ptr + extraFieldLength;
+      while (ptr + 4 <= extraFieldEnd) {
+	unsigned id = get2BytesLE(ptr, extraFieldEnd);
+	unsigned length = get2BytesLE(ptr, extraFieldEnd);
+	u_int8_t const* const fieldEnd = ptr + length;
+	if (fieldEnd > extraFieldEnd) break;
+	if (id == ZIP64_EXTRA_FIELD_ID) {
+	  if (member.uncompressedSize == 0xFFFFFFFF) member.uncompressedSize = getWord64LE(ptr, fieldEnd);
+	  if (member.compressedSize == 0xFFFFFFFF) member.compressedSize = getWord64LE(ptr, fieldEnd);
+	  if (member.localHeaderOffset == 0xFFFFFFFF) member.localHeaderOffset = getWord64LE(ptr, fieldEnd);
+	}
+	ptr = fieldEnd;
+      }
+      ptr = extraFieldEnd + commentLength;
+
+      fMembers.push_back(member);
+    }
+  } catch (int /*e*/) {
+    return 0;
+  }
+
+  return 1;
+}
+
+InputStream* ZipArchive::openMember(unsigned i) const {
+  ZipMember const& member = fMembers[i]; // alias
+  if ((member.flags&ZIP_FLAG_ENCRYPTED) != 0
+      || (member.compressionMethod != ZIP_METHOD_STORED && member.compressionMethod != ZIP_METHOD_DEFLATED)) {
+    fprintf(stderr, "\"%s\" (in the zip archive) is encrypted, or compressed using an unsupported method (%u)\n",
+	    member.name.c_str(), member.compressionMethod);
+    return NULL;
+  }
+
+  // The member's data follows its 'local header' (whose name and extra field lengths may differ from
+  // those in the central directory):
+  u_int8_t const* const end = &fMappedFile[fFileSize];
+  u_int8_t const* data;
+  try {
+    if (member.localHeaderOffset > fFileSize) throw END_OF_DATA;
+    u_int8_t const* ptr = &fMappedFile[member.localHeaderOffset];
+    if (getWord32LE(ptr, end) != ZIP_LOCAL_HEADER_SIGNATURE) throw END_OF_DATA;
+    ptr += 22;
+    unsigned nameLength = get2BytesLE(ptr, end);
+    unsigned extraFieldLength = get2BytesLE(ptr, end);
+    data = ptr + nameLength + extraFieldLength;
+    if (data > end || member.compressedSize > (u_int64_t)(end - data)) throw END_OF_DATA;
+  } catch (int /*e*/) {
+    fprintf(stderr, "\"%s\" (in the zip archive) is bad\n", member.name.c_str());
+    return NULL;
+  }
+
+  return InflateInputStream::createNew(data, member.compressedSize,
+				       member.compressionMethod == ZIP_METHOD_DEFLATED, member.crc);
+}
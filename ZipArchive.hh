@@ -0,0 +1,71 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A zip archive (e.g., a bundle of ".txt" files exported by the app), mapped into memory.
+    Header File.
+*/
+
+#ifndef _ZIP_ARCHIVE_HH
+#define _ZIP_ARCHIVE_HH
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+class InputStream; // forward
+
+class ZipMember {
+public:
+  std::string name;
+  u_int16_t flags, compressionMethod;
+  u_int32_t crc;
+  u_int64_t compressedSize, uncompressedSize;
+  u_int64_t localHeaderOffset;
+};
+
+class ZipArchive {
+public:
+  static ZipArchive* createNew(char const* fileName);
+      // returns NULL (after printing an error message) if the file can't be opened, or is bad
+
+  static int isZipData(u_int8_t const* data, unsigned size);
+
+  virtual ~ZipArchive(); // unmaps the file
+
+  unsigned numMembers() const { return fMembers.size(); }
+  ZipMember const& member(unsigned i) const { return fMembers[i]; }
+
+  InputStream* openMember(unsigned i) const;
+      // returns a stream of the member's (decompressed) data, or NULL (after printing an error message)
+      // if it's compressed (or encrypted) in a way that we don't support
+
+private:
+  ZipArchive(u_int8_t* mappedFile, u_int64_t fileSize); // called only by "createNew()"
+  int readCentralDirectory(); // returns 1 iff it succeeds
+
+private:
+  u_int8_t* fMappedFile;
+  u_int64_t fFileSize;
+  std::vector<ZipMember> fMembers;
+};
+
+#endif
@@ -21,117 +21,981 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DJITxtParser.hh"
+#include "DJITxtFile.hh"
+#include "ParquetWriter.hh"
+#include "FlightCache.hh"
+#include "ResultCache.hh"
+#include "BatchProcessor.hh"
+#include "InflateInputStream.hh"
+#include "ZipArchive.hh"
+#include "OutputCompressor.hh"
+#include "TrackExporter.hh"
+#include "FleetAggregator.hh"
+#include "FleetCatalog.hh"
+#include "FleetGeofence.hh"
+#include "FlightSegmenter.hh"
+#include "LogExtractor.hh"
+#include "WorkerPool.hh"
 
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
-#include <sys/mman.h>
 #include <errno.h>
 
-#define OLD_HEADER_SIZE 12
-#define NEW_HEADER_SIZE 100
-#define MIN_RECORD_SIZE 3 // type+0-length+FF
+static void usage(char const* progName) {
+  fprintf(stderr, "Usage: %s [options] <txtFileName>\t(\"-\" for 'stdin'; it may be gzip-compressed, or a zip archive)\n", progName);
+  fprintf(stderr, "   or: %s [options] --batch <outputDirectory> <inputDirectory>\n", progName);
+  fprintf(stderr, "   or: %s [options] --aggregate <spec> <inputDirectory>\n", progName);
+  fprintf(stderr, "   or: %s [options] --catalog <catalogFile> <inputDirectory>\n", progName);
+  fprintf(stderr, "   or: %s --query <query> <catalogFile>\n", progName);
+  fprintf(stderr, "   or: %s [options] --geofence <zonesFile> <txtFileName or inputDirectory>\n", progName);
+  fprintf(stderr, "   or: %s [options] --extract <outputTxtFileName> --range <range> <txtFileName>\n", progName);
+  fprintf(stderr, "Options:\n");
+  fprintf(stderr, "\t-j <archiveFileName>\toutput embedded JPEG images to this 'tar' archive\n");
+  fprintf(stderr, "\t\t\t\t(default: <txtFileName>, with the \".txt\" suffix replaced by \".jpg.tar\")\n");
+  fprintf(stderr, "\t-g\t\t\tgeotag each JPEG image (in the archive) with the aircraft's position\n");
+  fprintf(stderr, "\t-s\t\t\tparse records sequentially (rather than in a pipeline of threads)\n");
+  fprintf(stderr, "\t--format csv|changes|jsonl|parquet|none\toutput format (to 'stdout'); default: csv\n");
+  fprintf(stderr, "\t\t\t\t(\"changes\" is CSV lines \"row,column,value\", for values that differ from the previous row's;\n");
+  fprintf(stderr, "\t\t\t\t\"jsonl\" is one JSON object per row)\n");
+  fprintf(stderr, "\t--compress gzip[:<level>]|lz4\tcompress the (CSV or JSON Lines) output, in a separate thread;\n");
+  fprintf(stderr, "\t\t\t\t<level> is 1 (fastest) to 9 (smallest); default: 6\n");
+  fprintf(stderr, "\t--streams <fileNamePrefix>\talso output every record of each type to its own CSV (or, with\n");
+  fprintf(stderr, "\t\t\t\t--format jsonl, JSON Lines) file, named <fileNamePrefix><recordType>.csv (or .jsonl)\n");
+  fprintf(stderr, "\t\t\t\t(e.g., with the prefix \"FLY001.\": \"FLY001.GIMBAL.csv\")\n");
+  fprintf(stderr, "\t--track <fileName>\talso output the flight's track (aircraft and app positions, and the home point)\n");
+  fprintf(stderr, "\t\t\t\tto this file, as GPX, KML or GeoJSON (from its suffix: .gpx, .kml or .geojson); may be repeated\n");
+  fprintf(stderr, "\t--track-min-distance <meters>\tdecimate the track, to positions at least this far apart\n");
+  fprintf(stderr, "\t--track-lod <meters>[,<meters>...]\talso output simplified versions of the aircraft's track, for\n");
+  fprintf(stderr, "\t\t\t\teach of these tolerances (e.g., for different map zoom levels)\n");
+  fprintf(stderr, "\t--segments <fileName>\talso output an index of the flight's segments (motors on, airborne, going home,\n");
+  fprintf(stderr, "\t\t\t\tlanding, and each flight mode) to this file, as CSV: each segment's rows, byte positions and times\n");
+  fprintf(stderr, "\t-c <cacheFileName>\talso write the parsed flight to this (memory-mappable) 'flight cache' file.\n");
+  fprintf(stderr, "\t\t\t\tIf it's already up-to-date, and the output format is parquet or none, the file isn't parsed again\n");
+  fprintf(stderr, "\t--cache-dir <directory>\tkeep a copy of each output (and JPEG archive) in this directory (indexed by a hash of\n");
+  fprintf(stderr, "\t\t\t\tthe input file); if the input file has been seen before, output the copy instead of parsing the file\n");
+  fprintf(stderr, "\t--batch <outputDirectory>\tprocess each new or changed \".txt\" file in <inputDirectory>, writing\n");
+  fprintf(stderr, "\t\t\t\tits output (and JPEG archive) to <outputDirectory>, which also holds a manifest of the results\n");
+  fprintf(stderr, "\t--aggregate <spec>\taggregate a field over every \".txt\" file in <inputDirectory>, outputting\n");
+  fprintf(stderr, "\t\t\t\tonly the result (as CSV).  <spec> is \"<function>[(<field>)][ by <keyField>]\", where\n");
+  fprintf(stderr, "\t\t\t\t<function> is count, sum, mean (of each flight's final value), min, max, or time (in seconds)\n");
+  fprintf(stderr, "\t\t\t\t(e.g., \"sum(DETAILS.totalTime) by DETAILS.aircraftSn\" or \"time by OSD.flycState\")\n");
+  fprintf(stderr, "\t--catalog <catalogFile>\tbring this (memory-mappable) catalog of the flights in <inputDirectory> - their\n");
+  fprintf(stderr, "\t\t\t\tserial numbers, time, location, total time, maximum height and track - up to date\n");
+  fprintf(stderr, "\t--query <query>\t\toutput (as CSV) the flights in <catalogFile> that match <query>: space-separated\n");
+  fprintf(stderr, "\t\t\t\tterms \"aircraft=<sn>\", \"battery=<sn>\", \"camera=<sn>\", \"from=<time>\", \"to=<time>\",\n");
+  fprintf(stderr, "\t\t\t\t\"month=<YYYY-MM>\", \"near=<latitude>,<longitude>,<km>\" (of the flight's start) or\n");
+  fprintf(stderr, "\t\t\t\t\"over=<latitude>,<longitude>,<km>\" (of any part of its track; the time range then applies\n");
+  fprintf(stderr, "\t\t\t\tto its passage) (times are UTC \"YYYY-MM-DD[THH:MM[:SS]]\")\n");
+  fprintf(stderr, "\t--geofence <zonesFile>\toutput (as CSV) only each visit - entry and exit times, and maximum height - to the\n");
+  fprintf(stderr, "\t\t\t\tpolygonal zones in <zonesFile> (one per line: \"<name> <latitude>,<longitude> ...\") by the\n");
+  fprintf(stderr, "\t\t\t\tflight, or by each flight in <inputDirectory>\n");
+  fprintf(stderr, "\t--extract <outputTxtFileName>\twrite only part of the flight - the rows in the --range - as a new \".txt\" file\n");
+  fprintf(stderr, "\t\t\t\t(e.g., to send an excerpt of a long log); <txtFileName> must be an uncompressed \".txt\" file\n");
+  fprintf(stderr, "\t--range <range>\t\tthe rows to extract: \"<kind>[:<n>]\" - the <n>th (default: first) segment of this kind\n");
+  fprintf(stderr, "\t\t\t\t(motors, airborne, goHome, landing or mode; see --segments) - or \"<fromTime>,<toTime>\"\n");
+  fprintf(stderr, "\t\t\t\t(UTC \"YYYY-MM-DD[THH:MM[:SS]]\"; <toTime> is exclusive)\n");
+  fprintf(stderr, "\t--follow\t\tthe file is still being written; keep parsing (and outputting CSV rows) as it grows,\n");
+  fprintf(stderr, "\t\t\t\tuntil it's completed\n");
+  fprintf(stderr, "\t-P <numProcesses>\t(with --batch, --aggregate, --catalog, --geofence, or a zip archive) the number of files to process at once\n");
+  fprintf(stderr, "\t\t\t\t(default: the number of CPUs)\n");
+}
+
+#define OUTPUT_FORMAT_CSV 0
+#define OUTPUT_FORMAT_PARQUET 1
+#define OUTPUT_FORMAT_NONE 2
+#define OUTPUT_FORMAT_CHANGES 3 // 'long' CSV, with only the values that have changed
+#define OUTPUT_FORMAT_JSONL 4 // JSON Lines (one JSON object per row)
+
+// Options (set by "main()"):
+static char const* jpgArchiveFileNameOption = NULL;
+static int parseInParallel = 1;
+static int outputFormat = OUTPUT_FORMAT_CSV;
+static char const* cacheFileName = NULL;
+static char const* cacheDirectoryName = NULL;
+static int followInput = 0;
+static unsigned numProcesses = 0; // for "--batch", "--aggregate", "--catalog", "--geofence", or a zip archive; if 0, the number of CPUs
+static int compressionMethod = COMPRESSION_NONE;
+static int compressionLevel = -1; // the default
+static char const* recordStreamsPrefix = NULL;
+static std::vector<char const*> trackFileNames;
+static double trackMinDistance = 0.0;
+static std::vector<double> trackLODTolerances;
+static char const* segmentIndexFileName = NULL;
+static FlightSegmenter* flightSegmenter = NULL; // if "segmentIndexFileName" was given
+
+// The kind of row output (if any) that the parser produces:
+static int rowOutput() {
+  switch (outputFormat) {
+    case OUTPUT_FORMAT_CSV: return ROW_OUTPUT_CSV;
+    case OUTPUT_FORMAT_CHANGES: return ROW_OUTPUT_CSV_CHANGES;
+    case OUTPUT_FORMAT_JSONL: return ROW_OUTPUT_JSON_LINES;
+    default: return ROW_OUTPUT_NONE;
+  }
+}
+
+// The suffix of an output file name (or result cache entry), e.g. ".csv.gz", or NULL if there's no output:
+static char const* outputSuffix() {
+  static std::string suffix; // formed once (after the options have been set)
+
+  if (outputFormat == OUTPUT_FORMAT_NONE) return NULL;
+  if (suffix.empty()) {
+    suffix = outputFormat == OUTPUT_FORMAT_PARQUET ? ".parquet"
+      : outputFormat == OUTPUT_FORMAT_CHANGES ? ".changes.csv"
+      : outputFormat == OUTPUT_FORMAT_JSONL ? ".jsonl" : ".csv";
+    suffix += OutputCompressor::fileNameSuffix(compressionMethod);
+  }
+  return suffix.c_str();
+}
+
+// The type of a result cache entry for our output (e.g., "csv"), naming the options that affect its contents
+// (e.g., "z9.csv.gz" for CSV compressed at level 9):
+static std::string resultCacheSuffix() {
+  std::string suffix = outputSuffix() + 1; // without the initial "."
+  if (compressionMethod != COMPRESSION_NONE && compressionLevel >= 0) {
+    char levelPrefix[20];
+    snprintf(levelPrefix, sizeof levelPrefix, "z%d.", compressionLevel);
+    suffix = levelPrefix + suffix;
+  }
+  return suffix;
+}
+
+// The same, for the JPEG archive:
+static char const* jpgArchiveResultCacheSuffix() {
+  extern int geotagJPGFiles;
+  return geotagJPGFiles ? "geotagged.jpg.tar" : "jpg.tar";
+}
+
+// Creates a parser whose CSV output (if any) goes to "outputFD".  If that output is to be compressed,
+// "compressor" is set to a new "OutputCompressor" (to be deleted after the parser); otherwise, to NULL.
+// Returns NULL if a track file couldn't be created:
+static DJITxtParser* createParser(int outputFD, OutputCompressor*& compressor) {
+  int const outputRows = rowOutput();
+  compressor = outputRows != ROW_OUTPUT_NONE && compressionMethod != COMPRESSION_NONE
+    ? OutputCompressor::createNew(outputFD, compressionMethod, compressionLevel)
+    : NULL;
+
+  DJITxtParser* parser = DJITxtParser::createNew(outputRows, outputFD, compressor);
+  if (recordStreamsPrefix != NULL) {
+    // (The streams are JSON Lines if the rows are; otherwise CSV.)
+    std::string suffix = std::string(outputFormat == OUTPUT_FORMAT_JSONL ? ".jsonl" : ".csv")
+      + OutputCompressor::fileNameSuffix(compressionMethod);
+    parser->enableRecordStreams(recordStreamsPrefix, suffix.c_str(), compressionMethod, compressionLevel);
+  }
+  for (unsigned i = 0; i < trackFileNames.size(); ++i) {
+    char const* trackFileName = trackFileNames[i];
+    if (!parser->enableTrackExport(trackFileName, TrackExporter::formatFromFileName(trackFileName), trackMinDistance,
+				   trackLODTolerances.data(), trackLODTolerances.size())) {
+      delete parser;
+      delete compressor; compressor = NULL;
+      return NULL;
+    }
+  }
+  if (flightSegmenter != NULL) (void)parser->addFlightObserver(flightSegmenter);
+
+  return parser;
+}
+
+// Returns 1 iff "fileName" names something (e.g., "-" for 'stdin', or a pipe) that can only be read
+// sequentially.  If so, "fd" is set to a descriptor for reading it:
+static int isStream(char const* fileName, int& fd) {
+  if (strcmp(fileName, "-") == 0) {
+    fd = 0;
+    return 1;
+  }
+
+  struct stat sb;
+  if (stat(fileName, &sb) != 0 || S_ISREG(sb.st_mode)) return 0;
+  fd = open(fileName, O_RDONLY);
+  return fd >= 0;
+}
+
+// Returns the name of an output file for "inputFileName": its base name, without any ".txt" (or ".txt.gz")
+// suffix, plus "suffix", in the directory "outputDirectoryName" (or the current directory, if NULL):
+static std::string outputFileName(char const* inputFileName, char const* outputDirectoryName, char const* suffix) {
+  char const* baseName = strrchr(inputFileName, '/');
+  std::string result = baseName == NULL ? inputFileName : baseName+1;
+  if (result.size() > 3 && strcasecmp(&result[result.size()-3], ".gz") == 0) result.resize(result.size()-3);
+  if (result.size() > 4 && strcasecmp(&result[result.size()-4], ".txt") == 0) result.resize(result.size()-4);
+
+  if (outputDirectoryName != NULL) result = std::string(outputDirectoryName) + "/" + result;
+  return result + suffix;
+}
+
+// Unless we were given a name for the JPEG image archive, name it after the input file
+// (in the current directory), so that logs processed in the same directory don't collide:
+static void setJPGArchiveFileName(char const* inputFileName, char const* outputDirectoryName) {
+  extern char const* jpgArchiveFileName;
+  static std::string defaultJPGArchiveFileName;
+
+  if (jpgArchiveFileNameOption != NULL) {
+    jpgArchiveFileName = jpgArchiveFileNameOption;
+  } else if (strcmp(inputFileName, "-") != 0) {
+    defaultJPGArchiveFileName = outputFileName(inputFileName, outputDirectoryName, ".jpg.tar");
+    jpgArchiveFileName = defaultJPGArchiveFileName.c_str();
+  }
+}
+
+// Parses input that's read sequentially - from "input" (if not NULL), otherwise from "inputFD" -
+// writing the output to "outputFD".  If "detailsInput" is not NULL, it's another reading of the same input (e.g., of
+// a compressed file, decompressed again), from which the 'details' area is parsed first, so that (as when the file
+// is mapped) every row gets the 'DETAILS' fields.  Returns 0 iff it succeeds:
+static int parseSequentially(InputStream* input, int inputFD, int outputFD, InputStream* detailsInput = NULL) {
+  OutputCompressor* compressor;
+  DJITxtParser* parser = createParser(outputFD, compressor);
+  if (parser == NULL) return 1;
+  int const needTable = outputFormat == OUTPUT_FORMAT_PARQUET;
+  if (needTable) parser->enableFlightTable();
+  u_int64_t const recordAreaEnd = detailsInput != NULL ? parser->parseDetailsAreaOfStream(*detailsInput) : 0;
+  int result = (input != NULL ? parser->parseStream(*input, recordAreaEnd) : parser->parseFileDescriptor(inputFD))
+    ? 0 : 1;
+
+  FlightTable* table = needTable ? parser->detachFlightTable() : NULL;
+  delete parser;
+  delete compressor;
+  if (table != NULL) {
+    ParquetWriter* writer = ParquetWriter::createNew(outputFD);
+    if (!writer->writeTable(*table)) {
+      fprintf(stderr, "Failed to write Parquet output\n");
+      result = 1;
+    }
+    delete writer;
+    delete table;
+  }
+
+  return result;
+}
+
+// Processes one member of a zip archive, writing the output to its own file.  Returns 0 iff it succeeds:
+static int processZipMember(ZipArchive const& archive, unsigned memberIndex, char const* outputDirectoryName) {
+  char const* memberName = archive.member(memberIndex).name.c_str();
+  setJPGArchiveFileName(memberName, outputDirectoryName);
+
+  std::string outputName;
+  int outputFD = -1;
+  if (outputFormat != OUTPUT_FORMAT_NONE) {
+    outputName = outputFileName(memberName, outputDirectoryName, outputSuffix());
+    outputFD = open(outputName.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (outputFD < 0) {
+      fprintf(stderr, "Failed to open \"%s\": %s\n", outputName.c_str(), strerror(errno));
+      return 1;
+    }
+  }
+
+  InputStream* detailsInput = archive.openMember(memberIndex);
+  InputStream* input = detailsInput == NULL ? NULL : archive.openMember(memberIndex);
+  int result = input == NULL ? 1 : parseSequentially(input, -1, outputFD, detailsInput);
+  delete input; delete detailsInput;
+
+  if (outputFD >= 0 && close(outputFD) != 0) result = 1;
+  if (result == 0 && outputFD >= 0) fprintf(stderr, "Wrote \"%s\" (from \"%s\")\n", outputName.c_str(), memberName);
+  return result;
+}
+
+// Processes members of a zip archive, in worker processes (see "WorkerPool.hh"):
+class ZipMemberPool: public WorkerPool {
+public:
+  ZipMemberPool(ZipArchive const& archive, std::vector<unsigned> const& memberIndexes, char const* outputDirectoryName);
+
+private: // redefined virtual functions:
+  virtual int doTask(unsigned taskIndex, FILE* resultFile);
+
+private:
+  ZipArchive const& fArchive;
+  std::vector<unsigned> const& fMemberIndexes;
+  char const* fOutputDirectoryName;
+};
+
+ZipMemberPool::ZipMemberPool(ZipArchive const& archive, std::vector<unsigned> const& memberIndexes,
+			     char const* outputDirectoryName)
+  : fArchive(archive), fMemberIndexes(memberIndexes), fOutputDirectoryName(outputDirectoryName) {
+}
+
+int ZipMemberPool::doTask(unsigned taskIndex, FILE* /*resultFile*/) {
+  return processZipMember(fArchive, fMemberIndexes[taskIndex], fOutputDirectoryName) == 0;
+}
+
+// Processes each ".txt" file in a zip archive (e.g., a bundle exported by the app).  If there's just one,
+// its output goes to "outputFD".  Otherwise, each one's output goes to its own file (named after it), and
+// up to "numProcesses" of them are processed (in separate processes) at once.  Returns 0 iff all succeed:
+static int processZipArchive(ZipArchive const& archive, char const* outputDirectoryName, int outputFD) {
+  std::vector<unsigned> txtMembers;
+  for (unsigned i = 0; i < archive.numMembers(); ++i) {
+    std::string const& name = archive.member(i).name;
+    if (name.size() > 4 && strcasecmp(&name[name.size()-4], ".txt") == 0) txtMembers.push_back(i);
+  }
+  if (txtMembers.empty()) {
+    fprintf(stderr, "The zip archive contains no \".txt\" files\n");
+    return 1;
+  }
+
+  if (txtMembers.size() == 1) {
+    setJPGArchiveFileName(archive.member(txtMembers[0]).name.c_str(), outputDirectoryName);
+    InputStream* detailsInput = archive.openMember(txtMembers[0]);
+    InputStream* input = detailsInput == NULL ? NULL : archive.openMember(txtMembers[0]);
+    int result = input == NULL ? 1 : parseSequentially(input, -1, outputFD, detailsInput);
+    delete input; delete detailsInput;
+    return result;
+  }
+
+  if (recordStreamsPrefix != NULL || !trackFileNames.empty() || segmentIndexFileName != NULL) {
+    fprintf(stderr, "--streams, --track and --segments can't be used with a zip archive that contains more than one \".txt\" file\n");
+    return 1;
+  }
+
+  // Each process has its own parser, which uses global state (e.g., "fileVersionNumber"), so
+  // members are processed in separate processes, rather than threads:
+  ZipMemberPool pool(archive, txtMembers, outputDirectoryName);
+  return pool.runTasks(txtMembers.size(), numProcesses) ? 0 : 1;
+}
+
+// Processes one ".txt" file, writing the output to "outputFD".  If "outputDirectoryName" is not NULL,
+// the JPEG image archive (if any) is written there.  Returns 0 iff it succeeds:
+static int processFile(char const* fileName, char const* outputDirectoryName, int outputFD) {
+  setJPGArchiveFileName(fileName, outputDirectoryName);
+
+  if (followInput) {
+    // The file is still growing, so parse it incrementally, outputting rows as they become available:
+    OutputCompressor* compressor; // not used, because we don't compress output here
+    DJITxtParser* parser = createParser(outputFD, compressor);
+    if (parser == NULL) return 1;
+    int result = parser->followFile(fileName) ? 0 : 1;
+    delete parser;
+
+    return result;
+  }
 
-u_int32_t fileVersionNumber;
+  // Check whether the input is compressed, by looking at its first few bytes:
+  int inputFD;
+  int const inputIsStream = isStream(fileName, inputFD);
+  if (!inputIsStream) inputFD = open(fileName, O_RDONLY); // if this fails, "DJITxtFile::createNew()" will report it
+  InputStream* input = NULL;
+  u_int8_t magic[4];
+  unsigned magicSize = 0;
+  if (inputFD >= 0) {
+    struct stat sb;
+    if (fstat(inputFD, &sb) == 0 && S_ISREG(sb.st_mode)) {
+      ssize_t numBytesRead = pread(inputFD, magic, sizeof magic, lseek(inputFD, 0, SEEK_CUR));
+      if (numBytesRead > 0) magicSize = numBytesRead;
+    } else {
+      // We can't read a pipe twice, so begin streaming it now, and peek at the start of the stream:
+      input = InputStream::createNew(inputFD);
+      u_int8_t const* data = input->beginRead(magicSize, sizeof magic);
+      if (magicSize > sizeof magic) magicSize = sizeof magic;
+      if (magicSize > 0) memcpy(magic, data, magicSize);
+    }
+  }
+  int const isZip = ZipArchive::isZipData(magic, magicSize);
+  int const isGzip = InflateInputStream::isGzipData(magic, magicSize);
+
+  if (inputIsStream || isZip || isGzip) {
+    // We can't map the input into memory (as a '.txt' file), so read it sequentially instead.
+    // (We can't hash it in advance either, so the caches can't be used.)
+    int result = 1;
+    if (cacheFileName != NULL || cacheDirectoryName != NULL) {
+      fprintf(stderr, "-c and --cache-dir can't be used with input that's compressed, or from 'stdin' or a pipe\n");
+    } else if (isZip) {
+      if (inputIsStream) {
+	fprintf(stderr, "A zip archive can't be read from 'stdin' or a pipe\n");
+      } else {
+	ZipArchive* archive = ZipArchive::createNew(fileName);
+	if (archive != NULL) result = processZipArchive(*archive, outputDirectoryName, outputFD);
+	delete archive;
+      }
+    } else {
+      InputStream* detailsInput = NULL;
+      int detailsInputFD = -1;
+      if (isGzip) {
+	if (input == NULL) {
+	  // The input is a file, so we can decompress it twice: first just to parse its 'details' area (at the end),
+	  // then to parse its records:
+	  detailsInputFD = open(fileName, O_RDONLY);
+	  if (detailsInputFD >= 0) detailsInput = InflateInputStream::createNew(InputStream::createNew(detailsInputFD));
+	  input = InputStream::createNew(inputFD);
+	}
+	// Decompress the input in a separate thread, while we parse it:
+	input = InflateInputStream::createNew(input);
+      }
+      result = parseSequentially(input, inputFD, outputFD, detailsInput);
+      delete detailsInput;
+      if (detailsInputFD >= 0) close(detailsInputFD);
+    }
+
+    delete input;
+    if (inputFD > 0/*not 'stdin'*/) close(inputFD);
+    return result;
+  }
+  if (inputFD >= 0) close(inputFD);
+
+  DJITxtFile* file = DJITxtFile::createNew(fileName);
+  if (file == NULL) return 1;
+  char const* outputFormatName = outputFormat == OUTPUT_FORMAT_PARQUET ? "Parquet"
+    : outputFormat == OUTPUT_FORMAT_JSONL ? "JSON Lines" : "CSV";
+
+  // If we've already produced output for this file (i.e., for a file with the same contents), then
+  // just output that again.  Otherwise, output to a new cache entry (which is then copied to "outputFD").
+  // The JPEG archive is cached the same way.  (But the flight cache file can be written only by parsing, so
+  // with "-c", we always parse.):
+  extern char const* jpgArchiveFileName;
+  int const finalOutputFD = outputFD;
+  ResultCache* resultCache = NULL;
+  if (cacheDirectoryName != NULL && outputFormat != OUTPUT_FORMAT_NONE) {
+    resultCache = ResultCache::createNew(cacheDirectoryName);
+    if (resultCache != NULL) {
+      std::string const suffix = resultCacheSuffix();
+      if (cacheFileName == NULL
+	  && resultCache->lookupFile(*file, jpgArchiveResultCacheSuffix(), jpgArchiveFileName)
+	  && resultCache->lookup(*file, suffix.c_str(), outputFD)) {
+	delete resultCache;
+	delete file;
+	fprintf(stderr, "Done writing %s.\n", outputFormatName);
+	return 0;
+      }
+
+      int fd = resultCache->beginResult(*file, suffix.c_str());
+      if (fd >= 0) outputFD = fd;
+    }
+  }
+
+  // If we have an up-to-date flight cache file (and don't need to output CSV), use it instead of parsing:
+  FlightTable* table = NULL;
+  if (cacheFileName != NULL && rowOutput() == ROW_OUTPUT_NONE) {
+    table = FlightCache::open(cacheFileName, file);
+    if (table != NULL) fprintf(stderr, "Using the flight cache file \"%s\"\n", cacheFileName);
+  }
+
+  int result = 0, outputFailed = 0;
+  int jpegArchiveResult = -1; // (unknown, unless we parse the file)
+  if (table == NULL) {
+    // Create a parser, and use it to parse the file:
+    OutputCompressor* compressor;
+    DJITxtParser* parser = createParser(outputFD, compressor);
+    if (parser == NULL) { // (we have no "resultCache", because "--track" can't be used with "--cache-dir")
+      delete file;
+      return 1;
+    }
+    int const needTable = outputFormat == OUTPUT_FORMAT_PARQUET || cacheFileName != NULL;
+    if (needTable) parser->enableFlightTable();
+    parser->parseFile(*file, parseInParallel);
+
+    if (needTable) table = parser->detachFlightTable();
+    jpegArchiveResult = parser->jpegArchiveResult();
+    delete parser;
+    if (compressor != NULL) {
+      compressor->finish();
+      if (compressor->writeFailed()) outputFailed = 1; // don't keep a truncated result in the cache
+      delete compressor;
+    }
+
+    if (cacheFileName != NULL) {
+      if (FlightCache::write(*table, *file, cacheFileName)) {
+	fprintf(stderr, "Wrote the flight cache file \"%s\"\n", cacheFileName);
+      } else {
+	result = 1;
+      }
+    }
+  }
+
+  if (outputFormat == OUTPUT_FORMAT_PARQUET) {
+    // The rows were collected in a (columnar) table.  Write it as a Parquet file:
+    ParquetWriter* writer = ParquetWriter::createNew(outputFD);
+    if (!writer->writeTable(*table)) {
+      fprintf(stderr, "Failed to write Parquet output\n");
+      outputFailed = 1;
+    }
+    delete writer;
+  }
+
+  if (resultCache != NULL) {
+    if (outputFD != finalOutputFD && !outputFailed && !resultCache->finishResult(finalOutputFD)) outputFailed = 1;
+    if (!outputFailed && jpegArchiveResult >= 0) {
+      (void)resultCache->addFile(*file, jpgArchiveResultCacheSuffix(), jpegArchiveResult ? jpgArchiveFileName : NULL);
+    }
+    delete resultCache;
+  }
+
+  delete table;
+  delete file;
+
+  if (outputFailed) return 1;
+  if (outputFormat != OUTPUT_FORMAT_NONE) fprintf(stderr, "Done writing %s.\n", outputFormatName);
+  return result;
+}
+
+// Parses one file (".txt" or ".txt.gz") into "parser" (which produces no output), for "--aggregate", "--catalog"
+// or "--geofence".
+// Returns 0 iff it succeeds:
+static int parseWithoutOutput(char const* fileName, DJITxtParser& parser) {
+  int result = 1;
+  unsigned const nameLength = strlen(fileName);
+  if (nameLength > 3 && strcasecmp(&fileName[nameLength-3], ".gz") == 0) {
+    int inputFD = open(fileName, O_RDONLY);
+    if (inputFD < 0) {
+      fprintf(stderr, "Failed to open \"%s\": %s\n", fileName, strerror(errno));
+    } else {
+      // Decompress the file twice: first just to parse its 'details' area (at the end), then to parse its records:
+      InputStream* input = InflateInputStream::createNew(InputStream::createNew(inputFD));
+      u_int64_t const recordAreaEnd = parser.parseDetailsAreaOfStream(*input);
+      delete input;
+      if (lseek(inputFD, 0, SEEK_SET) == 0) {
+	input = InflateInputStream::createNew(InputStream::createNew(inputFD));
+	if (parser.parseStream(*input, recordAreaEnd)) result = 0;
+	delete input;
+      }
+      close(inputFD);
+    }
+  } else {
+    DJITxtFile* file = DJITxtFile::createNew(fileName);
+    if (file != NULL) {
+      parser.parseFile(*file, parseInParallel);
+      result = 0;
+    }
+    delete file;
+  }
+
+  return result;
+}
+
+// Parses one file for "--aggregate", adding its rows to "aggregation".  Returns 0 iff it succeeds:
+static int aggregateFile(char const* fileName, Aggregation& aggregation) {
+  DJITxtParser* parser = DJITxtParser::createNew(ROW_OUTPUT_NONE);
+  parser->disableJPEGOutput();
+  int result = 1;
+  if (parser->addFlightObserver(&aggregation)) { // (this can't fail; the spec was checked in advance)
+    result = parseWithoutOutput(fileName, *parser);
+  }
+
+  delete parser; // this also ends the flight, in the aggregation
+  return result;
+}
+
+// Writes the rows of "fileName" that are in "rangeSpec" (a segment - "<kind>[:<n>]" - or a time range -
+// "<fromTime>,<toTime>") as a new ".txt" file, for "--extract".  Returns 0 iff it succeeds:
+static int extractFromFile(char const* fileName, char const* rangeSpec, char const* extractFileName) {
+  FlightSegmenter segmenter;
+  std::string const spec(rangeSpec);
+  std::string::size_type const colonPos = spec.find(':');
+  int kind = FlightSegment::kindFromName(spec.substr(0, colonPos).c_str());
+  unsigned segmentNumber = 1;
+  int rangeIsOK = 1;
+  if (kind >= 0) {
+    int numChars = 0;
+    if (colonPos != std::string::npos) {
+      rangeIsOK = sscanf(&rangeSpec[colonPos+1], "%u%n", &segmentNumber, &numChars) == 1
+	&& rangeSpec[colonPos+1+numChars] == '\0' && segmentNumber > 0;
+    }
+  } else {
+    std::string::size_type const commaPos = spec.find(',');
+    int64_t fromTime, toTime;
+    rangeIsOK = commaPos != std::string::npos
+      && FleetCatalogQuery::parseTime(spec.substr(0, commaPos).c_str(), fromTime)
+      && FleetCatalogQuery::parseTime(spec.substr(commaPos+1).c_str(), toTime) && fromTime < toTime;
+    kind = SEGMENT_TIME_RANGE;
+    if (rangeIsOK) segmenter.setTimeRange(fromTime, toTime);
+  }
+  if (!rangeIsOK) {
+    fprintf(stderr, "Bad --range \"%s\": expected \"<kind>[:<n>]\" (where <kind> is motors, airborne, goHome, landing or mode), or \"<fromTime>,<toTime>\" (times are UTC \"YYYY-MM-DD[THH:MM[:SS]]\")\n", rangeSpec);
+    return 1;
+  }
+
+  // Parse the file, to find its segments (and their positions in the file):
+  DJITxtFile* file = DJITxtFile::createNew(fileName);
+  if (file == NULL) return 1;
+  DJITxtParser* parser = DJITxtParser::createNew(ROW_OUTPUT_NONE);
+  (void)parser->addFlightObserver(&segmenter);
+  parser->disableJPEGOutput();
+  parser->parseFile(*file, parseInParallel);
+  delete parser; // this also ends the flight, in the segmenter
+
+  // Find the segment.  (If the time went outside the time range, and then returned, we use all of the rows from
+  // its first entry to its last exit.):
+  std::vector<FlightSegment> const& segments = segmenter.segments(); // alias
+  FlightSegment const* first = NULL;
+  FlightSegment const* last = NULL;
+  unsigned numOfKind = 0;
+  for (unsigned i = 0; i < segments.size(); ++i) {
+    if (segments[i].kind != kind) continue;
+    ++numOfKind;
+    if (kind == SEGMENT_TIME_RANGE) {
+      if (first == NULL) first = &segments[i];
+      last = &segments[i];
+    } else if (numOfKind == segmentNumber) {
+      first = last = &segments[i];
+      break;
+    }
+  }
+
+  int result = 1;
+  if (first == NULL) {
+    if (kind == SEGMENT_TIME_RANGE) {
+      fprintf(stderr, "None of the flight's rows are within the --range times\n");
+    } else {
+      fprintf(stderr, "The flight has no \"%s\" segment %u (it has %u)\n",
+	      FlightSegment::kindName(kind), segmentNumber, numOfKind);
+    }
+  } else {
+    // Write the records before the first row, and any others that describe the aircraft, then the segment's rows:
+    std::vector<RecordExtent> extents;
+    RecordExtent const start = { (u_int64_t)(file->recordArea() - file->data()), segmenter.firstRowPosition() };
+    if (start.endPosition > start.position) extents.push_back(start);
+    std::vector<RecordExtent> const& descriptionRecords = segmenter.descriptionRecords(); // alias
+    for (unsigned i = 0; i < descriptionRecords.size(); ++i) {
+      RecordExtent const& record = descriptionRecords[i]; // alias
+      if (record.position >= start.endPosition
+	  && (record.endPosition <= first->startPosition || record.position >= last->endPosition)) {
+	extents.push_back(record);
+      }
+    }
+    RecordExtent const rows = { first->startPosition, last->endPosition };
+    extents.push_back(rows);
+    u_int64_t numRecordBytes = 0;
+    for (unsigned i = 0; i < extents.size(); ++i) numRecordBytes += extents[i].endPosition - extents[i].position;
+
+    if (LogExtractor::write(*file, fileName, extractFileName, extents)) {
+      fprintf(stderr, "Wrote rows %u-%u (of %u) - %llu of the %llu bytes of records - to \"%s\"\n",
+	      first->startRow, last->endRow - 1, segmenter.numRows(),
+	      (unsigned long long)numRecordBytes,
+	      (unsigned long long)(file->detailsArea() - file->recordArea()), extractFileName);
+      result = 0;
+    }
+  }
+
+  delete file;
+  return result;
+}
+
+// Parses one file for "--geofence", following the aircraft through the zones.  Returns 0 iff it succeeds:
+static int geofenceFile(char const* fileName, GeofenceMonitor& monitor) {
+  DJITxtParser* parser = DJITxtParser::createNew(ROW_OUTPUT_NONE);
+  (void)parser->addFlightObserver(&monitor);
+  parser->disableJPEGOutput();
+  int result = parseWithoutOutput(fileName, *parser);
+
+  delete parser;
+  return result;
+}
+
+// The options, other than those that select the mode (see below), that can't be used in every mode.  "main()"
+// notes each one that's given:
+#define OPTION_JPG_ARCHIVE		0x000001 // -j
+#define OPTION_GEOTAG			0x000002 // -g
+#define OPTION_SEQUENTIAL		0x000004 // -s
+#define OPTION_FORMAT			0x000008 // --format
+#define OPTION_FLIGHT_CACHE		0x000010 // -c
+#define OPTION_CACHE_DIR		0x000020 // --cache-dir
+#define OPTION_COMPRESS			0x000040 // --compress
+#define OPTION_STREAMS			0x000080 // --streams
+#define OPTION_TRACK			0x000100 // --track
+#define OPTION_TRACK_MIN_DISTANCE	0x000200 // --track-min-distance
+#define OPTION_TRACK_LOD		0x000400 // --track-lod
+#define OPTION_SEGMENTS			0x000800 // --segments
+#define OPTION_FOLLOW			0x001000 // --follow
+#define OPTION_RANGE			0x002000 // --range
+#define OPTION_NUM_PROCESSES		0x004000 // -P
+// The options that select the mode:
+#define OPTION_BATCH			0x008000 // --batch
+#define OPTION_AGGREGATE		0x010000 // --aggregate
+#define OPTION_CATALOG			0x020000 // --catalog
+#define OPTION_QUERY			0x040000 // --query
+#define OPTION_GEOFENCE			0x080000 // --geofence
+#define OPTION_EXTRACT			0x100000 // --extract
+
+class CommandOption {
+public:
+  char const* name;
+  unsigned flag; // one of the "OPTION_*" values above
+};
+
+static CommandOption const commandOptions[] = {
+  { "-j", OPTION_JPG_ARCHIVE }, { "-g", OPTION_GEOTAG }, { "-s", OPTION_SEQUENTIAL }, { "--format", OPTION_FORMAT },
+  { "-c", OPTION_FLIGHT_CACHE }, { "--cache-dir", OPTION_CACHE_DIR }, { "--compress", OPTION_COMPRESS },
+  { "--streams", OPTION_STREAMS }, { "--track", OPTION_TRACK }, { "--track-min-distance", OPTION_TRACK_MIN_DISTANCE },
+  { "--track-lod", OPTION_TRACK_LOD }, { "--segments", OPTION_SEGMENTS }, { "--follow", OPTION_FOLLOW },
+  { "--range", OPTION_RANGE }, { "-P", OPTION_NUM_PROCESSES },
+  { "--batch", OPTION_BATCH }, { "--aggregate", OPTION_AGGREGATE }, { "--catalog", OPTION_CATALOG },
+  { "--query", OPTION_QUERY }, { "--geofence", OPTION_GEOFENCE }, { "--extract", OPTION_EXTRACT }
+};
+#define NUM_COMMAND_OPTIONS (sizeof commandOptions/sizeof commandOptions[0])
+
+// Each mode, and the other options that can be used with it.  If more than one mode is selected, the first
+// one (in this table) is used - and the other options that select a mode are reported as not allowed:
+class ProgramMode {
+public:
+  char const* name; // the option that selects the mode
+  unsigned flag; // ditto, as an "OPTION_*" value (0 for the default mode: parsing a single file)
+  unsigned allowedOptions;
+};
+
+static ProgramMode const programModes[] = {
+  { "--query", OPTION_QUERY, 0 },
+  { "--extract", OPTION_EXTRACT, OPTION_SEQUENTIAL|OPTION_RANGE },
+  { "--geofence", OPTION_GEOFENCE, OPTION_SEQUENTIAL|OPTION_NUM_PROCESSES },
+  { "--catalog", OPTION_CATALOG, OPTION_SEQUENTIAL|OPTION_NUM_PROCESSES },
+  { "--aggregate", OPTION_AGGREGATE, OPTION_SEQUENTIAL|OPTION_NUM_PROCESSES },
+  { "--batch", OPTION_BATCH, // (options that name a single output file don't make sense here)
+    OPTION_GEOTAG|OPTION_SEQUENTIAL|OPTION_FORMAT|OPTION_CACHE_DIR|OPTION_COMPRESS|OPTION_NUM_PROCESSES },
+  { "<txtFileName>", 0, // the default mode
+    OPTION_JPG_ARCHIVE|OPTION_GEOTAG|OPTION_SEQUENTIAL|OPTION_FORMAT|OPTION_FLIGHT_CACHE|OPTION_CACHE_DIR
+    |OPTION_COMPRESS|OPTION_STREAMS|OPTION_TRACK|OPTION_TRACK_MIN_DISTANCE|OPTION_TRACK_LOD|OPTION_SEGMENTS
+    |OPTION_FOLLOW|OPTION_NUM_PROCESSES }
+};
+#define NUM_PROGRAM_MODES (sizeof programModes/sizeof programModes[0])
+
+// Returns the mode selected by "optionsGiven" (a set of "OPTION_*" values).  If any of the other options can't
+// be used in this mode, returns NULL, after printing an error message:
+static ProgramMode const* checkMode(unsigned optionsGiven) {
+  ProgramMode const* mode = &programModes[NUM_PROGRAM_MODES-1]; // the default mode
+  for (unsigned i = 0; i < NUM_PROGRAM_MODES; ++i) {
+    if ((optionsGiven & programModes[i].flag) != 0) {
+      mode = &programModes[i];
+      break;
+    }
+  }
+
+  unsigned const badOptions = optionsGiven & ~(mode->flag|mode->allowedOptions);
+  if (badOptions == 0) return mode;
+
+  fprintf(stderr, "These options can't be used with %s:", mode->name);
+  for (unsigned i = 0; i < NUM_COMMAND_OPTIONS; ++i) {
+    if ((badOptions & commandOptions[i].flag) != 0) fprintf(stderr, " %s", commandOptions[i].name);
+  }
+  fprintf(stderr, "\n");
+  return NULL;
+}
 
 int main(int argc, char** argv) {
   fprintf(stderr, "\"%s\", version 2019-02-08. Copyright (c) 2019 Live Networks, Inc. All rights reserved.\n", argv[0]);
   fprintf(stderr, "For the latest version of this program (and more information), visit http://djilogs.live555.com\n");
 
+  extern int geotagJPGFiles;
+  char const* batchOutputDirectoryName = NULL;
+  char const* aggregationSpec = NULL;
+  char const* catalogFileName = NULL;
+  char const* catalogQuery = NULL;
+  char const* geofenceFileName = NULL;
+  char const* extractFileName = NULL;
+  char const* extractRange = NULL;
+  unsigned optionsGiven = 0;
+
   int fileNamePos = 1;
-  if (argc != 2) {
-    fprintf(stderr, "Usage: %s <txtFileName>\n", argv[0]);
+  while (fileNamePos < argc && argv[fileNamePos][0] == '-' && argv[fileNamePos][1] != '\0'/*not "-"*/) {
+    char const* option = argv[fileNamePos];
+    for (unsigned i = 0; i < NUM_COMMAND_OPTIONS; ++i) {
+      if (strcmp(option, commandOptions[i].name) == 0) optionsGiven |= commandOptions[i].flag;
+    }
+    if (strcmp(option, "-j") == 0 && fileNamePos+1 < argc) {
+      jpgArchiveFileNameOption = argv[++fileNamePos];
+    } else if (strcmp(option, "-g") == 0) {
+      geotagJPGFiles = 1;
+    } else if (strcmp(option, "-s") == 0) {
+      parseInParallel = 0;
+    } else if (strcmp(option, "--format") == 0 && fileNamePos+1 < argc) {
+      char const* format = argv[++fileNamePos];
+      if (strcmp(format, "csv") == 0) {
+	outputFormat = OUTPUT_FORMAT_CSV;
+      } else if (strcmp(format, "changes") == 0) {
+	outputFormat = OUTPUT_FORMAT_CHANGES;
+      } else if (strcmp(format, "jsonl") == 0) {
+	outputFormat = OUTPUT_FORMAT_JSONL;
+      } else if (strcmp(format, "parquet") == 0) {
+	outputFormat = OUTPUT_FORMAT_PARQUET;
+      } else if (strcmp(format, "none") == 0) {
+	outputFormat = OUTPUT_FORMAT_NONE;
+      } else {
+	usage(argv[0]);
+	return 1;
+      }
+    } else if (strcmp(option, "-c") == 0 && fileNamePos+1 < argc) {
+      cacheFileName = argv[++fileNamePos];
+    } else if (strcmp(option, "--cache-dir") == 0 && fileNamePos+1 < argc) {
+      cacheDirectoryName = argv[++fileNamePos];
+    } else if (strcmp(option, "--compress") == 0 && fileNamePos+1 < argc) {
+      char const* method = argv[++fileNamePos];
+      if (strcmp(method, "lz4") == 0) {
+	compressionMethod = COMPRESSION_LZ4;
+      } else if (strcmp(method, "gzip") == 0) {
+	compressionMethod = COMPRESSION_GZIP;
+      } else if (sscanf(method, "gzip:%d", &compressionLevel) == 1 && compressionLevel >= 1 && compressionLevel <= 9) {
+	compressionMethod = COMPRESSION_GZIP;
+      } else {
+	usage(argv[0]);
+	return 1;
+      }
+    } else if (strcmp(option, "--streams") == 0 && fileNamePos+1 < argc) {
+      recordStreamsPrefix = argv[++fileNamePos];
+    } else if (strcmp(option, "--track") == 0 && fileNamePos+1 < argc) {
+      char const* trackFileName = argv[++fileNamePos];
+      if (TrackExporter::formatFromFileName(trackFileName) < 0) {
+	fprintf(stderr, "The --track file name \"%s\" must end with \".gpx\", \".kml\" or \".geojson\"\n", trackFileName);
+	return 1;
+      }
+      trackFileNames.push_back(trackFileName);
+    } else if (strcmp(option, "--segments") == 0 && fileNamePos+1 < argc) {
+      segmentIndexFileName = argv[++fileNamePos];
+    } else if (strcmp(option, "--track-min-distance") == 0 && fileNamePos+1 < argc
+	       && sscanf(argv[fileNamePos+1], "%lf", &trackMinDistance) == 1 && trackMinDistance >= 0.0) {
+      ++fileNamePos;
+    } else if (strcmp(option, "--track-lod") == 0 && fileNamePos+1 < argc) {
+      // A comma-separated list of tolerances (in meters):
+      char const* tolerances = argv[++fileNamePos];
+      double tolerance;
+      int numChars;
+      while (sscanf(tolerances, "%lf%n", &tolerance, &numChars) == 1 && tolerance > 0.0) {
+	trackLODTolerances.push_back(tolerance);
+	tolerances += numChars;
+	if (*tolerances != ',') break;
+	++tolerances;
+      }
+      if (*tolerances != '\0') {
+	usage(argv[0]);
+	return 1;
+      }
+    } else if (strcmp(option, "--follow") == 0) {
+      followInput = 1;
+    } else if (strcmp(option, "--batch") == 0 && fileNamePos+1 < argc) {
+      batchOutputDirectoryName = argv[++fileNamePos];
+    } else if (strcmp(option, "--aggregate") == 0 && fileNamePos+1 < argc) {
+      aggregationSpec = argv[++fileNamePos];
+    } else if (strcmp(option, "--catalog") == 0 && fileNamePos+1 < argc) {
+      catalogFileName = argv[++fileNamePos];
+    } else if (strcmp(option, "--query") == 0 && fileNamePos+1 < argc) {
+      catalogQuery = argv[++fileNamePos];
+    } else if (strcmp(option, "--geofence") == 0 && fileNamePos+1 < argc) {
+      geofenceFileName = argv[++fileNamePos];
+    } else if (strcmp(option, "--extract") == 0 && fileNamePos+1 < argc) {
+      extractFileName = argv[++fileNamePos];
+    } else if (strcmp(option, "--range") == 0 && fileNamePos+1 < argc) {
+      extractRange = argv[++fileNamePos];
+    } else if (strcmp(option, "-P") == 0 && fileNamePos+1 < argc
+	       && sscanf(argv[fileNamePos+1], "%u", &numProcesses) == 1 && numProcesses > 0) {
+      ++fileNamePos;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+    ++fileNamePos;
+  }
+  if (fileNamePos != argc-1) {
+    usage(argv[0]);
     return 1;
   }
   char const* fileName = argv[fileNamePos];
 
-  FILE* fid = fopen(fileName, "rb");
-  if (fid == NULL) {
-    fprintf(stderr, "Failed to open \"%s\"\n", fileName);
+  if ((extractFileName == NULL) != (extractRange == NULL)) {
+    fprintf(stderr, "--extract and --range must be used together\n");
     return 1;
   }
+  ProgramMode const* mode = checkMode(optionsGiven);
+  if (mode == NULL) return 1;
 
-  // Figure out the file's size
-  struct stat sb;
-  u_int64_t fileSize;
-  if (stat(fileName, &sb) == 0) {
-    fileSize = sb.st_size;
-  } else {
-    fprintf(stderr, "Failed to get file size\n");
+  if (compressionMethod != COMPRESSION_NONE
+      && ((rowOutput() == ROW_OUTPUT_NONE && recordStreamsPrefix == NULL) || followInput)) {
+    // (With "--follow", compressed rows would be held back until a whole block of them had been compressed.)
+    fprintf(stderr, "--compress can be used only with CSV (or JSON Lines) output, and not with --follow\n");
     return 1;
   }
 
-  // Check the file size:
-  if (fileSize < OLD_HEADER_SIZE) {
-    fprintf(stderr, "Bad file size: %lld bytes\n", fileSize);
+  if ((recordStreamsPrefix != NULL || !trackFileNames.empty() || segmentIndexFileName != NULL) && (cacheFileName != NULL || cacheDirectoryName != NULL)) {
+    // (Cached output would be used without parsing the file, so the streams (or tracks) wouldn't be written.)
+    fprintf(stderr, "--streams, --track and --segments can't be used with -c or --cache-dir\n");
     return 1;
   }
 
-  // Map the file into memory:
-  u_int8_t* const mappedFile
-    = (u_int8_t*)mmap(0, fileSize, PROT_READ, MAP_SHARED, fileno(fid), 0);
-  if (mappedFile == MAP_FAILED) {
-    extern int errno;
-    fprintf(stderr, "mmap() call failed: %s\n", strerror(errno));
+  if (followInput && (outputFormat == OUTPUT_FORMAT_PARQUET || cacheFileName != NULL || cacheDirectoryName != NULL)) {
+    // These all need the complete file:
+    fprintf(stderr, "--follow can be used only with CSV output, and not with -c or --cache-dir\n");
     return 1;
   }
 
-  // Get/check the first 8 bytes (little-endian) of the file; it's the size of the header+record area:
-  u_int8_t const* ptr = mappedFile;
-  u_int64_t headerPlusRecordAreaSize = getWord64LE(ptr);
+  if (numProcesses == 0) {
+    long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    numProcesses = numCPUs > 0 ? numCPUs : 1;
+  }
 
-  // The next 4 bytes are the file version number (apparently big-endian):
-  fileVersionNumber = getWord32BE(ptr);
-  fprintf(stderr, "File version number: 0x%08x\n", fileVersionNumber);
+  if (mode->flag == OPTION_QUERY) {
+    // Query mode.  The file is a catalog (and no logs are parsed):
+    FleetCatalogQuery query;
+    if (!query.parse(catalogQuery)) return 1;
+    FleetCatalog* catalog = FleetCatalog::open(fileName);
+    if (catalog == NULL) return 1;
 
+    std::vector<FleetCatalogMatch> flights;
+    catalog->query(query, flights);
+    catalog->outputFlights(stdout, flights, query);
+    fprintf(stderr, "%u of %u flight(s) matched\n", (unsigned)flights.size(), catalog->numFlights());
+    delete catalog;
 
-  // Old versions of the file have a smaller header, and are not scrambled:
-  unsigned headerSize;
-  int isScrambled;
-  if ((fileVersionNumber&0x0000FF00) < 0x00000600) {
-    headerSize = OLD_HEADER_SIZE;
-    isScrambled = 0;
-  } else {
-    headerSize = NEW_HEADER_SIZE;
-    isScrambled = 1;
+    return 0;
   }
 
-  unsigned const minFileSize = headerSize + MIN_RECORD_SIZE;
-  if (headerPlusRecordAreaSize < minFileSize || headerPlusRecordAreaSize > fileSize) {
-    fprintf(stderr, "Bad 'header+record-area' size: %lld (0x%llx); file size is %lld\n", headerPlusRecordAreaSize, headerPlusRecordAreaSize, fileSize);
-    return 1;
+  if (mode->flag == OPTION_EXTRACT) {
+    // Extract mode.  The only output is the new ".txt" file:
+    return extractFromFile(fileName, extractRange, extractFileName);
   }
 
-  // Create a parser:
-  DJITxtParser* parser = DJITxtParser::createNew();
+  if (mode->flag == OPTION_GEOFENCE) {
+    // Geofence mode.  The only output is the zone visits:
+    GeofenceZones* zones = GeofenceZones::createNew(geofenceFileName);
+    if (zones == NULL) return 1;
 
-  // Begin by parsing the 'DETAILS' area (the data after the header+record area):
-  u_int8_t* const detailsArea = &mappedFile[headerPlusRecordAreaSize];
-  u_int8_t* const endOfDetailsArea = &mappedFile[fileSize];
-  ptr = detailsArea;
-  parser->parseDetailsArea(ptr, endOfDetailsArea);
+    int result = 1;
+    FleetGeofence* fleetGeofence = FleetGeofence::createNew(fileName, *zones, geofenceFile);
+    if (fleetGeofence != NULL) {
+      result = fleetGeofence->run(numProcesses, stdout);
+      delete fleetGeofence;
+    }
+    delete zones;
 
-  // Then, parse all of the records in the file:
-  u_int8_t* const recordArea = &mappedFile[headerSize];
-  u_int8_t* const endOfRecordArea = detailsArea;
+    return result;
+  }
 
-  ptr = recordArea;
-  while (ptr < endOfRecordArea) {
-#ifdef DEBUG_RECORD_PARSING
-    u_int64_t curFilePosition = ptr - mappedFile;
-    fprintf(stderr, "@0x%08llx: ", curFilePosition);
-#endif
-    if (!parser->parseRecord(ptr, endOfRecordArea, isScrambled)) break;
+  if (mode->flag == OPTION_CATALOG) {
+    // Catalog mode.  There's no other output:
+    return FleetCatalog::update(catalogFileName, fileName, parseWithoutOutput, numProcesses) ? 0 : 1;
   }
-  if (ptr < endOfRecordArea) {
-    u_int64_t curFilePosition = ptr - mappedFile;
-    fprintf(stderr, "Premature end of record parsing at file position %lld (0x%08llx)\n", curFilePosition, curFilePosition);
+
+  if (mode->flag == OPTION_AGGREGATE) {
+    // Aggregation mode.  The only output is the result.  (The spec - including its field names - is checked
+    // before anything is parsed.):
+    unsigned numColumns;
+    OutputColumn const* columns = DJITxtParser::outputColumnTable(numColumns);
+    Aggregation* aggregation = Aggregation::createNew(aggregationSpec, columns, numColumns);
+    if (aggregation == NULL) return 1;
+
+    int result = 1;
+    FleetAggregator* fleetAggregator = FleetAggregator::createNew(fileName, *aggregation, aggregateFile);
+    if (fleetAggregator != NULL) {
+      result = fleetAggregator->run(numProcesses);
+      aggregation->outputResult(stdout);
+      delete fleetAggregator;
+    }
+    delete aggregation;
+
+    return result;
   }
-  parser->outputOneRow(); // the final row of data
-  parser->summarizeRecordParsing();
 
-  delete parser;
+  if (mode->flag != OPTION_BATCH) {
+    if (segmentIndexFileName == NULL) return processFile(fileName, NULL, 1/*stdout*/);
+
+    // Also index the flight's segments (found while it's being parsed), then write the index:
+    FlightSegmenter segmenter;
+    flightSegmenter = &segmenter;
+    int result = processFile(fileName, NULL, 1/*stdout*/);
+    flightSegmenter = NULL;
+    if (result == 0 && !segmenter.writeIndex(segmentIndexFileName)) result = 1;
+    return result;
+  }
+
+  // Batch mode:
+  BatchProcessor* batchProcessor
+    = BatchProcessor::createNew(fileName, batchOutputDirectoryName, outputSuffix(), processFile);
+  if (batchProcessor == NULL) return 1;
+
+  int result = batchProcessor->run(numProcesses);
+  delete batchProcessor;
 
-  fprintf(stderr, "Done writing CSV.\n");
-  return 0;
+  return result;
 }
@@ -25,60 +25,62 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "FieldDatabase.hh"
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
+#include <math.h>
 
-void FieldDatabase::outputField(char const* label, unsigned numFractionalDigits) {
-  FieldValue const* fieldValue = lookupFieldValue(label);
-  if (fieldValue == NULL) return; // output nothing for a nonexistent field
+void FieldDatabase::formatField(OutputBuffer& out, FieldSnapshot const& field, unsigned numFractionalDigits) {
+  if (!field.isPresent) return; // output nothing for a nonexistent field
+  FieldSnapshot const* fieldValue = &field;
 
   int timeIsInMilliseconds = 0; // by default
 
   switch (fieldValue->fType) {
     case IntegerByteUnsigned: {
-      printf("%u", fieldValue->fByte);
+      out.appendUnsigned(fieldValue->fByte);
       break;
     }
     case IntegerByteSigned: {
-      printf("%d", (int8_t)(fieldValue->fByte));
+      out.appendSigned((int8_t)(fieldValue->fByte));
       break;
     }
     case Integer2ByteUnsigned: {
-      printf("%u", fieldValue->fBytes2);
+      out.appendUnsigned(fieldValue->fBytes2);
       break;
     }
     case Integer2ByteSigned: {
-      printf("%d", (int16_t)(fieldValue->fBytes2));
+      out.appendSigned((int16_t)(fieldValue->fBytes2));
       break;
     }
     case Date2Byte: {
       // Interpret the two bytes as: 7 bits (years since 1980) + 4 bits (month) + 5 bits (day of month):
-      printf("%u/%02u/%02u",
-	     ((fieldValue->fBytes2&0xFE00)>>9) + 1980,
-	     (fieldValue->fBytes2&0x01E0)>>5,
-	     (fieldValue->fBytes2&0x001F));
+      out.appendf("%u/%02u/%02u",
+	          ((fieldValue->fBytes2&0xFE00)>>9) + 1980,
+	          (fieldValue->fBytes2&0x01E0)>>5,
+	          (fieldValue->fBytes2&0x001F));
 
       break;
     }
     case Integer4ByteUnsigned: {
-      printf("%u", fieldValue->fBytes4);
+      out.appendUnsigned(fieldValue->fBytes4);
       break;
     }
     case Integer4ByteSigned: {
-      printf("%d", (int32_t)(fieldValue->fBytes4));
+      out.appendSigned((int32_t)(fieldValue->fBytes4));
       break;
     }
     case Version4Byte: {
       // Use the first 3 bytes (big-endian) as version numbers:
       u_int32_t v = fieldValue->fBytes4;
-      printf("%u.%u.%u", (v>>24)&0xFF, (v>>16)&0xFF, (v>>8)&0xFF);
+      out.appendf("%u.%u.%u", (v>>24)&0xFF, (v>>16)&0xFF, (v>>8)&0xFF);
       break;
     }
     case Float: {
-      printf("%.*f", numFractionalDigits, fieldValue->fFloat);
+      out.appendf("%.*f", numFractionalDigits, fieldValue->fFloat);
       break;
     }
     case Double: {
-      printf("%.*f", numFractionalDigits, fieldValue->fDouble);
+      out.appendf("%.*f", numFractionalDigits, fieldValue->fDouble);
       break;
     }
     case Timestamp8ByteInMilliseconds: {
@@ -98,29 +100,30 @@ void FieldDatabase::outputField(char const* label, unsigned numFractionalDigits)
 	milliseconds = 0;
       }
 
-      struct tm* convertedTime = gmtime((time_t*)&timeInSeconds);
+      struct tm tmResult; // we use "gmtime_r()", because we may be called from an output thread
+      struct tm* convertedTime = gmtime_r((time_t*)&timeInSeconds, &tmResult);
       if (convertedTime == NULL) {
-	fprintf(stderr, "outputField(8-byte timestamp): gmtime(%llu) failed!\n", timeInSeconds);
+	fprintf(stderr, "formatField(8-byte timestamp): gmtime(%llu) failed!\n", (unsigned long long)timeInSeconds);
 	return;
       }
-      printf("%u/%02u/%02u %02u:%02u:%02u",
-	     convertedTime->tm_year + 1900, convertedTime->tm_mon + 1, convertedTime->tm_mday,
-	     convertedTime->tm_hour, convertedTime->tm_min, convertedTime->tm_sec);
+      out.appendf("%u/%02u/%02u %02u:%02u:%02u",
+	          convertedTime->tm_year + 1900, convertedTime->tm_mon + 1, convertedTime->tm_mday,
+	          convertedTime->tm_hour, convertedTime->tm_min, convertedTime->tm_sec);
       if (timeIsInMilliseconds) {
-	printf(".%03u", milliseconds);
+	out.appendf(".%03u", milliseconds);
       }
       break;
     }
     case String: {
-      printf("%s", fieldValue->fStr);
+      out.append(fieldValue->fStr);
       break;
     }
   }
 }
 
-void FieldDatabase::outputFieldAsBoolean(char const* label) {
-  FieldValue const* fieldValue = lookupFieldValue(label);
-  if (fieldValue == NULL) return; // output nothing for a nonexistent field
+void FieldDatabase::formatFieldAsBoolean(OutputBuffer& out, FieldSnapshot const& field) {
+  if (!field.isPresent) return; // output nothing for a nonexistent field
+  FieldSnapshot const* fieldValue = &field;
 
   int booleanValue = 0;
 
@@ -145,13 +148,14 @@ void FieldDatabase::outputFieldAsBoolean(char const* label) {
     }
   }
 
-  printf(booleanValue ? "True" : "False");
+  out.append(booleanValue ? "True" : "False");
 }
 
-void FieldDatabase::outputFieldInterpreted(char const* label, char const* interpretedLabel) {
-  // First, check whether we currently have a value for the field "label":
-  FieldValue const* fieldValue = lookupFieldValue(label);
-  if (fieldValue == NULL) return; // output nothing for a nonexistent field
+void FieldDatabase::formatFieldInterpreted(OutputBuffer& out, FieldSnapshot const& field,
+					   InterpretationTable* interpretationTable) {
+  // First, check whether we have a value for the field:
+  if (!field.isPresent) return; // output nothing for a nonexistent field
+  FieldSnapshot const* fieldValue = &field;
 
   // Next, check its type.  It needs to be an unsigned integer type <= 4 bytes long:
   u_int32_t intValue;
@@ -173,10 +177,138 @@ void FieldDatabase::outputFieldInterpreted(char const* label, char const* interp
     }
   }
   
-  // Now, look up an InterpretationTable for "interpretedLabel":
-  InterpretationTable* interpretationTable = fInterpretationTableMap[interpretedLabel];
+  // Now, check that we have an InterpretationTable for the field:
   if (interpretationTable == NULL) return;
 
   // And use this to look up (and print) a string 'interpretation' of our integer value:
-  printf("%s", interpretationTable->lookup(intValue));
+  out.append(interpretationTable->lookup(intValue));
+}
+
+void FieldDatabase::formatFieldAsJSON(OutputBuffer& out, FieldSnapshot const& field, unsigned numFractionalDigits) {
+  if (!field.isPresent) {
+    out.append("null", 4);
+    return;
+  }
+
+  switch (field.fType) {
+    case IntegerByteUnsigned:
+    case IntegerByteSigned:
+    case Integer2ByteUnsigned:
+    case Integer2ByteSigned:
+    case Integer4ByteUnsigned:
+    case Integer4ByteSigned: {
+      formatField(out, field); // the same as for CSV
+      break;
+    }
+    case Float:
+    case Double: {
+      double value = field.fType == Float ? field.fFloat : field.fDouble;
+      if (isfinite(value)) {
+	out.appendFixed(value, numFractionalDigits);
+      } else {
+	out.append("null", 4); // JSON has no NaN or infinity
+      }
+      break;
+    }
+    case Date2Byte:
+    case Version4Byte:
+    case Timestamp8ByteInSeconds:
+    case Timestamp8ByteInMilliseconds: {
+      // Output these as strings (formatted as for CSV, so they contain nothing that needs escaping):
+      out.appendChar('"');
+      formatField(out, field);
+      out.appendChar('"');
+      break;
+    }
+    case String: {
+      formatJSONString(out, field.fStr);
+      break;
+    }
+  }
+}
+
+void FieldDatabase::formatFieldAsJSONBoolean(OutputBuffer& out, FieldSnapshot const& field) {
+  int booleanValue;
+  switch (field.isPresent ? field.fType : String) {
+    case IntegerByteUnsigned:
+    case IntegerByteSigned: { booleanValue = field.fByte != 0; break; }
+    case Integer2ByteUnsigned:
+    case Integer2ByteSigned: { booleanValue = field.fBytes2 != 0; break; }
+    case Integer4ByteUnsigned:
+    case Integer4ByteSigned: { booleanValue = field.fBytes4 != 0; break; }
+    default: { // the field cannot be interpreted as Boolean (or has no value)
+      out.append("null", 4);
+      return;
+    }
+  }
+
+  if (booleanValue) out.append("true", 4); else out.append("false", 5);
+}
+
+void FieldDatabase::formatFieldAsJSONInterpreted(OutputBuffer& out, FieldSnapshot const& field,
+						 InterpretationTable* interpretationTable) {
+  u_int32_t intValue;
+  switch (field.isPresent ? field.fType : String) {
+    case IntegerByteUnsigned: { intValue = field.fByte; break; }
+    case Integer2ByteUnsigned: { intValue = field.fBytes2; break; }
+    case Integer4ByteUnsigned: { intValue = field.fBytes4; break; }
+    default: { interpretationTable = NULL; break; } // bad type (or no value)
+  }
+
+  if (interpretationTable == NULL) {
+    out.append("null", 4);
+  } else {
+    formatJSONString(out, interpretationTable->lookup(intValue));
+  }
+}
+
+// Returns the length of the (valid) UTF-8 sequence at "str", or 0 if it's not valid:
+static unsigned utf8SequenceLength(u_int8_t const* str) {
+  unsigned length;
+  if (str[0] < 0x80) return 1;
+  else if (str[0] >= 0xC2 && str[0] <= 0xDF) length = 2;
+  else if (str[0] >= 0xE0 && str[0] <= 0xEF) length = 3;
+  else if (str[0] >= 0xF0 && str[0] <= 0xF4) length = 4;
+  else return 0;
+
+  for (unsigned i = 1; i < length; ++i) {
+    if ((str[i]&0xC0) != 0x80) return 0; // (this also stops at the string's terminating '\0')
+  }
+  return length;
+}
+
+void FieldDatabase::formatJSONString(OutputBuffer& out, char const* str) {
+  static char const hexDigits[] = "0123456789abcdef";
+  u_int8_t const* ptr = (u_int8_t const*)str;
+
+  out.appendChar('"');
+  while (*ptr != '\0') {
+    // Copy as much as we can (i.e., characters that don't need escaping) at once:
+    u_int8_t const* run = ptr;
+    unsigned seqLength;
+    while (*ptr >= 0x20 && *ptr != '"' && *ptr != '\\' && (seqLength = utf8SequenceLength(ptr)) > 0) {
+      ptr += seqLength;
+    }
+    if (ptr > run) out.append((char const*)run, ptr - run);
+    if (*ptr == '\0') break;
+
+    // Escape the next character:
+    u_int8_t c = *ptr++;
+    switch (c) {
+      case '"': { out.append("\\\"", 2); break; }
+      case '\\': { out.append("\\\\", 2); break; }
+      case '\n': { out.append("\\n", 2); break; }
+      case '\r': { out.append("\\r", 2); break; }
+      case '\t': { out.append("\\t", 2); break; }
+      default: {
+	if (c < 0x20) {
+	  char escape[6] = { '\\', 'u', '0', '0', hexDigits[c>>4], hexDigits[c&0xF] };
+	  out.append(escape, 6);
+	} else {
+	  out.append("\\ufffd", 6); // a byte that isn't valid UTF-8
+	}
+      }
+    }
+  }
+  out.appendChar('"');
 }
@@ -0,0 +1,205 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Parsing a DJI ".txt" file while it's still being written.
+    Implementation.
+*/
+
+#include "DJITxtParser.hh"
+#include "DJITxtFile.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/inotify.h>
+#include <errno.h>
+
+// While a file is being written, we wait (using "inotify") for it to change.  But we also check it
+// at least this often, in case its file system doesn't report changes:
+#define FOLLOW_POLL_INTERVAL_MS 1000
+
+extern u_int32_t fileVersionNumber;
+
+// While the app is writing the file, the 'header+record-area size' at the start of the file is not
+// yet valid; it gets set only once the 'details' area has been written (after the last record).
+// Until then, the records extend (as far as we know) to the current end of the file, and we parse
+// each one only once it's complete.  (As a result, the 'DETAILS' fields get values only in the final row.)
+
+int DJITxtParser::followFile(char const* fileName) {
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open \"%s\"\n", fileName);
+    return 0;
+  }
+
+  int inotifyFD = inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+  if (inotifyFD < 0 || inotify_add_watch(inotifyFD, fileName,
+					  IN_MODIFY|IN_CLOSE_WRITE|IN_DELETE_SELF|IN_MOVE_SELF) < 0) {
+    fprintf(stderr, "Failed to watch \"%s\" for changes: %s\n", fileName, strerror(errno));
+    if (inotifyFD >= 0) close(inotifyFD);
+    close(fd);
+    return 0;
+  }
+
+  u_int8_t* mappedFile = NULL;
+  u_int64_t mappedSize = 0;
+  unsigned headerSize = 0; // until we've seen the header
+  int isScrambled = 0;
+  u_int64_t parseOffset = 0; // the file position of the next record to be parsed
+  u_int64_t badRecordOffset = 0; // if not 0, we've already warned about a bad record here
+  int fileWasRemoved = 0, result = 1;
+  while (1) {
+    // Map in any new data:
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+      fprintf(stderr, "Failed to get file size\n");
+      result = 0;
+      break;
+    }
+    u_int64_t fileSize = sb.st_size;
+    if (fileSize < mappedSize) {
+      fprintf(stderr, "\"%s\" was truncated (to %llu bytes) while being followed\n",
+	      fileName, (unsigned long long)fileSize);
+      result = 0;
+      break;
+    }
+    if (fileSize > mappedSize) {
+      if (mappedFile != NULL) munmap(mappedFile, mappedSize);
+      mappedFile = (u_int8_t*)mmap(0, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+      if (mappedFile == MAP_FAILED) {
+	fprintf(stderr, "mmap() call failed: %s\n", strerror(errno));
+	mappedFile = NULL; mappedSize = 0;
+	result = 0;
+	break;
+      }
+      mappedSize = fileSize;
+    }
+
+    if (headerSize == 0 && fileSize >= OLD_HEADER_SIZE) {
+      // We can now see the file version number (which tells us the header size):
+      u_int8_t const* ptr = &mappedFile[8];
+      fileVersionNumber = getWord32BE(ptr);
+      fprintf(stderr, "File version number: 0x%08x\n", fileVersionNumber);
+      if (DJITxtFile::versionHasNewHeader(fileVersionNumber)) {
+	headerSize = NEW_HEADER_SIZE;
+	isScrambled = 1;
+      } else {
+	headerSize = OLD_HEADER_SIZE;
+	isScrambled = 0;
+      }
+      parseOffset = headerSize;
+    }
+
+    if (headerSize != 0 && fileSize >= parseOffset) {
+      // The record area is final once the 'header+record-area size' is valid, and a 'details'
+      // area follows it:
+      u_int8_t const* ptr = mappedFile;
+      u_int64_t headerPlusRecordAreaSize = getWord64LE(ptr);
+      int const recordAreaIsFinal = headerPlusRecordAreaSize >= headerSize + MIN_RECORD_SIZE
+	&& headerPlusRecordAreaSize >= parseOffset && headerPlusRecordAreaSize < fileSize;
+
+      u_int8_t const* const endOfRecordArea
+	= &mappedFile[recordAreaIsFinal ? headerPlusRecordAreaSize : fileSize];
+      ptr = &mappedFile[parseOffset];
+      setPositionBase(mappedFile, 0); // (the file may have been mapped again)
+      if (parseOffset == headerSize) prepareToParseRecords(ptr, endOfRecordArea);
+
+      while (ptr < endOfRecordArea) {
+	if (!recordAreaIsFinal) {
+	  // The last record might not have been completely written yet:
+	  int status = checkRecord(ptr, endOfRecordArea);
+	  if (status == RECORD_IS_INCOMPLETE) break;
+	  if (status == RECORD_IS_BAD) {
+	    // This might be the start of the 'details' area (written before the header is updated).
+	    // Wait to see what happens:
+	    if (badRecordOffset != (u_int64_t)(ptr - mappedFile)) {
+	      badRecordOffset = ptr - mappedFile;
+	      fprintf(stderr, "Can't parse the data at file position %llu (yet); waiting for the file to be completed\n",
+		      (unsigned long long)badRecordOffset);
+	    }
+	    break;
+	  }
+	}
+	if (!parseRecord(ptr, endOfRecordArea, isScrambled)) break;
+      }
+      parseOffset = ptr - mappedFile;
+      flushRows(); // so that rows get delivered as soon as they're complete
+
+      if (recordAreaIsFinal) {
+	if (ptr < endOfRecordArea) {
+	  fprintf(stderr, "Premature end of record parsing at file position %llu (0x%08llx)\n",
+		  (unsigned long long)parseOffset, (unsigned long long)parseOffset);
+	  result = 0;
+	}
+
+	// The file is complete.  Finish by parsing its 'details' area:
+	ptr = endOfRecordArea;
+	try {
+	  parseDetailsArea(ptr, &mappedFile[fileSize]);
+	} catch (int /*e*/) {
+	  fprintf(stderr, "Unexpected error in parsing the 'details' area\n");
+	}
+	break;
+      }
+    }
+
+    if (fileWasRemoved) {
+      fprintf(stderr, "\"%s\" was removed before it was completed\n", fileName);
+      result = 0;
+      break;
+    }
+
+    // Wait until the file changes (or it's time to check it again anyway):
+    struct pollfd pfd;
+    pfd.fd = inotifyFD;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, FOLLOW_POLL_INTERVAL_MS) < 0 && errno != EINTR) {
+      fprintf(stderr, "poll() failed: %s\n", strerror(errno));
+      result = 0;
+      break;
+    }
+
+    // Drain (all of) the pending events; we only need to know whether the file went away:
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t numBytes;
+    while ((numBytes = read(inotifyFD, events, sizeof events)) > 0) {
+      for (char* p = events; p < events + numBytes; ) {
+	struct inotify_event const* event = (struct inotify_event const*)p;
+	if (event->mask & (IN_DELETE_SELF|IN_MOVE_SELF)) fileWasRemoved = 1;
+	p += sizeof (struct inotify_event) + event->len;
+      }
+    }
+  }
+
+  outputOneRow(); // the final row of data
+  flushRows();
+  summarizeRecordParsing();
+
+  if (mappedFile != NULL) munmap(mappedFile, mappedSize);
+  close(inotifyFD);
+  close(fd);
+
+  return result;
+}
@@ -61,7 +61,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 int RecordAndDetailsParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled) {
   // Attempt to parse a record; Returns 1 iff it succeeds.
+  RecordView recordView;
+  if (!scanRecord(ptr, limit, isScrambled, recordView)) return 0;
+
+  return decodeRecord(recordView);
+}
+
+int RecordAndDetailsParser::scanRecord(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled,
+				       RecordView& recordView) {
+  // Find the extent of the next record (unscrambling its data, if necessary); Returns 1 iff it succeeds.
   try {
+    recordView.position = filePosition(ptr);
+
     // The first two bytes are the 'record type' and the 'record length':
     u_int8_t recordType = getByte(ptr, limit);
     u_int8_t recordLength = getByte(ptr, limit);
@@ -79,14 +90,23 @@ int RecordAndDetailsParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* li
     fprintf(stderr, "[%d]\trecordType %d[%s], recordLength %d\n", fRecordTypeStats[RECORD_TYPE_OSD].count, recordType, recordTypeName, recordLength);
 #endif
 
-    if (recordType == RECORD_TYPE_JPEG) {
+    recordView.recordType = recordType;
+    if (recordType == RECORD_TYPE_JPEG || (recordType == 0xFF && recordLength == JPEG_SOI_BYTE)) {
       // This record contains one or more JPEG images, and needs to be handled especially.
       // (In particular, the 'recordLength' seems to be irrelevant in this case)
-      return parseRecord_JPEG(ptr, limit);
-    } else if (recordType == 0xFF && recordLength == JPEG_SOI_BYTE) {
-      // Some old log formats start JPEG images this way.  Back up 4 bytes; handle them the same way:
-      ptr -=4;
-      return parseRecord_JPEG(ptr, limit);
+      if (recordType == 0xFF) {
+	// Some old log formats start JPEG images this way.  Back up 4 bytes; handle them the same way:
+	ptr -=4;
+      }
+
+      // Find the end of the image(s) now, but output them only when the record gets decoded:
+      recordView.recordType = RECORD_TYPE_JPEG;
+      recordView.data = ptr;
+      int result = parseRecord_JPEG(ptr, limit, 0/*don't output images*/);
+      recordView.length = ptr - recordView.data;
+      recordView.nextRecord = ptr;
+      recordView.endPosition = filePosition(ptr);
+      return result;
     }
 
     // Check the record length, and whether there's a 0xFF byte at the end:
@@ -96,10 +116,11 @@ int RecordAndDetailsParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* li
       return 0;
     }
     u_int8_t const* recordStart = ptr;
-    u_int8_t const* recordLimit = ptr + recordLength; // position of the 0xFF 'End of record' byte
     ptr += recordLength + 1; // advance to the next record, if any
+    recordView.nextRecord = ptr;
+    recordView.endPosition = filePosition(ptr);
 
-    u_int8_t unscrambledRecord[recordLength-1]; // used only if "isScrambled"
+    u_int8_t* unscrambledRecord = recordView.unscrambledData; // used only if "isScrambled"
     if (isScrambled) {
       // We need to unscramble the record data before we can parse it.
 
@@ -125,16 +146,32 @@ int RecordAndDetailsParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* li
 	  unscrambledRecord[i] = recordStart[i] ^ scrambleBytes[i%8];
 	}
 	recordStart = unscrambledRecord;
-	recordLimit = unscrambledRecord + recordLength;
       }
     }
 
+    recordView.data = recordStart;
+    recordView.length = recordLength;
+  } catch (int /*e*/) {
+    fprintf(stderr, "Unexpected error in parsing\n");
+    return 0;
+  }
+
+  return 1;
+}
+
+int RecordAndDetailsParser::decodeRecord(RecordView const& recordView) {
+  // Parse the fields within a record (that was found by "scanRecord()"); Returns 1 iff it succeeds.
+  try {
+    u_int8_t recordType = recordView.recordType;
+    u_int8_t const* recordStart = recordView.data;
+    u_int8_t const* recordLimit = recordView.data + recordView.length;
+
     switch (recordType) {
       case RECORD_TYPE_OSD: {
 	// Because an 'OSD' record effectively starts a new row of data, output a row of data
 	// before we parse it (except for the very first 'OSD' record, where we output
 	// the column labels instead):
-	outputOneRow(fRecordTypeStats[RECORD_TYPE_OSD].count == 1);
+	outputOneRow(++fNumOSDRecordsDecoded == 1);
 	parseRecord_OSD(recordStart, recordLimit);
 	break;
       }
@@ -218,6 +255,9 @@ int RecordAndDetailsParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* li
 	parseRecordUnknownFormat("APP_SER_WARN", recordStart, recordLimit);
 	break;
       }
+      case RECORD_TYPE_JPEG: {
+	return parseRecord_JPEG(recordStart, recordLimit, fOutputJPEGImages);
+      }
       default: {
 #ifdef DEBUG_RECORD_PARSING
 	char const* recordTypeName = fRecordTypeName[recordType];
@@ -231,6 +271,10 @@ int RecordAndDetailsParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* li
 #endif
       }
     }
+
+    for (unsigned i = 0; i < fFlightObservers.size(); ++i) {
+      fFlightObservers[i]->noteRecord(recordType, recordView.position, recordView.endPosition);
+    }
   } catch (int /*e*/) {
     fprintf(stderr, "Unexpected error in parsing\n");
     return 0;
@@ -239,6 +283,32 @@ int RecordAndDetailsParser::parseRecord(u_int8_t const*& ptr, u_int8_t const* li
   return 1;
 }
 
+void RecordAndDetailsParser::prepareToParseRecords(u_int8_t const* /*ptr*/, u_int8_t const* /*limit*/) {
+  // (The table's columns grow as rows are added, so we don't need to look at the records in advance.)
+  if (fFlightTableIsEnabled && fFlightTable == NULL) fFlightTable = createFlightTable();
+}
+
+int RecordAndDetailsParser::checkRecord(u_int8_t const* ptr, u_int8_t const* limit) {
+  // Look only at the record's header (and, for a JPEG record, its image(s)), without unscrambling or parsing its data:
+  try {
+    u_int8_t type = getByte(ptr, limit);
+    u_int8_t length = getByte(ptr, limit);
+
+    if (type == RECORD_TYPE_JPEG || (type == 0xFF && length == JPEG_SOI_BYTE)) {
+      if (type == 0xFF) ptr -= 4;
+      if (!parseRecord_JPEG(ptr, limit, 0/*don't output images*/)) return RECORD_IS_BAD;
+
+      // If the image(s) end right at "limit", another image might still follow:
+      return ptr < limit ? RECORD_IS_COMPLETE : RECORD_IS_INCOMPLETE;
+    }
+
+    if (ptr + length + 1 > limit) return RECORD_IS_INCOMPLETE;
+    return ptr[length] == 0xFF ? RECORD_IS_COMPLETE : RECORD_IS_BAD;
+  } catch (int /*e*/) {
+    return RECORD_IS_INCOMPLETE;
+  }
+}
+
 void RecordAndDetailsParser::summarizeRecordParsing() {
 #ifdef DEBUG_RECORD_PARSING
   fprintf(stderr, "%d records parsed; max num records for one type: %d\n", fNumRecords, fMaxNumRecordsForOneType);
@@ -32,28 +32,37 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define JPEG_SOI ((0xFF<<8)|JPEG_SOI_BYTE)
 #define JPEG_EOI 0xFFD9
 
-int outputJPGFiles = 1;
-
-static char outputJPGFilenamePrefix[] = "embeddedImage";
-
-static FILE* openOutputJPGFile() {
-  static unsigned jpgFileNumber = 0;
-  char outputFileName[strlen(outputJPGFilenamePrefix) + 100];
-  sprintf(outputFileName, "embedded%d.jpg", ++jpgFileNumber);
-  FILE* outputFid = fopen(outputFileName, "wb");
-  if (outputFid == NULL) {
-    fprintf(stderr, "Failed to open output JPG file \"%s\"\n", outputFileName);
-  } else {
-    fprintf(stderr, "\tOutputting embedded JPEG image to the file \"%s\"\n", outputFileName);
-
-    // Begin by writing the initial JPEG SOI code:
-    fputc(JPEG_SOI>>8, outputFid); fputc(JPEG_SOI, outputFid);
+char const* jpgArchiveFileName = "embeddedImages.tar"; // usually set by "main()", from the input file name
+int geotagJPGFiles = 0;
+
+void RecordAndDetailsParser::outputJPEGImage(u_int8_t const* imageStart, u_int8_t const* imageEnd) {
+  if (fJPEGArchive == NULL) {
+    // This is the first image in the file.  Create the archive now (so that we don't create one
+    // for the (usual) case of a file that contains no images):
+    if (fJPEGArchiveFailed) return;
+    fJPEGArchive = JPEGArchive::createNew(jpgArchiveFileName);
+    if (fJPEGArchive == NULL) {
+      fJPEGArchiveFailed = 1;
+      return;
+    }
+  }
+
+  JPEGGeoTag geoTag;
+  double updateTime;
+  if (fFieldDatabase->getFieldAsDouble("CUSTOM.updateTime", updateTime)) {
+    geoTag.captureTime = (u_int64_t)(updateTime/1000);
+  }
+  if (geotagJPGFiles) {
+    geoTag.hasPosition
+      = fFieldDatabase->getFieldAsDouble("OSD.latitude", geoTag.latitude)
+      && fFieldDatabase->getFieldAsDouble("OSD.longitude", geoTag.longitude)
+      && fFieldDatabase->getFieldAsDouble("OSD.height", geoTag.height);
   }
 
-  return outputFid;
+  if (!fJPEGArchive->addImage(imageStart, imageEnd - imageStart, &geoTag)) fJPEGArchiveFailed = 1;
 }
 
-int RecordAndDetailsParser::parseRecord_JPEG(u_int8_t const*& ptr, u_int8_t const* limit) {
+int RecordAndDetailsParser::parseRecord_JPEG(u_int8_t const*& ptr, u_int8_t const* limit, int outputImages) {
   // Skip the first two bytes (both zero) in the record:
   (void)get2BytesBE(ptr, limit);
 
@@ -67,40 +76,24 @@ int RecordAndDetailsParser::parseRecord_JPEG(u_int8_t const*& ptr, u_int8_t cons
   }
   
   // The JPEG data is all following data, up to (and including) the next JPEG 'end of image' code,
-  // that's not then immediately followed by a JPEG 'start of image' code:
-  FILE* outputFid;
-  if (outputJPGFiles) {
-    outputFid = openOutputJPGFile();
-    if (outputFid == NULL) return 0;
-  }
-    
+  // that's not then immediately followed by a JPEG 'start of image' code.
+  // Because each image is contiguous in the file, we output it (in one chunk) once we've found its end:
+  u_int8_t const* imageStart = ptr - 2;
   while (1) {
     u_int16_t next2Bytes = get2BytesBE(ptr, limit);
     if (next2Bytes == JPEG_EOI) {
-      if (outputJPGFiles) {
-	// We've finished writing the JPG file:
-	fputc(JPEG_EOI>>8, outputFid); fputc(JPEG_EOI, outputFid);
-	fclose(outputFid);
-      }
+      if (outputImages) outputJPEGImage(imageStart, ptr);
 
       // Look for an immediately following JPEG 'start of image' code (if there's more data left):
       if (ptr == limit) return 1; // we're done
       next2Bytes = get2BytesBE(ptr, limit);
       if (next2Bytes == JPEG_SOI) {
-	if (outputJPGFiles) {
-	  outputFid = openOutputJPGFile();
-	  if (outputFid == NULL) return 0;
-	}
+	imageStart = ptr - 2;
       } else {
 	ptr -= 2;
 	return 1;
       }
     } else {
-      // Output the first byte, then continue:
-      if (outputJPGFiles) {
-	u_int8_t firstByte = next2Bytes >> 8;
-	fputc(firstByte, outputFid);
-      }
       --ptr;
     }
   }
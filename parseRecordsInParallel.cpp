@@ -0,0 +1,79 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Parsing all records within DJI ".txt" files, using a pipeline of threads.
+    Implementation.
+*/
+
+#include "RecordAndDetailsParser.hh"
+
+// The records are parsed by a pipeline of three stages, each in its own thread:
+//   1/ 'scan': find each record, and unscramble its data (if necessary)
+//   2/ 'decode': parse the fields in each record, and snapshot each row (the calling thread)
+//   3/ 'format': format and output each row (our "RowWriter"'s thread)
+// Stages 1 and 2 are connected by a bounded queue of "RecordView"s.
+
+void RecordAndDetailsParser
+::parseRecordsInParallel(u_int8_t const*& ptr, u_int8_t const* limit, int isScrambled) {
+  fRecordViews = new SPSCQueue<RecordView, NUM_RECORD_VIEWS>;
+  fStopScanning = 0;
+  std::thread scanner(&RecordAndDetailsParser::scannerThread, this, ptr, limit, isScrambled);
+
+  u_int8_t const* decodeFailurePtr = NULL;
+  while (1) {
+    RecordView& recordView = fRecordViews->beginPopWait();
+    if (recordView.isEnd) {
+      fRecordViews->endPop();
+      break;
+    }
+
+    if (decodeFailurePtr == NULL && !decodeRecord(recordView)) {
+      // Stop parsing here (as we would if we were parsing sequentially).  But keep
+      // consuming records until the 'scan' stage notices:
+      decodeFailurePtr = recordView.nextRecord;
+      fStopScanning = 1;
+    }
+    fRecordViews->endPop();
+  }
+
+  scanner.join();
+  delete fRecordViews; fRecordViews = NULL;
+
+  ptr = decodeFailurePtr != NULL ? decodeFailurePtr : fScanEndPtr;
+}
+
+void RecordAndDetailsParser::scannerThread(u_int8_t const* ptr, u_int8_t const* limit, int isScrambled) {
+  while (ptr < limit && !fStopScanning) {
+    RecordView& recordView = fRecordViews->beginPushWait();
+    if (!scanRecord(ptr, limit, isScrambled, recordView)) break;
+
+    // Note that we fill in each "RecordView" in place (in the queue), so that any unscrambled data -
+    // which is stored within the "RecordView" - doesn't need to be copied:
+    recordView.isEnd = 0;
+    fRecordViews->endPush();
+  }
+  fScanEndPtr = ptr;
+
+  // Tell the 'decode' stage that there are no more records:
+  RecordView& endView = fRecordViews->beginPushWait();
+  endView.isEnd = 1;
+  fRecordViews->endPush();
+}
@@ -0,0 +1,150 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Parsing a DJI ".txt" file that's read sequentially (e.g., from a pipe).
+    Implementation.
+*/
+
+#include "StreamingParser.hh"
+#include "DJITxtFile.hh"
+#include "InputStream.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// We don't expect the 'details' area to be any larger than this:
+#define MAX_DETAILS_AREA_SIZE 65536
+
+int DJITxtParser::parseFileDescriptor(int fd) {
+  // If "fd" is a file that we can read from anywhere (and we're at its start), then begin by reading
+  // its 'details' area from the end, so that (as when the file is mapped) every row gets the 'DETAILS' fields:
+  u_int64_t recordAreaEnd = 0;
+  struct stat sb;
+  if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && lseek(fd, 0, SEEK_CUR) == 0) {
+    u_int64_t const fileSize = sb.st_size;
+    u_int8_t header[OLD_HEADER_SIZE];
+    if (pread(fd, header, sizeof header, 0) == sizeof header) {
+      u_int8_t const* ptr = header;
+      u_int64_t headerPlusRecordAreaSize = getWord64LE(ptr);
+      if (headerPlusRecordAreaSize >= OLD_HEADER_SIZE + MIN_RECORD_SIZE && headerPlusRecordAreaSize < fileSize
+	  && fileSize - headerPlusRecordAreaSize <= MAX_DETAILS_AREA_SIZE) {
+	unsigned detailsAreaSize = fileSize - headerPlusRecordAreaSize;
+	u_int8_t* detailsArea = new u_int8_t[detailsAreaSize];
+	if (pread(fd, detailsArea, detailsAreaSize, headerPlusRecordAreaSize) == (ssize_t)detailsAreaSize) {
+	  parseDetailsAreaAfterHeader(header, detailsArea, detailsAreaSize);
+	  recordAreaEnd = headerPlusRecordAreaSize;
+	}
+	delete[] detailsArea;
+      }
+    }
+  }
+
+  InputStream* input = InputStream::createNew(fd);
+  int result = parseStream(*input, recordAreaEnd);
+  delete input;
+
+  return result;
+}
+
+u_int64_t DJITxtParser::parseDetailsAreaOfStream(InputStream& input) {
+  // Read (and discard) the header and the record area - whose size is given by the header - keeping only
+  // the 'details' area that follows:
+  u_int8_t header[OLD_HEADER_SIZE];
+  unsigned headerSize = 0;
+  u_int64_t headerPlusRecordAreaSize = 0; // (known once we have the header)
+  u_int8_t* detailsArea = new u_int8_t[MAX_DETAILS_AREA_SIZE];
+  unsigned detailsAreaSize = 0;
+  u_int64_t position = 0; // of the current piece of the input
+  while (1) {
+    unsigned numBytes;
+    u_int8_t const* data = input.beginRead(numBytes);
+    if (numBytes == 0) break; // end of stream
+
+    for (unsigned i = 0; i < numBytes && headerSize < sizeof header; ++i) header[headerSize++] = data[i];
+    if (headerSize == sizeof header && headerPlusRecordAreaSize == 0) {
+      u_int8_t const* ptr = header;
+      headerPlusRecordAreaSize = getWord64LE(ptr);
+      if (headerPlusRecordAreaSize < OLD_HEADER_SIZE + MIN_RECORD_SIZE) { // not a '.txt' file
+	input.endRead(numBytes);
+	break;
+      }
+    }
+
+    if (headerPlusRecordAreaSize > 0 && position + numBytes > headerPlusRecordAreaSize) {
+      // (The rest of) this piece of the input is (part of) the 'details' area:
+      u_int64_t const start = headerPlusRecordAreaSize > position ? headerPlusRecordAreaSize - position : 0;
+      unsigned numDetailsBytes = numBytes - start;
+      if (numDetailsBytes > MAX_DETAILS_AREA_SIZE - detailsAreaSize) {
+	numDetailsBytes = MAX_DETAILS_AREA_SIZE - detailsAreaSize; // any more data is ignored
+      }
+      memcpy(&detailsArea[detailsAreaSize], &data[start], numDetailsBytes);
+      detailsAreaSize += numDetailsBytes;
+    }
+    input.endRead(numBytes);
+    position += numBytes;
+  }
+
+  u_int64_t recordAreaEnd = 0;
+  if (detailsAreaSize > 0 && !input.readFailed()) {
+    parseDetailsAreaAfterHeader(header, detailsArea, detailsAreaSize);
+    recordAreaEnd = headerPlusRecordAreaSize;
+  }
+  delete[] detailsArea;
+
+  return recordAreaEnd;
+}
+
+void DJITxtParser::parseDetailsAreaAfterHeader(u_int8_t const* header, u_int8_t const* detailsArea,
+					       unsigned detailsAreaSize) {
+  extern u_int32_t fileVersionNumber;
+  u_int8_t const* ptr = header + 8;
+  fileVersionNumber = getWord32BE(ptr); // the 'details' area's format depends on it
+
+  ptr = detailsArea;
+  try {
+    parseDetailsArea(ptr, detailsArea + detailsAreaSize);
+  } catch (int /*e*/) {
+    fprintf(stderr, "Unexpected error in parsing the 'details' area\n");
+  }
+}
+
+int DJITxtParser::parseStream(InputStream& input, u_int64_t recordAreaEnd) {
+  // Feed each (contiguous) piece of the input stream to our parser, as it arrives:
+  StreamingParser streamingParser(*this);
+  u_int64_t position = 0;
+  while (recordAreaEnd == 0 || position < recordAreaEnd) {
+    unsigned numBytes;
+    u_int8_t const* data = input.beginRead(numBytes);
+    if (numBytes == 0) break; // end of stream
+
+    if (recordAreaEnd != 0 && numBytes > recordAreaEnd - position) numBytes = recordAreaEnd - position;
+    streamingParser.feed(data, numBytes);
+    input.endRead(numBytes);
+    position += numBytes;
+  }
+
+  int result = streamingParser.endFeed();
+  if (input.readFailed()) result = 0;
+
+  return result;
+}
@@ -24,200 +24,309 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "RecordAndDetailsParser.hh"
-#include <stdio.h>
-
-#define separator ","
-#define o_(label,nFrac) if (outputColumnLabels) printf(label); else fFieldDatabase->outputField(label, nFrac)
-#define oInterpreted_(label,interpretedLabel) if (outputColumnLabels) printf(interpretedLabel); else fFieldDatabase->outputFieldInterpreted(label, interpretedLabel)
-#define oBoolean_(label) if (outputColumnLabels) printf(label); else fFieldDatabase->outputFieldAsBoolean(label)
-#define oFirst(label) o_(label,0)
-#define oFrac(label,nFrac) do { printf(separator); o_(label,nFrac); } while (0)
-#define o(label) oFrac(label,0)
-#define oInterpreted(label,interpretedLabel) do { printf(separator); oInterpreted_(label,interpretedLabel); } while (0)
-#define oBoolean(label) do { printf(separator); oBoolean_(label); } while (0)
+#include <string.h>
+
+#define COLUMN_FRAC(label,nFrac) { label, NULL, ColumnPlain, nFrac }
+#define COLUMN(label) COLUMN_FRAC(label,0)
+#define COLUMN_INTERPRETED(label,interpretedLabel) { label, interpretedLabel, ColumnInterpreted, 0 }
+#define COLUMN_BOOLEAN(label) { label, NULL, ColumnBoolean, 0 }
+
+// The columns of each output row, in order:
+static OutputColumn const outputColumns[] = {
+  COLUMN("CUSTOM.updateTime"),
+  COLUMN_FRAC("CUSTOM.hSpeed", 2),
+  COLUMN_FRAC("CUSTOM.distance", 2),
+  COLUMN_FRAC("OSD.latitude", 6),
+  COLUMN_FRAC("OSD.longitude", 6),
+  COLUMN_FRAC("OSD.height", 1),
+  COLUMN_FRAC("OSD.xSpeed", 1),
+  COLUMN_FRAC("OSD.ySpeed", 1),
+  COLUMN_FRAC("OSD.zSpeed", 1),
+  COLUMN_FRAC("OSD.pitch", 1),
+  COLUMN_FRAC("OSD.roll", 1),
+  COLUMN_FRAC("OSD.yaw", 1),
+  COLUMN_INTERPRETED("OSD.flycState.RAW", "OSD.flycState"),
+  COLUMN_INTERPRETED("OSD.flycCommand.RAW", "OSD.flycCommand"),
+  COLUMN_BOOLEAN("OSD.canIOCWork"),
+  COLUMN_INTERPRETED("OSD.groundOrSky.RAW", "OSD.groundOrSky"),
+  COLUMN_BOOLEAN("OSD.isMotorUp"),
+  COLUMN_BOOLEAN("OSD.isSwaveWork"),
+  COLUMN_INTERPRETED("OSD.goHomeStatus.RAW", "OSD.goHomeStatus"),
+  COLUMN_BOOLEAN("OSD.isImuPreheated"),
+  COLUMN_BOOLEAN("OSD.isVisionUsed"),
+  COLUMN("OSD.voltageWarning"),
+  COLUMN("OSD.modeChannel"),
+  COLUMN_BOOLEAN("OSD.compassError"),
+  COLUMN_BOOLEAN("OSD.waveError"),
+  COLUMN("OSD.gpsLevel"),
+  COLUMN_INTERPRETED("OSD.batteryType.RAW", "OSD.batteryType"),
+  COLUMN_BOOLEAN("OSD.isAcceletorOverRange"),
+  COLUMN_BOOLEAN("OSD.isVibrating"),
+  COLUMN_BOOLEAN("OSD.isBarometerDeadInAir"),
+  COLUMN_BOOLEAN("OSD.isMotorBlocked"),
+  COLUMN_BOOLEAN("OSD.isNotEnoughForce"),
+  COLUMN_BOOLEAN("OSD.isPropellerCatapult"),
+  COLUMN_BOOLEAN("OSD.isGoHomeHeightModified"),
+  COLUMN_BOOLEAN("OSD.isOutOfLimit"),
+  COLUMN("OSD.gpsNum"),
+  COLUMN("OSD.flightAction"),
+  COLUMN_INTERPRETED("OSD.flightAction.RAW", "OSD.flightAction"),
+  COLUMN_INTERPRETED("OSD.motorStartFailedCause.RAW", "OSD.motorStartFailedCause"),
+  COLUMN_INTERPRETED("OSD.nonGPSCause.RAW", "OSD.nonGPSCause"),
+  COLUMN_BOOLEAN("OSD.isQuickSpin"),
+  COLUMN("OSD.battery"),
+  COLUMN_FRAC("OSD.sWaveHeight", 1),
+  COLUMN_FRAC("OSD.flyTime", 1),
+  COLUMN("OSD.motorRevolution"),
+  COLUMN("OSD.flycVersion"),
+  COLUMN_INTERPRETED("OSD.droneType.RAW", "OSD.droneType"),
+  COLUMN_INTERPRETED("OSD.imuInitFailReason.RAW", "OSD.imuInitFailReason"),
+  COLUMN_INTERPRETED("OSD.motorFailReason.RAW", "OSD.motorFailReason"),
+  COLUMN_INTERPRETED("OSD.ctrlDevice.RAW", "OSD.ctrlDevice"),
+  COLUMN_FRAC("GIMBAL.pitch", 1),
+  COLUMN_FRAC("GIMBAL.roll", 1),
+  COLUMN_FRAC("GIMBAL.yaw", 1),
+  COLUMN_INTERPRETED("GIMBAL.mode.RAW", "GIMBAL.mode"),
+  COLUMN_FRAC("GIMBAL.rollAdjust", 1),
+  COLUMN_FRAC("GIMBAL.yawAngle", 1),
+  COLUMN_BOOLEAN("GIMBAL.isAutoCalibration"),
+  COLUMN("GIMBAL.autoCalibrationResult"),
+  COLUMN_BOOLEAN("GIMBAL.isPitchInLimit"),
+  COLUMN_BOOLEAN("GIMBAL.isRollInLimit"),
+  COLUMN_BOOLEAN("GIMBAL.isYawInLimit"),
+  COLUMN_BOOLEAN("GIMBAL.isStuck"),
+  COLUMN("GIMBAL.version"),
+  COLUMN_BOOLEAN("GIMBAL.isSingleClick"),
+  COLUMN_BOOLEAN("GIMBAL.isDoubleClick"),
+  COLUMN_BOOLEAN("GIMBAL.isTripleClick"),
+  COLUMN("RC.aileron"),
+  COLUMN("RC.elevator"),
+  COLUMN("RC.throttle"),
+  COLUMN("RC.rudder"),
+  COLUMN("RC.gimbal"),
+  COLUMN("RC.goHome"),
+  COLUMN("RC.mode"),
+  COLUMN("RC.wheelOffset"),
+  COLUMN("RC.record"),
+  COLUMN("RC.shutter"),
+  COLUMN("RC.playback"),
+  COLUMN("RC.custom1"),
+  COLUMN("RC.custom2"),
+  COLUMN("CENTER_BATTERY.relativeCapacity"),
+  COLUMN("CENTER_BATTERY.currentPV"),
+  COLUMN("CENTER_BATTERY.currentCapacity"),
+  COLUMN("CENTER_BATTERY.fullCapacity"),
+  COLUMN("CENTER_BATTERY.life"),
+  COLUMN("CENTER_BATTERY.loopNum"),
+  COLUMN("CENTER_BATTERY.errorType"),
+  COLUMN("CENTER_BATTERY.current"),
+  COLUMN("CENTER_BATTERY.voltageCell1"),
+  COLUMN("CENTER_BATTERY.voltageCell2"),
+  COLUMN("CENTER_BATTERY.voltageCell3"),
+  COLUMN("CENTER_BATTERY.voltageCell4"),
+  COLUMN("CENTER_BATTERY.voltageCell5"),
+  COLUMN("CENTER_BATTERY.voltageCell6"),
+  COLUMN("CENTER_BATTERY.serialNo"),
+  COLUMN("CENTER_BATTERY.productDate"),
+  COLUMN("CENTER_BATTERY.temperature"),
+  COLUMN("CENTER_BATTERY.connStatus"),
+  COLUMN("CENTER_BATTERY.totalStudyCycle"),
+  COLUMN("CENTER_BATTERY.lastStudyCycle"),
+  COLUMN("CENTER_BATTERY.isNeedStudy"),
+  COLUMN("CENTER_BATTERY.isBatteryOnCharge"),
+  COLUMN("SMART_BATTERY.usefulTime"),
+  COLUMN("SMART_BATTERY.goHomeTime"),
+  COLUMN("SMART_BATTERY.landTime"),
+  COLUMN("SMART_BATTERY.goHomeBattery"),
+  COLUMN("SMART_BATTERY.landBattery"),
+  COLUMN("SMART_BATTERY.safeFlyRadius"),
+  COLUMN("SMART_BATTERY.volumeConsume"),
+  COLUMN_INTERPRETED("SMART_BATTERY.status.RAW", "SMART_BATTERY.status"),
+  COLUMN_INTERPRETED("SMART_BATTERY.goHomeStatus.RAW", "SMART_BATTERY.goHomeStatus"),
+  COLUMN("SMART_BATTERY.goHomeCountdown"),
+  COLUMN("SMART_BATTERY.voltage"),
+  COLUMN("SMART_BATTERY.battery"),
+  COLUMN("SMART_BATTERY.lowWarning"),
+  COLUMN("SMART_BATTERY.lowWarningGoHome"),
+  COLUMN("SMART_BATTERY.seriousLowWarning"),
+  COLUMN("SMART_BATTERY.seriousLowWarningLanding"),
+  COLUMN("SMART_BATTERY.voltagePercent"),
+  COLUMN("DEFORM.isDeformProtected"),
+  COLUMN_INTERPRETED("DEFORM.deformStatus.RAW", "DEFORM.deformStatus"),
+  COLUMN_INTERPRETED("DEFORM.deformMode.RAW", "DEFORM.deformMode"),
+  COLUMN_FRAC("HOME.latitude", 6),
+  COLUMN_FRAC("HOME.longitude", 6),
+  COLUMN_FRAC("HOME.height", 2),
+  COLUMN_BOOLEAN("HOME.isHomeRecord"),
+  COLUMN("HOME.goHomeMode"),
+  COLUMN("HOME.aircraftHeadDirection"),
+  COLUMN_BOOLEAN("HOME.isDynamicHomePointEnabled"),
+  COLUMN("HOME.goHomeStatus"),
+  COLUMN_BOOLEAN("HOME.hasGoHome"),
+  COLUMN("HOME.compassCeleStatus"),
+  COLUMN_BOOLEAN("HOME.isCompassCeleing"),
+  COLUMN_BOOLEAN("HOME.isBeginnerMode"),
+  COLUMN_BOOLEAN("HOME.isIOCEnabled"),
+  COLUMN_INTERPRETED("HOME.iocMode.RAW", "HOME.iocMode"),
+  COLUMN("HOME.goHomeHeight"),
+  COLUMN_FRAC("HOME.courseLockAngle", 1),
+  COLUMN("HOME.dataRecorderStatus"),
+  COLUMN("HOME.dataRecorderRemainCapacity"),
+  COLUMN("HOME.dataRecorderRemainTime"),
+  COLUMN("HOME.dataRecorderFileIndex"),
+  COLUMN_INTERPRETED("RECOVER.droneType.RAW", "RECOVER.droneType"),
+  COLUMN_INTERPRETED("RECOVER.appType.RAW", "RECOVER.appType"),
+  COLUMN("RECOVER.appVersion"),
+  COLUMN("RECOVER.aircraftSn"),
+  COLUMN("RECOVER.aircraftName"),
+  COLUMN("RECOVER.activeTimestamp"),
+  COLUMN("RECOVER.cameraSn"),
+  COLUMN("RECOVER.rcSn"),
+  COLUMN("RECOVER.batterySn"),
+  COLUMN("FIRMWARE.version"),
+  COLUMN("DETAILS.street"),
+  COLUMN("DETAILS.citypart"),
+  COLUMN("DETAILS.city"),
+  COLUMN("DETAILS.area"),
+  COLUMN("DETAILS.isFavorite"),
+  COLUMN("DETAILS.isNew"),
+  COLUMN("DETAILS.needUpload"),
+  COLUMN("DETAILS.recordLineCount"),
+  COLUMN("DETAILS.timestamp"),
+  COLUMN_FRAC("DETAILS.latitude", 6),
+  COLUMN_FRAC("DETAILS.longitude", 6),
+  COLUMN_FRAC("DETAILS.totalDistance", 2),
+  COLUMN_FRAC("DETAILS.totalTime", 1),
+  COLUMN_FRAC("DETAILS.maxHeight", 1),
+  COLUMN_FRAC("DETAILS.maxHorizontalSpeed", 2),
+  COLUMN_FRAC("DETAILS.maxVerticalSpeed", 1),
+  COLUMN("DETAILS.photoNum"),
+  COLUMN("DETAILS.videoTime"),
+  COLUMN("DETAILS.activeTimestamp"),
+  COLUMN("DETAILS.aircraftName"),
+  COLUMN("DETAILS.aircraftSn"),
+  COLUMN("DETAILS.cameraSn"),
+  COLUMN("DETAILS.rcSn"),
+  COLUMN("DETAILS.batterySn"),
+  COLUMN_INTERPRETED("DETAILS.appType.RAW", "DETAILS.appType"),
+  COLUMN("DETAILS.appVersion"),
+  COLUMN_FRAC("APP_GPS.latitude", 6),
+  COLUMN_FRAC("APP_GPS.longitude", 6),
+  COLUMN("APP_GPS.accuracy"),
+  COLUMN("APP_TIP.tip"),
+  COLUMN("APP_WARN.warn")
+};
+
+#define NUM_OUTPUT_COLUMNS (sizeof outputColumns/sizeof outputColumns[0])
+
+RowWriter* RecordAndDetailsParser::createRowWriter(int fd, OutputCompressor* compressor) {
+  return RowWriter::createNew(outputColumns, NUM_OUTPUT_COLUMNS, fFieldDatabase, fd, compressor, fRowFormat);
+}
+
+void RecordAndDetailsParser::enableRecordStreams(char const* fileNamePrefix, char const* fileNameSuffix,
+						 int compressionMethod, int compressionLevel) {
+  RecordStreams* recordStreams
+    = RecordStreams::createNew(fileNamePrefix, fileNameSuffix, outputColumns, NUM_OUTPUT_COLUMNS,
+			       fFieldDatabase, fRowFormat == RowFormatJSONLines ? RowFormatJSONLines : RowFormatCSV,
+			       compressionMethod, compressionLevel);
+  fFlightObservers.push_back(recordStreams);
+  fOwnedFlightObservers.push_back(recordStreams);
+}
+
+int RecordAndDetailsParser::enableTrackExport(char const* fileName, int trackFormat, double minDistance,
+					      double const* lodTolerances, unsigned numLODLevels) {
+  if (trackFormat < 0 || trackFormat >= NUM_TRACK_FORMATS) return 0;
+
+  TrackExporter* trackExporter = TrackExporter::createNew(fileName, trackFormat, fFieldDatabase, minDistance,
+							 lodTolerances, numLODLevels);
+  if (trackExporter == NULL) return 0;
+
+  fFlightObservers.push_back(trackExporter);
+  fOwnedFlightObservers.push_back(trackExporter);
+  return 1;
+}
+
+int RecordAndDetailsParser::addFlightObserver(FlightObserver* observer) {
+  if (!observer->startFlight(fFieldDatabase, outputColumns, NUM_OUTPUT_COLUMNS)) return 0;
+
+  fFlightObservers.push_back(observer);
+  return 1;
+}
+
+void RecordAndDetailsParser::disableJPEGOutput() {
+  fOutputJPEGImages = 0;
+}
+
+int RecordAndDetailsParser::jpegArchiveResult() const {
+  if (fJPEGArchiveFailed) return -1;
+  return fJPEGArchive != NULL;
+}
+
+// Returns the output column with the given name (the last one, if there's more than one), or NULL if none:
+static OutputColumn const* lookupOutputColumn(char const* columnName) {
+  OutputColumn const* result = NULL;
+  for (unsigned i = 0; i < NUM_OUTPUT_COLUMNS; ++i) {
+    if (strcmp(outputColumns[i].columnName(), columnName) == 0) result = &outputColumns[i];
+  }
+
+  return result;
+}
+
+int RecordAndDetailsParser::getFieldValue(char const* fieldName, double& result) {
+  OutputColumn const* column = lookupOutputColumn(fieldName);
+  return column != NULL && fFieldDatabase->getFieldAsDouble(column->label, result);
+}
+
+int RecordAndDetailsParser::getFieldValue(char const* fieldName, std::string& result) {
+  OutputColumn const* column = lookupOutputColumn(fieldName);
+  if (column == NULL) return 0;
+
+  FieldSnapshot snapshot;
+  StringArena arena;
+  fFieldDatabase->snapshotField(column->label, snapshot, arena);
+  if (!snapshot.isPresent) return 0;
+
+  OutputBuffer out(-1, 256); // in memory
+  switch (column->kind) {
+    case ColumnPlain: {
+      FieldDatabase::formatField(out, snapshot, column->numFractionalDigits);
+      break;
+    }
+    case ColumnBoolean: {
+      FieldDatabase::formatFieldAsBoolean(out, snapshot);
+      break;
+    }
+    case ColumnInterpreted: {
+      FieldDatabase::formatFieldInterpreted(out, snapshot, fFieldDatabase->lookupInterpretationTable(column->interpretedLabel));
+      break;
+    }
+  }
+  result.assign(out.data(), out.size());
+
+  return 1;
+}
+
+OutputColumn const* DJITxtParser::outputColumnTable(unsigned& numColumns) {
+  numColumns = NUM_OUTPUT_COLUMNS;
+  return outputColumns;
+}
+
+FlightTable* RecordAndDetailsParser::createFlightTable() {
+  return FlightTable::createNew(outputColumns, NUM_OUTPUT_COLUMNS, fFieldDatabase);
+}
 
 void RecordAndDetailsParser::outputOneRow(int outputColumnLabels) {
-  oFirst("CUSTOM.updateTime");
-  oFrac("CUSTOM.hSpeed", 2);
-  oFrac("CUSTOM.distance", 2);
-  oFrac("OSD.latitude", 6);
-  oFrac("OSD.longitude", 6);
-  oFrac("OSD.height", 1);
-  oFrac("OSD.xSpeed", 1);
-  oFrac("OSD.ySpeed", 1);
-  oFrac("OSD.zSpeed", 1);
-  oFrac("OSD.pitch", 1);
-  oFrac("OSD.roll", 1);
-  oFrac("OSD.yaw", 1);
-  oInterpreted("OSD.flycState.RAW", "OSD.flycState");
-  oInterpreted("OSD.flycCommand.RAW", "OSD.flycCommand");
-  oBoolean("OSD.canIOCWork");
-  oInterpreted("OSD.groundOrSky.RAW", "OSD.groundOrSky");
-  oBoolean("OSD.isMotorUp");
-  oBoolean("OSD.isSwaveWork");
-  oInterpreted("OSD.goHomeStatus.RAW", "OSD.goHomeStatus");
-  oBoolean("OSD.isImuPreheated");
-  oBoolean("OSD.isVisionUsed");
-  o("OSD.voltageWarning");
-  o("OSD.modeChannel");
-  oBoolean("OSD.compassError");
-  oBoolean("OSD.waveError");
-  o("OSD.gpsLevel");
-  oInterpreted("OSD.batteryType.RAW", "OSD.batteryType");
-  oBoolean("OSD.isAcceletorOverRange");
-  oBoolean("OSD.isVibrating");
-  oBoolean("OSD.isBarometerDeadInAir");
-  oBoolean("OSD.isMotorBlocked");
-  oBoolean("OSD.isNotEnoughForce");
-  oBoolean("OSD.isPropellerCatapult");
-  oBoolean("OSD.isGoHomeHeightModified");
-  oBoolean("OSD.isOutOfLimit");
-  o("OSD.gpsNum");
-  o("OSD.flightAction");
-  oInterpreted("OSD.flightAction.RAW", "OSD.flightAction");
-  oInterpreted("OSD.motorStartFailedCause.RAW", "OSD.motorStartFailedCause");
-  oInterpreted("OSD.nonGPSCause.RAW", "OSD.nonGPSCause");
-  oBoolean("OSD.isQuickSpin");
-  o("OSD.battery");
-  oFrac("OSD.sWaveHeight", 1);
-  oFrac("OSD.flyTime", 1);
-  o("OSD.motorRevolution");
-  o("OSD.flycVersion");
-  oInterpreted("OSD.droneType.RAW", "OSD.droneType");
-  oInterpreted("OSD.imuInitFailReason.RAW", "OSD.imuInitFailReason");
-  oInterpreted("OSD.motorFailReason.RAW", "OSD.motorFailReason");
-  oInterpreted("OSD.ctrlDevice.RAW", "OSD.ctrlDevice");
-  oFrac("GIMBAL.pitch", 1);
-  oFrac("GIMBAL.roll", 1);
-  oFrac("GIMBAL.yaw", 1);
-  oInterpreted("GIMBAL.mode.RAW", "GIMBAL.mode");
-  oFrac("GIMBAL.rollAdjust", 1);
-  oFrac("GIMBAL.yawAngle", 1);
-  oBoolean("GIMBAL.isAutoCalibration");
-  o("GIMBAL.autoCalibrationResult");
-  oBoolean("GIMBAL.isPitchInLimit");
-  oBoolean("GIMBAL.isRollInLimit");
-  oBoolean("GIMBAL.isYawInLimit");
-  oBoolean("GIMBAL.isStuck");
-  o("GIMBAL.version");
-  oBoolean("GIMBAL.isSingleClick");
-  oBoolean("GIMBAL.isDoubleClick");
-  oBoolean("GIMBAL.isTripleClick");
-  o("RC.aileron");
-  o("RC.elevator");
-  o("RC.throttle");
-  o("RC.rudder");
-  o("RC.gimbal");
-  o("RC.goHome");
-  o("RC.mode");
-  o("RC.wheelOffset");
-  o("RC.record");
-  o("RC.shutter");
-  o("RC.playback");
-  o("RC.custom1");
-  o("RC.custom2");
-  o("CENTER_BATTERY.relativeCapacity");
-  o("CENTER_BATTERY.currentPV");
-  o("CENTER_BATTERY.currentCapacity");
-  o("CENTER_BATTERY.fullCapacity");
-  o("CENTER_BATTERY.life");
-  o("CENTER_BATTERY.loopNum");
-  o("CENTER_BATTERY.errorType");
-  o("CENTER_BATTERY.current");
-  o("CENTER_BATTERY.voltageCell1");
-  o("CENTER_BATTERY.voltageCell2");
-  o("CENTER_BATTERY.voltageCell3");
-  o("CENTER_BATTERY.voltageCell4");
-  o("CENTER_BATTERY.voltageCell5");
-  o("CENTER_BATTERY.voltageCell6");
-  o("CENTER_BATTERY.serialNo");
-  o("CENTER_BATTERY.productDate");
-  o("CENTER_BATTERY.temperature");
-  o("CENTER_BATTERY.connStatus");
-  o("CENTER_BATTERY.totalStudyCycle");
-  o("CENTER_BATTERY.lastStudyCycle");
-  o("CENTER_BATTERY.isNeedStudy");
-  o("CENTER_BATTERY.isBatteryOnCharge");
-  o("SMART_BATTERY.usefulTime");
-  o("SMART_BATTERY.goHomeTime");
-  o("SMART_BATTERY.landTime");
-  o("SMART_BATTERY.goHomeBattery");
-  o("SMART_BATTERY.landBattery");
-  o("SMART_BATTERY.safeFlyRadius");
-  o("SMART_BATTERY.volumeConsume");
-  oInterpreted("SMART_BATTERY.status.RAW", "SMART_BATTERY.status");
-  oInterpreted("SMART_BATTERY.goHomeStatus.RAW", "SMART_BATTERY.goHomeStatus");
-  o("SMART_BATTERY.goHomeCountdown");
-  o("SMART_BATTERY.voltage");
-  o("SMART_BATTERY.battery");
-  o("SMART_BATTERY.lowWarning");
-  o("SMART_BATTERY.lowWarningGoHome");
-  o("SMART_BATTERY.seriousLowWarning");
-  o("SMART_BATTERY.seriousLowWarningLanding");
-  o("SMART_BATTERY.voltagePercent");
-  o("DEFORM.isDeformProtected");
-  oInterpreted("DEFORM.deformStatus.RAW", "DEFORM.deformStatus");
-  oInterpreted("DEFORM.deformMode.RAW","DEFORM.deformMode");
-  oFrac("HOME.latitude", 6);
-  oFrac("HOME.longitude", 6);
-  oFrac("HOME.height", 2);
-  oBoolean("HOME.isHomeRecord");
-  o("HOME.goHomeMode");
-  o("HOME.aircraftHeadDirection");
-  oBoolean("HOME.isDynamicHomePointEnabled");
-  o("HOME.goHomeStatus");
-  oBoolean("HOME.hasGoHome");
-  o("HOME.compassCeleStatus");
-  oBoolean("HOME.isCompassCeleing");
-  oBoolean("HOME.isBeginnerMode");
-  oBoolean("HOME.isIOCEnabled");
-  oInterpreted("HOME.iocMode.RAW", "HOME.iocMode");
-  o("HOME.goHomeHeight");
-  oFrac("HOME.courseLockAngle", 1);
-  o("HOME.dataRecorderStatus");
-  o("HOME.dataRecorderRemainCapacity");
-  o("HOME.dataRecorderRemainTime");
-  o("HOME.dataRecorderFileIndex");
-  oInterpreted("RECOVER.droneType.RAW", "RECOVER.droneType");
-  oInterpreted("RECOVER.appType.RAW", "RECOVER.appType");
-  o("RECOVER.appVersion");
-  o("RECOVER.aircraftSn");
-  o("RECOVER.aircraftName");
-  o("RECOVER.activeTimestamp");
-  o("RECOVER.cameraSn");
-  o("RECOVER.rcSn");
-  o("RECOVER.batterySn");
-  o("FIRMWARE.version");
-  o("DETAILS.street");
-  o("DETAILS.citypart");
-  o("DETAILS.city");
-  o("DETAILS.area");
-  o("DETAILS.isFavorite");
-  o("DETAILS.isNew");
-  o("DETAILS.needUpload");
-  o("DETAILS.recordLineCount");
-  o("DETAILS.timestamp");
-  oFrac("DETAILS.latitude", 6);
-  oFrac("DETAILS.longitude", 6);
-  oFrac("DETAILS.totalDistance", 2);
-  oFrac("DETAILS.totalTime", 1);
-  oFrac("DETAILS.maxHeight", 1);
-  oFrac("DETAILS.maxHorizontalSpeed", 2);
-  oFrac("DETAILS.maxVerticalSpeed", 1);
-  o("DETAILS.photoNum");
-  o("DETAILS.videoTime");
-  o("DETAILS.activeTimestamp");
-  o("DETAILS.aircraftName");
-  o("DETAILS.aircraftSn");
-  o("DETAILS.cameraSn");
-  o("DETAILS.rcSn");
-  o("DETAILS.batterySn");
-  oInterpreted("DETAILS.appType.RAW", "DETAILS.appType");
-  o("DETAILS.appVersion");
-  oFrac("APP_GPS.latitude", 6);
-  oFrac("APP_GPS.longitude", 6);
-  o("APP_GPS.accuracy");
-  o("APP_TIP.tip");
-  o("APP_WARN.warn");
-  printf("\n");
+  // Hand a snapshot of the row's fields to our writer (which formats and outputs it in another thread):
+  if (fRowWriter != NULL) fRowWriter->outputRow(outputColumnLabels);
+
+  // Also append the row's fields to our "FlightTable", if we have one.  (The first row - which is
+  // output as column labels - has no data.):
+  if (fFlightTable != NULL && !outputColumnLabels) fFlightTable->appendRow();
+
+  for (unsigned i = 0; i < fFlightObservers.size(); ++i) fFlightObservers[i]->noteRow(outputColumnLabels);
+}
+
+void RecordAndDetailsParser::flushRows() {
+  if (fRowWriter != NULL) fRowWriter->flush();
+  for (unsigned i = 0; i < fFlightObservers.size(); ++i) fFlightObservers[i]->flush();
 }
@@ -0,0 +1,50 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    A shared library (for the tests) that exports a parsed log through the Arrow C Data Interface.
+    Implementation.
+*/
+
+// A shared library (used by "arrowImport.py") that exports a parsed log through the Arrow C Data Interface,
+// so that the export can be checked by a standard consumer.
+
+#include "DJITxtParser.hh"
+#include "DJITxtFile.hh"
+#include "ArrowExport.hh"
+
+// Parses "txtFileName" into a "FlightTable", and exports it.  Returns 1 iff it succeeds (in which case
+// "*schema" and "*array" must later be released, by the consumer):
+extern "C" int exportLog(char const* txtFileName, struct ArrowSchema* schema, struct ArrowArray* array) {
+  DJITxtFile* file = DJITxtFile::createNew(txtFileName);
+  if (file == NULL) return 0;
+
+  DJITxtParser* parser = DJITxtParser::createNew(ROW_OUTPUT_NONE);
+  parser->disableJPEGOutput();
+  parser->enableFlightTable();
+  (void)parser->parseFile(*file);
+  FlightTable* table = parser->detachFlightTable();
+  delete parser;
+  delete file;
+
+  if (exportFlightTableToArrow(table, schema, array)) return 1;
+  delete table;
+  return 0;
+}
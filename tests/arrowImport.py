@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+# Usage: arrowImport.py <library> <txtFile> <csvFile>
+# Imports a log into pyarrow through the Arrow C Data Interface - from "exportLog()" in <library> (built from
+# "arrowExportLibrary.cpp") - and checks that it's a valid record batch, with the same rows and values as the
+# CSV output for the same log.
+# Exits with status 0 iff they match; 77 (i.e., 'skipped') if pyarrow isn't installed.
+
+import sys, ctypes
+
+try:
+    import pyarrow
+except ImportError:
+    print('pyarrow is not installed; skipping the Arrow import check')
+    sys.exit(77)
+from csvCompare import compareWithCSV
+
+library = ctypes.CDLL(sys.argv[1])
+library.exportLog.argtypes = [ctypes.c_char_p, ctypes.c_void_p, ctypes.c_void_p]
+schema = ctypes.create_string_buffer(72) # a "struct ArrowSchema"
+array = ctypes.create_string_buffer(80) # a "struct ArrowArray"
+if library.exportLog(sys.argv[2].encode(), ctypes.addressof(schema), ctypes.addressof(array)) != 1:
+    print('FAILED: Arrow import: %s: exportLog() failed' % sys.argv[2])
+    sys.exit(1)
+
+# pyarrow takes ownership of the exported schema and array (and releases them when it's done with them):
+batch = pyarrow.RecordBatch._import_from_c(ctypes.addressof(array), ctypes.addressof(schema))
+try:
+    batch.validate(full=True)
+    problems = compareWithCSV(batch, sys.argv[3])
+except pyarrow.ArrowInvalid as e:
+    problems = ['invalid: %s' % e]
+
+for problem in problems:
+    print('FAILED: Arrow import: %s: %s' % (sys.argv[2], problem))
+if problems:
+    sys.exit(1)
+print('%s: %d rows and %d columns match the CSV output' % (sys.argv[2], batch.num_rows, batch.num_columns))
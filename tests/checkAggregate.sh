@@ -0,0 +1,73 @@
+# Checks --aggregate, over a directory holding both test logs and a gzip-compressed copy of one of them: each
+# result must be the one computed from the expected CSV output of the logs, whatever the number of processes.
+
+mkdir "$TMP/logs"
+cp "$DATA/a.txt" "$DATA/b.txt" "$TMP/logs/" && gzip -c "$DATA/a.txt" >"$TMP/logs/c.txt.gz"
+aggregate() {
+  $DJIPARSETXT --aggregate "$1" "$TMP/logs" 2>/dev/null
+}
+
+[ "`aggregate count`" = "count,flights
+3,3" ] || fail "--aggregate count"
+# (A key that contains a comma or a quote is quoted:)
+[ "`aggregate 'count by APP_TIP.tip'`" = 'APP_TIP.tip,count,flights
+"Tip: ""quoted"", with comma",3,3' ] || fail "--aggregate: a key that needs quoting"
+aggregate "time by OSD.flycState" >"$TMP/time.csv" && $DJIPARSETXT -P 3 --aggregate "time by OSD.flycState" \
+  "$TMP/logs" 2>/dev/null | cmp -s - "$TMP/time.csv" || fail "--aggregate with several processes"
+aggregate bogus >/dev/null && fail "--aggregate: a bad aggregation"
+aggregate "max(OSD.noSuchField)" >/dev/null && fail "--aggregate: an unknown field"
+aggregate "count by" >/dev/null && fail "--aggregate: a missing key field"
+
+if [ -n "$PYTHON" ]; then
+  aggregate "max(OSD.height)" >"$TMP/max.csv" && aggregate "min(OSD.latitude) by DETAILS.aircraftName" >"$TMP/min.csv" \
+    && $PYTHON - "$TMP" "$DATA/a.csv" "$DATA/b.csv" <<'END' || fail "--aggregate: the results"
+import sys, time, calendar
+tmp = sys.argv[1]
+flights = []
+for csvFileName in (sys.argv[2], sys.argv[3], sys.argv[2]): # (c.txt.gz is a copy of a.txt)
+    lines = open(csvFileName).read().splitlines()
+    labels = lines[0].split(',')
+    flights.append([dict(zip(labels, line.split(','))) for line in lines[1:]])
+def seconds(updateTime):
+    return calendar.timegm(time.strptime(updateTime[:19], '%Y/%m/%d %H:%M:%S')) + float(updateTime[19:] or 0)
+def result(fileName): # the output's rows, as {key: (value, numFlights)}
+    lines = open(tmp + '/' + fileName).read().splitlines()
+    return dict((tuple(line.split(',')[:-2]), (line.split(',')[-2], int(line.split(',')[-1]))) for line in lines[1:])
+problems = []
+
+# "time by OSD.flycState": the time from each row to the next, by the row's flight mode:
+expected = {}
+for rows in flights:
+    modes = set()
+    for row, nextRow in zip(rows, rows[1:]):
+        mode = row['OSD.flycState']
+        value, numFlights = expected.get((mode,), (0.0, 0))
+        expected[(mode,)] = (value + seconds(nextRow['CUSTOM.updateTime']) - seconds(row['CUSTOM.updateTime']),
+                             numFlights + (mode not in modes))
+        modes.add(mode)
+actual = result('time.csv')
+if sorted(actual) != sorted(expected) or any(abs(float(actual[key][0]) - expected[key][0]) > 0.001
+                                             or actual[key][1] != expected[key][1] for key in expected):
+    problems.append('time by OSD.flycState: %s, not %s' % (actual, expected))
+
+# "max(OSD.height)" and "min(OSD.latitude) by DETAILS.aircraftName", over every row:
+for fileName, function, field, key in (('max.csv', max, 'OSD.height', None),
+                                       ('min.csv', min, 'OSD.latitude', 'DETAILS.aircraftName')):
+    expected = {}
+    for rows in flights:
+        for k in set(row[key] if key else None for row in rows if row[field] != ''):
+            values = [row[field] for row in rows if row[field] != '' and (key is None or row[key] == k)]
+            value = function(values, key=float)
+            expectedValue, numFlights = expected.get((k,) if key else (), (value, 0))
+            expected[(k,) if key else ()] = (function(value, expectedValue, key=float), numFlights + 1)
+    actual = result(fileName)
+    # (The values are output as in the CSV output, at the precision of the field:)
+    if actual != expected:
+        problems.append('%s(%s): %s, not %s' % (function.__name__, field, actual, expected))
+
+for problem in problems:
+    print('FAILED: --aggregate: %s' % problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -rf "$TMP/logs" "$TMP"/*.csv
@@ -0,0 +1,12 @@
+# Checks the export of a "FlightTable" through the Arrow C Data Interface, by importing each test log into a
+# standard consumer (pyarrow, if it's installed), using the shared library "arrowExportLibrary.so".
+
+if [ -n "$PYTHON" ]; then
+  for log in a b; do
+    $PYTHON "$TESTS/arrowImport.py" "$TESTS/arrowExportLibrary.so" "$DATA/$log.txt" "$DATA/$log.csv" 2>/dev/null
+    case $? in
+      0|77) ;;
+      *) fail "Arrow export of $log.txt, imported by pyarrow" ;;
+    esac
+  done
+fi
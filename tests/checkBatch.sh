@@ -0,0 +1,40 @@
+# Checks --batch: each new or changed log in the input directory is processed, and its output (and JPEG archive)
+# written to the output directory, which also holds a manifest of the results.  When it's run again, only the logs
+# that have changed since then are processed.
+
+inputDirectory="$TMP/batchInput"
+outputDirectory="$TMP/batchOutput"
+mkdir "$inputDirectory"
+cp "$DATA/a.txt" "$DATA/b.txt" "$inputDirectory"
+
+$DJIPARSETXT --batch "$outputDirectory" "$inputDirectory" >/dev/null 2>"$TMP/batch.err" \
+  && grep -q "0 file(s) are up-to-date; 2 file(s) to process" "$TMP/batch.err" \
+  && cmp -s "$outputDirectory/a.csv" "$DATA/a.csv" && cmp -s "$outputDirectory/b.csv" "$DATA/b.csv" \
+  && [ -f "$outputDirectory/a.jpg.tar" ] || fail "batch: processing a directory"
+[ "`grep -v '^#' "$outputDirectory/djiparsetxt-manifest.tsv" | cut -f1,5 | tr '\t\n' ': '`" = "a.txt:a.csv b.txt:b.csv " ] \
+  || fail "batch: the manifest"
+
+# Running it again processes nothing - even after a log has been 'touched' (but not changed):
+touch "$inputDirectory/a.txt"
+$DJIPARSETXT --batch "$outputDirectory" "$inputDirectory" >/dev/null 2>"$TMP/batch.err" \
+  && grep -q "2 file(s) are up-to-date; 0 file(s) to process" "$TMP/batch.err" || fail "batch: running again"
+
+# A changed log is processed again:
+cp "$DATA/b.txt" "$inputDirectory/a.txt"
+$DJIPARSETXT --batch "$outputDirectory" "$inputDirectory" >/dev/null 2>"$TMP/batch.err" \
+  && grep -q "1 file(s) are up-to-date; 1 file(s) to process" "$TMP/batch.err" \
+  && cmp -s "$outputDirectory/a.csv" "$DATA/b.csv" || fail "batch: a changed log"
+
+# A log that's been removed is dropped from the manifest:
+rm "$inputDirectory/b.txt"
+$DJIPARSETXT --batch "$outputDirectory" "$inputDirectory" >/dev/null 2>&1 \
+  && [ "`grep -v '^#' "$outputDirectory/djiparsetxt-manifest.tsv" | cut -f1`" = "a.txt" ] \
+  || fail "batch: the manifest, after a log has been removed"
+
+# A ".txt.gz" log whose ".txt" log is also in the directory (so that their output would have the same name) is
+# skipped:
+gzip -c "$DATA/a.txt" >"$inputDirectory/a.txt.gz"
+$DJIPARSETXT --batch "$outputDirectory" "$inputDirectory" >/dev/null 2>"$TMP/batch.err" \
+  && grep -q "Skipping .*a.txt.gz" "$TMP/batch.err" && ! grep -q "a.txt.gz" "$outputDirectory/djiparsetxt-manifest.tsv" \
+  && cmp -s "$outputDirectory/a.csv" "$DATA/b.csv" || fail "batch: a .txt.gz log with the same output name as a .txt log"
+rm -rf "$inputDirectory" "$outputDirectory"
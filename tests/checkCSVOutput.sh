@@ -0,0 +1,10 @@
+# Checks the CSV output for each test log, which must match its expected output exactly - both when the records
+# are parsed in a pipeline of threads, and sequentially.
+# (The embedded JPEG images are written to an archive in the temporary directory, not beside the log.)
+
+for log in a b; do
+  for options in "" "-s"; do
+    $DJIPARSETXT $options -j "$TMP/$log.jpg.tar" "$DATA/$log.txt" >"$TMP/$log.csv" 2>/dev/null \
+      && cmp -s "$TMP/$log.csv" "$DATA/$log.csv" || fail "CSV output for $log.txt (options: \"$options\")"
+  done
+done
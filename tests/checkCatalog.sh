@@ -0,0 +1,73 @@
+# Checks --catalog and --query, over a directory holding both test logs and a gzip-compressed copy of one of them:
+# each flight's catalog entry must have the serial numbers, time and location from its log, each query must match
+# just the flights that it should, and running --catalog again must parse only the logs that have changed.
+
+mkdir "$TMP/logs"
+cp "$DATA/a.txt" "$DATA/b.txt" "$TMP/logs/" && gzip -c "$DATA/a.txt" >"$TMP/logs/c.txt.gz"
+$DJIPARSETXT --catalog "$TMP/flights.catalog" "$TMP/logs" 2>"$TMP/catalog.err" \
+  && grep -q '3 flight(s) (3 parsed, 0 unchanged); 0 file(s) failed' "$TMP/catalog.err" || fail "--catalog"
+$DJIPARSETXT --catalog "$TMP/flights.catalog" "$TMP/logs" 2>"$TMP/catalog.err" \
+  && grep -q '3 flight(s) (0 parsed, 3 unchanged)' "$TMP/catalog.err" || fail "--catalog: an unchanged directory"
+head -c 20000 "$DATA/b.txt" >"$TMP/logs/b.txt"
+$DJIPARSETXT --catalog "$TMP/flights.catalog" "$TMP/logs" 2>"$TMP/catalog.err"
+grep -q '2 flight(s) (0 parsed, 2 unchanged); 1 file(s) failed' "$TMP/catalog.err" || fail "--catalog: a truncated log"
+cp "$DATA/b.txt" "$TMP/logs/b.txt"
+$DJIPARSETXT --catalog "$TMP/flights.catalog" "$TMP/logs" 2>"$TMP/catalog.err" \
+  && grep -q '3 flight(s) (1 parsed, 2 unchanged)' "$TMP/catalog.err" || fail "--catalog: a changed log"
+
+# Outputs the files (in order) of the flights that match a query:
+queryFiles() {
+  $DJIPARSETXT --query "$1" "$TMP/flights.catalog" 2>/dev/null | sed 1d | cut -d, -f1 | tr '\n' ' '
+}
+[ "`queryFiles aircraft=AIRCRAFTSN000001`" = "a.txt c.txt.gz " ] || fail "--query aircraft="
+[ "`queryFiles aircraft=SN12345678`" = "b.txt " ] || fail "--query aircraft= (from a 'RECOVER' record)"
+[ "`queryFiles 'battery=BATTSN0000000001 camera=CAMERASN00000001'`" = "a.txt c.txt.gz " ] \
+  || fail "--query battery= camera="
+[ "`queryFiles month=2019-02`" = "a.txt b.txt c.txt.gz " ] || fail "--query month="
+[ "`queryFiles month=2019-03`" = "" ] || fail "--query month= (for another month)"
+[ "`queryFiles 'from=2019-02-12T19:33 to=2019-02-12T19:34'`" = "a.txt b.txt c.txt.gz " ] || fail "--query from= to="
+[ "`queryFiles 'from=2019-02-12T19:33:21'`" = "" ] || fail "--query from= (after the flights)"
+[ "`queryFiles 'aircraft=SN12345678 near=46.51,6.6,1.2'`" = "b.txt " ] || fail "--query near="
+[ "`queryFiles 'near=46.51,6.6,1'`" = "" ] || fail "--query near= (too far)"
+$DJIPARSETXT --query "near=46.5" "$TMP/flights.catalog" >/dev/null 2>&1 && fail "--query: a bad term"
+# (The track passes - at its end - within 1 km of this point, but doesn't start there:)
+[ "`queryFiles 'over=46.52,6.6,1'`" = "a.txt b.txt c.txt.gz " ] || fail "--query over="
+[ "`queryFiles 'over=46.53,6.6,1'`" = "" ] || fail "--query over= (too far)"
+
+if [ -n "$PYTHON" ]; then
+  $DJIPARSETXT --query aircraft=AIRCRAFTSN000001 "$TMP/flights.catalog" >"$TMP/query.csv" 2>/dev/null
+  # (For the passage, use a point that's reached only in the last 0.01-degree grid cell that the track visits:)
+  $DJIPARSETXT --query over=46.511402,6.599574,0.005 "$TMP/flights.catalog" >"$TMP/over.csv" 2>/dev/null
+  $PYTHON - "$TMP" "$DATA/a.csv" <<'END' || fail "--query: the flights' details"
+import sys, math
+tmp = sys.argv[1]
+lines = open(sys.argv[2]).read().splitlines()
+labels = lines[0].split(',')
+rows = [dict(zip(labels, line.split(','))) for line in lines[1:]]
+problems = []
+
+queryLines = open(tmp + '/query.csv').read().splitlines()
+for flight in [dict(zip(queryLines[0].split(','), line.split(','))) for line in queryLines[1:]]:
+    expected = {'timestamp': rows[0]['DETAILS.timestamp'], 'aircraftSn': rows[0]['DETAILS.aircraftSn'],
+                'batterySn': rows[0]['DETAILS.batterySn'], 'cameraSn': rows[0]['DETAILS.cameraSn'],
+                'latitude': rows[0]['DETAILS.latitude'], 'longitude': rows[0]['DETAILS.longitude']}
+    if dict((key, flight[key]) for key in expected) != expected:
+        problems.append('%s: %s, not %s' % (flight['file'], flight, expected))
+
+# The passage (of each flight - b.txt's track is the same as a.txt's) must be the times of the first and last positions in the point's cell:
+over = [line.split(',') for line in open(tmp + '/over.csv').read().splitlines()][1:]
+def cell(row):
+    return (math.floor(float(row['OSD.latitude'])/0.01), math.floor(float(row['OSD.longitude'])/0.01))
+times = [row['CUSTOM.updateTime'] for row in rows]
+inCell = [i for i, row in enumerate(rows) if cell(row) == cell(rows[-1])]
+for flight in over:
+    if flight[-2:] != [times[inCell[0]], times[inCell[-1]]]:
+        problems.append('over=: %s: the passage is %s to %s, not %s to %s'
+                        % (flight[0], flight[-2], flight[-1], times[inCell[0]], times[inCell[-1]]))
+
+for problem in problems:
+    print('FAILED: --query: %s' % problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -rf "$TMP/logs" "$TMP"/flights.catalog "$TMP"/*.csv "$TMP"/catalog.err
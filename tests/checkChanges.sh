@@ -0,0 +1,32 @@
+# Checks --format changes: carrying each column's last value forward, row by row, must give back exactly the
+# expected CSV output.  (Two columns have the same label, "OSD.flightAction"; the first of them never has a value,
+# so a change of that label is a change of the last column with the label.)
+
+for log in a b; do
+  labels=`head -1 "$DATA/$log.csv"`
+  numRows=`expr \`wc -l <"$DATA/$log.csv"\` - 1`
+  $DJIPARSETXT --format changes -j "$TMP/$log.jpg.tar" "$DATA/$log.txt" >"$TMP/$log.changes.csv" 2>/dev/null \
+    && [ "`head -1 "$TMP/$log.changes.csv"`" = "row,column,value" ] \
+    && { echo "$labels"; awk -v labels="$labels" -v numRows=$numRows '
+BEGIN {
+  numColumns = split(labels, label, ",")
+  for (c = 1; c <= numColumns; ++c) lastColumn[label[c]] = c
+}
+NR > 1 { # a line "row,column,value" (the value may contain commas)
+  i = index($0, ","); row = substr($0, 1, i-1) + 0; rest = substr($0, i+1)
+  j = index(rest, ","); column = substr(rest, 1, j-1)
+  newValue[row, column] = substr(rest, j+1); isChanged[row, column] = 1
+}
+END {
+  for (row = 0; row < numRows; ++row) {
+    line = ""
+    for (c = 1; c <= numColumns; ++c) {
+      if ((row, label[c]) in isChanged && lastColumn[label[c]] == c) value[c] = newValue[row, label[c]]
+      line = line (c > 1 ? "," : "") value[c]
+    }
+    print line
+  }
+}' "$TMP/$log.changes.csv"; } >"$TMP/$log.csv" \
+    && cmp -s "$TMP/$log.csv" "$DATA/$log.csv" || fail "--format changes for $log.txt, with values carried forward"
+done
+rm -f "$TMP"/a.* "$TMP"/b.*
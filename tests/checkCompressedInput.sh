@@ -0,0 +1,38 @@
+# Checks reading compressed logs: gzip-compressed (a ".gz" file, or a pipe), and zip archives (created with Python).
+# A ".gz" file, or a zip archive, gives the same output as the uncompressed log; a pipe is parsed as it's read, so
+# the fields from the 'details' area have values only in the final row (as in "<log>.stream.csv").
+
+for log in a b; do
+  gzip -c "$DATA/$log.txt" >"$TMP/$log.txt.gz"
+  $DJIPARSETXT -j "$TMP/$log.jpg.tar" "$TMP/$log.txt.gz" >"$TMP/$log.csv" 2>/dev/null \
+    && cmp -s "$TMP/$log.csv" "$DATA/$log.csv" || fail "CSV output for $log.txt.gz"
+  gzip -c "$DATA/$log.txt" | $DJIPARSETXT -j "$TMP/$log.jpg.tar" - >"$TMP/$log.csv" 2>/dev/null \
+    && cmp -s "$TMP/$log.csv" "$DATA/$log.stream.csv" || fail "CSV output for $log.txt, gzip-compressed, from a pipe"
+done
+
+# A truncated ".gz" file is reported as bad:
+head -c 10000 "$TMP/a.txt.gz" >"$TMP/c.txt.gz"
+$DJIPARSETXT -j "$TMP/c.jpg.tar" "$TMP/c.txt.gz" >/dev/null 2>&1 && fail "a truncated .gz file"
+
+if [ -n "$PYTHON" ]; then
+  # A zip archive that contains one log outputs it (to 'stdout'); one that contains several logs outputs each to its
+  # own file, named after it, in the current directory.  Other files in the archive are ignored:
+  $PYTHON -c "
+import sys, zipfile
+with zipfile.ZipFile(sys.argv[1] + '/one.zip', 'w', zipfile.ZIP_DEFLATED) as z:
+    z.write(sys.argv[2] + '/a.txt', 'FLY001.txt')
+with zipfile.ZipFile(sys.argv[1] + '/two.zip', 'w', zipfile.ZIP_DEFLATED) as z:
+    z.write(sys.argv[2] + '/a.txt', 'logs/FLY001.txt')
+    z.writestr('logs/README', 'not a log')
+    z.write(sys.argv[2] + '/b.txt', 'logs/FLY002.txt', zipfile.ZIP_STORED)
+" "$TMP" "$DATA"
+  $DJIPARSETXT -j "$TMP/a.jpg.tar" "$TMP/one.zip" >"$TMP/a.csv" 2>/dev/null \
+    && cmp -s "$TMP/a.csv" "$DATA/a.csv" || fail "CSV output for a zip archive that contains one log"
+  mkdir "$TMP/zip"
+  (cd "$TMP/zip" && $DJIPARSETXT "$TMP/two.zip" >/dev/null 2>&1) \
+    && [ "`ls "$TMP/zip" | tr '\n' ' '`" = "FLY001.csv FLY001.jpg.tar FLY002.csv FLY002.jpg.tar " ] \
+    && cmp -s "$TMP/zip/FLY001.csv" "$DATA/a.csv" && cmp -s "$TMP/zip/FLY002.csv" "$DATA/b.csv" \
+    || fail "CSV output for a zip archive that contains several logs"
+  rm -rf "$TMP/zip" "$TMP"/*.zip
+fi
+rm -f "$TMP"/a.* "$TMP"/b.* "$TMP"/c.*
@@ -0,0 +1,21 @@
+# Checks --compress: the compressed CSV output, decompressed by "gzip" (and "lz4", if it's installed), must match
+# the expected CSV output.
+
+for log in a b; do
+  for method in gzip gzip:1 gzip:9; do
+    $DJIPARSETXT --compress $method -j "$TMP/$log.jpg.tar" "$DATA/$log.txt" 2>/dev/null | gzip -dc >"$TMP/$log.csv" \
+      && cmp -s "$TMP/$log.csv" "$DATA/$log.csv" || fail "CSV output for $log.txt, compressed with --compress $method"
+  done
+  if command -v lz4 >/dev/null 2>&1; then
+    $DJIPARSETXT --compress lz4 -j "$TMP/$log.jpg.tar" "$DATA/$log.txt" 2>/dev/null | lz4 -dc >"$TMP/$log.csv" \
+      && cmp -s "$TMP/$log.csv" "$DATA/$log.csv" || fail "CSV output for $log.txt, compressed with --compress lz4"
+  fi
+done
+$DJIPARSETXT --compress gzip:0 -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 && fail "--compress gzip:0"
+
+# With --batch, the output files are named for their compression:
+mkdir "$TMP/batchInput"
+cp "$DATA/a.txt" "$TMP/batchInput"
+$DJIPARSETXT --compress gzip --batch "$TMP/batchOutput" "$TMP/batchInput" >/dev/null 2>&1 \
+  && gzip -dc "$TMP/batchOutput/a.csv.gz" | cmp -s - "$DATA/a.csv" || fail "--compress gzip, with --batch"
+rm -rf "$TMP/batchInput" "$TMP/batchOutput" "$TMP"/a.* "$TMP"/b.*
@@ -0,0 +1,44 @@
+# Checks --extract: the new ".txt" file for a time range, or a segment, must be a log that parses to just the
+# chosen rows (with the same 'OSD', 'CUSTOM' and 'DETAILS' values as in the expected CSV output of the original).
+
+# Extracts a range from "a.txt" to "$TMP/$1.txt", then parses it (to "$TMP/$1.csv"):
+extract() {
+  $DJIPARSETXT --extract "$TMP/$1.txt" --range "$2" "$DATA/a.txt" >/dev/null 2>&1 \
+    && $DJIPARSETXT -j "$TMP/$1.jpg.tar" "$TMP/$1.txt" >"$TMP/$1.csv" 2>/dev/null
+}
+extract time 2019-02-12T19:33:30,2019-02-12T19:33:31 || fail "--extract --range <fromTime>,<toTime>"
+extract airborne airborne || fail "--extract --range airborne"
+extract goHome mode:3 || fail "--extract --range mode:3"
+extract none landing && fail "--extract: a segment that the flight doesn't have"
+extract none 2019-02-13T00:00,2019-02-14 && fail "--extract: a time range that has no rows"
+extract none 2019-02-12T19:33:31,2019-02-12T19:33:30 && fail "--extract: a bad time range"
+gzip -c "$DATA/a.txt" >"$TMP/a.txt.gz"
+$DJIPARSETXT --extract "$TMP/none.txt" --range airborne "$TMP/a.txt.gz" >/dev/null 2>&1 \
+  && fail "--extract: compressed input"
+
+if [ -n "$PYTHON" ]; then
+  $PYTHON - "$TMP" "$DATA/a.csv" <<'END' || fail "--extract: the extracted rows"
+import sys
+tmp = sys.argv[1]
+def readRows(csvFileName): # (only the 'OSD', 'CUSTOM' and 'DETAILS' values)
+    lines = open(csvFileName).read().splitlines()
+    labels = lines[0].split(',')
+    return [dict((label, field) for label, field in zip(labels, line.split(','))
+                 if label.split('.')[0] in ('OSD', 'CUSTOM', 'DETAILS')) for line in lines[1:]]
+rows = readRows(sys.argv[2])
+problems = []
+
+# (The time range's rows are those from 19:33:30.000 (row 100) up to, but not including, 19:33:31.000 (row 110); the
+# 'airborne' segment is rows 21-179, and the third 'mode' segment ('GoHome') rows 141-179 - see "--segments".)
+for name, startRow, endRow in (('time', 100, 110), ('airborne', 21, 180), ('goHome', 141, 180)):
+    extracted = readRows('%s/%s.csv' % (tmp, name))
+    if extracted != rows[startRow:endRow]:
+        problems.append('%s: %d rows, from %s, not rows %d-%d' % (name, len(extracted),
+            extracted and extracted[0]['CUSTOM.updateTime'], startRow, endRow-1))
+
+for problem in problems:
+    print('FAILED: --extract: %s' % problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -f "$TMP"/time.* "$TMP"/airborne.* "$TMP"/goHome.* "$TMP"/none.* "$TMP"/a.txt.gz
@@ -0,0 +1,18 @@
+# Checks the flight cache file (-c): it's written when a log is first parsed, and then used (if it's up-to-date)
+# instead of parsing the log again.
+
+cp "$DATA/a.txt" "$TMP/c.txt"
+rm -f "$TMP/c.fc"
+$DJIPARSETXT --format parquet -c "$TMP/c.fc" -j "$TMP/c.jpg.tar" "$TMP/c.txt" >"$TMP/c.parquet" 2>"$TMP/c.err" \
+  && grep -q "Wrote the flight cache file" "$TMP/c.err" || fail "flight cache: writing the file"
+$DJIPARSETXT --format parquet -c "$TMP/c.fc" -j "$TMP/c.jpg.tar" "$TMP/c.txt" >"$TMP/c2.parquet" 2>"$TMP/c.err" \
+  && grep -q "Using the flight cache file" "$TMP/c.err" && cmp -s "$TMP/c.parquet" "$TMP/c2.parquet" \
+  || fail "flight cache: using an up-to-date file"
+
+# After the log changes, the file isn't used (but is written again):
+cp "$DATA/b.txt" "$TMP/c.txt"
+$DJIPARSETXT --format parquet -j "$TMP/c.jpg.tar" "$TMP/c.txt" >"$TMP/c.parquet" 2>/dev/null
+$DJIPARSETXT --format parquet -c "$TMP/c.fc" -j "$TMP/c.jpg.tar" "$TMP/c.txt" >"$TMP/c2.parquet" 2>"$TMP/c.err" \
+  && ! grep -q "Using the flight cache file" "$TMP/c.err" && cmp -s "$TMP/c.parquet" "$TMP/c2.parquet" \
+  || fail "flight cache: a file made from an older version of the log"
+rm -f "$TMP"/c.* "$TMP"/c2.*
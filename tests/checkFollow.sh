@@ -0,0 +1,27 @@
+# Checks --follow, by writing a log as the app does - first its header (with its 'header+record-area size' not yet
+# valid), then its records, then its 'details' area, and finally the valid size - while the program follows it.
+# The expected output is "a.stream.csv": the same as "a.csv", except that the fields from the 'details' area (which
+# comes at the end of the file) have values only in the final row.
+
+logSize=`wc -c <"$DATA/a.txt"`
+recordAreaEnd=`od -An -tu8 -N8 "$DATA/a.txt" | tr -d ' '` # the 'header+record-area size'
+recordAreaMiddle=`expr 100 + \( $recordAreaEnd - 100 \) / 2`
+followedLog="$TMP/followed.txt"
+{ head -c 8 /dev/zero; head -c 100 "$DATA/a.txt" | tail -c 92; } >"$followedLog"
+
+$DJIPARSETXT --follow -j "$TMP/followed.jpg.tar" "$followedLog" >"$TMP/followed.csv" 2>/dev/null &
+followPID=$!
+( sleep 30; kill $followPID ) >/dev/null 2>&1 & # in case the program never sees the end of the log
+timeoutPID=$!
+
+sleep 1
+head -c $recordAreaMiddle "$DATA/a.txt" | tail -c +101 >>"$followedLog"
+sleep 1
+head -c $recordAreaEnd "$DATA/a.txt" | tail -c +`expr $recordAreaMiddle + 1` >>"$followedLog"
+sleep 1
+tail -c `expr $logSize - $recordAreaEnd` "$DATA/a.txt" >>"$followedLog"
+dd if="$DATA/a.txt" of="$followedLog" bs=8 count=1 conv=notrunc 2>/dev/null
+
+wait $followPID && cmp -s "$TMP/followed.csv" "$DATA/a.stream.csv" || fail "following a log as it's written"
+kill $timeoutPID 2>/dev/null
+rm -f "$TMP"/followed.*
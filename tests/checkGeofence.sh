@@ -0,0 +1,69 @@
+# Checks --geofence: each visit by a flight to a zone must be output, with its entry and exit times, duration and
+# maximum height as computed from the positions (and times) in the expected CSV output.
+
+cat >"$TMP/zones.txt" <<'END'
+# A rectangle and a triangle that the test flight passes through, and a zone far away:
+site-7 46.505,6.59 46.505,6.61 46.51,6.61 46.51,6.59
+odd,zone 46.5005,6.59 46.502,6.59 46.502,6.61
+elsewhere 47,7 47,7.1 47.1,7.1
+END
+$DJIPARSETXT --geofence "$TMP/zones.txt" "$DATA/a.txt" >"$TMP/a.csv" 2>/dev/null \
+  && [ `wc -l <"$TMP/a.csv"` -eq 3 ] || fail "--geofence"
+grep -q '^[^,]*,"odd,zone",' "$TMP/a.csv" || fail "--geofence: a zone name that needs quoting"
+mkdir "$TMP/logs"
+cp "$DATA/a.txt" "$DATA/b.txt" "$TMP/logs/"
+$DJIPARSETXT -P 1 --geofence "$TMP/zones.txt" "$TMP/logs" >"$TMP/logs1.csv" 2>/dev/null \
+  && $DJIPARSETXT -P 2 --geofence "$TMP/zones.txt" "$TMP/logs" 2>/dev/null | cmp -s - "$TMP/logs1.csv" \
+  && [ "`sed 1d "$TMP/logs1.csv" | cut -d, -f1 | tr '\n' ' '`" = "a.txt a.txt b.txt b.txt " ] \
+  || fail "--geofence: a directory, with several processes"
+echo "bad 46.5,6.6 46.6" >"$TMP/bad.txt"
+$DJIPARSETXT --geofence "$TMP/bad.txt" "$DATA/a.txt" >/dev/null 2>&1 && fail "--geofence: a bad zones file"
+
+if [ -n "$PYTHON" ]; then
+  $PYTHON - "$TMP/a.csv" "$DATA/a.csv" <<'END' || fail "--geofence: the visits"
+import sys, csv
+lines = open(sys.argv[2]).read().splitlines()
+labels = lines[0].split(',')
+rows = [dict(zip(labels, line.split(','))) for line in lines[1:]]
+zones = {'site-7': [(46.505, 6.59), (46.505, 6.61), (46.51, 6.61), (46.51, 6.59)],
+         'odd,zone': [(46.5005, 6.59), (46.502, 6.59), (46.502, 6.61)]}
+def contains(zone, latitude, longitude): # (by the even-odd rule)
+    inside = False
+    for (aLatitude, aLongitude), (bLatitude, bLongitude) in zip(zone, zone[1:] + zone[:1]):
+        if (aLatitude > latitude) != (bLatitude > latitude) and longitude < \
+           aLongitude + (latitude - aLatitude)*(bLongitude - aLongitude)/(bLatitude - aLatitude):
+            inside = not inside
+    return inside
+def seconds(updateTime):
+    return float(updateTime.split(':')[-1]) + 60*int(updateTime.split(':')[-2])
+
+# Each visit, as [zone, first row inside, first row outside, maximum height]:
+expected = []
+for name, zone in zones.items():
+    visit = None
+    for i, row in enumerate(rows):
+        if contains(zone, float(row['OSD.latitude']), float(row['OSD.longitude'])):
+            if visit is None:
+                visit = [name, i, None, row['OSD.height']]
+                expected.append(visit)
+            visit[3] = max(visit[3], row['OSD.height'], key=float)
+        elif visit is not None:
+            visit[2] = i
+            visit = None
+times = [row['CUSTOM.updateTime'] for row in rows]
+visits = list(csv.reader(open(sys.argv[1])))[1:]
+problems = []
+if sorted(visit[1] for visit in visits) != sorted(zones) or len(expected) != len(zones):
+    problems.append('%s, not the visits to %s' % ([visit[1] for visit in visits], sorted(zones)))
+for zone, entryRow, exitRow, maxHeight in expected:
+    visit = [visit for visit in visits if visit[1] == zone][0]
+    if visit[2:4] != [times[entryRow], times[exitRow]] \
+       or visit[4] != '%.1f' % (seconds(times[exitRow]) - seconds(times[entryRow])) or visit[5] != maxHeight:
+        problems.append('%s: %s, not entering at %s, exiting at %s, with a maximum height of %s'
+                        % (zone, visit[2:], times[entryRow], times[exitRow], maxHeight))
+for problem in problems:
+    print('FAILED: --geofence: %s' % problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -rf "$TMP/logs" "$TMP"/*.csv "$TMP"/zones.txt "$TMP"/bad.txt
@@ -0,0 +1,30 @@
+# Checks the 'tar' archive of the embedded JPEG images.  ("a.txt" has two 'JPEG' records, each containing two
+# images.)
+
+rm -f "$TMP/a.jpg.tar"
+$DJIPARSETXT -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 || fail "JPEG archive: parsing a.txt"
+mkdir "$TMP/images"
+if (cd "$TMP/images" && tar xf ../a.jpg.tar); then
+  images=`ls "$TMP/images" | tr '\n' ' '`
+  [ "$images" = "image00001.jpg image00002.jpg image00003.jpg image00004.jpg " ] \
+    || fail "JPEG archive: the images' names ($images)"
+  for image in "$TMP"/images/*; do
+    # Each image begins with a JPEG 'SOI' marker, and ends with an 'EOI' marker:
+    [ "`head -c 2 "$image" | od -An -tx1 | tr -d ' '`" = "ffd8" ] \
+      && [ "`tail -c 2 "$image" | od -An -tx1 | tr -d ' '`" = "ffd9" ] || fail "JPEG archive: $image is not a JPEG image"
+  done
+else
+  fail "JPEG archive: extracting the images (with \"tar\")"
+fi
+rm -rf "$TMP/images"
+
+# By default, the archive is named after the log, in the current directory:
+mkdir "$TMP/images"
+(cd "$TMP/images" && $DJIPARSETXT "$DATA/a.txt" >/dev/null 2>&1) \
+  && cmp -s "$TMP/images/a.jpg.tar" "$TMP/a.jpg.tar" || fail "JPEG archive: the default archive name"
+rm -rf "$TMP/images"
+
+# With -g, each image is preceded by a 'pax' header that records the aircraft's position:
+$DJIPARSETXT -g -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 \
+  && [ "`grep -a -c 'comment=latitude=[0-9.-]* longitude=[0-9.-]* height=' "$TMP/a.jpg.tar"`" = 4 ] \
+  || fail "JPEG archive: geotagged images (-g)"
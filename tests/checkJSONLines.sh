@@ -0,0 +1,70 @@
+# Checks --format jsonl: each line must be a JSON object whose members - in the order of the CSV output's columns,
+# with the fields that haven't been seen yet omitted - have the values (as formatted) of the expected CSV output.
+# (Numbers are compared as their text, so the JSON output must also format them at the same precision.)
+
+for log in a b; do
+  $DJIPARSETXT --format jsonl -j "$TMP/$log.jpg.tar" "$DATA/$log.txt" >"$TMP/$log.jsonl" 2>/dev/null \
+    && [ `wc -l <"$TMP/$log.jsonl"` -eq `expr \`wc -l <"$DATA/$log.csv"\` - 1` ] || fail "--format jsonl for $log.txt"
+  if [ -n "$PYTHON" ]; then
+    $PYTHON - "$TMP/$log.jsonl" "$DATA/$log.csv" <<'END' || fail "--format jsonl for $log.txt: the values"
+import sys, json
+lines = open(sys.argv[2]).read().splitlines()
+labels = lines[0].split(',')
+def text(value): # numbers are parsed as their (unchanged) text
+    return ('True' if value else 'False') if isinstance(value, bool) else value
+for row, line in enumerate(open(sys.argv[1])):
+    members = json.loads(line, object_pairs_hook=list, parse_float=str, parse_int=str)
+    # (A string containing a comma is output unquoted in the CSV, so is masked before splitting the CSV row.)
+    line = lines[row+1]
+    for key, value in members:
+        if isinstance(value, str) and ',' in value:
+            line = line.replace(value, value.replace(',', '\0'))
+    fields = [field.replace('\0', ',') for field in line.split(',')]
+    # (A label can be repeated in the CSV output, for different fields; a member then has the value of one of them.)
+    expected = [label for label, field in zip(labels, fields) if field != '']
+    order = [label for label in labels if label in dict(members)]
+    ok = [key for key, value in members] == sorted(set(order), key=order.index) \
+        and set(expected) <= set(dict(members)) \
+        and all(value is not None and text(value) in [field for label, field in zip(labels, fields) if label == key]
+                for key, value in members)
+    if not ok:
+        print('FAILED: --format jsonl: %s: row %d differs from the CSV output' % (sys.argv[1], row))
+        sys.exit(1)
+END
+  fi
+done
+
+# With --streams, each per-record-type file is also JSON Lines, with the values of the corresponding CSV file:
+$DJIPARSETXT --streams "$TMP/csv." -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 \
+  && $DJIPARSETXT --format jsonl --streams "$TMP/jsonl." -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 \
+  || fail "--format jsonl --streams"
+for recordType in OSD HOME GIMBAL APP_TIP; do
+  [ -f "$TMP/jsonl.$recordType.jsonl" ] || fail "--format jsonl --streams: no file for '$recordType' records"
+  if [ -n "$PYTHON" ]; then
+    $PYTHON - "$TMP/jsonl.$recordType.jsonl" "$TMP/csv.$recordType.csv" <<'END' \
+      || fail "--format jsonl --streams: the values of '$recordType' records"
+import sys, json, csv
+lines = list(csv.reader(open(sys.argv[2])))
+labels = lines[0]
+def text(value):
+    return ('True' if value else 'False') if isinstance(value, bool) else value
+records = open(sys.argv[1]).read().splitlines()
+if len(records) != len(lines)-1:
+    print('FAILED: --format jsonl --streams: %s has %d records, not %d' % (sys.argv[1], len(records), len(lines)-1))
+    sys.exit(1)
+for row, record in enumerate(records):
+    members = json.loads(record, object_pairs_hook=list, parse_float=str, parse_int=str)
+    fields = lines[row+1]
+    # (As in the full rows, fields that haven't been seen are omitted, and a repeated label appears once.)
+    expected = [label for label, field in zip(labels, fields) if field != '']
+    order = [label for label in labels if label in dict(members)]
+    ok = [key for key, value in members] == sorted(set(order), key=order.index) \
+        and set(expected) <= set(dict(members)) \
+        and all(text(value) in [field for label, field in zip(labels, fields) if label == key] for key, value in members)
+    if not ok:
+        print('FAILED: --format jsonl --streams: %s: record %d differs from the CSV file' % (sys.argv[1], row))
+        sys.exit(1)
+END
+  fi
+done
+rm -rf "$TMP"/a.* "$TMP"/b.* "$TMP"/csv.* "$TMP"/jsonl.*
@@ -0,0 +1,14 @@
+# Checks the Parquet output for each test log, by reading it back with a standard reader (pyarrow, if it's
+# installed), and comparing it with the expected CSV output.
+
+for log in a b; do
+  $DJIPARSETXT --format parquet -j "$TMP/$log.jpg.tar" "$DATA/$log.txt" >"$TMP/$log.parquet" 2>/dev/null \
+    || fail "Parquet output for $log.txt"
+  if [ -n "$PYTHON" ]; then
+    $PYTHON "$TESTS/parquetCheck.py" "$TMP/$log.parquet" "$DATA/$log.csv"
+    case $? in
+      0|77) ;;
+      *) fail "Parquet output for $log.txt, read by pyarrow" ;;
+    esac
+  fi
+done
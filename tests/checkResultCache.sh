@@ -0,0 +1,30 @@
+# Checks the result cache (--cache-dir): each output is kept in the cache directory, and is output from there
+# (instead of parsing the log again) when the same log - identified by its contents, not its name - is seen again.
+# (The program reports each cached output that it uses as: Using the cached result "<entry>".)
+
+cacheDirectory="$TMP/cache"
+$DJIPARSETXT --cache-dir "$cacheDirectory" -j "$TMP/a.jpg.tar" "$DATA/a.txt" >"$TMP/a.csv" 2>"$TMP/cache.err" \
+  && ! grep -q 'Using the cached result "[^"]*"$' "$TMP/cache.err" && cmp -s "$TMP/a.csv" "$DATA/a.csv" \
+  || fail "result cache: the first output"
+
+cp "$DATA/a.txt" "$TMP/c.txt"
+$DJIPARSETXT --cache-dir "$cacheDirectory" -j "$TMP/c.jpg.tar" "$TMP/c.txt" >"$TMP/c.csv" 2>"$TMP/cache.err" \
+  && grep -q 'Using the cached result "[^"]*"$' "$TMP/cache.err" && cmp -s "$TMP/c.csv" "$DATA/a.csv" \
+  || fail "result cache: the output for a log that's been seen before"
+cmp -s "$TMP/c.jpg.tar" "$TMP/a.jpg.tar" || fail "result cache: the JPEG archive for a log that's been seen before"
+
+$DJIPARSETXT --cache-dir "$cacheDirectory" -j "$TMP/b.jpg.tar" "$DATA/b.txt" >"$TMP/b.csv" 2>"$TMP/cache.err" \
+  && ! grep -q 'Using the cached result "[^"]*"$' "$TMP/cache.err" && cmp -s "$TMP/b.csv" "$DATA/b.csv" \
+  || fail "result cache: the output for another log"
+
+# A result is used only for the same options:
+$DJIPARSETXT --format parquet -j "$TMP/a.jpg.tar" "$DATA/a.txt" >"$TMP/a.parquet" 2>/dev/null
+$DJIPARSETXT --cache-dir "$cacheDirectory" --format parquet -j "$TMP/c.jpg.tar" "$TMP/c.txt" >"$TMP/c.parquet" \
+    2>"$TMP/cache.err" \
+  && ! grep -q 'Using the cached result "[^"]*"$' "$TMP/cache.err" && cmp -s "$TMP/c.parquet" "$TMP/a.parquet" \
+  || fail "result cache: the output in another format"
+$DJIPARSETXT -g -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1
+$DJIPARSETXT --cache-dir "$cacheDirectory" -g -j "$TMP/c.jpg.tar" "$TMP/c.txt" >"$TMP/c.csv" 2>"$TMP/cache.err" \
+  && cmp -s "$TMP/c.csv" "$DATA/a.csv" && cmp -s "$TMP/c.jpg.tar" "$TMP/a.jpg.tar" \
+  || fail "result cache: geotagged JPEG images"
+rm -rf "$cacheDirectory" "$TMP"/a.* "$TMP"/b.* "$TMP"/c.*
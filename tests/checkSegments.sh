@@ -0,0 +1,53 @@
+# Checks --segments: the index must have a segment for each span of rows (in the expected CSV output) with the
+# motors on, airborne, and going home, and for each flight mode, with the times of its first and last rows - and
+# the byte positions of the segments must span the log's record area.
+
+$DJIPARSETXT --format none --segments "$TMP/a.segments.csv" -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 \
+  && [ "`head -1 "$TMP/a.segments.csv"`" = "kind,label,startRow,endRow,startPosition,endPosition,startTime,endTime" ] \
+  || fail "--segments"
+
+if [ -n "$PYTHON" ]; then
+  recordAreaEnd=`od -An -tu8 -N8 "$DATA/a.txt" | tr -d ' '`
+  $PYTHON - "$TMP/a.segments.csv" "$DATA/a.csv" $recordAreaEnd <<'END' || fail "--segments: the segments"
+import sys
+lines = open(sys.argv[2]).read().splitlines()
+labels = lines[0].split(',')
+rows = [dict(zip(labels, line.split(','))) for line in lines[1:]]
+times = [row['CUSTOM.updateTime'] for row in rows]
+
+# Each span of rows, as (kind, label, startRow, endRow), for which a row's "kind" and "label" are given by "span":
+def spans(kind, span):
+    result, start = [], 0
+    for i in range(1, len(rows) + 1):
+        if i == len(rows) or span(rows[i]) != span(rows[start]):
+            if span(rows[start]) is not None:
+                result.append((kind, span(rows[start]), start, i))
+            start = i
+    return result
+expected = spans('mode', lambda row: row['OSD.flycState']) \
+    + spans('motors', lambda row: '' if row['OSD.isMotorUp'] == 'True' else None) \
+    + spans('airborne', lambda row: '' if row['OSD.groundOrSky'] == 'Sky' else None) \
+    + spans('goHome', lambda row: '' if row['OSD.flycState'] == 'GoHome' else None)
+
+segments = [line.split(',') for line in open(sys.argv[1]).read().splitlines()[1:]]
+problems = []
+if sorted((s[0], s[1], int(s[2]), int(s[3])) for s in segments) != sorted(expected):
+    problems.append('%s, not %s' % ([s[:4] for s in segments], expected))
+if [int(s[2]) for s in segments] != sorted(int(s[2]) for s in segments):
+    problems.append('not ordered by their first row')
+for kind, label, startRow, endRow, startPosition, endPosition, startTime, endTime in segments:
+    startRow, endRow = int(startRow), int(endRow)
+    # (A segment ends at the time of the row that follows it - or, at the end of the flight, of its last row:)
+    if (startTime, endTime) != (times[startRow], times[endRow] if endRow < len(times) else times[-1]):
+        problems.append('%s %s: from %s to %s, not from %s to %s'
+                        % (kind, label, startTime, endTime, times[startRow], times[endRow-1]))
+# (The first row's record follows the 100-byte header, and the last row's ends at the end of the record area.)
+if min(int(s[4]) for s in segments) != 100 or max(int(s[5]) for s in segments) != int(sys.argv[3]):
+    problems.append('the positions don\'t span the record area')
+
+for problem in problems:
+    print('FAILED: --segments: %s' % problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -f "$TMP"/a.*
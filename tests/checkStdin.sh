@@ -0,0 +1,15 @@
+# Checks reading a log from 'stdin' ("-").  If 'stdin' is a file, the output is the same as when the file is named;
+# if it's a pipe, the log is parsed as it's read, so the fields from the 'details' area (which comes at the end of the
+# file) have values only in the final row, as in "<log>.stream.csv".
+
+for log in a b; do
+  $DJIPARSETXT -j "$TMP/$log.jpg.tar" - <"$DATA/$log.txt" >"$TMP/$log.csv" 2>/dev/null \
+    && cmp -s "$TMP/$log.csv" "$DATA/$log.csv" || fail "CSV output for $log.txt, read from 'stdin' (a file)"
+  cat "$DATA/$log.txt" | $DJIPARSETXT -j "$TMP/$log.jpg.tar" - >"$TMP/$log.csv" 2>/dev/null \
+    && cmp -s "$TMP/$log.csv" "$DATA/$log.stream.csv" || fail "CSV output for $log.txt, read from 'stdin' (a pipe)"
+done
+
+# A log that ends early (i.e., that's truncated) is reported as bad:
+head -c 20000 "$DATA/a.txt" | $DJIPARSETXT -j "$TMP/a.jpg.tar" - >/dev/null 2>&1 \
+  && fail "a truncated log, read from 'stdin'"
+rm -f "$TMP"/a.* "$TMP"/b.*
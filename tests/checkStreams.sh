@@ -0,0 +1,41 @@
+# Checks --streams: every record of each type is output to its own CSV file, whose rows begin with the record's
+# sequence number ("seq") and the number of the most recent normal CSV row ("osdRow").  The normal CSV output is
+# unchanged.
+
+$DJIPARSETXT --streams "$TMP/streams." -j "$TMP/a.jpg.tar" "$DATA/a.txt" >"$TMP/a.csv" 2>/dev/null \
+  && cmp -s "$TMP/a.csv" "$DATA/a.csv" || fail "--streams: the CSV output"
+for recordType in OSD HOME GIMBAL CUSTOM SMART_BATTERY RECOVER APP_TIP; do
+  [ -f "$TMP/streams.$recordType.csv" ] || fail "--streams: no file for '$recordType' records"
+done
+[ `wc -l <"$TMP/streams.OSD.csv"` -eq `wc -l <"$DATA/a.csv"` ] || fail "--streams: a row for each 'OSD' record"
+
+if [ -n "$PYTHON" ]; then
+  $PYTHON - "$TMP" "$DATA/a.csv" <<'END' || fail "--streams: the contents of the files"
+import sys, csv, glob
+osdRows = list(csv.reader(open(sys.argv[2])))
+problems = []
+for fileName in sorted(glob.glob(sys.argv[1] + '/streams.*.csv')):
+    rows = list(csv.reader(open(fileName)))
+    header, rows = rows[0], rows[1:]
+    if header[:2] != ['seq', 'osdRow']:
+        problems.append('%s: the header' % fileName)
+    for i, row in enumerate(rows):
+        if len(row) != len(header) or row[0] != str(i) or int(row[1]) >= len(osdRows) - 1 \
+           or (i > 0 and int(row[1]) < int(rows[i-1][1])):
+            problems.append('%s: row %d: %s' % (fileName, i, row[:2]))
+            break
+    if fileName.endswith('.OSD.csv'): # each row's OSD values are those of the CSV row that it began
+        columns = [(c, [o for o, l in enumerate(osdRows[0]) if l == label][header[:c].count(label)])
+                   for c, label in enumerate(header) if label.startswith('OSD.')] # (a label may be repeated)
+        for i, row in enumerate(rows):
+            if row[1] != str(i) or any(row[c] != osdRows[i+1][o] for c, o in columns):
+                problems.append('%s: row %d differs from the CSV output' % (fileName, i))
+                break
+    if fileName.endswith('.APP_TIP.csv') and rows != [['0', '100', '10.0', 'Tip: "quoted", with comma']]:
+        problems.append('%s: a quoted value' % fileName)
+for problem in problems:
+    print('FAILED: --streams: ' + problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -f "$TMP"/streams.* "$TMP"/a.*
@@ -0,0 +1,69 @@
+# Checks --track: the GPX, KML and GeoJSON tracks (written in the same pass) must have the aircraft's position (and
+# height) from each CSV row, in order - and (for GPX and GeoJSON) that row's time - and --track-min-distance must
+# keep only positions that are far enough apart.
+
+$DJIPARSETXT --format none --track "$TMP/a.gpx" --track "$TMP/a.kml" --track "$TMP/a.geojson" \
+  -j "$TMP/a.jpg.tar" "$DATA/a.txt" >"$TMP/a.out" 2>/dev/null \
+  && [ -s "$TMP/a.gpx" -a -s "$TMP/a.kml" -a -s "$TMP/a.geojson" ] || fail "--track"
+[ -s "$TMP/a.out" ] && fail "--track: output with --format none"
+$DJIPARSETXT --format none --track "$TMP/a.track" -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 \
+  && fail "--track: a file name with an unknown suffix"
+$DJIPARSETXT --format none --track "$TMP/a.gpx" --track "$TMP/a2.gpx" -j "$TMP/a.jpg.tar" "$DATA/a.txt" \
+  >/dev/null 2>&1 && cmp -s "$TMP/a.gpx" "$TMP/a2.gpx" || fail "--track: two files of the same format"
+$DJIPARSETXT --format none --track "$TMP/min.gpx" --track-min-distance 50 -j "$TMP/a.jpg.tar" "$DATA/a.txt" \
+  >/dev/null 2>&1 || fail "--track-min-distance"
+
+if [ -n "$PYTHON" ]; then
+  $PYTHON - "$TMP" "$DATA/a.csv" <<'END' || fail "--track: the positions"
+import sys, re, json, math
+tmp = sys.argv[1]
+rows = [line.split(',') for line in open(sys.argv[2]).read().splitlines()]
+labels = rows.pop(0)
+time, latitude, longitude, height = [labels.index(label) for label in
+                                     ('CUSTOM.updateTime', 'OSD.latitude', 'OSD.longitude', 'OSD.height')]
+positions = [(row[latitude], row[longitude], row[height]) for row in rows]
+times = [row[time].replace('/', '-').replace(' ', 'T') + 'Z' for row in rows]
+problems = []
+
+gpx = re.findall(r'<trkpt lat="([^"]*)" lon="([^"]*)"><ele>([^<]*)</ele>(?:<time>([^<]*)</time>)?</trkpt>',
+                 open(tmp + '/a.gpx').read())
+if [point[:3] for point in gpx] != positions:
+    problems.append('the GPX track positions')
+if [point[3] for point in gpx] != times:
+    problems.append('the GPX track times')
+kml = open(tmp + '/a.kml').read()
+kml = kml[kml.index('<LineString>'):]
+kml = kml[kml.index('<coordinates>')+len('<coordinates>'):kml.index('</coordinates>')].split()
+if kml != ['%s,%s,%s' % (position[1], position[0], position[2]) for position in positions]:
+    problems.append('the KML track positions')
+geojson = json.load(open(tmp + '/a.geojson'), parse_float=str, parse_int=str)
+track = [feature for feature in geojson['features'] if feature['geometry']['type'] == 'LineString'][0]
+if track['geometry']['coordinates'] != [[position[1], position[0], position[2]] for position in positions] \
+   or track['properties']['numPoints'] != str(len(positions)):
+    problems.append('the GeoJSON track positions')
+if (track['properties']['startTime'], track['properties']['endTime']) != (times[0], times[-1]):
+    problems.append('the GeoJSON track start and end times')
+
+# With --track-min-distance 50, the kept positions must be (in order) the first position, then each one that's at
+# least 50 m (in 3 dimensions) from the previously-kept one, and the last position:
+def distance(p, q): # (including the difference in height)
+    (pLatitude, pLongitude, pHeight), (qLatitude, qLongitude, qHeight) = [map(float, position) for position in (p, q)]
+    dx = math.radians(qLongitude - pLongitude)*math.cos(math.radians(pLatitude))*6371008.8
+    dy = math.radians(qLatitude - pLatitude)*6371008.8
+    return math.sqrt(dx*dx + dy*dy + (qHeight - pHeight)**2)
+expected = [positions[0]]
+for position in positions[1:-1]:
+    if distance(expected[-1], position) >= 50:
+        expected.append(position)
+expected.append(positions[-1])
+kept = [point[:3] for point in re.findall(r'<trkpt lat="([^"]*)" lon="([^"]*)"><ele>([^<]*)</ele>',
+                                          open(tmp + '/min.gpx').read())]
+if kept != expected:
+    problems.append('--track-min-distance 50: %d positions kept, not %d' % (len(kept), len(expected)))
+
+for problem in problems:
+    print('FAILED: --track: %s' % problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -f "$TMP"/a.* "$TMP"/a2.* "$TMP"/min.*
@@ -0,0 +1,54 @@
+# Checks --track-lod: each simplified track must be a subset (in order) of the aircraft's positions - including the
+# first and last - with fewer positions for a larger tolerance, and must pass within (approximately) its tolerance -
+# plus those of the tracks that it was simplified from - of every position that's left out.
+
+$DJIPARSETXT --format none --track "$TMP/a.gpx" --track "$TMP/a.geojson" --track-lod 50,2,10 \
+  -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 || fail "--track-lod"
+[ `grep -c '<trk>' "$TMP/a.gpx"` -eq 4 ] || fail "--track-lod: a GPX track for each tolerance"
+$DJIPARSETXT --format none --track "$TMP/a.gpx" --track-lod 2,x -j "$TMP/a.jpg.tar" "$DATA/a.txt" >/dev/null 2>&1 \
+  && fail "--track-lod: a bad tolerance"
+
+if [ -n "$PYTHON" ]; then
+  $PYTHON - "$TMP/a.geojson" <<'END' || fail "--track-lod: the simplified tracks"
+import sys, json, math
+tracks = [feature for feature in json.load(open(sys.argv[1]))['features']
+          if feature['geometry']['type'] == 'LineString']
+positions = [tuple(point) for point in tracks[0]['geometry']['coordinates']]
+def xy(point): # (meters, from the first position)
+    return ((point[0] - positions[0][0])*111195.08*math.cos(math.radians(positions[0][1])),
+            (point[1] - positions[0][1])*111195.08)
+def distanceToSegment(p, a, b):
+    (px, py), (ax, ay), (bx, by) = xy(p), xy(a), xy(b)
+    dx, dy = bx - ax, by - ay
+    t = 0.0 if dx == 0 and dy == 0 else max(0.0, min(1.0, ((px - ax)*dx + (py - ay)*dy)/(dx*dx + dy*dy)))
+    return math.hypot(px - (ax + t*dx), py - (ay + t*dy))
+
+problems = []
+if [track['properties'].get('tolerance') for track in tracks] != [None, 2, 10, 50]:
+    problems.append('the tolerances (in increasing order)')
+totalTolerance, previous = 0.0, positions
+for track in tracks[1:]:
+    tolerance = track['properties']['tolerance']
+    totalTolerance += tolerance
+    kept = [tuple(point) for point in track['geometry']['coordinates']]
+    indices = [positions.index(point) if point in positions else -1 for point in kept]
+    if -1 in indices or indices != sorted(indices) or indices[0] != 0 or indices[-1] != len(positions) - 1 \
+       or track['properties']['numPoints'] != len(kept):
+        problems.append('%g m: not a subset of the positions, including the first and last' % tolerance)
+        continue
+    if len(kept) >= len(previous):
+        problems.append('%g m: no fewer positions than the track that it was simplified from' % tolerance)
+    previous = kept
+    for i in range(len(indices) - 1):
+        for position in positions[indices[i]+1:indices[i+1]]:
+            if distanceToSegment(position, kept[i], kept[i+1]) > totalTolerance*1.01:
+                problems.append('%g m: a position is %.1f m from the simplified track'
+                                % (tolerance, distanceToSegment(position, kept[i], kept[i+1])))
+                break
+
+for problem in problems:
+    print('FAILED: --track-lod: %s' % problem)
+sys.exit(1 if problems else 0)
+END
+fi
+rm -f "$TMP"/a.*
@@ -0,0 +1,47 @@
+# Compares a table that was read by pyarrow (e.g., from the Parquet output, or imported through the Arrow C Data
+# Interface) with the CSV output for the same log.  (The CSV output doesn't quote its values, so a string value
+# that contains commas spans several of the CSV line's fields.)
+
+import datetime
+
+def valueMatches(value, text):
+    if value is None:
+        return text == ''
+    if isinstance(value, bool):
+        return text.lower() == str(value).lower()
+    if isinstance(value, float): # the CSV output has a fixed number of fractional digits
+        numFractionalDigits = len(text.split('.')[1]) if '.' in text else 0
+        return text != '' and abs(float(text) - value) <= 0.51*10**-numFractionalDigits + 1e-9
+    if isinstance(value, int):
+        return text != '' and int(float(text)) == value
+    if isinstance(value, datetime.datetime):
+        seconds = value.strftime('%Y/%m/%d %H:%M:%S')
+        return text in (seconds, seconds + '.%03d' % (value.microsecond//1000))
+    return text == value
+
+# Returns a list of the differences (at most "maxProblems") between "table" and the CSV file "csvFileName":
+def compareWithCSV(table, csvFileName, maxProblems=10):
+    lines = open(csvFileName, encoding='utf-8', errors='replace').read().splitlines()
+    labels, lines = lines[0].split(','), lines[1:]
+    names = table.schema.names
+
+    problems = []
+    if names != labels:
+        problems.append('the column names differ')
+    if table.num_rows != len(lines):
+        problems.append('%d rows, but %d CSV lines' % (table.num_rows, len(lines)))
+
+    columns = [table.column(i).to_pylist() for i in range(table.num_columns)]
+    for row in range(min(table.num_rows, len(lines))):
+        fields = lines[row].split(',')
+        f = 0
+        for c, name in enumerate(names):
+            value = columns[c][row]
+            numFields = value.count(',') + 1 if isinstance(value, str) else 1
+            text = ','.join(fields[f:f + numFields])
+            f += numFields
+            if not valueMatches(value, text):
+                problems.append('row %d, column %s: %r vs. %r (CSV)' % (row, name, value, text))
+        if f != len(fields):
+            problems.append('row %d: %d CSV fields, but %d were expected' % (row, len(fields), f))
+    return problems[:maxProblems]
@@ -0,0 +1,23 @@
+#!/usr/bin/env python3
+# Usage: parquetCheck.py <parquetFile> <csvFile>
+# Reads a Parquet file (output by "djiparsetxt --format parquet") using a standard reader (pyarrow), and checks
+# that it contains the same rows and values as the CSV output for the same log.
+# Exits with status 0 iff they match; 77 (i.e., 'skipped') if pyarrow isn't installed.
+
+import sys
+
+try:
+    import pyarrow.parquet
+except ImportError:
+    print('pyarrow is not installed; skipping the Parquet check')
+    sys.exit(77)
+from csvCompare import compareWithCSV
+
+table = pyarrow.parquet.ParquetFile(sys.argv[1]).read()
+problems = compareWithCSV(table, sys.argv[2])
+
+for problem in problems:
+    print('FAILED: Parquet round trip: %s: %s' % (sys.argv[1], problem))
+if problems:
+    sys.exit(1)
+print('%s: %d rows and %d columns match the CSV output' % (sys.argv[1], table.num_rows, table.num_columns))
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Runs the tests (as "make check", from the top-level directory):
+#	- the behavior tests of the program's components ("unitTests.cpp");
+#	- each "check*.sh" script, which checks one feature of the program's output.
+# The test logs - small synthetic logs, one scrambled and one in the old (unscrambled) format - and their
+# expected CSV output are in "tests/data".  Checks that need Python 3 (to read the output) are skipped if it
+# isn't installed.
+
+# (All of the paths are absolute, so that a test can run the program in another directory.)
+TESTS=`cd "\`dirname "$0"\`" && pwd`
+DATA="$TESTS/data"
+DJIPARSETXT="`pwd`/djiparsetxt"
+TMP=`mktemp -d "${TMPDIR:-/tmp}/djiparsetxt-tests.XXXXXX"` || exit 1
+trap 'rm -rf "$TMP"' 0
+
+numFailures=0
+fail() {
+  echo "FAILED: $1"
+  numFailures=`expr $numFailures + 1`
+}
+
+if command -v python3 >/dev/null 2>&1; then PYTHON=python3; else PYTHON=; fi
+
+echo "Running the unit tests:"
+"$TESTS/unitTests" "$DATA" "$TMP" 2>"$TMP/unitTests.err" || fail "unit tests (see above)"
+
+for script in "$TESTS"/check*.sh; do
+  echo "Running `basename "$script"`"
+  . "$script"
+done
+
+if [ $numFailures -ne 0 ]; then
+  echo "$numFailures test(s) failed"
+  exit 1
+fi
+echo "All tests passed"
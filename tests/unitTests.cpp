@@ -0,0 +1,1060 @@
+/**********
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********/
+/*
+    A C++ program to parse DJI's ".txt" log files (recorded by the "DJI Go 4" app).
+    Version 2019-02-08
+
+    Copyright (c) 2019 Live Networks, Inc.  All rights reserved.
+    For the latest version of this program (and more information), visit http://djilogs.live555.com
+
+    Tests of the program's components (run by "make check").
+    Implementation.
+*/
+
+// Usage: unitTests <dataDirectory> <temporaryDirectory>
+// Each test checks the behavior of one component - using the (small, synthetic) logs in <dataDirectory> where
+// it needs a parsed flight - and reports each failed check.  The exit status is 0 iff every check passed.
+
+#include "DJITxtParser.hh"
+#include "DJITxtFile.hh"
+#include "StreamingParser.hh"
+#include "FlightTable.hh"
+#include "ArrowExport.hh"
+#include "ParquetWriter.hh"
+#include "FileHash.hh"
+#include "FlightCache.hh"
+#include "OutputCompressor.hh"
+#include "TrackSimplifier.hh"
+#include "Geofence.hh"
+#include "FlightSegmenter.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+static char const* dataDirectory;
+static char const* temporaryDirectory;
+static unsigned numChecks = 0, numFailures = 0;
+
+static void check(int condition, char const* testName, char const* description) {
+  ++numChecks;
+  if (!condition) {
+    ++numFailures;
+    printf("FAILED: %s: %s\n", testName, description);
+  }
+}
+
+static std::string dataFileName(char const* name) {
+  return std::string(dataDirectory) + "/" + name;
+}
+
+static std::string temporaryFileName(char const* name) {
+  return std::string(temporaryDirectory) + "/" + name;
+}
+
+static int readFile(std::string const& fileName, std::string& result) {
+  result.clear();
+  FILE* fid = fopen(fileName.c_str(), "rb");
+  if (fid == NULL) return 0;
+
+  char buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof buffer, fid)) > 0) result.append(buffer, n);
+  fclose(fid);
+  return 1;
+}
+
+static int createFile(std::string const& fileName) {
+  return open(fileName.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+}
+
+// A pseudo-random number generator (so that each run of the tests uses the same data):
+static u_int32_t randomState = 1;
+static u_int32_t nextRandom() {
+  randomState = randomState*1103515245 + 12345;
+  return randomState >> 8;
+}
+
+// Parses a flight into a "FlightTable" (or, if "outputFD" is not -1, outputs it as CSV), optionally also
+// adding an observer.
+// Returns the table (or NULL):
+static FlightTable* parseFlight(char const* txtFileName, int outputFD = -1, FlightObserver* observer = NULL) {
+  DJITxtFile* file = DJITxtFile::createNew(dataFileName(txtFileName).c_str());
+  if (file == NULL) return NULL;
+
+  DJITxtParser* parser = DJITxtParser::createNew(outputFD < 0 ? ROW_OUTPUT_NONE : ROW_OUTPUT_CSV, outputFD);
+  parser->disableJPEGOutput();
+  if (outputFD < 0) parser->enableFlightTable();
+  if (observer != NULL) (void)parser->addFlightObserver(observer);
+
+  (void)parser->parseFile(*file, 0/*sequentially*/);
+  FlightTable* table = outputFD < 0 ? parser->detachFlightTable() : NULL;
+
+  delete parser;
+  delete file;
+  return table;
+}
+
+////////// The columnar flight table //////////
+
+// Returns 1 iff the value of "column" in row "row" is output (in the CSV output) as "text":
+static int valueMatches(FlightColumn const& column, unsigned row, std::string const& text) {
+  if (!column.isValid(row)) return text.empty();
+
+  char buffer[100];
+  switch (column.type()) {
+    case FlightColumnInt64: {
+      snprintf(buffer, sizeof buffer, "%lld", (long long)column.int64Values()[row]);
+      return text == buffer;
+    }
+    case FlightColumnDouble: {
+      snprintf(buffer, sizeof buffer, "%.*f", column.numFractionalDigits(), column.doubleValues()[row]);
+      return text == buffer;
+    }
+    case FlightColumnBoolean: {
+      return text == (column.booleanValues()[row] ? "True" : "False");
+    }
+    case FlightColumnTimestamp: { // the CSV output omits the milliseconds of some timestamps
+      int64_t milliseconds = column.int64Values()[row];
+      time_t seconds = (time_t)(milliseconds/1000);
+      struct tm t;
+      strftime(buffer, sizeof buffer, "%Y/%m/%d %H:%M:%S", gmtime_r(&seconds, &t));
+      std::string withSeconds = buffer;
+      snprintf(buffer, sizeof buffer, ".%03d", (int)(milliseconds%1000));
+      return text == withSeconds || text == withSeconds + buffer;
+    }
+    case FlightColumnString: {
+      u_int32_t const* offsets = column.stringOffsets();
+      return text == std::string(column.stringData() + offsets[row], offsets[row+1] - offsets[row]);
+    }
+    case FlightColumnDictionary: {
+      int32_t index = column.dictionaryIndices()[row];
+      u_int32_t const* offsets = column.dictionaryOffsets();
+      return text == std::string(column.dictionaryData() + offsets[index], offsets[index+1] - offsets[index]);
+    }
+    default: {
+      return text.empty();
+    }
+  }
+}
+
+// Returns 1 iff "table" has the same columns, rows and values as the CSV file "csvFileName".
+// (The CSV output doesn't quote its values, so a string value that contains commas spans several fields.)
+static int tableMatchesCSV(FlightTable const& table, std::string const& csvFileName, char const* testName) {
+  std::string csv;
+  if (!readFile(csvFileName, csv)) return 0;
+
+  std::vector<std::string> lines;
+  for (size_t start = 0; start < csv.size(); ) {
+    size_t end = csv.find('\n', start);
+    if (end == std::string::npos) end = csv.size();
+    lines.push_back(csv.substr(start, end - start));
+    start = end + 1;
+  }
+  if (lines.size() != table.numRows() + 1) return 0;
+
+  for (unsigned i = 0; i < lines.size(); ++i) {
+    std::vector<std::string> fields;
+    for (size_t start = 0; ; ) {
+      size_t end = lines[i].find(',', start);
+      fields.push_back(lines[i].substr(start, end == std::string::npos ? end : end - start));
+      if (end == std::string::npos) break;
+      start = end + 1;
+    }
+
+    unsigned f = 0;
+    for (unsigned c = 0; c < table.numColumns(); ++c) {
+      FlightColumn const& column = *table.column(c); // alias
+      if (i == 0) { // the column labels
+	if (f >= fields.size() || fields[f++] != column.name()) return 0;
+	continue;
+      }
+
+      unsigned row = i - 1;
+      unsigned numFields = 1;
+      if (column.isValid(row) && column.type() == FlightColumnString) {
+	u_int32_t const* offsets = column.stringOffsets();
+	for (u_int32_t j = offsets[row]; j < offsets[row+1]; ++j) numFields += column.stringData()[j] == ',';
+      }
+      if (f + numFields > fields.size()) return 0;
+      std::string text = fields[f];
+      for (unsigned j = 1; j < numFields; ++j) text += "," + fields[f+j];
+      f += numFields;
+
+      if (!valueMatches(column, row, text)) {
+	printf("%s: row %u, column %s: \"%s\" (CSV)\n", testName, row, column.name(), text.c_str());
+	return 0;
+      }
+    }
+    if (f != fields.size()) return 0;
+  }
+  return 1;
+}
+
+static void testFlightTable() {
+  char const* const name = "FlightTable";
+  char const* const logs[2] = { "a"/*scrambled*/, "b"/*old format*/ };
+
+  for (unsigned i = 0; i < 2; ++i) {
+    std::string txtFileName = std::string(logs[i]) + ".txt";
+    FlightTable* table = parseFlight(txtFileName.c_str());
+    check(table != NULL && table->numRows() > 0, name, "parsing a log into a table");
+    if (table == NULL) continue;
+
+    // The table holds the same rows (and values) as the CSV output:
+    char description[100];
+    snprintf(description, sizeof description, "the table of %s matches its CSV output", txtFileName.c_str());
+    check(tableMatchesCSV(*table, dataFileName((std::string(logs[i]) + ".csv").c_str()), name), name, description);
+
+    if (i == 0) {
+      // Each column's type is chosen from its field's first value:
+      FlightColumn const* latitude = table->lookupColumn("OSD.latitude");
+      FlightColumn const* flycState = table->lookupColumn("OSD.flycState");
+      FlightColumn const* updateTime = table->lookupColumn("CUSTOM.updateTime");
+      FlightColumn const* isMotorUp = table->lookupColumn("OSD.isMotorUp");
+      check(latitude != NULL && latitude->type() == FlightColumnDouble && latitude->nullCount() == 0, name,
+	    "a numeric column");
+      check(flycState != NULL && flycState->type() == FlightColumnDictionary && flycState->dictionarySize() < 10,
+	    name, "an interpreted column (a dictionary of its values)");
+      check(updateTime != NULL && updateTime->type() == FlightColumnTimestamp
+	    && updateTime->int64Values()[1] - updateTime->int64Values()[0] == 100, name, "a timestamp column");
+      check(isMotorUp != NULL && isMotorUp->type() == FlightColumnBoolean, name, "a boolean column");
+      check(table->lookupColumn("NO.such") == NULL, name, "looking up an unknown column");
+    }
+    delete table;
+  }
+}
+
+////////// The Arrow C Data Interface export //////////
+
+// The Arrow format string for each type of column:
+static char const* arrowFormat(FlightColumnType type) {
+  switch (type) {
+    case FlightColumnInt64: return "l";
+    case FlightColumnDouble: return "g";
+    case FlightColumnBoolean: return "b";
+    case FlightColumnTimestamp: return "tsm:";
+    case FlightColumnString: return "u";
+    case FlightColumnDictionary: return "i";
+    default: return "n";
+  }
+}
+
+static void testArrowExport() {
+  char const* const name = "Arrow export";
+
+  FlightTable* table = parseFlight("a.txt");
+  check(table != NULL, name, "parsing \"a.txt\" into a table");
+  if (table == NULL) return;
+  unsigned const numRows = table->numRows();
+  unsigned const numColumns = table->numColumns();
+
+  struct ArrowSchema schema;
+  struct ArrowArray array;
+  check(exportFlightTableToArrow(table, &schema, &array), name, "exportFlightTableToArrow()");
+  check(strcmp(schema.format, "+s") == 0 && schema.n_children == numColumns
+	&& array.n_children == numColumns && array.length == numRows && array.null_count == 0, name,
+	"the table is exported as a 'struct' array, with a child array for each column");
+
+  // Each child array refers to its column's own data:
+  int childrenMatch = 1;
+  unsigned latitudeIndex = numColumns;
+  for (unsigned i = 0; i < numColumns && childrenMatch; ++i) {
+    FlightColumn const* column = table->column(i);
+    struct ArrowSchema const* childSchema = schema.children[i];
+    struct ArrowArray const* child = array.children[i];
+    childrenMatch = strcmp(childSchema->name, column->name()) == 0
+      && strcmp(childSchema->format, arrowFormat(column->type())) == 0
+      && child->length == numRows && child->null_count == column->nullCount() && child->offset == 0
+      && (column->nullCount() == 0 || column->type() == FlightColumnNull
+	  || child->buffers[0] == column->validityBitmap());
+
+    switch (column->type()) {
+      case FlightColumnDouble: {
+	childrenMatch = childrenMatch && child->buffers[1] == column->doubleValues();
+	if (strcmp(column->name(), "OSD.latitude") == 0) latitudeIndex = i;
+	break;
+      }
+      case FlightColumnBoolean: { // the values are bit-packed
+	u_int8_t const* bits = (u_int8_t const*)child->buffers[1];
+	for (unsigned row = 0; row < numRows && childrenMatch; ++row) {
+	  childrenMatch = !column->isValid(row) || ((bits[row>>3]>>(row&7))&1) == column->booleanValues()[row];
+	}
+	break;
+      }
+      case FlightColumnDictionary: { // the values are indices into a 'utf8' dictionary
+	childrenMatch = childrenMatch && childSchema->dictionary != NULL
+	  && strcmp(childSchema->dictionary->format, "u") == 0 && child->dictionary != NULL
+	  && child->dictionary->length == column->dictionarySize()
+	  && child->dictionary->buffers[2] == column->dictionaryData();
+	break;
+      }
+      default: {
+	break;
+      }
+    }
+  }
+  check(childrenMatch, name, "each child array's name, type, length and buffers");
+  check(latitudeIndex < numColumns, name, "the \"OSD.latitude\" column");
+  if (latitudeIndex == numColumns) return;
+  std::vector<double> latitudes(table->column(latitudeIndex)->doubleValues(),
+				table->column(latitudeIndex)->doubleValues() + numRows);
+
+  // The schema can be released independently of the arrays:
+  schema.release(&schema);
+  check(schema.release == NULL, name, "releasing the schema");
+
+  // A child array that the consumer moves out of the 'struct' array remains valid (and keeps the table alive)
+  // after the 'struct' array has been released:
+  struct ArrowArray latitudeArray = *array.children[latitudeIndex];
+  array.children[latitudeIndex]->release = NULL; // the child has been moved
+  array.release(&array);
+  check(array.release == NULL, name, "releasing the 'struct' array");
+  check(memcmp(latitudeArray.buffers[1], &latitudes[0], numRows*sizeof (double)) == 0, name,
+	"a moved child array remains valid");
+  latitudeArray.release(&latitudeArray);
+  check(latitudeArray.release == NULL, name, "releasing the moved child array (and the table)");
+}
+
+////////// The Parquet writer (and its Thrift 'compact protocol' metadata) //////////
+
+// Thrift compact protocol types:
+#define THRIFT_BOOLEAN_TRUE 1
+#define THRIFT_BOOLEAN_FALSE 2
+#define THRIFT_BYTE 3
+#define THRIFT_I16 4
+#define THRIFT_I32 5
+#define THRIFT_I64 6
+#define THRIFT_DOUBLE 7
+#define THRIFT_BINARY 8
+#define THRIFT_LIST 9
+#define THRIFT_SET 10
+#define THRIFT_MAP 11
+#define THRIFT_STRUCT 12
+
+#define THRIFT_ERROR 1 // exception thrown if the data is bad
+
+// A reader for just enough of the 'Thrift compact protocol' to check Parquet file metadata:
+class ThriftCompactReader {
+public:
+  ThriftCompactReader(u_int8_t const* ptr, u_int8_t const* limit): fPtr(ptr), fLimit(limit) {}
+
+  u_int8_t readByte() {
+    if (fPtr >= fLimit) throw THRIFT_ERROR;
+    return *fPtr++;
+  }
+  u_int64_t readVarint() {
+    u_int64_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      u_int8_t b = readByte();
+      result |= (u_int64_t)(b&0x7F) << shift;
+      if ((b&0x80) == 0) return result;
+    }
+    throw THRIFT_ERROR;
+  }
+  int64_t readInteger() { // i16, i32 or i64 (zigzag-encoded)
+    u_int64_t value = readVarint();
+    return (int64_t)(value >> 1) ^ -(int64_t)(value&1);
+  }
+  std::string readBinary() {
+    u_int64_t size = readVarint();
+    if (size > (u_int64_t)(fLimit - fPtr)) throw THRIFT_ERROR;
+    std::string result((char const*)fPtr, size);
+    fPtr += size;
+    return result;
+  }
+
+  // Reads a field header (updating "lastFieldId").  Returns 0 at the end of the struct:
+  int readFieldHeader(int& lastFieldId, int& type) {
+    u_int8_t b = readByte();
+    if (b == 0) return 0;
+    type = b&0x0F;
+    lastFieldId = (b>>4) != 0 ? lastFieldId + (b>>4) : (int)readInteger();
+    return 1;
+  }
+  unsigned readListHeader(int& elementType) {
+    u_int8_t b = readByte();
+    elementType = b&0x0F;
+    return (b>>4) == 15 ? (unsigned)readVarint() : b>>4;
+  }
+
+  void skip(int type, int isListElement = 0) {
+    switch (type) {
+      case THRIFT_BOOLEAN_TRUE: case THRIFT_BOOLEAN_FALSE: {
+	if (isListElement) (void)readByte(); // (in a field header, the type is the value)
+	break;
+      }
+      case THRIFT_BYTE: { (void)readByte(); break; }
+      case THRIFT_I16: case THRIFT_I32: case THRIFT_I64: { (void)readVarint(); break; }
+      case THRIFT_DOUBLE: {
+	if (fLimit - fPtr < 8) throw THRIFT_ERROR;
+	fPtr += 8;
+	break;
+      }
+      case THRIFT_BINARY: { (void)readBinary(); break; }
+      case THRIFT_LIST: case THRIFT_SET: {
+	int elementType;
+	unsigned size = readListHeader(elementType);
+	for (unsigned i = 0; i < size; ++i) skip(elementType, 1);
+	break;
+      }
+      case THRIFT_STRUCT: {
+	int fieldId = 0, fieldType;
+	while (readFieldHeader(fieldId, fieldType)) skip(fieldType);
+	break;
+      }
+      default: { // (we don't expect maps)
+	throw THRIFT_ERROR;
+      }
+    }
+  }
+
+private:
+  u_int8_t const* fPtr;
+  u_int8_t const* fLimit;
+};
+static void testParquetWriter() {
+  char const* const name = "Parquet writer";
+
+  FlightTable* table = parseFlight("a.txt");
+  check(table != NULL && table->numRows() > 0, name, "parsing \"a.txt\" into a table");
+  if (table == NULL) return;
+
+  // Use small row groups, so that there are several of them:
+  unsigned const rowGroupSize = 64;
+  std::string fileName = temporaryFileName("a.parquet");
+  int fd = createFile(fileName);
+  check(fd >= 0, name, "creating the output file");
+  if (fd < 0) return;
+  ParquetWriter* writer = ParquetWriter::createNew(fd, rowGroupSize);
+  check(writer->writeTable(*table), name, "writeTable()");
+  delete writer;
+  close(fd);
+
+  // The file begins and ends with the 'magic' bytes; its metadata (a Thrift "FileMetaData" struct) precedes
+  // its 4-byte length at the end:
+  std::string file;
+  check(readFile(fileName, file), name, "reading the output");
+  check(file.size() > 12 && file.compare(0, 4, "PAR1") == 0 && file.compare(file.size() - 4, 4, "PAR1") == 0,
+	name, "the 'magic' bytes");
+  if (file.size() <= 12) return;
+  u_int8_t const* end = (u_int8_t const*)file.data() + file.size() - 8;
+  u_int32_t metaDataSize = end[0] | (end[1]<<8) | (end[2]<<16) | ((u_int32_t)end[3]<<24);
+  check(metaDataSize < file.size() - 12, name, "the metadata length");
+  if (metaDataSize >= file.size() - 12) return;
+
+  int version = 0;
+  int64_t numRows = -1, rowGroupRows = 0;
+  unsigned numRowGroups = 0;
+  std::vector<std::string> schemaNames;
+  int metaDataIsValid = 1;
+  try {
+    ThriftCompactReader reader(end - metaDataSize, end);
+    int fieldId = 0, type;
+    while (reader.readFieldHeader(fieldId, type)) {
+      if (fieldId == 1 && type == THRIFT_I32) { // version
+	version = (int)reader.readInteger();
+      } else if (fieldId == 2 && type == THRIFT_LIST) { // schema: a "SchemaElement" for the root, then each column
+	int elementType;
+	unsigned size = reader.readListHeader(elementType);
+	for (unsigned i = 0; i < size; ++i) {
+	  int elementFieldId = 0, elementFieldType;
+	  std::string elementName;
+	  while (reader.readFieldHeader(elementFieldId, elementFieldType)) {
+	    if (elementFieldId == 4 && elementFieldType == THRIFT_BINARY) elementName = reader.readBinary();
+	    else reader.skip(elementFieldType);
+	  }
+	  schemaNames.push_back(elementName);
+	}
+      } else if (fieldId == 3 && type == THRIFT_I64) { // num_rows
+	numRows = reader.readInteger();
+      } else if (fieldId == 4 && type == THRIFT_LIST) { // row_groups
+	int elementType;
+	numRowGroups = reader.readListHeader(elementType);
+	for (unsigned i = 0; i < numRowGroups; ++i) {
+	  int rowGroupFieldId = 0, rowGroupFieldType;
+	  while (reader.readFieldHeader(rowGroupFieldId, rowGroupFieldType)) {
+	    if (rowGroupFieldId == 3 && rowGroupFieldType == THRIFT_I64) rowGroupRows += reader.readInteger();
+	    else reader.skip(rowGroupFieldType);
+	  }
+	}
+      } else {
+	reader.skip(type);
+      }
+    }
+  } catch (int /*e*/) {
+    metaDataIsValid = 0;
+  }
+  check(metaDataIsValid, name, "the metadata can be parsed");
+  check(version == 1, name, "the metadata's version");
+  check(numRows == (int64_t)table->numRows(), name, "the metadata's number of rows");
+  check(numRowGroups == (table->numRows() + rowGroupSize - 1)/rowGroupSize, name, "the number of row groups");
+  check(rowGroupRows == numRows, name, "the row groups' numbers of rows add up to the number of rows");
+  check(schemaNames.size() == table->numColumns() + 1, name, "the schema has the root, then each column");
+  int namesMatch = schemaNames.size() == table->numColumns() + 1;
+  for (unsigned i = 0; namesMatch && i < table->numColumns(); ++i) {
+    namesMatch = schemaNames[i+1] == table->column(i)->name();
+  }
+  check(namesMatch, name, "the schema's column names");
+
+  delete table;
+}
+
+////////// XXH64 //////////
+
+static void testXXH64() {
+  char const* const name = "XXH64";
+
+  // Reference values (from the reference implementation of XXH64):
+  check(hashFileContents((u_int8_t const*)"", 0) == 0xEF46DB3751D8E999ULL, name, "empty input");
+  check(hashFileContents((u_int8_t const*)"abc", 3) == 0x44BC2CF5AD770999ULL, name, "3 bytes (no stripes)");
+  char const* const sentence = "Nobody inspects the spammish repetition";
+  check(hashFileContents((u_int8_t const*)sentence, strlen(sentence)) == 0xFBCEA83C8A378BF1ULL,
+	name, "39 bytes (one stripe, then 8-, 4- and 1-byte tails)");
+
+  u_int8_t data[1027];
+  for (unsigned i = 0; i < sizeof data; ++i) data[i] = i < 1024 ? i&0xFF : "xyz"[i-1024];
+  check(hashFileContents(data, sizeof data) == 0xE146CB31B65BC21AULL, name, "1027 bytes");
+  check(hashFileContents(data, sizeof data, 12345) == 0xE323A559C0F2EE86ULL, name, "1027 bytes, with a seed");
+
+  // The hash of a file is that of its contents:
+  std::string fileName = temporaryFileName("hash.bin");
+  int fd = createFile(fileName);
+  check(fd >= 0 && write(fd, data, sizeof data) == (ssize_t)sizeof data, name, "writing a file");
+  if (fd >= 0) close(fd);
+  u_int64_t fileHash = 0;
+  check(hashFile(fileName.c_str(), fileHash) && fileHash == 0xE146CB31B65BC21AULL, name, "hashFile()");
+}
+
+////////// The flight cache file //////////
+
+static int writeFile(std::string const& fileName, std::string const& data) {
+  int fd = createFile(fileName);
+  if (fd < 0) return 0;
+  int result = write(fd, data.data(), data.size()) == (ssize_t)data.size();
+  close(fd);
+  return result;
+}
+
+// Returns 1 iff opening a copy of a flight cache file (whose data is "data"), after changing it, fails:
+static int changedFileIsRejected(std::string const& data, DJITxtFile const* source) {
+  std::string fileName = temporaryFileName("changed.fc");
+  if (!writeFile(fileName, data)) return 0;
+  FlightTable* table = FlightCache::open(fileName.c_str(), source);
+  delete table;
+  return table == NULL;
+}
+
+static void testFlightCache() {
+  char const* const name = "FlightCache";
+
+  DJITxtFile* source = DJITxtFile::createNew(dataFileName("a.txt").c_str());
+  DJITxtFile* otherSource = DJITxtFile::createNew(dataFileName("b.txt").c_str());
+  FlightTable* table = parseFlight("a.txt");
+  check(source != NULL && otherSource != NULL && table != NULL, name, "parsing \"a.txt\" into a table");
+  if (source == NULL || otherSource == NULL || table == NULL) return;
+
+  std::string fileName = temporaryFileName("a.fc");
+  check(FlightCache::write(*table, *source, fileName.c_str()), name, "writing a flight cache file");
+  delete table;
+
+  // The table that's opened (i.e., mapped) from the file has the same rows and values as the CSV output:
+  table = FlightCache::open(fileName.c_str(), source);
+  check(table != NULL && tableMatchesCSV(*table, dataFileName("a.csv"), name), name,
+	"opening the file (its table matches the CSV output)");
+  delete table;
+
+  // A file that wasn't made from the given source (i.e., that's 'stale') isn't opened:
+  table = FlightCache::open(fileName.c_str(), otherSource);
+  check(table == NULL, name, "a file made from another source");
+  delete table;
+  table = FlightCache::open(temporaryFileName("none.fc").c_str());
+  check(table == NULL, name, "a file that doesn't exist");
+  delete table;
+
+  // Nor is a file that's damaged:
+  std::string data;
+  check(readFile(fileName, data) && data.size() > sizeof (FlightCacheHeader), name, "reading the file");
+  if (data.size() <= sizeof (FlightCacheHeader)) return;
+  check(!changedFileIsRejected(data, source), name, "an unchanged copy of the file");
+  check(changedFileIsRejected(data.substr(0, data.size() - 1), source), name, "a truncated file");
+  std::string changed = data;
+  changed[0] ^= 0xFF;
+  check(changedFileIsRejected(changed, source), name, "a file with the wrong 'magic' bytes");
+  changed = data;
+  ((FlightCacheHeader*)&changed[0])->numRows += 1000;
+  check(changedFileIsRejected(changed, source), name, "a file whose blocks are too small for its number of rows");
+
+  // Including a file whose string offsets, or dictionary indices, would lie outside its data:
+  FlightCacheHeader const* header = (FlightCacheHeader const*)data.data();
+  unsigned dictionaryColumn = header->numColumns;
+  for (unsigned i = 0; i < header->numColumns; ++i) {
+    FlightCacheColumnEntry const* entry
+      = (FlightCacheColumnEntry const*)&data[header->directoryOffset + i*sizeof (FlightCacheColumnEntry)];
+    if (entry->type == FlightColumnDictionary && entry->nullCount == 0) {
+      dictionaryColumn = i;
+      break;
+    }
+  }
+  check(dictionaryColumn < header->numColumns, name, "the file has a dictionary column");
+  if (dictionaryColumn == header->numColumns) return;
+  FlightCacheColumnEntry entry
+    = *(FlightCacheColumnEntry const*)&data[header->directoryOffset + dictionaryColumn*sizeof entry];
+  changed = data;
+  ((u_int32_t*)&changed[entry.offsetsOffset])[1] = 0xFFFFFFF0;
+  check(changedFileIsRejected(changed, source), name, "a file with a bad dictionary offset");
+  changed = data;
+  ((int32_t*)&changed[entry.valuesOffset])[0] = entry.dictionarySize;
+  check(changedFileIsRejected(changed, source), name, "a file with a bad dictionary index");
+
+  delete otherSource;
+  delete source;
+}
+
+////////// The streaming ('push') parser //////////
+
+// Parses "txtFileName" - fed to a "StreamingParser" in chunks of "chunkSize" bytes (or, if "limit" is not 0,
+// only its first "limit" bytes) - outputting CSV to "csvFileName".  Returns the result of "endFeed()":
+static int feedFile(std::string const& data, unsigned chunkSize, std::string const& csvFileName,
+		    unsigned limit = 0) {
+  int fd = createFile(csvFileName);
+  if (fd < 0) return -1;
+
+  DJITxtParser* parser = DJITxtParser::createNew(ROW_OUTPUT_CSV, fd);
+  parser->disableJPEGOutput();
+  StreamingParser* streamingParser = new StreamingParser(*parser);
+
+  unsigned size = limit != 0 && limit < data.size() ? limit : data.size();
+  for (unsigned i = 0; i < size; i += chunkSize) {
+    unsigned n = size - i < chunkSize ? size - i : chunkSize;
+    (void)streamingParser->feed((u_int8_t const*)&data[i], n);
+  }
+  int result = streamingParser->endFeed();
+
+  delete streamingParser;
+  delete parser; // writes out the remaining rows
+  close(fd);
+  return result;
+}
+
+static void testStreamingParser() {
+  char const* const name = "StreamingParser";
+  char const* const txtFileNames[2] = { "a.txt"/*scrambled*/, "b.txt"/*old format*/ };
+
+  for (unsigned f = 0; f < 2; ++f) {
+    // The rows that are output when the whole file is parsed (from memory):
+    std::string parsedFileName = temporaryFileName("parsed.csv");
+    int fd = createFile(parsedFileName);
+    (void)parseFlight(txtFileNames[f], fd);
+    close(fd);
+    std::string parsed, data;
+    check(readFile(parsedFileName, parsed) && parsed.size() > 0, name, "parsing the whole file");
+    check(readFile(dataFileName(txtFileNames[f]), data), name, "reading the file");
+
+    // When the file is fed in one chunk, the same rows are output - except that the fields from the
+    // 'details' area (which comes at the end of the file) have values only in the final row:
+    std::string expectedFileName = temporaryFileName("expected.csv");
+    std::string expected;
+    check(feedFile(data, data.size(), expectedFileName) == 1 && readFile(expectedFileName, expected),
+	  name, "feeding the whole file");
+    size_t const lastRow = expected.rfind('\n', expected.size() - 2);
+    check(lastRow != std::string::npos && parsed.size() > lastRow
+	  && parsed.compare(parsed.rfind('\n', parsed.size() - 2), std::string::npos, expected, lastRow,
+			    std::string::npos) == 0, name, "the final row");
+    unsigned numParsedRows = 0, numExpectedRows = 0;
+    for (size_t i = 0; i < parsed.size(); ++i) numParsedRows += parsed[i] == '\n';
+    for (size_t i = 0; i < expected.size(); ++i) numExpectedRows += expected[i] == '\n';
+    check(numExpectedRows == numParsedRows, name, "the number of rows");
+
+    // The same rows must be output however the data is divided into chunks - including chunks that
+    // end within the header, and within records (and that each contain many records, or only part of one):
+    unsigned const chunkSizes[] = { 1, 2, 3, 7, 64, 1000, 4096 };
+    for (unsigned i = 0; i < sizeof chunkSizes/sizeof chunkSizes[0]; ++i) {
+      std::string outputFileName = temporaryFileName("fed.csv");
+      std::string output;
+      char description[100];
+      snprintf(description, sizeof description, "%s, fed in chunks of %u bytes", txtFileNames[f], chunkSizes[i]);
+      check(feedFile(data, chunkSizes[i], outputFileName) == 1 && readFile(outputFileName, output)
+	    && output == expected, name, description);
+    }
+
+    // Data that ends early is reported as bad:
+    std::string outputFileName = temporaryFileName("fed.csv");
+    check(feedFile(data, 100, outputFileName, 10) == 0, name, "data that ends within the header");
+    check(feedFile(data, 100, outputFileName, data.size()/2) == 0, name, "data that ends within the records");
+  }
+}
+
+////////// The LZ4 frame writer //////////
+
+// Decodes a LZ4 block (appending its data to "result").  Returns 1 iff the block is valid:
+static int lz4DecodeBlock(u_int8_t const* ptr, u_int8_t const* end, std::string& result) {
+  size_t const blockStart = result.size(); // the blocks are independent, so a match can't precede this
+  while (ptr < end) {
+    unsigned token = *ptr++;
+
+    size_t literalLength = token>>4;
+    if (literalLength == 15) {
+      u_int8_t b;
+      do {
+	if (ptr >= end) return 0;
+	b = *ptr++;
+	literalLength += b;
+      } while (b == 255);
+    }
+    if (literalLength > (size_t)(end - ptr)) return 0;
+    result.append((char const*)ptr, literalLength);
+    ptr += literalLength;
+    if (ptr == end) break; // the last sequence has no match
+
+    if (end - ptr < 2) return 0;
+    size_t offset = ptr[0] | (ptr[1]<<8);
+    ptr += 2;
+    if (offset == 0 || offset > result.size() - blockStart) return 0;
+
+    size_t matchLength = token&0x0F;
+    if (matchLength == 15) {
+      u_int8_t b;
+      do {
+	if (ptr >= end) return 0;
+	b = *ptr++;
+	matchLength += b;
+      } while (b == 255);
+    }
+    matchLength += 4;
+
+    size_t from = result.size() - offset;
+    for (size_t i = 0; i < matchLength; ++i) result.push_back(result[from + i]); // (the match may overlap itself)
+  }
+
+  return 1;
+}
+
+static void testLZ4FrameWriter() {
+  char const* const name = "LZ4 frame writer";
+
+  // Input that spans several (1 MByte) blocks: text (that compresses well), runs of one byte (matches that
+  // overlap themselves), then random data (that doesn't compress, so its block must be stored as is):
+  std::string input, csv;
+  check(readFile(dataFileName("a.csv"), csv), name, "reading \"a.csv\"");
+  while (input.size() < 1500000) input += csv;
+  input.append(100000, 'x');
+  for (unsigned i = 0; i < 1200000; ++i) input.push_back((char)nextRandom());
+  input += "the end";
+
+  std::string fileName = temporaryFileName("output.lz4");
+  int fd = createFile(fileName);
+  check(fd >= 0, name, "creating the output file");
+  if (fd < 0) return;
+  OutputCompressor* compressor = OutputCompressor::createNew(fd, COMPRESSION_LZ4);
+  for (size_t i = 0; i < input.size(); ) {
+    // Hand over the data in chunks of various sizes:
+    size_t n = 1 + nextRandom()%100000;
+    if (n > input.size() - i) n = input.size() - i;
+    compressor->write(&input[i], n);
+    i += n;
+  }
+  compressor->finish();
+  check(!compressor->writeFailed(), name, "writing the output");
+  delete compressor;
+  close(fd);
+
+  std::string frame;
+  check(readFile(fileName, frame), name, "reading the output");
+  check(frame.size() < input.size(), name, "the output is smaller than the input");
+  u_int8_t const* ptr = (u_int8_t const*)frame.data();
+  u_int8_t const* end = ptr + frame.size();
+
+  // The frame header: the magic number, then "FLG" (version 01, independent blocks, no checksums or
+  // content size), "BD" (1 MByte maximum block size), and the header checksum:
+  static u_int8_t const expectedHeader[7] = { 0x04, 0x22, 0x4D, 0x18, 0x60, 0x60, 0x51 };
+  check(frame.size() >= sizeof expectedHeader && memcmp(ptr, expectedHeader, sizeof expectedHeader) == 0,
+	name, "the frame header");
+  ptr += sizeof expectedHeader;
+
+  std::string output;
+  unsigned numCompressedBlocks = 0, numStoredBlocks = 0;
+  int isValid = 1, sawEndMark = 0;
+  while (isValid && end - ptr >= 4) {
+    u_int32_t blockSize = ptr[0] | (ptr[1]<<8) | (ptr[2]<<16) | ((u_int32_t)ptr[3]<<24);
+    ptr += 4;
+    if (blockSize == 0) { // the end mark
+      sawEndMark = 1;
+      break;
+    }
+
+    int isStored = (blockSize&0x80000000) != 0;
+    blockSize &= 0x7FFFFFFF;
+    if (blockSize > 1024*1024 || blockSize > (size_t)(end - ptr)) {
+      isValid = 0;
+      break;
+    }
+    if (isStored) {
+      output.append((char const*)ptr, blockSize);
+      ++numStoredBlocks;
+    } else {
+      size_t blockStart = output.size();
+      isValid = lz4DecodeBlock(ptr, ptr + blockSize, output) && output.size() - blockStart <= 1024*1024;
+      ++numCompressedBlocks;
+    }
+    ptr += blockSize;
+  }
+  check(isValid, name, "each block is valid");
+  check(sawEndMark && ptr == end, name, "the frame ends with the end mark");
+  check(numCompressedBlocks > 0 && numStoredBlocks > 0, name, "both compressed and stored blocks");
+  check(output == input, name, "the decompressed output equals the input");
+}
+
+////////// The track simplifier (Douglas-Peucker) //////////
+
+#define METERS_PER_DEGREE (6371008.8*M_PI/180.0)
+
+// Simplifies a track of points that are given as (x,y) offsets (in meters) from (46.5N, 6.6E):
+static void simplifyTrack(std::vector<double> const& xs, std::vector<double> const& ys, double tolerance,
+			  unsigned windowSize, std::vector<unsigned>& kept) {
+  TrackSimplifier simplifier(tolerance, windowSize);
+  double const metersPerDegreeLongitude = METERS_PER_DEGREE*cos(46.5*M_PI/180.0);
+  kept.clear();
+
+  for (unsigned i = 0; i <= xs.size(); ++i) {
+    if (i < xs.size()) {
+      TrackPoint point;
+      point.latitude = 46.5 + ys[i]/METERS_PER_DEGREE;
+      point.longitude = 6.6 + xs[i]/metersPerDegreeLongitude;
+      point.height = 0.0;
+      point.time = i; // (to identify the point)
+      simplifier.addPoint(point);
+    } else {
+      simplifier.finish();
+    }
+    for (unsigned j = 0; j < simplifier.numOutputPoints(); ++j) kept.push_back(simplifier.outputPoint(j).time);
+    simplifier.clearOutput();
+  }
+}
+
+// The distance from point P to the line segment AB:
+static double distanceToSegment(double px, double py, double ax, double ay, double bx, double by) {
+  double dx = bx - ax, dy = by - ay;
+  double lengthSquared = dx*dx + dy*dy;
+  double t = lengthSquared > 0.0 ? ((px - ax)*dx + (py - ay)*dy)/lengthSquared : 0.0;
+  if (t < 0.0) t = 0.0; else if (t > 1.0) t = 1.0;
+  return hypot(ax + t*dx - px, ay + t*dy - py);
+}
+
+static void testTrackSimplifier() {
+  char const* const name = "TrackSimplifier";
+  std::vector<double> xs, ys;
+  std::vector<unsigned> kept;
+
+  // A straight line simplifies to its end points:
+  for (unsigned i = 0; i < 100; ++i) { xs.push_back(i*3.0); ys.push_back(i*4.0); }
+  simplifyTrack(xs, ys, 1.0, DEFAULT_SIMPLIFIER_WINDOW_SIZE, kept);
+  check(kept.size() == 2 && kept[0] == 0 && kept[1] == 99, name, "a straight line");
+
+  // A spike (20 m from the line) is kept if the tolerance is smaller than it, but not otherwise:
+  // (The points on either side of the spike are then also kept, because they're more than the tolerance
+  // from the lines between the spike and the end points.)
+  ys[50] += 20.0;
+  simplifyTrack(xs, ys, 5.0, DEFAULT_SIMPLIFIER_WINDOW_SIZE, kept);
+  check(kept.size() == 5 && kept[1] == 49 && kept[2] == 50 && kept[3] == 51, name,
+	"a spike that's outside the tolerance");
+  simplifyTrack(xs, ys, 25.0, DEFAULT_SIMPLIFIER_WINDOW_SIZE, kept);
+  check(kept.size() == 2, name, "a spike that's within the tolerance");
+
+  // A zigzag (of 5 m) is kept entirely if the tolerance is smaller than it:
+  for (unsigned i = 0; i < 100; ++i) { xs[i] = i*10.0; ys[i] = (i&1)*5.0; }
+  simplifyTrack(xs, ys, 1.0, DEFAULT_SIMPLIFIER_WINDOW_SIZE, kept);
+  check(kept.size() == 100, name, "a zigzag that's outside the tolerance");
+
+  // A random walk - with a window that's much smaller than the track: the kept points are in order,
+  // include the first and last points, and every other point is within the tolerance of the simplified track:
+  xs.assign(2000, 0.0); ys.assign(2000, 0.0);
+  for (unsigned i = 1; i < xs.size(); ++i) {
+    xs[i] = xs[i-1] + (double)(nextRandom()%1000)/100.0 - 4.0;
+    ys[i] = ys[i-1] + (double)(nextRandom()%1000)/100.0 - 5.0;
+  }
+  double const tolerance = 8.0;
+  simplifyTrack(xs, ys, tolerance, 16, kept);
+  int isInOrder = kept.size() >= 2 && kept[0] == 0 && kept.back() == xs.size() - 1;
+  for (unsigned k = 1; isInOrder && k < kept.size(); ++k) isInOrder = kept[k] > kept[k-1];
+  check(isInOrder, name, "a random walk: the kept points are in order, and include the end points");
+  check(kept.size() < xs.size()/2, name, "a random walk: most points are removed");
+  int isWithinTolerance = isInOrder;
+  for (unsigned k = 1; isWithinTolerance && k < kept.size(); ++k) {
+    unsigned a = kept[k-1], b = kept[k];
+    for (unsigned i = a + 1; i < b; ++i) {
+      if (distanceToSegment(xs[i], ys[i], xs[a], ys[a], xs[b], ys[b]) > tolerance + 0.01) {
+	isWithinTolerance = 0;
+	break;
+      }
+    }
+  }
+  check(isWithinTolerance, name, "a random walk: each removed point is within the tolerance");
+}
+
+////////// The geofence (point-in-polygon) test //////////
+
+static void testGeofence() {
+  char const* const name = "Geofence";
+
+  // A pentagram (a self-intersecting zone, whose center - which it encloses twice - is 'outside' it, by the
+  // even-odd rule); a 'U' (a concave zone); and a zone that crosses the 180th meridian:
+  std::string fileName = temporaryFileName("zones.txt");
+  FILE* fid = fopen(fileName.c_str(), "w");
+  check(fid != NULL, name, "creating the zones file");
+  if (fid == NULL) return;
+  fprintf(fid, "# test zones\n\nstar");
+  for (unsigned k = 0; k < 5; ++k) {
+    double angle = (90.0 + 144.0*k)*M_PI/180.0;
+    fprintf(fid, " %.6f,%.6f", 10.0 + sin(angle), 20.0 + cos(angle));
+  }
+  fprintf(fid, "\nu-shape 0,0 0,3 3,3 3,2 1,2 1,1 3,1 3,0\n");
+  fprintf(fid, "dateline -1,179.5 -1,-179.5 1,-179.5 1,179.5\n");
+  fclose(fid);
+
+  GeofenceZones* zones = GeofenceZones::createNew(fileName.c_str());
+  check(zones != NULL && zones->numZones() == 3, name, "reading the zones file");
+  if (zones == NULL || zones->numZones() != 3) return;
+  check(strcmp(zones->zoneName(0), "star") == 0 && strcmp(zones->zoneName(2), "dateline") == 0, name,
+	"the zone names");
+
+  check(zones->contains(0, 10.8, 20.0), name, "a point in one of the star's points");
+  check(!zones->contains(0, 10.0, 20.0), name, "the star's center");
+  check(!zones->contains(0, 10.0, 20.9), name, "a point between the star's points");
+  check(zones->contains(1, 0.5, 1.5), name, "a point in the 'U's base");
+  check(zones->contains(1, 2.5, 0.5) && zones->contains(1, 2.5, 2.5), name, "points in the 'U's arms");
+  check(!zones->contains(1, 2.0, 1.5), name, "a point in the 'U's notch");
+  check(!zones->contains(1, 4.0, 0.5), name, "a point outside the 'U's bounding box");
+  check(zones->contains(2, 0.0, 179.9) && zones->contains(2, 0.0, -179.9), name,
+	"points on either side of the 180th meridian");
+  check(!zones->contains(2, 0.0, 179.0) && !zones->contains(2, 0.0, -179.0), name,
+	"points beyond the zone that crosses the 180th meridian");
+
+  // Each zone is a candidate for the points within it:
+  std::vector<unsigned> const* candidates = zones->candidates(10.8, 20.0);
+  int isCandidate = 0;
+  for (unsigned i = 0; candidates != NULL && i < candidates->size(); ++i) isCandidate |= (*candidates)[i] == 0;
+  check(isCandidate, name, "the grid lists the zone for a point within it");
+  delete zones;
+
+  // "a.txt" (whose rows are 100 ms apart) enters a zone at row 88, and leaves it at row 175; each time is that of
+  // the row's own position:
+  fid = fopen(fileName.c_str(), "w");
+  check(fid != NULL, name, "creating the zones file");
+  if (fid == NULL) return;
+  fprintf(fid, "site-7 46.505,6.59 46.505,6.61 46.51,6.61 46.51,6.59\n");
+  fclose(fid);
+  zones = GeofenceZones::createNew(fileName.c_str());
+  check(zones != NULL, name, "reading the zones file");
+  if (zones == NULL) return;
+  OutputBuffer out(-1);
+  GeofenceMonitor monitor(*zones, out);
+  monitor.setFlightName("a");
+  delete parseFlight("a.txt", -1, &monitor);
+  check(std::string(out.data(), out.size())
+	== "a,site-7,2019/02/12 19:33:28.800,2019/02/12 19:33:37.500,8.7,34.9\n", name, "a visit's entry and exit");
+
+  delete zones;
+}
+
+////////// The flight segmenter //////////
+
+static void testFlightSegmenter() {
+  char const* const name = "FlightSegmenter";
+
+  // "a.txt" (a synthetic log of 200 rows) starts its motors at row 11, takes off at row 21, goes home at
+  // row 141, and lands at row 180:
+  FlightSegmenter segmenter;
+  delete parseFlight("a.txt", -1, &segmenter);
+  check(segmenter.numRows() == 200, name, "the number of rows");
+  check(segmenter.firstRowPosition() == NEW_HEADER_SIZE, name, "the position of the first row");
+
+  struct { int kind; char const* label; unsigned startRow, endRow; } const expected[] = {
+    { SEGMENT_MODE, "Manual", 0, 21 },
+    { SEGMENT_MOTORS, "", 11, 200 },
+    { SEGMENT_AIRBORNE, "", 21, 180 },
+    { SEGMENT_MODE, "GPS_Atti", 21, 141 },
+    { SEGMENT_GO_HOME, "", 141, 180 },
+    { SEGMENT_MODE, "GoHome", 141, 180 },
+    { SEGMENT_MODE, "Manual", 180, 200 }
+  };
+  unsigned const numExpected = sizeof expected/sizeof expected[0];
+  std::vector<FlightSegment> const& segments = segmenter.segments(); // alias
+  check(segments.size() == numExpected, name, "the number of segments");
+  for (unsigned i = 0; i < numExpected && i < segments.size(); ++i) {
+    char description[100];
+    snprintf(description, sizeof description, "segment %u (%s %s)", i,
+	     FlightSegment::kindName(expected[i].kind), expected[i].label);
+    check(segments[i].kind == expected[i].kind && segments[i].label == expected[i].label
+	  && segments[i].startRow == expected[i].startRow && segments[i].endRow == expected[i].endRow
+	  && segments[i].startPosition < segments[i].endPosition && segments[i].startTime <= segments[i].endTime,
+	  name, description);
+
+    // Each segment starts at the time of its first row, and ends at that of the following row (or, at the end of
+    // the flight, of its last row).  (The rows of "a.txt" are 100 ms apart, from 2019-02-12T19:33:20Z.):
+    unsigned const timeEndRow = expected[i].endRow < 200 ? expected[i].endRow : 199;
+    snprintf(description, sizeof description, "segment %u's times", i);
+    check(segments[i].startTime == 1550000000000LL + 100*expected[i].startRow
+	  && segments[i].endTime == 1550000000000LL + 100*timeEndRow, name, description);
+  }
+
+  // Segments that end at the same row end at the same position (that of the row's 'OSD' record):
+  check(segments.size() == numExpected && segments[2].endPosition == segments[4].endPosition
+	&& segments[4].startPosition == segments[5].startPosition, name, "the segments' positions");
+  check(FlightSegment::kindFromName("goHome") == SEGMENT_GO_HOME && FlightSegment::kindFromName("nothing") == -1,
+	name, "segment kind names");
+
+  // A time range - here, from 19:33:30 (the time of row 100) up to, but not including, 19:33:31 - contains the
+  // rows whose own time is in it:
+  FlightSegmenter rangeSegmenter;
+  rangeSegmenter.setTimeRange(1550000010000LL, 1550000011000LL);
+  delete parseFlight("a.txt", -1, &rangeSegmenter);
+  unsigned numTimeRanges = 0;
+  for (unsigned i = 0; i < rangeSegmenter.segments().size(); ++i) {
+    FlightSegment const& segment = rangeSegmenter.segments()[i]; // alias
+    if (segment.kind != SEGMENT_TIME_RANGE) continue;
+    ++numTimeRanges;
+    check(segment.startRow == 100 && segment.endRow == 110, name, "the rows in a time range");
+  }
+  check(numTimeRanges == 1, name, "the number of time range segments");
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s <dataDirectory> <temporaryDirectory>\n", argv[0]);
+    return 1;
+  }
+  dataDirectory = argv[1];
+  temporaryDirectory = argv[2];
+
+  testFlightTable();
+  testArrowExport();
+  testParquetWriter();
+  testXXH64();
+  testFlightCache();
+  testStreamingParser();
+  testLZ4FrameWriter();
+  testTrackSimplifier();
+  testGeofence();
+  testFlightSegmenter();
+
+  printf("%u checks; %u failed\n", numChecks, numFailures);
+  return numFailures == 0 ? 0 : 1;
+}